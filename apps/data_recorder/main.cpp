@@ -3,6 +3,8 @@
 #include <fstream>
 #include <string>
 #include <shared/ArgParser.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <profiler/StatsServer.hpp>
 #include <nlohmann/json.hpp>
 
 using namespace apps::data_recorder;
@@ -47,6 +49,20 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    if (nodes_ipc.contains("thread_config"))
+    {
+        BspThreadConfig::getInstance().loadJsonConfig(nodes_ipc["thread_config"]);
+        BspThreadConfig::getInstance().applyMemoryPolicy();
+    }
+
+    // live metrics endpoint, e.g. "stats_server": {"data_recorder": "tcp:127.0.0.1:9464"}
+    std::unique_ptr<bsp_perf::common::StatsServer> stats_server{nullptr};
+    if (nodes_ipc.contains("stats_server") && nodes_ipc["stats_server"].contains("data_recorder"))
+    {
+        stats_server = std::make_unique<bsp_perf::common::StatsServer>(nodes_ipc["stats_server"]["data_recorder"].get<std::string>());
+        stats_server->start();
+    }
+
     CarlaVehicle vehicle(json_data["rig"], output_file, nodes_ipc);
     vehicle.run();
 
@@ -2,6 +2,9 @@
 #include <fstream>
 #include <string>
 #include <shared/ArgParser.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <profiler/StatsServer.hpp>
+#include <profiler/BspTrace.hpp>
 #include <nlohmann/json.hpp>
 #include "objDetector.hpp"
 
@@ -41,6 +44,37 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    if (nodes_ipc.contains("thread_config"))
+    {
+        BspThreadConfig::getInstance().loadJsonConfig(nodes_ipc["thread_config"]);
+        BspThreadConfig::getInstance().applyMemoryPolicy();
+    }
+
+    // live metrics endpoint, e.g. "stats_server": {"obj_detector": "unix:/tmp/obj_detector.stats"}
+    std::unique_ptr<bsp_perf::common::StatsServer> stats_server{nullptr};
+    if (nodes_ipc.contains("stats_server") && nodes_ipc["stats_server"].contains("obj_detector"))
+    {
+        stats_server = std::make_unique<bsp_perf::common::StatsServer>(nodes_ipc["stats_server"]["obj_detector"].get<std::string>());
+        stats_server->start();
+    }
+
+    // always-on trace ring, dumped on SIGUSR2 or when an SLO is violated, e.g.
+    // "flight_recorder": {"buffer_kb": 16384, "snapshot_dir": "logs", "inference_slo_us": 50000}
+    std::unique_ptr<bsp_perf::common::BspTrace> flight_recorder{nullptr};
+    if (nodes_ipc.contains("flight_recorder"))
+    {
+        const json& fr_cfg = nodes_ipc["flight_recorder"];
+        bsp_perf::common::BspTrace::FlightRecorderConfig config{};
+        config.buffer_kb = fr_cfg.value("buffer_kb", config.buffer_kb);
+        config.snapshot_dir = fr_cfg.value("snapshot_dir", config.snapshot_dir);
+        config.snapshot_prefix = fr_cfg.value("snapshot_prefix", std::string("obj_detector"));
+        flight_recorder = std::make_unique<bsp_perf::common::BspTrace>(config);
+        for (const auto& category : fr_cfg.value("disabled_categories", std::vector<std::string>{}))
+        {
+            bsp_perf::common::BspTrace::setCategoryEnabled(category, false);
+        }
+    }
+
     ObjDetector obj_detector(std::move(parser), nodes_ipc);
     obj_detector.runLoop();
 
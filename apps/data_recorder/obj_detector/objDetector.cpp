@@ -1,5 +1,7 @@
 #include "objDetector.hpp"
 #include <common/msg/ObjDetectMsg.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <profiler/BspTrace.hpp>
 #include <thread>
 #include <chrono>
 #include <iostream>
@@ -42,6 +44,21 @@ ObjDetector::ObjDetector(ArgParser&& args, const json& nodes_ipc)
         m_dnnObjDetector->loadModel(modelPath);
         setObjDetectParams(args, m_dnnObjDetector);
     }
+
+    auto& stats = bsp_perf::common::StatsRegistry::getInstance();
+    bsp_perf::common::StatsRegistry::Labels labels{{"detector", m_name}};
+    m_stat_frames = stats.counter("objdet_frames_total", "Frames run through the detector", labels);
+    m_stat_frame_drops = stats.counter("objdet_frame_drops_total", "Frames dropped because inference is behind", labels);
+    m_stat_receive_errors = stats.counter("objdet_receive_errors_total", "Failed or malformed shared memory messages", labels);
+    m_stat_queue_depth = stats.gauge("objdet_inference_queue_depth", "Frames waiting for inference", labels);
+    m_stat_fps = stats.gauge("objdet_fps", "Frames detected in the last second", labels);
+    m_stat_inference_latency = stats.histogram("objdet_inference_latency_us", "DNN inference latency in microseconds", labels);
+    m_stat_publish_latency = stats.histogram("objdet_publish_latency_us", "Result publish latency in microseconds", labels);
+    if (nodes_ipc.contains("flight_recorder") && nodes_ipc["flight_recorder"].contains("inference_slo_us"))
+    {
+        m_stat_inference_latency->setSlo(nodes_ipc["flight_recorder"]["inference_slo_us"].get<double>());
+    }
+
     m_inference_thread = std::make_unique<std::thread>([this]() {inferenceLoop();});
 }
 
@@ -157,6 +174,7 @@ void ObjDetector::publishObjDetectResults(const std::vector<bsp_dnn::ObjDetectOu
 
 void ObjDetector::inferenceLoop()
 {
+    BspThreadConfig::getInstance().applyToCurrentThread("dnn_inference");
     std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> inference_frame{nullptr};
 
     size_t frame_count = 0;
@@ -170,6 +188,7 @@ void ObjDetector::inferenceLoop()
             {
                 inference_frame = m_inference_frames_queue.front();
                 m_inference_frames_queue.pop();
+                m_stat_queue_depth->set(m_inference_frames_queue.size());
             }
         }
 
@@ -181,12 +200,25 @@ void ObjDetector::inferenceLoop()
         else
         {
             std::cout << "ObjDetector::inferenceLoop() runDnnInference format: " << inference_frame->view.desc.format << std::endl;
-            std::vector<bsp_dnn::ObjDetectOutputBox> output_boxes = runDnnInference(inference_frame);
+            auto inference_start = std::chrono::steady_clock::now();
+            std::vector<bsp_dnn::ObjDetectOutputBox> output_boxes;
+            {
+                BSP_TRACE_SCOPE(Dnn, "runDnnInference");
+                output_boxes = runDnnInference(inference_frame);
+            }
+            auto inference_end = std::chrono::steady_clock::now();
+            m_stat_inference_latency->observe(std::chrono::duration<double, std::micro>(inference_end - inference_start).count());
             for (const auto& output_box : output_boxes)
             {
                 std::cout << "ObjDetector::inferenceLoop() output_box: " << output_box.label << std::endl;
             }
-            publishObjDetectResults(output_boxes, inference_frame);
+            {
+                BSP_TRACE_SCOPE(Io, "publishObjDetectResults");
+                publishObjDetectResults(output_boxes, inference_frame);
+            }
+            m_stat_publish_latency->observe(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - inference_end).count());
+            m_stat_frames->inc();
 
             std::lock_guard<std::mutex> lock(m_free_frames_queue_mutex);
             if (m_free_frames_queue.size() < m_free_frames_queue_size)
@@ -200,6 +232,7 @@ void ObjDetector::inferenceLoop()
             if (elapsed >= 1)
             {
                 std::cout << "ObjDetector::inferenceLoop() FPS: " << frame_count / elapsed << std::endl;
+                m_stat_fps->set(static_cast<double>(frame_count) / elapsed);
                 frame_count = 0;
                 start_time = now;
             }
@@ -208,6 +241,7 @@ void ObjDetector::inferenceLoop()
 }
 void ObjDetector::runLoop()
 {
+    BspThreadConfig::getInstance().applyToCurrentThread("detector_receiver");
     // 增加缓冲区大小，确保能容纳完整的 msgpack 数据
     const size_t MAX_MSG_SIZE = 4096; // 4KB 应该足够
     std::shared_ptr<uint8_t[]> msg_buffer(new uint8_t[MAX_MSG_SIZE]);
@@ -221,6 +255,7 @@ void ObjDetector::runLoop()
         if (msg_size <= 0)
         {
             std::cerr << "ObjDetector::runLoop() receive msg failed" << std::endl;
+            m_stat_receive_errors->inc();
             continue;
         }
 
@@ -231,6 +266,7 @@ void ObjDetector::runLoop()
                 std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> temp_frame = m_inference_frames_queue.front();
                 m_inference_frames_queue.pop();
                 temp_frame.reset();
+                m_stat_frame_drops->inc();
             }
         }
 
@@ -244,6 +280,7 @@ void ObjDetector::runLoop()
             inference_frame->owner = std::shared_ptr<uint8_t>(
                 new uint8_t[shmem_msg.data_size],
                 std::default_delete<uint8_t[]>());
+            BspThreadConfig::getInstance().adviseHugePages(inference_frame->owner.get(), shmem_msg.data_size);
             bsp_perf::bsp_image::ImageDesc frameDesc{};
             frameDesc.dataSize = shmem_msg.data_size;
             frameDesc.width = shmem_msg.width;
@@ -252,7 +289,7 @@ void ObjDetector::runLoop()
             frameDesc.heightStride = shmem_msg.height;
             frameDesc.format = shmem_msg.pixel_format;
             inference_frame->view = bsp_perf::bsp_image::makeHostImageView(
-                static_cast<uint8_t*>(inference_frame->owner.get()), frameDesc, shmem_msg.width);
+                static_cast<uint8_t*>(inference_frame->owner.get()), frameDesc);
         }
         else
         {
@@ -266,6 +303,7 @@ void ObjDetector::runLoop()
         {
             std::lock_guard<std::mutex> lock(m_inference_frames_queue_mutex);
             m_inference_frames_queue.push(inference_frame);
+            m_stat_queue_depth->set(m_inference_frames_queue.size());
             inference_frame.reset();
         }
 
@@ -281,9 +319,11 @@ void ObjDetector::runLoop()
         } catch (const msgpack::insufficient_bytes& e) {
             std::cerr << "ObjDetector::runLoop() msgpack insufficient bytes error: " << e.what() << std::endl;
             std::cerr << "Received message size: " << msg_size << " bytes" << std::endl;
+            m_stat_receive_errors->inc();
             continue;
         } catch (const std::exception& e) {
             std::cerr << "ObjDetector::runLoop() msgpack unpack error: " << e.what() << std::endl;
+            m_stat_receive_errors->inc();
             continue;
         }
     }
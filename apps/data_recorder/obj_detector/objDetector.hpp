@@ -9,6 +9,7 @@
 #include <shared/ArgParser.hpp>
 #include <bsp_dnn/dnnObjDetector.hpp>
 #include <bsp_image/ImageBuffer.hpp>
+#include <profiler/StatsRegistry.hpp>
 #include <atomic>
 #include <mutex>
 #include <queue>
@@ -58,6 +59,15 @@ private:
     std::atomic<bool> m_stopSignal{false};
 
     std::unique_ptr<std::thread> m_inference_thread{nullptr};
+
+    // live stats
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_frames;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_frame_drops;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_receive_errors;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_queue_depth;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_fps;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_inference_latency;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_publish_latency;
 };
 
 } // namespace data_recorder
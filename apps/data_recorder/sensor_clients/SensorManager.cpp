@@ -25,7 +25,8 @@ SensorManager::SensorManager(const json& sensors_array, const json& vehicle_info
                 if (camera_node_name.compare(sensor_name) == 0)
                 {
                     std::cout << "Camera client created" << std::endl;
-                    m_clients_list.push_back(std::make_unique<CameraClient>(sensor, vehicle_info, camera_node));
+                    m_clients_list.push_back(std::make_unique<CameraClient>(sensor, vehicle_info, camera_node,
+                                             getDecoderSessions(vehicle_info, node_ipc)));
                     break;
                 }
             }
@@ -33,6 +34,26 @@ SensorManager::SensorManager(const json& sensors_array, const json& vehicle_info
     }
 }
 
+std::shared_ptr<bsp_codec::DecoderSessionManager> SensorManager::getDecoderSessions(const json& vehicle_info, const json& node_ipc)
+{
+    if (m_decoder_sessions != nullptr)
+    {
+        return m_decoder_sessions;
+    }
+
+    bsp_codec::DecoderSessionManager::Config cfg;
+    cfg.codecPlatform = CameraClient::decoderPlatform(vehicle_info["target_platform"]);
+    if (node_ipc.contains("decoder_sessions"))
+    {
+        const json& sessions = node_ipc["decoder_sessions"];
+        cfg.workers = sessions.value("workers", cfg.workers);
+        cfg.maxSessions = sessions.value("max_sessions", cfg.maxSessions);
+    }
+    std::cout << "Decoder sessions: " << cfg.workers << " workers, max " << cfg.maxSessions << " streams" << std::endl;
+    m_decoder_sessions = std::make_shared<bsp_codec::DecoderSessionManager>(cfg);
+    return m_decoder_sessions;
+}
+
 void SensorManager::runLoop()
 {
     size_t cycle_count = 0;
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <bsp_codec/DecoderSessionManager.hpp>
 #include "SensorClient.hpp"
 
 using json = nlohmann::json;
@@ -28,6 +29,13 @@ public:
     ~SensorManager();
 
 private:
+    /**
+     * @brief Decoder workers shared by all cameras, created with the first camera.
+     */
+    std::shared_ptr<bsp_codec::DecoderSessionManager> getDecoderSessions(const json& vehicle_info, const json& node_ipc);
+
+private:
+    std::shared_ptr<bsp_codec::DecoderSessionManager> m_decoder_sessions{nullptr};
     std::vector<std::unique_ptr<SensorClient>> m_clients_list;
     std::atomic<bool> m_stopSignal{false};
 };
@@ -1,4 +1,5 @@
 #include "CameraClient.hpp"
+#include <shared/BspThreadConfig.hpp>
 #include <iostream>
 #include <chrono>
 #include <stdexcept>
@@ -8,29 +9,23 @@ namespace apps
 namespace data_recorder
 {
 
-CameraClient::CameraClient(const json& sensor_context, const json& vehicle_info, const json& node_ipc)
+CameraClient::CameraClient(const json& sensor_context, const json& vehicle_info, const json& node_ipc,
+                           std::shared_ptr<DecoderSessionManager> decoder_sessions)
     : SensorClient(sensor_context)
 {
     setupInputConfig(sensor_context, vehicle_info);
     setupOutputConfig(node_ipc);
 
-    if (m_target_platform.compare("rk3588") == 0)
-    {
-        m_video_dec_helper = std::make_unique<VideoDecHelper>("rkmpp", "rkrga", m_out_pixel_format);
-    }
-    else if (m_target_platform.compare("jetson") == 0)
-    {
-        m_video_dec_helper = std::make_unique<VideoDecHelper>("nvdec", "nvvic", m_out_pixel_format);
-    }
-    else
-    {
-        throw std::runtime_error("Unsupported platform: " + m_target_platform);
-    }
-    DecodeConfig cfg = {
-        .encoding = "h264",
-        .fps = 75,
-    };
-    m_video_dec_helper->setupAndStartDecoder(cfg);
+    auto& stats = bsp_perf::common::StatsRegistry::getInstance();
+    bsp_perf::common::StatsRegistry::Labels labels{{"sensor", getSensorName()}};
+    m_stat_rtp_packets = stats.counter("camera_rtp_packets_total", "RTP packets received from the simulator", labels);
+    m_stat_rtp_errors = stats.counter("camera_rtp_errors_total", "RTP packets rejected by receive/parse errors", labels);
+    m_stat_published_frames = stats.counter("camera_published_frames_total", "Decoded frames published to shared memory", labels);
+    m_stat_recv_fps = stats.gauge("camera_recv_fps", "RTP frames received in the last second", labels);
+    m_stat_publish_fps = stats.gauge("camera_publish_fps", "Frames published in the last second", labels);
+    m_stat_publish_latency = stats.histogram("camera_publish_latency_us", "Shared memory publish latency in microseconds", labels);
+
+    setupDecoder(node_ipc, decoder_sessions);
     m_main_thread = std::make_unique<std::thread>([this]() {runLoop();});
     m_consumer_thread = std::make_unique<std::thread>([this]() {consumerLoop();});
 }
@@ -53,6 +48,49 @@ void CameraClient::setupOutputConfig(const json& node_ipc)
                             publisher["shmem_single_buffer_size"]);
 }
 
+std::string CameraClient::decoderPlatform(const std::string& target_platform)
+{
+    if (target_platform.compare("rk3588") == 0)
+    {
+        return "rkmpp";
+    }
+    else if (target_platform.compare("jetson") == 0)
+    {
+        return "nvdec";
+    }
+    throw std::runtime_error("Unsupported platform: " + target_platform);
+}
+
+void CameraClient::setupDecoder(const json& node_ipc, std::shared_ptr<DecoderSessionManager> decoder_sessions)
+{
+    std::string g2d_platform;
+    if (m_target_platform.compare("rk3588") == 0)
+    {
+        g2d_platform = "rkrga";
+    }
+    else if (m_target_platform.compare("jetson") == 0)
+    {
+        g2d_platform = "nvvic";
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported platform: " + m_target_platform);
+    }
+    m_video_dec_helper = std::make_unique<VideoDecHelper>(decoder_sessions, g2d_platform, m_out_pixel_format, getSensorName());
+
+    DecoderSessionManager::StreamConfig cfg;
+    cfg.name = getSensorName();
+    cfg.decode.encoding = "h264";
+    cfg.decode.fps = 75;
+    // optional per camera: packets decoded per turn and queueing deadline
+    cfg.priority = node_ipc.value("decode_priority", 1);
+    cfg.deadline_ms = node_ipc.value("decode_deadline_ms", 0);
+    if (m_video_dec_helper->setupAndStartDecoder(cfg) < 0)
+    {
+        throw std::runtime_error("No decoder session left for camera " + getSensorName());
+    }
+}
+
 CameraClient::~CameraClient()
 {
     if (m_main_thread->joinable() || m_consumer_thread->joinable())
@@ -80,6 +118,7 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> CameraClient::getCameraVideoFr
 
 void CameraClient::consumerLoop()
 {
+    bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread("camera_publisher");
     size_t frame_count = 0;
     auto last_time = std::chrono::steady_clock::now();
     CameraSensorMsg sensor_msg;
@@ -95,15 +134,20 @@ void CameraClient::consumerLoop()
             if (elapsed >= 1)
             {
                 std::cout << "CameraClient::Decoding FPS: " << frame_count << std::endl;
+                m_stat_publish_fps->set(static_cast<double>(frame_count) / elapsed);
                 frame_count = 0;
                 last_time = now;
             }
+            auto publish_start = std::chrono::steady_clock::now();
             fillCameraSensorMsg(sensor_msg, frame->view.desc.dataSize, m_output_shmem_port->getFreeSlotIndex());
             msg_buffer.clear();
             msgpack::pack(msg_buffer, sensor_msg);
             m_output_shmem_port->publishData(reinterpret_cast<const uint8_t*>(msg_buffer.data()),
                                             msg_buffer.size(), frame->view.data(),
                                             sensor_msg.slot_index, sensor_msg.data_size);
+            m_stat_publish_latency->observe(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - publish_start).count());
+            m_stat_published_frames->inc();
             frame.reset();
         }
     }
@@ -112,6 +156,7 @@ void CameraClient::consumerLoop()
 
 void CameraClient::runLoop()
 {
+    bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread("camera_receiver");
     size_t frame_count = 0;
     std::cout << "runLoop" << std::endl;
     size_t min_buffer_size = 1024 * 1024;
@@ -124,6 +169,7 @@ void CameraClient::runLoop()
         if (valid_bytes <= 0)
         {
             std::cerr << "recvIpcDataMore failed, buffer size may be too small" << std::endl;
+            m_stat_rtp_errors->inc();
             min_buffer_size *= 2;
             continue;
         }
@@ -133,6 +179,7 @@ void CameraClient::runLoop()
         if (ret < 0)
         {
             std::cerr << "parseHeader failed" << std::endl;
+            m_stat_rtp_errors->inc();
             continue;
         }
         {
@@ -144,11 +191,13 @@ void CameraClient::runLoop()
         if (rtp_buffer->payload.size <= 0)
         {
             std::cerr << "extractPayload failed" << std::endl;
+            m_stat_rtp_errors->inc();
             continue;
         }
         rtp_buffer->payload_valid = true;
         m_video_dec_helper->sendToDecoder(rtp_buffer);
         rtp_buffer.reset();
+        m_stat_rtp_packets->inc();
 
         frame_count++;
         auto now = std::chrono::steady_clock::now();
@@ -158,6 +207,7 @@ void CameraClient::runLoop()
         {
             std::cout << "camera client frame_count: " << frame_count << std::endl;
             std::cout << "camera client recv FPS: " << frame_count << std::endl;
+            m_stat_recv_fps->set(static_cast<double>(frame_count) / elapsed);
             frame_count = 0;
             last_time = now;
         }
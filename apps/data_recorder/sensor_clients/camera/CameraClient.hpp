@@ -8,6 +8,7 @@
 #include <zeromq_ipc/sharedMemPublisher.hpp>
 #include <zeromq_ipc/zmqSubscriber.hpp>
 #include <common/msg/CameraSensorMsg.hpp>
+#include <profiler/StatsRegistry.hpp>
 #include <string>
 #include <vector>
 #include <memory>
@@ -24,7 +25,16 @@ namespace data_recorder
 class CameraClient : public SensorClient
 {
 public:
-    explicit CameraClient(const json& sensor_context, const json& vehicle_info, const json& node_ipc);
+    /**
+     * @param decoder_sessions decoder workers shared by all cameras, see decoderPlatform()
+     */
+    explicit CameraClient(const json& sensor_context, const json& vehicle_info, const json& node_ipc,
+                          std::shared_ptr<DecoderSessionManager> decoder_sessions);
+
+    /**
+     * @brief IDecoder platform of the target, throws for an unsupported one.
+     */
+    static std::string decoderPlatform(const std::string& target_platform);
 
     virtual ~CameraClient();
 
@@ -40,6 +50,8 @@ private:
 
     void setupOutputConfig(const json& node_ipc);
 
+    void setupDecoder(const json& node_ipc, std::shared_ptr<DecoderSessionManager> decoder_sessions);
+
     void fillCameraSensorMsg(CameraSensorMsg& msg, size_t data_size, size_t slot_index);
 
 private:
@@ -59,6 +71,14 @@ private:
 
     std::shared_ptr<ZmqSubscriber> m_input_port{nullptr};
     std::shared_ptr<SharedMemPublisher> m_output_shmem_port{nullptr};
+
+    // live stats
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_rtp_packets;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_rtp_errors;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_published_frames;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_recv_fps;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_publish_fps;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_publish_latency;
 };
 
 } // namespace data_recorder
@@ -2,7 +2,6 @@
 #include <bsp_image/ImageBuffer.hpp>
 #include <stdexcept>
 #include <iostream>
-#include <thread>
 #include <chrono>
 #include <cassert>
 
@@ -11,34 +10,60 @@ namespace apps
 namespace data_recorder
 {
 
-VideoDecHelper::VideoDecHelper(const std::string& decoder_name, const std::string& g2dPlatform, const std::string& out_pixel_format):
-    m_decoder(bsp_codec::IDecoder::create(decoder_name)),
+VideoDecHelper::VideoDecHelper(std::shared_ptr<DecoderSessionManager> sessions, const std::string& g2dPlatform,
+                               const std::string& out_pixel_format, const std::string& stream_name):
+    m_sessions(std::move(sessions)),
+    m_stream_name(stream_name),
     m_g2d(IGraphics2D::create(g2dPlatform)),
     m_out_pixel_format(out_pixel_format)
 {
+    bsp_perf::bsp_image::ImageBufferPool::Options poolOptions{};
+    poolOptions.onFree = [this](uint8_t* data)
+    {
+        bsp_perf::bsp_image::ImageDesc desc{};
+        m_g2d->invalidateBufferCache(bsp_perf::bsp_image::makeHostImageView(data, desc));
+    };
+    m_cvt_frame_pool = std::make_unique<bsp_perf::bsp_image::ImageBufferPool>(poolOptions);
+    m_g2d->setBufferCacheCapacity(G2D_BUFFER_CACHE_CAPACITY);
+
+    auto& stats = bsp_perf::common::StatsRegistry::getInstance();
+    bsp_perf::common::StatsRegistry::Labels labels{{"stream", stream_name}};
+    m_stat_frames = stats.counter("decoder_frames_total", "Frames output by the video decoder", labels);
+    m_stat_frame_drops = stats.counter("decoder_frame_drops_total", "Decoded frames dropped because the consumer is behind", labels);
+    m_stat_packet_drops = stats.counter("decoder_packet_drops_total", "RTP packets dropped because the decoder is behind", labels);
+    m_stat_frame_queue_depth = stats.gauge("decoder_frame_queue_depth", "Decoded frames waiting for the consumer", labels);
+    m_stat_packet_queue_depth = stats.gauge("decoder_packet_queue_depth", "RTP packets waiting for the decoder", labels);
+    m_stat_cvt_latency = stats.histogram("decoder_cvt_latency_us", "Pixel format conversion latency in microseconds", labels);
+    m_stat_decode_latency = stats.histogram("decoder_latency_us", "RTP packet queued to frame decoded latency in microseconds", labels);
+    m_stat_decode_fps = stats.gauge("decoder_fps", "Frames decoded in the last second", labels);
 }
 
-int VideoDecHelper::setupAndStartDecoder(DecodeConfig& cfg)
+int VideoDecHelper::setupAndStartDecoder(DecoderSessionManager::StreamConfig& cfg)
 {
-    auto decoderCallback = [this](std::any userdata, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> frame)
+    auto decoderCallback = [this](std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> frame, const DecoderSessionManager::FrameInfo& info)
     {
         std::lock_guard<std::mutex> lock(m_decoded_frame_queue_mutex);
-        std::cout << "VideoDecHelper::decoderCallback() frame width: " << frame->view.desc.width << " frame height: " << frame->view.desc.height << std::endl;
-        std::cout << "VideoDecHelper::decoderCallback() frame format: " << frame->view.desc.format << std::endl;
         m_decoded_frame_queue.push(frame);
+        m_stat_frames->inc();
+        m_stat_decode_latency->observe(info.latency_us);
+        m_stat_decode_fps->set(info.fps);
 
         while (m_decoded_frame_queue.size() > m_reserved_frame_num)
         {
             std::cerr << "VideoDecHelper::decoderCallback() drop the oldest frame" << std::endl;
             m_decoded_frame_queue.pop();
+            m_stat_frame_drops->inc();
         }
+        m_stat_frame_queue_depth->set(m_decoded_frame_queue.size());
     };
 
-    m_decoder->setup(cfg);
-
-    m_decoder->setDecodeReadyCallback(decoderCallback, nullptr);
-    m_dec_thread = std::make_unique<std::thread>([this]() {decoderLoop();});
-    return 0;
+    if (cfg.name.empty())
+    {
+        cfg.name = m_stream_name;
+    }
+    m_encoding = cfg.decode.encoding;
+    m_stream_id = m_sessions->addStream(cfg, decoderCallback);
+    return (m_stream_id < 0) ? -1 : 0;
 }
 
 bool VideoDecHelper::needPixelConverter(const std::string& pixel_format)
@@ -51,51 +76,24 @@ bool VideoDecHelper::needPixelConverter(const std::string& pixel_format)
     return true;
 }
 
-void VideoDecHelper::decoderLoop()
+int VideoDecHelper::sendToDecoder(std::shared_ptr<VideoDecHelper::RtpBuffer> rtp_pkt)
 {
-    while (true)
+    DecoderSessionManager::Packet packet;
+    packet.key_frame = DecoderSessionManager::isKeyframe(m_encoding, rtp_pkt->payload.data, rtp_pkt->payload.size);
+    // the rtp buffer goes back to the free list once decoded or dropped
+    packet.buffer = bsp_perf::shared::PacketBuffer::wrap(rtp_pkt->payload.data, rtp_pkt->payload.size,
+        std::shared_ptr<void>(rtp_pkt.get(), [this, rtp_pkt](void*) { releaseRtpVideoBuffer(rtp_pkt); }));
+
+    int ret = m_sessions->submit(m_stream_id, std::move(packet));
+    if (ret < 0)
     {
-        std::shared_ptr<RtpBuffer> rtp_pkt{nullptr};
-
-        if (m_encode_pkt_queue.empty())
-        {
-            continue;
-        }
-
-        {
-            std::lock_guard<std::mutex> lock(m_encode_pkt_queue_mutex);
-            rtp_pkt = m_encode_pkt_queue.front();
-            m_encode_pkt_queue.pop();
-        }
-
-        if (rtp_pkt != nullptr)
-        {
-            DecodePacket dec_pkt = {
-                .data = rtp_pkt->payload.data,
-                .pkt_size = rtp_pkt->payload.size,
-                .pkt_eos = false,
-            };
-            m_decoder->decode(dec_pkt);
-            releaseRtpVideoBuffer(rtp_pkt);
-            rtp_pkt.reset();
-        }
-
+        return -1;
     }
-}
-
-int VideoDecHelper::sendToDecoder(std::shared_ptr<VideoDecHelper::RtpBuffer> rtp_pkt)
-{
-    std::lock_guard<std::mutex> lock(m_encode_pkt_queue_mutex);
-    m_encode_pkt_queue.push(rtp_pkt);
-
-    while (m_encode_pkt_queue.size() > m_reserved_encode_pkt_num)
+    if (ret > 0)
     {
-        std::cerr << "VideoDecHelper::sendToDecoder() drop the oldest rtp packet" << std::endl;
-        auto oldest_pkt = m_encode_pkt_queue.front();
-        releaseRtpVideoBuffer(oldest_pkt);
-        m_encode_pkt_queue.pop();
-        oldest_pkt.reset();
+        m_stat_packet_drops->inc();
     }
+    m_stat_packet_queue_depth->set(m_sessions->stats(m_stream_id).queue_depth);
     return 0;
 }
 
@@ -106,11 +104,19 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> VideoDecHelper::convertPixelFo
     outDesc.widthStride = outDesc.width;
     outDesc.heightStride = outDesc.height;
     outDesc.dataSize = bsp_perf::bsp_image::imageDataSize(outDesc);
-    auto out_frame = bsp_perf::bsp_image::makeHostImageBuffer(outDesc);
+    auto out_frame = m_cvt_frame_pool->acquire(outDesc);
+    if (out_frame == nullptr) {
+        return nullptr;
+    }
 
-    if (m_g2d->imageCvtColorToHost(frame->view, out_frame->view) != 0) {
+    auto start = std::chrono::steady_clock::now();
+    const int ret = m_g2d->imageCvtColorToHost(frame->view, out_frame->view);
+    // decoder frames are not owned here, only the recycled output stays imported
+    m_g2d->invalidateBufferCache(frame->view);
+    if (ret != 0) {
         return nullptr;
     }
+    m_stat_cvt_latency->observe(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
     return out_frame;
 }
 
@@ -124,6 +130,7 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> VideoDecHelper::getDecodedFram
     }
     auto frame = m_decoded_frame_queue.front();
     m_decoded_frame_queue.pop();
+    m_stat_frame_queue_depth->set(m_decoded_frame_queue.size());
 
     if (needPixelConverter(frame->view.desc.format))
     {
@@ -201,12 +208,11 @@ int VideoDecHelper::releaseRtpVideoBuffer(std::shared_ptr<RtpBuffer> buffer)
 
 VideoDecHelper::~VideoDecHelper()
 {
-    if (m_dec_thread->joinable())
+    // waits for a decode of this stream in flight, no callback runs afterwards
+    if (m_stream_id >= 0)
     {
-        m_stopSignal.store(true);
-        m_dec_thread->join();
+        m_sessions->removeStream(m_stream_id);
     }
-    m_decoder.reset();
 }
 
 
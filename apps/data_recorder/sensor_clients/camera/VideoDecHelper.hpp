@@ -1,12 +1,12 @@
 #ifndef __VIDEO_DEC_HELPER_HPP__
 #define __VIDEO_DEC_HELPER_HPP__
 
-#include <bsp_codec/IDecoder.hpp>
+#include <bsp_codec/DecoderSessionManager.hpp>
 #include <protocol/RtpHeader.hpp>
 #include <bsp_g2d/IGraphics2D.hpp>
+#include <bsp_image/ImageBufferPool.hpp>
+#include <profiler/StatsRegistry.hpp>
 #include <memory>
-#include <thread>
-#include <atomic>
 #include <mutex>
 #include <queue>
 
@@ -31,9 +31,18 @@ public:
         bool payload_valid{false};
     };
 
-    VideoDecHelper(const std::string& decoder_name, const std::string& g2dPlatform, const std::string& out_pixel_format);
+    /**
+     * @param sessions decoder workers shared by all cameras of the rig
+     * @param stream_name label of the live stats exported by this decoder, e.g. the sensor name
+     */
+    VideoDecHelper(std::shared_ptr<DecoderSessionManager> sessions, const std::string& g2dPlatform,
+                   const std::string& out_pixel_format, const std::string& stream_name = "");
 
-    int setupAndStartDecoder(DecodeConfig& cfg);
+    /**
+     * @brief Open the decoder session of this stream, cfg.name defaults to the stream name.
+     * @return 0 success, -1 when no session is left
+     */
+    int setupAndStartDecoder(DecoderSessionManager::StreamConfig& cfg);
 
     std::shared_ptr<RtpBuffer> getRtpVideoBuffer(size_t min_size);
 
@@ -46,8 +55,6 @@ public:
     ~VideoDecHelper();
 
 private:
-    void decoderLoop();
-
     bool needPixelConverter(const std::string& pixel_format);
 
     std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> convertPixelFormat(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> frame);
@@ -55,9 +62,10 @@ private:
     std::shared_ptr<VideoDecHelper::RtpBuffer> createNewRtpBuffer(size_t min_size);
 
 private:
-    std::unique_ptr<bsp_codec::IDecoder> m_decoder;
-    std::unique_ptr<std::thread> m_dec_thread;
-    std::atomic<bool> m_stopSignal{false};
+    std::shared_ptr<DecoderSessionManager> m_sessions;
+    int m_stream_id{-1};
+    std::string m_stream_name;
+    std::string m_encoding{"h264"};
 
     // largest raw_data_bytes at the end
     std::vector<std::shared_ptr<RtpBuffer>> m_free_buffer_sort_queue;
@@ -68,12 +76,22 @@ private:
     std::mutex m_decoded_frame_queue_mutex;
     const size_t m_reserved_frame_num{30};
 
-    std::queue<std::shared_ptr<RtpBuffer>> m_encode_pkt_queue;
-    std::mutex m_encode_pkt_queue_mutex;
-    const size_t m_reserved_encode_pkt_num{30};
-
     std::unique_ptr<IGraphics2D> m_g2d{nullptr};
     std::string m_out_pixel_format;
+    // converted frames, recycled once the consumer drops them; declared after m_g2d since
+    // freeing a block drops its g2d import
+    std::unique_ptr<bsp_perf::bsp_image::ImageBufferPool> m_cvt_frame_pool{nullptr};
+    static constexpr size_t G2D_BUFFER_CACHE_CAPACITY{8};
+
+    // live stats
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_frames;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_frame_drops;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_packet_drops;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_frame_queue_depth;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_packet_queue_depth;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_cvt_latency;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_decode_latency;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_decode_fps;
 };
 
 } // namespace data_recorder
@@ -50,17 +50,16 @@ int GuiController::updateFrameRecord()
     const int height = compositeFrame.height();
     const int packedLineSize = width * 3;
     uint8_t* frameData = compositeFrame.bits();
-    std::vector<uint8_t> packedFrame;
 
     if (compositeFrame.bytesPerLine() != packedLineSize)
     {
-        packedFrame.resize(static_cast<size_t>(packedLineSize) * height);
+        m_packed_frame.resize(static_cast<size_t>(packedLineSize) * height);
         for (int row = 0; row < height; ++row)
         {
-            std::memcpy(packedFrame.data() + static_cast<size_t>(row) * packedLineSize,
+            std::memcpy(m_packed_frame.data() + static_cast<size_t>(row) * packedLineSize,
                 compositeFrame.constScanLine(row), packedLineSize);
         }
-        frameData = packedFrame.data();
+        frameData = m_packed_frame.data();
     }
 
     int ret = m_recorder->writeRecordFrame(frameData, width, height, "RGB888");
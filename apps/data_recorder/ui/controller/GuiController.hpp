@@ -63,6 +63,8 @@ private:
     bool m_record_enabled{false};
     std::mutex m_record_enabled_mutex;
     QElapsedTimer m_record_frame_timer;
+    // de-padded copy of the composite frame, kept to avoid a per-frame allocation
+    std::vector<uint8_t> m_packed_frame;
     int m_record_interval_ms{33};
 
 };
@@ -45,9 +45,16 @@ Recorder::Recorder(int argc, char *argv[])
     parser.getOptionVal("--g2d", g2dType);
     parser.getOptionVal("--muxer", muxerType);
 
-    m_encoder = IEncoder::create(encoderType);
+    m_encoder = std::make_unique<AsyncEncoder>(IEncoder::create(encoderType), ENCODER_SLOTS);
+    m_encoder->onPacket([this](std::any /*userdata*/, const EncodePacket& pkt, uint64_t /*frame_index*/)
+    {
+        muxerWriteStreamPacket(pkt);
+    }, nullptr);
     m_g2d = IGraphics2D::create(g2dType);
-    m_muxer = IMuxer::create(muxerType);
+    // keeps the recycled encoder input buffers imported across frames
+    m_g2d->setBufferCacheCapacity(G2D_BUFFER_CACHE_CAPACITY);
+    // the encoder thread only queues its packets, the muxer and the file have their own threads
+    m_muxer = std::make_unique<InterleavedMuxer>(IMuxer::create(muxerType));
     m_record_dir = std::filesystem::current_path().string();
 }
 
@@ -62,15 +69,31 @@ int Recorder::startNewRecord()
     std::cout << "Recorder::startNewRecord()" << std::endl;
     m_current_filename = "record_" + BspTimeUtils::getCurrentTimeString() + ".mp4";
     IMuxer::MuxConfig muxConfig{true, 30};
-    m_muxer->openContainerMux(m_current_filename, muxConfig);
+    muxConfig.fragmented = true;
+    muxConfig.fragment_ms = FRAGMENT_MS;
+    muxConfig.segment_ms = SEGMENT_MS;
+    muxConfig.async_io = true;
+    muxConfig.preallocate_bytes = SEGMENT_PREALLOCATE_BYTES;
+    muxConfig.segment_closed = [](const std::string& path)
+    {
+        std::cerr << "Recorder segment saved: " << path << std::endl;
+    };
+    if (m_muxer->openContainerMux(m_current_filename, muxConfig) < 0)
+    {
+        std::cerr << "Recorder::startNewRecord() open " << m_current_filename << " failed" << std::endl;
+        return -1;
+    }
     m_muxer_first_frame = true;
     return 0;
 }
 
 int Recorder::stopAndSaveRecord()
 {
+    // EOS, the frames still queued or held by the encoder are muxed before the muxer is closed
+    m_encoder->finish();
     m_encoder->tearDown();
     m_muxer->endStreamMux();
+    // waits until the last segment is synced
     m_muxer->closeContainerMux();
     m_muxer_first_frame = true;
     std::cerr << "Recorder::stopAndSaveRecord() record path: " << m_current_filename << std::endl;
@@ -116,49 +139,55 @@ int Recorder::convertImageFormat(uint8_t* input_data, int width, int height, std
     inputDesc.heightStride = static_cast<uint32_t>(height);
     inputDesc.format = input_format;
     inputDesc.dataSize = static_cast<size_t>(width) * height * bytesPerPixel(input_format);
-    auto inputImage = bsp_perf::bsp_image::makeHostImageView(input_data, inputDesc, static_cast<uint32_t>(width));
+    auto inputImage = bsp_perf::bsp_image::makeHostImageView(input_data, inputDesc);
 
     output_buf->view.desc.format = out_format;
-    return m_g2d->imageCvtColorToHost(inputImage, output_buf->view);
+    const int ret = m_g2d->imageCvtColorToHost(inputImage, output_buf->view);
+    // the GUI frame is only valid for this call, do not let a later frame hit its import
+    m_g2d->invalidateBufferCache(inputImage);
+    return ret;
 }
 
 
-int Recorder::muxerWriteStreamPacket(EncodePacket& enc_pkt)
+int Recorder::muxerWriteStreamPacket(const EncodePacket& enc_pkt)
 {
+    // the encoder output goes to the muxer by reference, the muxer keeps it while it interleaves
+    m_stream_packet.buffer = enc_pkt.buffer;
     m_stream_packet.useful_pkt_size = enc_pkt.pkt_len;
-    if (m_stream_packet.pkt_data.size() < m_stream_packet.useful_pkt_size)
-    {
-        m_stream_packet.pkt_data.resize(m_stream_packet.useful_pkt_size);
-    }
-    std::copy(enc_pkt.encode_pkt.begin(), enc_pkt.encode_pkt.begin() + m_stream_packet.useful_pkt_size,
-        m_stream_packet.pkt_data.begin());
-    return m_muxer->writeStreamPacket(m_stream_packet);
+    // segments are cut in front of an IDR
+    m_stream_packet.key_frame = enc_pkt.key_frame;
+    const int ret = m_muxer->writeStreamPacket(m_stream_packet);
+    m_stream_packet.buffer.reset();
+    return ret;
 }
 
 int Recorder::writeRecordFrame(uint8_t* data, int width, int height, std::string format)
 {
     if (m_muxer_first_frame == true)
     {
+        // the input buffers of the previous session are gone
+        m_g2d->invalidateBufferCache();
         setupEncoder(width, height);
-        m_enc_in_buf = m_encoder->getInputBuffer();
         addVideoStream(width, height);
         m_muxer_first_frame = false;
     }
 
-    if (convertImageFormat(data, width, height, format, m_enc_in_buf, "YUV420SP") != 0)
+    // waits only while ENCODER_SLOTS frames are still being encoded
+    auto enc_in_buf = m_encoder->acquireInputBuffer();
+    if (enc_in_buf == nullptr)
+    {
+        std::cerr << "Recorder::writeRecordFrame() get encoder input buffer failed" << std::endl;
+        return -1;
+    }
+
+    if (convertImageFormat(data, width, height, format, enc_in_buf, "YUV420SP") != 0)
     {
         std::cerr << "Recorder::writeRecordFrame() convert image format failed" << std::endl;
         return -1;
     }
 
-    EncodePacket enc_pkt = {
-        .max_size = m_encoder->getFrameSize(),
-        .pkt_eos = 0,
-        .pkt_len = 0,
-    };
-    enc_pkt.encode_pkt.resize(enc_pkt.max_size);
-    auto encode_len = m_encoder->encode(*m_enc_in_buf, enc_pkt);
-    return muxerWriteStreamPacket(enc_pkt);
+    // encoded and muxed on the encoder thread while the next frame is converted here
+    return m_encoder->submit(std::move(enc_in_buf));
 }
 }
 }
@@ -6,8 +6,10 @@
 #include <thread>
 #include <atomic>
 #include <bsp_codec/IEncoder.hpp>
+#include <bsp_codec/AsyncEncoder.hpp>
 #include <bsp_g2d/IGraphics2D.hpp>
 #include <bsp_container/IMuxer.hpp>
+#include <bsp_container/InterleavedMuxer.hpp>
 
 using namespace bsp_codec;
 using namespace bsp_g2d;
@@ -46,17 +48,24 @@ private:
     int convertImageFormat(uint8_t* input_data, int width, int height, std::string input_format,
             std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> output_buf, std::string out_format);
 
-    int muxerWriteStreamPacket(EncodePacket& enc_pkt);
+    int muxerWriteStreamPacket(const EncodePacket& enc_pkt);
 
 
 private:
+    // frames converted ahead while the encoder thread works on the previous ones
+    static constexpr size_t ENCODER_SLOTS{AsyncEncoder::DEFAULT_SLOTS};
+    static constexpr size_t G2D_BUFFER_CACHE_CAPACITY{ENCODER_SLOTS + 2};
+    // power can go any time: 1 s fragments synced to disk, a new file every minute
+    static constexpr int FRAGMENT_MS{1000};
+    static constexpr int SEGMENT_MS{60 * 1000};
+    static constexpr size_t SEGMENT_PREALLOCATE_BYTES{16 * 1024 * 1024};
+
     std::string m_record_dir;;
     std::string m_current_filename;
-    std::unique_ptr<IEncoder> m_encoder{nullptr};
-    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> m_enc_in_buf{nullptr};
+    std::unique_ptr<AsyncEncoder> m_encoder{nullptr};
     std::unique_ptr<IGraphics2D> m_g2d{nullptr};
     std::unique_ptr<IMuxer> m_muxer{nullptr};
-    StreamPacket m_stream_packet{};
+    StreamPacket m_stream_packet{};     // only touched by the encoder thread once frames flow
     std::atomic<bool> m_muxer_first_frame{true};
 
 };
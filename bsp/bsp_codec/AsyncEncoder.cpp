@@ -0,0 +1,253 @@
+#include <bsp_codec/AsyncEncoder.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace bsp_codec
+{
+
+using bsp_perf::bsp_image::ImageBuffer;
+
+constexpr char AsyncEncoder::LOG_TAG[];
+constexpr char AsyncEncoder::THREAD_ROLE[];
+
+AsyncEncoder::AsyncEncoder(std::unique_ptr<IEncoder> encoder, size_t slots):
+    m_encoder(std::move(encoder)),
+    m_slots(std::make_shared<SlotState>())
+{
+    if (m_encoder == nullptr)
+    {
+        throw std::invalid_argument("AsyncEncoder needs an encoder.");
+    }
+    m_slots->capacity = (slots > 0) ? slots : 1;
+}
+
+AsyncEncoder::~AsyncEncoder()
+{
+    stopWorker();
+}
+
+int AsyncEncoder::setup(EncodeConfig& cfg)
+{
+    stopWorker();
+
+    int ret = m_encoder->setup(cfg);
+    if (ret != 0)
+    {
+        std::cerr << LOG_TAG << "encoder setup failed ret: " << ret << std::endl;
+        return ret;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_encode_mutex);
+        // one frame never encodes larger than the raw frame; encode_pkt stays empty, the
+        // packets reach the callback as EncodePacket::buffer without a copy
+        m_pkt.max_size = m_encoder->getFrameSize();
+        m_pkt.encode_pkt.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+        m_next_index = 0;
+    }
+    m_errors = 0;
+    m_worker = std::make_unique<std::thread>([this]() { workerLoop(); });
+    return 0;
+}
+
+void AsyncEncoder::onPacket(packetCallback callback, std::any userdata)
+{
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    m_callback = callback;
+    m_userdata = userdata;
+}
+
+std::shared_ptr<ImageBuffer> AsyncEncoder::acquireInputBuffer(int timeout_ms)
+{
+    auto slots = m_slots;
+    {
+        std::unique_lock<std::mutex> lock(slots->mutex);
+        auto ready = [&slots]() { return slots->in_use < slots->capacity; };
+        if (timeout_ms < 0)
+        {
+            slots->cv.wait(lock, ready);
+        }
+        else if (!slots->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready))
+        {
+            return nullptr;
+        }
+        ++slots->in_use;
+    }
+
+    std::shared_ptr<ImageBuffer> buffer = m_encoder->getInputBuffer();
+    if (buffer == nullptr)
+    {
+        slots->release();
+        return nullptr;
+    }
+
+    // same memory and handle, the slot is given back after the encoder buffer is dropped
+    auto slot = std::make_shared<ImageBuffer>();
+    slot->view = buffer->view;
+    slot->nativeHandle = buffer->nativeHandle;
+    slot->release = [slots, buffer]() mutable
+    {
+        buffer.reset();
+        slots->release();
+    };
+    return slot;
+}
+
+int AsyncEncoder::submit(std::shared_ptr<ImageBuffer> input_buf, bool eos)
+{
+    if (input_buf == nullptr)
+    {
+        return -1;
+    }
+    if (queueJob(std::move(input_buf), false) < 0)
+    {
+        return -1;
+    }
+    // the frame first, the flush as a job of its own
+    return eos ? queueJob(nullptr, true) : 0;
+}
+
+int AsyncEncoder::finish()
+{
+    if (queueJob(nullptr, true) < 0)
+    {
+        return -1;
+    }
+    return flush();
+}
+
+int AsyncEncoder::queueJob(std::shared_ptr<ImageBuffer> input_buf, bool eos)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if ((m_worker == nullptr) || m_stop)
+        {
+            std::cerr << LOG_TAG << "submit() or finish() called before setup()" << std::endl;
+            return -1;
+        }
+        // an EOS job carries no frame, it takes no frame index
+        m_jobs.push_back(Job{std::move(input_buf), eos, eos ? m_next_index : m_next_index++});
+        ++m_pending;
+    }
+    m_job_cv.notify_one();
+    return 0;
+}
+
+int AsyncEncoder::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done_cv.wait(lock, [this]() { return m_pending == 0; });
+    }
+    return (m_errors.exchange(0) == 0) ? 0 : -1;
+}
+
+int AsyncEncoder::encode(ImageBuffer& input_buf, EncodePacket& out_pkt)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    return m_encoder->encode(input_buf, out_pkt);
+}
+
+int AsyncEncoder::getEncoderHeader(std::string& headBuf)
+{
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    return m_encoder->getEncoderHeader(headBuf);
+}
+
+int AsyncEncoder::tearDown()
+{
+    stopWorker();
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    return m_encoder->tearDown();
+}
+
+size_t AsyncEncoder::getFrameSize()
+{
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    return m_encoder->getFrameSize();
+}
+
+size_t AsyncEncoder::inFlight() const
+{
+    std::lock_guard<std::mutex> lock(m_slots->mutex);
+    return m_slots->in_use;
+}
+
+void AsyncEncoder::stopWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_worker == nullptr)
+        {
+            return;
+        }
+        m_stop = true;
+    }
+    // the worker drains the queue before it leaves
+    m_job_cv.notify_all();
+    if (m_worker->joinable())
+    {
+        m_worker->join();
+    }
+    m_worker.reset();
+}
+
+void AsyncEncoder::workerLoop()
+{
+    bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread(THREAD_ROLE);
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+            {
+                break;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        runJob(job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+void AsyncEncoder::runJob(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_encode_mutex);
+    m_pkt.pkt_eos = job.eos ? 1 : 0;
+    m_pkt.pkt_len = 0;
+    // an EOS job has no frame, the encoder does not read the input then
+    ImageBuffer none;
+    int ret = m_encoder->encode((job.input != nullptr) ? *job.input : none, m_pkt);
+    // free the slot before the packet is muxed, the producer can fill it meanwhile
+    job.input.reset();
+
+    if (ret < 0)
+    {
+        ++m_errors;
+        std::cerr << LOG_TAG << "encode frame " << job.index << " failed ret: " << ret << std::endl;
+        return;
+    }
+    if ((m_pkt.pkt_len > 0) && (m_callback != nullptr))
+    {
+        m_callback(m_userdata, m_pkt, job.index);
+    }
+}
+
+} // namespace bsp_codec
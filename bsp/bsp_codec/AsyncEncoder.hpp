@@ -0,0 +1,165 @@
+#ifndef __ASYNC_ENCODER_HPP__
+#define __ASYNC_ENCODER_HPP__
+
+#include <bsp_codec/IEncoder.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace bsp_codec
+{
+
+/**
+ * @brief Pipelined front end for any IEncoder: frames are submitted and the packets come back
+ * through onPacket() from an encoder thread, so the caller prepares frame k+1 (color conversion,
+ * overlay) while frame k is being encoded.
+ *
+ *     AsyncEncoder encoder(IEncoder::create("rkmpp"));
+ *     encoder.setup(cfg);
+ *     encoder.onPacket([](std::any, const EncodePacket& pkt, uint64_t) { mux(pkt); }, nullptr);
+ *     auto buf = encoder.acquireInputBuffer();    // waits while all slots are in flight
+ *     convert(frame, buf->view);
+ *     encoder.submit(std::move(buf));
+ *     ...
+ *     encoder.finish();                           // EOS, every submitted frame came out
+ *
+ * Input buffers come from IEncoder::getInputBuffer(), at most slots() of them are held by the
+ * caller or queued at a time. A slot is free again once the encoder is done with the frame and
+ * the caller dropped its reference. encode() keeps the blocking IEncoder call available.
+ */
+class AsyncEncoder
+{
+public:
+    static constexpr char LOG_TAG[] {"[AsyncEncoder]: "};
+    static constexpr char THREAD_ROLE[] {"video_encoder"};
+    static constexpr size_t DEFAULT_SLOTS{3};
+
+    /**
+     * @brief Called on the encoder thread with the packets of one frame, pkt is only valid during the call
+     * but pkt.buffer may be kept. Must not call back into the AsyncEncoder.
+     */
+    using packetCallback = std::function<void(std::any userdata, const EncodePacket& pkt, uint64_t frame_index)>;
+
+    explicit AsyncEncoder(std::unique_ptr<IEncoder> encoder, size_t slots = DEFAULT_SLOTS);
+    ~AsyncEncoder();
+
+    AsyncEncoder(const AsyncEncoder&) = delete;
+    AsyncEncoder& operator=(const AsyncEncoder&) = delete;
+
+    /**
+     * @brief Set up the encoder (drains a running session first) and start the encoder thread.
+     * @return the IEncoder::setup() result
+     */
+    int setup(EncodeConfig& cfg);
+
+    void onPacket(packetCallback callback, std::any userdata);
+
+    /**
+     * @brief Input buffer of the encoder, waits for a free slot.
+     * @param timeout_ms -1 waits forever
+     * @return nullptr on timeout or when the encoder has no buffer
+     */
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> acquireInputBuffer(int timeout_ms = -1);
+
+    /**
+     * @brief Queue a frame, buffers not taken from acquireInputBuffer() work too (they hold no slot).
+     * eos marks the last frame of the stream: it is encoded, then the encoder is flushed.
+     * @return 0 success, -1 not set up
+     */
+    int submit(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> input_buf, bool eos = false);
+
+    /**
+     * @brief End the stream without a frame: the encoder flushes the frames it still holds,
+     * waits like flush(). The encoder has to be set up again for a new stream.
+     * @return 0 success, -1 not set up or an encode failed since the last flush
+     */
+    int finish();
+
+    /**
+     * @brief Wait until every submitted frame has been encoded and its packets delivered.
+     * @return 0 success, -1 if an encode failed since the last flush
+     */
+    int flush();
+
+    /**
+     * @brief Blocking adapter with the IEncoder::encode() contract, runs after the queued frames.
+     */
+    int encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket& out_pkt);
+
+    int getEncoderHeader(std::string& headBuf);
+
+    /**
+     * @brief Flush, stop the encoder thread and tear the encoder down.
+     */
+    int tearDown();
+
+    size_t getFrameSize();
+
+    size_t slots() const { return m_slots->capacity; }
+
+    /**
+     * @brief Slots held by the caller or queued right now.
+     */
+    size_t inFlight() const;
+
+    IEncoder& encoder() { return *m_encoder; }
+
+private:
+    struct SlotState
+    {
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        size_t capacity{DEFAULT_SLOTS};
+        size_t in_use{0};
+
+        void release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --in_use;
+            }
+            cv.notify_one();
+        }
+    };
+
+    struct Job
+    {
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> input{};
+        bool eos{false};
+        uint64_t index{0};
+    };
+
+    int queueJob(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> input_buf, bool eos);
+
+    void workerLoop();
+
+    void runJob(Job& job);
+
+    void stopWorker();
+
+private:
+    std::unique_ptr<IEncoder> m_encoder;
+    std::shared_ptr<SlotState> m_slots;
+
+    std::mutex m_mutex;
+    std::condition_variable m_job_cv;
+    std::condition_variable m_done_cv;
+    std::deque<Job> m_jobs;
+    size_t m_pending{0};            // queued or encoding
+    uint64_t m_next_index{0};
+    bool m_stop{false};
+    std::unique_ptr<std::thread> m_worker;
+    std::atomic<int> m_errors{0};
+
+    // serializes the worker and the blocking encode()
+    std::mutex m_encode_mutex;
+    EncodePacket m_pkt{};
+    packetCallback m_callback{nullptr};
+    std::any m_userdata{nullptr};
+};
+
+} // namespace bsp_codec
+
+#endif // __ASYNC_ENCODER_HPP__
@@ -0,0 +1,370 @@
+#include <bsp_codec/DecoderSessionManager.hpp>
+#include <bsp_codec/H26xNal.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace bsp_codec
+{
+
+using bsp_perf::bsp_image::ImageBuffer;
+
+constexpr char DecoderSessionManager::LOG_TAG[];
+constexpr char DecoderSessionManager::THREAD_ROLE[];
+
+namespace
+{
+constexpr uint64_t FPS_WINDOW_NS{1000000000ULL};
+// weight of a new sample in the latency moving average
+constexpr double LATENCY_EWMA_ALPHA{1.0 / 16.0};
+} // namespace
+
+DecoderSessionManager::DecoderSessionManager(const Config& config):
+    m_config(config)
+{
+    size_t workers = (m_config.workers > 0) ? m_config.workers : 1;
+    for (size_t i = 0; i < workers; i++)
+    {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+DecoderSessionManager::~DecoderSessionManager()
+{
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& item : m_streams)
+        {
+            ids.push_back(item.first);
+        }
+    }
+    for (int id : ids)
+    {
+        removeStream(id);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+int DecoderSessionManager::addStream(const StreamConfig& cfg, frameCallback callback)
+{
+    {
+        // the session is reserved before the decoder is set up, a concurrent addStream() sees it
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_streams.size() + m_reserved >= m_config.maxSessions)
+        {
+            std::cerr << LOG_TAG << "no decoder session left for " << cfg.name
+                      << ", maxSessions: " << m_config.maxSessions << std::endl;
+            return -1;
+        }
+        ++m_reserved;
+    }
+
+    auto stream = std::make_shared<Stream>();
+    stream->cfg = cfg;
+    stream->cfg.priority = std::max(stream->cfg.priority, 1);
+    stream->cfg.queue_capacity = std::max<size_t>(stream->cfg.queue_capacity, 1);
+    stream->callback = std::move(callback);
+    stream->decoder = IDecoder::create(m_config.codecPlatform);
+    if (stream->decoder->setup(stream->cfg.decode) != 0)
+    {
+        std::cerr << LOG_TAG << "decoder setup failed for " << cfg.name << std::endl;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_reserved;
+        return -1;
+    }
+    // the session lives until removeStream() drained it, the raw pointer stays valid
+    Stream* raw = stream.get();
+    stream->decoder->setDecodeReadyCallback([this, raw](std::any /*userdata*/, std::shared_ptr<ImageBuffer> frame)
+    {
+        onFrame(*raw, std::move(frame));
+    }, nullptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_reserved;
+    stream->id = m_next_id++;
+    m_streams.emplace(stream->id, stream);
+    return stream->id;
+}
+
+int DecoderSessionManager::removeStream(int stream_id)
+{
+    std::shared_ptr<Stream> stream;
+    std::deque<QueuedPacket> dropped;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_streams.find(stream_id);
+        if (it == m_streams.end())
+        {
+            return -1;
+        }
+        stream = it->second;
+        stream->removed = true;
+        dropped.swap(stream->queue);
+        m_idle_cv.wait(lock, [&stream]() { return !stream->busy; });
+        m_streams.erase(it);
+    }
+    // packet owners run outside the lock, they may hand buffers back to the producer
+    dropped.clear();
+    stream->decoder->tearDown();
+    stream->decoder.reset();
+    return 0;
+}
+
+int DecoderSessionManager::submit(int stream_id, Packet packet)
+{
+    std::deque<QueuedPacket> dropped;
+    int ret = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_streams.find(stream_id);
+        if ((it == m_streams.end()) || it->second->removed)
+        {
+            return -1;
+        }
+        Stream& stream = *it->second;
+
+        if (stream.waiting_keyframe && !packet.key_frame)
+        {
+            ++stream.drops;
+            return 1;
+        }
+        stream.waiting_keyframe = false;
+
+        if (stream.queue.size() >= stream.cfg.queue_capacity)
+        {
+            switch (stream.cfg.drop_policy)
+            {
+            case DropPolicy::DropOldest:
+                dropped.push_back(std::move(stream.queue.front()));
+                stream.queue.pop_front();
+                ++stream.drops;
+                break;
+            case DropPolicy::DropNewest:
+                ++stream.drops;
+                return 1;
+            case DropPolicy::DropToKeyframe:
+                stream.drops += stream.queue.size();
+                dropped.swap(stream.queue);
+                if (!packet.key_frame)
+                {
+                    ++stream.drops;
+                    stream.waiting_keyframe = true;
+                    ret = 1;
+                }
+                break;
+            }
+        }
+
+        if (ret == 0)
+        {
+            stream.queue.push_back(QueuedPacket{std::move(packet), nowNs()});
+            ++stream.packets;
+        }
+    }
+    if (ret == 0)
+    {
+        m_work_cv.notify_one();
+    }
+    return ret;
+}
+
+DecoderSessionManager::StreamStats DecoderSessionManager::stats(int stream_id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(stream_id);
+    return (it == m_streams.end()) ? StreamStats{} : collectStats(*it->second);
+}
+
+std::vector<DecoderSessionManager::StreamStats> DecoderSessionManager::allStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<StreamStats> result;
+    for (auto& item : m_streams)
+    {
+        result.push_back(collectStats(*item.second));
+    }
+    return result;
+}
+
+DecoderSessionManager::StreamStats DecoderSessionManager::collectStats(const Stream& stream) const
+{
+    StreamStats stats;
+    stats.name = stream.cfg.name;
+    stats.packets = stream.packets;
+    stats.decoded = stream.decoded;
+    stats.frames = stream.frames.load(std::memory_order_relaxed);
+    stats.drops = stream.drops;
+    stats.queue_depth = stream.queue.size();
+    stats.waiting_keyframe = stream.waiting_keyframe;
+    stats.fps = stream.fps.load(std::memory_order_relaxed);
+    stats.latency_avg_us = stream.latency_avg_us.load(std::memory_order_relaxed);
+    stats.latency_max_us = stream.latency_max_us.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool DecoderSessionManager::isKeyframe(const std::string& encoding, const uint8_t* data, size_t size)
+{
+    return h26x::isKeyframe(encoding, data, size);
+}
+
+std::shared_ptr<DecoderSessionManager::Stream> DecoderSessionManager::pickStream(uint64_t now_ns)
+{
+    auto eligible = [](const Stream& stream) { return !stream.busy && !stream.removed && !stream.queue.empty(); };
+
+    // earliest deadline first among the streams whose oldest packet is overdue
+    std::shared_ptr<Stream> best;
+    uint64_t best_due = 0;
+    for (auto& item : m_streams)
+    {
+        Stream& stream = *item.second;
+        if (!eligible(stream) || (stream.cfg.deadline_ms <= 0))
+        {
+            continue;
+        }
+        uint64_t due = stream.queue.front().arrival_ns + static_cast<uint64_t>(stream.cfg.deadline_ms) * 1000000ULL;
+        if ((due <= now_ns) &&
+            ((best == nullptr) || (due < best_due) || ((due == best_due) && (stream.cfg.priority > best->cfg.priority))))
+        {
+            best = item.second;
+            best_due = due;
+        }
+    }
+    if (best != nullptr)
+    {
+        return best;
+    }
+
+    // round robin, continuing after the stream served last
+    auto it = m_streams.lower_bound(m_rr_cursor);
+    for (size_t i = 0; i < m_streams.size(); i++, it++)
+    {
+        if (it == m_streams.end())
+        {
+            it = m_streams.begin();
+        }
+        if (eligible(*it->second))
+        {
+            m_rr_cursor = it->first + 1;
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+void DecoderSessionManager::workerLoop()
+{
+    bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread(THREAD_ROLE);
+    std::vector<QueuedPacket> batch;
+    while (true)
+    {
+        std::shared_ptr<Stream> stream;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work_cv.wait(lock, [this, &stream]()
+            {
+                stream = pickStream(nowNs());
+                return m_stop || (stream != nullptr);
+            });
+            if (stream == nullptr)
+            {
+                break;
+            }
+            stream->busy = true;
+            size_t count = std::min<size_t>(static_cast<size_t>(stream->cfg.priority), stream->queue.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                batch.push_back(std::move(stream->queue.front()));
+                stream->queue.pop_front();
+            }
+            stream->decoded += count;
+        }
+
+        for (auto& queued : batch)
+        {
+            stream->current_arrival_ns.store(queued.arrival_ns, std::memory_order_relaxed);
+            DecodePacket dec_pkt = {
+                .data = queued.packet.buffer.data,
+                .pkt_size = queued.packet.buffer.size,
+                .pkt_eos = 0,
+            };
+            if (stream->decoder->decode(dec_pkt) < 0)
+            {
+                std::cerr << LOG_TAG << stream->cfg.name << ": decode failed" << std::endl;
+            }
+        }
+        // owners release the packet memory outside the lock
+        batch.clear();
+
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stream->busy = false;
+            more = !stream->queue.empty();
+        }
+        m_idle_cv.notify_all();
+        if (more)
+        {
+            m_work_cv.notify_one();
+        }
+    }
+}
+
+void DecoderSessionManager::onFrame(Stream& stream, std::shared_ptr<ImageBuffer> frame)
+{
+    uint64_t now = nowNs();
+    uint64_t arrival = stream.current_arrival_ns.load(std::memory_order_relaxed);
+    double latency_us = (arrival > 0 && now > arrival) ? static_cast<double>(now - arrival) / 1000.0 : 0.0;
+
+    uint64_t frames = stream.frames.fetch_add(1, std::memory_order_relaxed) + 1;
+    double avg = stream.latency_avg_us.load(std::memory_order_relaxed);
+    avg = (frames == 1) ? latency_us : (avg + LATENCY_EWMA_ALPHA * (latency_us - avg));
+    stream.latency_avg_us.store(avg, std::memory_order_relaxed);
+
+    // frames of one stream come from one thread at a time, the window needs no lock
+    if (stream.window_start_ns == 0)
+    {
+        stream.window_start_ns = now;
+    }
+    ++stream.window_frames;
+    stream.window_max_us = std::max(stream.window_max_us, latency_us);
+    if (now - stream.window_start_ns >= FPS_WINDOW_NS)
+    {
+        stream.fps.store(static_cast<double>(stream.window_frames) * 1e9 / static_cast<double>(now - stream.window_start_ns),
+                         std::memory_order_relaxed);
+        stream.latency_max_us.store(stream.window_max_us, std::memory_order_relaxed);
+        stream.window_start_ns = now;
+        stream.window_frames = 0;
+        stream.window_max_us = 0.0;
+    }
+
+    if (stream.callback != nullptr)
+    {
+        FrameInfo info;
+        info.stream_id = stream.id;
+        info.latency_us = latency_us;
+        info.fps = stream.fps.load(std::memory_order_relaxed);
+        stream.callback(std::move(frame), info);
+    }
+}
+
+uint64_t DecoderSessionManager::nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace bsp_codec
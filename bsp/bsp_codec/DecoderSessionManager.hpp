@@ -0,0 +1,201 @@
+#ifndef __DECODER_SESSION_MANAGER_HPP__
+#define __DECODER_SESSION_MANAGER_HPP__
+
+#include <bsp_codec/IDecoder.hpp>
+#include <shared/BspPacketBuffer.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bsp_codec
+{
+
+/**
+ * @brief Decodes many live streams (cameras) on a fixed set of worker threads.
+ *
+ * Every stream keeps its own decoder session (reference frames are per stream) and a bounded
+ * packet queue, but no thread of its own: config.workers threads pick the next stream with
+ * packets and decode up to priority packets of it before moving on. Streams are served round
+ * robin, a stream whose oldest packet waited longer than its deadline goes first (earliest
+ * deadline first). One stream is never decoded by two workers at once.
+ *
+ *     DecoderSessionManager manager({.codecPlatform = "rkmpp", .workers = 2});
+ *     int id = manager.addStream(streamCfg, [](auto frame, const auto& info) { publish(frame); });
+ *     manager.submit(id, {PacketBuffer::wrap(data, size, owner), key_frame});
+ *
+ * A full queue applies the stream's DropPolicy. Dropping single packets of an H.264 / H.265
+ * stream corrupts every frame up to the next keyframe, DropToKeyframe therefore drops the whole
+ * backlog and skips input until a keyframe arrives.
+ */
+class DecoderSessionManager
+{
+public:
+    static constexpr char LOG_TAG[] {"[DecoderSessionManager]: "};
+    static constexpr char THREAD_ROLE[] {"video_decoder"};
+
+    enum class DropPolicy
+    {
+        DropOldest,         // make room by dropping the oldest queued packet
+        DropNewest,         // reject the incoming packet
+        DropToKeyframe      // drop the backlog and wait for the next keyframe
+    };
+
+    struct Config
+    {
+        std::string codecPlatform{"rkmpp"};     // IDecoder::create()
+        size_t workers{2};
+        size_t maxSessions{16};                 // decoder sessions open at a time
+    };
+
+    struct StreamConfig
+    {
+        std::string name{};
+        DecodeConfig decode{};
+        int priority{1};                        // packets decoded per turn
+        int deadline_ms{0};                     // served first once a packet waited that long, 0 off
+        size_t queue_capacity{30};
+        DropPolicy drop_policy{DropPolicy::DropToKeyframe};
+    };
+
+    struct Packet
+    {
+        bsp_perf::shared::PacketBuffer buffer{};    // released once decoded or dropped
+        bool key_frame{false};                      // starts an IDR / IRAP access unit
+    };
+
+    struct FrameInfo
+    {
+        int stream_id{-1};
+        double latency_us{0.0};     // submit() of the packet decoded last -> frame out
+        double fps{0.0};            // decoded frames per second of the stream
+    };
+
+    /**
+     * @brief Called with every decoded frame of a stream, on a worker or decoder thread.
+     */
+    using frameCallback = std::function<void(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> frame,
+                                             const FrameInfo& info)>;
+
+    struct StreamStats
+    {
+        std::string name{};
+        uint64_t packets{0};        // accepted by submit()
+        uint64_t decoded{0};        // handed to the decoder
+        uint64_t frames{0};
+        uint64_t drops{0};
+        size_t queue_depth{0};
+        bool waiting_keyframe{false};
+        double fps{0.0};
+        double latency_avg_us{0.0};
+        double latency_max_us{0.0}; // in the last fps window
+    };
+
+    explicit DecoderSessionManager(const Config& config);
+    ~DecoderSessionManager();
+
+    DecoderSessionManager(const DecoderSessionManager&) = delete;
+    DecoderSessionManager& operator=(const DecoderSessionManager&) = delete;
+
+    /**
+     * @brief Open a decoder session for a stream.
+     * @return stream id, -1 when maxSessions are open or the decoder setup failed
+     */
+    int addStream(const StreamConfig& cfg, frameCallback callback);
+
+    /**
+     * @brief Drop the queued packets, wait for a running decode and close the session.
+     * @return 0 success, -1 unknown stream
+     */
+    int removeStream(int stream_id);
+
+    /**
+     * @brief Queue a packet of the stream.
+     * @return 0 queued, 1 dropped by the drop policy, -1 unknown stream
+     */
+    int submit(int stream_id, Packet packet);
+
+    /**
+     * @return stats of the stream, an empty name for an unknown stream
+     */
+    StreamStats stats(int stream_id) const;
+
+    std::vector<StreamStats> allStats() const;
+
+    size_t workers() const { return m_workers.size(); }
+
+    /**
+     * @brief Whether an Annex B buffer or a single RTP payload (NAL unit, FU-A / FU start)
+     * begins a keyframe: IDR or SPS for h264, IRAP or VPS / SPS for h265. Other codecs: false.
+     * Same as h26x::isKeyframe() of H26xNal.hpp.
+     */
+    static bool isKeyframe(const std::string& encoding, const uint8_t* data, size_t size);
+
+private:
+    struct QueuedPacket
+    {
+        Packet packet{};
+        uint64_t arrival_ns{0};
+    };
+
+    struct Stream
+    {
+        int id{-1};
+        StreamConfig cfg{};
+        std::unique_ptr<IDecoder> decoder{};
+        frameCallback callback{};
+
+        // guarded by m_mutex
+        std::deque<QueuedPacket> queue{};
+        bool busy{false};
+        bool removed{false};
+        bool waiting_keyframe{false};
+        uint64_t packets{0};
+        uint64_t decoded{0};
+        uint64_t drops{0};
+
+        // updated on the decoding thread
+        std::atomic<uint64_t> current_arrival_ns{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<double> fps{0.0};
+        std::atomic<double> latency_avg_us{0.0};
+        std::atomic<double> latency_max_us{0.0};
+        uint64_t window_start_ns{0};
+        uint64_t window_frames{0};
+        double window_max_us{0.0};
+    };
+
+    void workerLoop();
+
+    /**
+     * @brief Next stream to serve, m_mutex held.
+     */
+    std::shared_ptr<Stream> pickStream(uint64_t now_ns);
+
+    void onFrame(Stream& stream, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> frame);
+
+    StreamStats collectStats(const Stream& stream) const;
+
+    static uint64_t nowNs();
+
+private:
+    Config m_config;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_idle_cv;
+    std::map<int, std::shared_ptr<Stream>> m_streams{};
+    size_t m_reserved{0};               // sessions of addStream() calls still setting up their decoder
+    int m_next_id{0};
+    int m_rr_cursor{0};                 // stream id the round robin continues at
+    bool m_stop{false};
+
+    std::vector<std::thread> m_workers{};
+};
+
+} // namespace bsp_codec
+
+#endif // __DECODER_SESSION_MANAGER_HPP__
@@ -0,0 +1,91 @@
+#ifndef __H26X_NAL_HPP__
+#define __H26X_NAL_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bsp_codec
+{
+namespace h26x
+{
+
+/**
+ * @brief Whether a NAL unit type starts a keyframe: IDR slice or SPS for h264, IRAP slices or
+ * VPS / SPS for h265.
+ */
+inline bool isKeyNalType(bool h265, int type)
+{
+    if (!h265)
+    {
+        return (type == 5) || (type == 7);
+    }
+    return ((type >= 16) && (type <= 21)) || (type == 32) || (type == 33);
+}
+
+/**
+ * @brief Same for the NAL unit at nal (no start code), fragmentation units count only when they
+ * carry the start of the NAL unit.
+ */
+inline bool isKeyNal(bool h265, const uint8_t* nal, size_t size)
+{
+    if (size == 0)
+    {
+        return false;
+    }
+    if (!h265)
+    {
+        int type = nal[0] & 0x1f;
+        if ((type == 28) || (type == 29))
+        {
+            // FU-A / FU-B
+            return (size > 1) && ((nal[1] & 0x80) != 0) && isKeyNalType(false, nal[1] & 0x1f);
+        }
+        return isKeyNalType(false, type);
+    }
+
+    int type = (nal[0] >> 1) & 0x3f;
+    if (type == 49)
+    {
+        // fragmentation unit, FU header after the two byte NAL header
+        return (size > 2) && ((nal[2] & 0x80) != 0) && isKeyNalType(true, nal[2] & 0x3f);
+    }
+    return isKeyNalType(true, type);
+}
+
+/**
+ * @brief Whether an Annex B buffer or a single RTP payload (NAL unit, FU-A / FU start) begins a
+ * keyframe. encoding is "h264", "h265" or "hevc", other codecs: false.
+ *
+ * For streams that come without the encoder's own flag (RTP, raw files), encoder output carries
+ * EncodePacket::key_frame.
+ */
+inline bool isKeyframe(const std::string& encoding, const uint8_t* data, size_t size)
+{
+    bool h265 = (encoding.compare("h265") == 0) || (encoding.compare("hevc") == 0);
+    if ((!h265 && (encoding.compare("h264") != 0)) || (data == nullptr))
+    {
+        return false;
+    }
+
+    bool start_code = false;
+    for (size_t i = 0; i + 3 < size; i++)
+    {
+        if ((data[i] == 0) && (data[i + 1] == 0) && (data[i + 2] == 1))
+        {
+            start_code = true;
+            i += 3;
+            if (isKeyNal(h265, data + i, size - i))
+            {
+                return true;
+            }
+        }
+    }
+    // no Annex B framing, a single NAL unit as carried by RTP
+    return !start_code && isKeyNal(h265, data, size);
+}
+
+} // namespace h26x
+} // namespace bsp_codec
+
+#endif // __H26X_NAL_HPP__
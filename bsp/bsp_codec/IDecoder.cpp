@@ -5,6 +5,9 @@
 #ifdef BUILD_PLATFORM_JETSON
 #include "video/nvVideoDec.hpp"
 #endif
+#ifdef BUILD_CODEC_FFMPEG
+#include "video/ffmpegDec.hpp"
+#endif
 #include <stdexcept>
 #include <memory>
 
@@ -23,6 +26,12 @@ std::unique_ptr<IDecoder> IDecoder::create(const std::string& codecPlatform)
     {
         return std::make_unique<nvVideoDec>();
     }
+#endif
+#ifdef BUILD_CODEC_FFMPEG
+    if (codecPlatform.compare("ffmpeg") == 0)
+    {
+        return std::make_unique<ffmpegDec>();
+    }
 #endif
     throw std::invalid_argument("Invalid Decoder platform specified.");
 }
@@ -51,6 +51,7 @@ public:
      * Supported values:
      * - "rkmpp" for Rockchip MPP decoder
      * - "nvdec" for NVIDIA NVDEC decoder (Jetson platforms)
+     * - "ffmpeg" for the libavcodec software decoder (any platform with FFmpeg)
      *
      * @throws std::invalid_argument If an invalid codec platform is specified.
      * @return std::unique_ptr<IDecoder> A unique pointer to the created IDecoder instance.
@@ -5,6 +5,9 @@
 #ifdef BUILD_PLATFORM_JETSON
 #include "video/nvVideoEnc.hpp"
 #endif
+#ifdef BUILD_CODEC_FFMPEG
+#include "video/ffmpegEnc.hpp"
+#endif
 #include <stdexcept>
 #include <memory>
 
@@ -23,6 +26,12 @@ std::unique_ptr<IEncoder> IEncoder::create(const std::string& codecPlatform)
     {
         return std::make_unique<nvVideoEnc>();
     }
+#endif
+#ifdef BUILD_CODEC_FFMPEG
+    if (codecPlatform.compare("ffmpeg") == 0)
+    {
+        return std::make_unique<ffmpegEnc>();
+    }
 #endif
     throw std::invalid_argument("Invalid Encoder platform specified.");
 }
@@ -7,6 +7,7 @@
 #include <functional>
 #include <vector>
 #include <bsp_image/ImageBuffer.hpp>
+#include <shared/BspPacketBuffer.hpp>
 
 namespace bsp_codec
 {
@@ -26,9 +27,15 @@ struct EncodeConfig
 struct EncodePacket
 {
     size_t max_size{0};
+    // end of stream: flush the frames the encoder still holds, the input buffer is not read
     int pkt_eos;
     size_t pkt_len{0};
+    // optional copy target, only filled when the caller sized it (legacy, costs a copy per frame)
     std::vector<uint8_t> encode_pkt{};
+    // bitstream of the frame (pkt_len bytes), shared with the encoder's output memory, no copy
+    bsp_perf::shared::PacketBuffer buffer{};
+    // the packet starts a keyframe (IDR / IRAP), as reported by the encoder
+    bool key_frame{false};
 };
 
 class IEncoder
@@ -45,6 +52,7 @@ public:
      * Supported values:
      * - "rkmpp" for Rockchip MPP encoder
      * - "nvenc" for NVIDIA NVENC encoder (Jetson platforms)
+     * - "ffmpeg" for the libavcodec software encoder (any platform with FFmpeg)
      *
      * @throws std::invalid_argument If an invalid codec platform is specified.
      * @return std::unique_ptr<IEncoder> A unique pointer to the created IEncoder instance.
@@ -89,7 +97,9 @@ public:
      * Behavior:
      * - Reads frame data from input_buf.view.data()
      * - Encodes the frame
-     * - Fills out_pkt with encoded data (if out_pkt.encode_pkt has capacity)
+     * - Sets out_pkt.buffer to the encoded data, a refcounted buffer that stays valid as long
+     *   as it is referenced (e.g. by a StreamPacket queued in the muxer)
+     * - Also copies it into out_pkt.encode_pkt if the caller sized that vector
      * - Calls the callback (if set) with encoded data
      * - Automatically releases input_buf back to pool
      * 
@@ -100,14 +110,13 @@ public:
      * 
      * Usage:
      *   EncodePacket out_pkt;
-     *   out_pkt.max_size = frame_size * 2;
-     *   out_pkt.encode_pkt.resize(out_pkt.max_size);
+     *   out_pkt.max_size = encoder->getFrameSize();
      *   
      *   encoder->encode(*input_buf, out_pkt);
      *   
      *   if (out_pkt.pkt_len > 0) {
-     *       // Encoded data available in out_pkt.encode_pkt
-     *       write_to_file(out_pkt.encode_pkt.data(), out_pkt.pkt_len);
+     *       // Encoded data available in out_pkt.buffer
+     *       write_to_file(out_pkt.buffer.data, out_pkt.buffer.size);
      *   }
      * 
      * @param input_buf Input image buffer obtained from getInputBuffer()
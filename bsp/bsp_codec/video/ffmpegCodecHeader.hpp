@@ -0,0 +1,95 @@
+#ifndef __FFMPEG_VIDEO_CODEC_HEADER_HPP__
+#define __FFMPEG_VIDEO_CODEC_HEADER_HPP__
+extern "C" {
+#include <libavcodec/codec_id.h>
+#include <libavutil/pixfmt.h>
+}
+#include <unordered_map>
+#include <string>
+#include <mutex>
+
+namespace bsp_codec
+{
+
+class ffmpegCodecHeader
+{
+public:
+    static ffmpegCodecHeader& getInstance()
+    {
+        static ffmpegCodecHeader instance;
+        return instance;
+    }
+
+    enum AVCodecID strToFFmpegCoding(const std::string& str)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return strToFFmpegCodingMap.at(str);
+    }
+
+    enum AVPixelFormat strToPixelFormat(const std::string& str)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return strToPixelFormatMap.at(str);
+    }
+
+    const std::string& pixelFormatToStr(enum AVPixelFormat pixelFormat)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return pixelFormatToStrMap.at(pixelFormat);
+    }
+
+    bool isSupportedPixelFormat(enum AVPixelFormat pixelFormat)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return pixelFormatToStrMap.count(pixelFormat) > 0;
+    }
+
+private:
+    ffmpegCodecHeader() = default;
+    ~ffmpegCodecHeader() = default;
+    ffmpegCodecHeader(const ffmpegCodecHeader&) = delete;
+    ffmpegCodecHeader& operator=(const ffmpegCodecHeader&) = delete;
+
+private:
+    std::mutex m_mutex;
+    const std::unordered_map<std::string, enum AVCodecID> strToFFmpegCodingMap{
+        {"mpeg2", AV_CODEC_ID_MPEG2VIDEO},
+        {"h263", AV_CODEC_ID_H263},
+        {"mpeg4", AV_CODEC_ID_MPEG4},
+        {"h264", AV_CODEC_ID_H264},
+        {"mjpeg", AV_CODEC_ID_MJPEG},
+        {"vp8", AV_CODEC_ID_VP8},
+        {"vp9", AV_CODEC_ID_VP9},
+        {"h265", AV_CODEC_ID_HEVC},
+        {"hevc", AV_CODEC_ID_HEVC},
+        {"av1", AV_CODEC_ID_AV1}
+    };
+    // only layouts that match the bsp_image pixel format table (8 bit, planar or semi planar)
+    const std::unordered_map<std::string, enum AVPixelFormat> strToPixelFormatMap{
+        {"YUV420SP", AV_PIX_FMT_NV12},
+        {"YUV420P", AV_PIX_FMT_YUV420P},
+        {"YUV422SP", AV_PIX_FMT_NV16},
+        {"YUV422P", AV_PIX_FMT_YUV422P},
+        {"YUV444P", AV_PIX_FMT_YUV444P},
+        {"RGB888", AV_PIX_FMT_RGB24},
+        {"BGR888", AV_PIX_FMT_BGR24},
+        {"GRAY8", AV_PIX_FMT_GRAY8}
+    };
+    const std::unordered_map<enum AVPixelFormat, std::string> pixelFormatToStrMap{
+        {AV_PIX_FMT_NV12, "YUV420SP"},
+        {AV_PIX_FMT_YUV420P, "YUV420P"},
+        {AV_PIX_FMT_YUVJ420P, "YUV420P"},
+        {AV_PIX_FMT_NV16, "YUV422SP"},
+        {AV_PIX_FMT_YUV422P, "YUV422P"},
+        {AV_PIX_FMT_YUVJ422P, "YUV422P"},
+        {AV_PIX_FMT_YUV444P, "YUV444P"},
+        {AV_PIX_FMT_YUVJ444P, "YUV444P"},
+        {AV_PIX_FMT_RGB24, "RGB888"},
+        {AV_PIX_FMT_BGR24, "BGR888"},
+        {AV_PIX_FMT_GRAY8, "GRAY8"}
+    };
+};
+
+} // namespace bsp_codec
+
+#endif // __FFMPEG_VIDEO_CODEC_HEADER_HPP__
@@ -0,0 +1,439 @@
+#include "ffmpegCodecHeader.hpp"
+#include "ffmpegDec.hpp"
+#include <bsp_image/ImageBuffer.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace bsp_codec
+{
+
+using namespace bsp_perf::bsp_image;
+
+constexpr char ffmpegDec::LOG_TAG[];
+
+static inline unsigned long GetCurrentTimeMS()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec*1000 + tv.tv_usec / 1000;
+}
+
+ffmpegDec::~ffmpegDec()
+{
+    releaseContext();
+}
+
+void ffmpegDec::releaseContext()
+{
+    if (m_parser != nullptr)
+    {
+        av_parser_close(m_parser);
+        m_parser = nullptr;
+    }
+    if (m_codec_ctx != nullptr)
+    {
+        avcodec_free_context(&m_codec_ctx);
+    }
+    if (m_packet != nullptr)
+    {
+        av_packet_free(&m_packet);
+    }
+    if (m_frame != nullptr)
+    {
+        av_frame_free(&m_frame);
+    }
+
+    // blocks still referenced by delivered frames are freed when the consumers drop them
+    std::lock_guard<std::mutex> lock(m_pool_mutex);
+    if (m_buffer_pool != nullptr)
+    {
+        av_buffer_pool_uninit(&m_buffer_pool);
+        m_buffer_pool_size = 0;
+    }
+}
+
+int ffmpegDec::setup(DecodeConfig& cfg)
+{
+    try
+    {
+        m_params.codec_id = ffmpegCodecHeader::getInstance().strToFFmpegCoding(cfg.encoding);
+    }
+    catch (const std::out_of_range& e)
+    {
+        std::cerr << LOG_TAG << "Invalid encoding type " << cfg.encoding << std::endl;
+        return -1;
+    }
+    m_params.fps = cfg.fps;
+    m_params.last_frame_time_ms = 0;
+
+    releaseContext();
+
+    const AVCodec* codec = avcodec_find_decoder(m_params.codec_id);
+    if (codec == nullptr)
+    {
+        std::cerr << LOG_TAG << "no libavcodec decoder for " << cfg.encoding << std::endl;
+        return -1;
+    }
+
+    m_codec_ctx = avcodec_alloc_context3(codec);
+    if (m_codec_ctx == nullptr)
+    {
+        std::cerr << LOG_TAG << "avcodec_alloc_context3 failed" << std::endl;
+        return -1;
+    }
+    m_codec_ctx->thread_count = m_params.thread_count;
+    m_codec_ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    m_codec_ctx->opaque = this;
+    m_codec_ctx->get_buffer2 = &ffmpegDec::getFrameBuffer;
+
+    int ret = avcodec_open2(m_codec_ctx, codec, nullptr);
+    if (ret < 0)
+    {
+        std::cerr << LOG_TAG << "avcodec_open2 " << codec->name << " failed ret: " << ret << std::endl;
+        releaseContext();
+        return -1;
+    }
+
+    // no parser (e.g. a codec only fed by the demuxer): packets must hold whole frames
+    m_parser = av_parser_init(codec->id);
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+    if ((m_packet == nullptr) || (m_frame == nullptr))
+    {
+        std::cerr << LOG_TAG << "packet / frame allocation failed" << std::endl;
+        releaseContext();
+        return -1;
+    }
+
+    std::cout << LOG_TAG << "setup " << codec->name << " threads: " << m_codec_ctx->thread_count
+              << " parser: " << (m_parser != nullptr ? "yes" : "no") << std::endl;
+    return 0;
+}
+
+int ffmpegDec::getFrameBuffer(AVCodecContext* ctx, AVFrame* frame, int flags)
+{
+    auto* self = static_cast<ffmpegDec*>(ctx->opaque);
+    auto& header = ffmpegCodecHeader::getInstance();
+    const auto pixelFormat = static_cast<enum AVPixelFormat>(frame->format);
+
+    if ((self == nullptr) || !(ctx->codec->capabilities & AV_CODEC_CAP_DR1) ||
+        !header.isSupportedPixelFormat(pixelFormat))
+    {
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+
+    const PixelFormat format = pixelFormatFromString(header.pixelFormatToStr(pixelFormat));
+    int width = frame->width;
+    int height = frame->height;
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(ctx, &width, &height, linesize_align);
+
+    // widen the stride until every plane row meets the SIMD alignment the codec asks for
+    auto rowsAligned = [&linesize_align](const PlaneLayout& layout)
+    {
+        for (uint32_t plane = 0; plane < layout.planeCount; ++plane)
+        {
+            if ((layout.rowStride[plane] % static_cast<uint32_t>(std::max(linesize_align[plane], 1))) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    uint32_t width_stride = FFALIGN(static_cast<uint32_t>(width), 64U);
+    PlaneLayout layout = planeLayout(format, width_stride, static_cast<uint32_t>(height));
+    while (!rowsAligned(layout))
+    {
+        width_stride += 64;
+        layout = planeLayout(format, width_stride, static_cast<uint32_t>(height));
+    }
+
+    // room for the SIMD over-reads at the end of the last plane
+    const size_t size = layout.totalSize + AV_INPUT_BUFFER_PADDING_SIZE;
+    AVBufferRef* buf = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(self->m_pool_mutex);
+        if ((self->m_buffer_pool == nullptr) || (self->m_buffer_pool_size != size))
+        {
+            // stream resolution changed, the old pool lives on until its blocks come back
+            av_buffer_pool_uninit(&self->m_buffer_pool);
+            self->m_buffer_pool = av_buffer_pool_init(size, nullptr);
+            self->m_buffer_pool_size = size;
+        }
+        if (self->m_buffer_pool != nullptr)
+        {
+            buf = av_buffer_pool_get(self->m_buffer_pool);
+        }
+    }
+    if (buf == nullptr)
+    {
+        return AVERROR(ENOMEM);
+    }
+
+    frame->buf[0] = buf;
+    for (uint32_t plane = 0; plane < layout.planeCount; ++plane)
+    {
+        frame->data[plane] = buf->data + layout.offset[plane];
+        frame->linesize[plane] = static_cast<int>(layout.rowStride[plane]);
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+int ffmpegDec::decode(DecodePacket& pkt_data)
+{
+    if (m_codec_ctx == nullptr)
+    {
+        std::cerr << LOG_TAG << "decode() called before setup()" << std::endl;
+        return -1;
+    }
+
+    const uint8_t* data = pkt_data.data;
+    size_t remaining = (data != nullptr) ? pkt_data.pkt_size : 0;
+
+    if (m_parser == nullptr)
+    {
+        if (remaining > 0)
+        {
+            m_packet->data = const_cast<uint8_t*>(data);
+            m_packet->size = static_cast<int>(remaining);
+            int ret = sendPacket(m_packet);
+            av_packet_unref(m_packet);
+            if (ret < 0)
+            {
+                return -1;
+            }
+        }
+    }
+    else
+    {
+        while (remaining > 0)
+        {
+            int used = av_parser_parse2(m_parser, m_codec_ctx, &m_packet->data, &m_packet->size,
+                                        data, static_cast<int>(remaining), AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+            if (used < 0)
+            {
+                std::cerr << LOG_TAG << "av_parser_parse2 failed ret: " << used << std::endl;
+                return -1;
+            }
+            data += used;
+            remaining -= static_cast<size_t>(used);
+
+            if ((m_packet->size > 0) && (sendPacket(m_packet) < 0))
+            {
+                return -1;
+            }
+        }
+    }
+
+    if (pkt_data.pkt_eos)
+    {
+        if (m_parser != nullptr)
+        {
+            // the parser holds back the last access unit until it is flushed
+            av_parser_parse2(m_parser, m_codec_ctx, &m_packet->data, &m_packet->size,
+                             nullptr, 0, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+            if ((m_packet->size > 0) && (sendPacket(m_packet) < 0))
+            {
+                return -1;
+            }
+        }
+
+        // drain the frames still queued in the frame threads
+        if (sendPacket(nullptr) < 0)
+        {
+            return -1;
+        }
+        std::cout << LOG_TAG << "found last frame " << std::endl;
+        avcodec_flush_buffers(m_codec_ctx);
+    }
+
+    return 0;
+}
+
+int ffmpegDec::sendPacket(AVPacket* packet)
+{
+    int ret = avcodec_send_packet(m_codec_ctx, packet);
+    while (ret == AVERROR(EAGAIN))
+    {
+        if (receiveFrames() < 0)
+        {
+            return -1;
+        }
+        ret = avcodec_send_packet(m_codec_ctx, packet);
+    }
+
+    if (ret == AVERROR_INVALIDDATA)
+    {
+        // e.g. a stream joined in the middle of a GOP, keep going until the next key frame
+        std::cerr << LOG_TAG << "skip invalid packet size " << (packet != nullptr ? packet->size : 0) << std::endl;
+        return 0;
+    }
+    if ((ret < 0) && (ret != AVERROR_EOF))
+    {
+        std::cerr << LOG_TAG << "avcodec_send_packet failed ret: " << ret << std::endl;
+        return -1;
+    }
+
+    return receiveFrames();
+}
+
+int ffmpegDec::receiveFrames()
+{
+    while (true)
+    {
+        int ret = avcodec_receive_frame(m_codec_ctx, m_frame);
+        if ((ret == AVERROR(EAGAIN)) || (ret == AVERROR_EOF))
+        {
+            return 0;
+        }
+        if (ret < 0)
+        {
+            std::cerr << LOG_TAG << "avcodec_receive_frame failed ret: " << ret << std::endl;
+            return -1;
+        }
+
+        deliverFrame(m_frame);
+        av_frame_unref(m_frame);
+    }
+}
+
+void ffmpegDec::deliverFrame(AVFrame* frame)
+{
+    if (m_callback != nullptr)
+    {
+        const auto pixelFormat = static_cast<enum AVPixelFormat>(frame->format);
+        if (!ffmpegCodecHeader::getInstance().isSupportedPixelFormat(pixelFormat))
+        {
+            const char* name = av_get_pix_fmt_name(pixelFormat);
+            std::cerr << LOG_TAG << "drop frame, unsupported pixel format " << (name != nullptr ? name : "none") << std::endl;
+            return;
+        }
+
+        auto buffer = wrapFrame(frame);
+        if (buffer == nullptr)
+        {
+            buffer = copyFrame(frame);
+        }
+        if (buffer != nullptr)
+        {
+            m_callback(m_userdata, buffer);
+        }
+    }
+
+    if (m_params.fps > 0)
+    {
+        unsigned long cur_time_ms = GetCurrentTimeMS();
+        long time_gap = (1000 / m_params.fps) - static_cast<long>(cur_time_ms - m_params.last_frame_time_ms);
+        if ((m_params.last_frame_time_ms != 0) && (time_gap > 0))
+        {
+            usleep(time_gap * 1000);
+        }
+        m_params.last_frame_time_ms = GetCurrentTimeMS();
+    }
+}
+
+std::shared_ptr<ImageBuffer> ffmpegDec::wrapFrame(AVFrame* frame)
+{
+    // zero copy needs every plane inside the one buffer of getFrameBuffer, behind the luma plane
+    if ((frame->buf[0] == nullptr) || (frame->buf[1] != nullptr))
+    {
+        return nullptr;
+    }
+
+    const std::string& formatName = ffmpegCodecHeader::getInstance().pixelFormatToStr(static_cast<enum AVPixelFormat>(frame->format));
+    const PixelFormat format = pixelFormatFromString(formatName);
+    const auto& info = pixelFormatInfo(format);
+    const uint8_t* bufferEnd = frame->buf[0]->data + frame->buf[0]->size;
+
+    PlaneLayout layout{};
+    layout.planeCount = info.planeCount;
+    for (uint32_t plane = 0; plane < layout.planeCount; ++plane)
+    {
+        if ((frame->data[plane] < frame->data[0]) || (frame->linesize[plane] <= 0))
+        {
+            return nullptr;
+        }
+        layout.offset[plane] = static_cast<size_t>(frame->data[plane] - frame->data[0]);
+        layout.rowStride[plane] = static_cast<uint32_t>(frame->linesize[plane]);
+        layout.size[plane] = static_cast<size_t>(layout.rowStride[plane]) *
+                             planeRows(format, plane, static_cast<uint32_t>(frame->height));
+        if (frame->data[0] + layout.offset[plane] + layout.size[plane] > bufferEnd)
+        {
+            return nullptr;
+        }
+        layout.totalSize = std::max(layout.totalSize, layout.offset[plane] + layout.size[plane]);
+    }
+
+    ImageDesc desc{};
+    desc.width = static_cast<uint32_t>(frame->width);
+    desc.height = static_cast<uint32_t>(frame->height);
+    desc.widthStride = layout.rowStride[0] * 8 / info.planes[0].bitsPerElement;
+    desc.heightStride = desc.height;
+    if ((layout.planeCount > 1) && ((layout.offset[1] % layout.rowStride[0]) == 0))
+    {
+        // rows the codec padded below the picture
+        desc.heightStride = static_cast<uint32_t>(layout.offset[1] / layout.rowStride[0]);
+    }
+    desc.format = formatName;
+    desc.dataSize = layout.totalSize;
+
+    AVFrame* ref = av_frame_clone(frame);
+    if (ref == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto buffer = std::make_shared<ImageBuffer>();
+    buffer->owner = std::shared_ptr<AVFrame>(ref, [](AVFrame* p) { av_frame_free(&p); });
+    buffer->view = makeHostImageView(ref->data[0], desc, layout);
+    // lets libavcodec consumers (ffmpegEnc) take a reference instead of copying
+    buffer->nativeHandle = ref;
+    return buffer;
+}
+
+std::shared_ptr<ImageBuffer> ffmpegDec::copyFrame(AVFrame* frame)
+{
+    ImageDesc desc{};
+    desc.width = static_cast<uint32_t>(frame->width);
+    desc.height = static_cast<uint32_t>(frame->height);
+    desc.widthStride = desc.width;
+    desc.heightStride = desc.height;
+    desc.format = ffmpegCodecHeader::getInstance().pixelFormatToStr(static_cast<enum AVPixelFormat>(frame->format));
+    desc.dataSize = imageDataSize(desc);
+
+    auto buffer = m_frame_pool.acquire(desc);
+    if (buffer == nullptr)
+    {
+        return nullptr;
+    }
+
+    const PixelFormat format = pixelFormatFromString(desc.format);
+    const auto& view = buffer->view;
+    for (uint32_t plane = 0; plane < view.planeCount; ++plane)
+    {
+        const uint32_t rowBytes = planeRowBytes(format, plane, desc.width);
+        const uint32_t rows = planeRows(format, plane, desc.height);
+        for (uint32_t row = 0; row < rows; ++row)
+        {
+            std::memcpy(view.data(plane) + static_cast<size_t>(row) * view.planes[plane].rowStride,
+                        frame->data[plane] + static_cast<ptrdiff_t>(row) * frame->linesize[plane], rowBytes);
+        }
+    }
+    return buffer;
+}
+
+int ffmpegDec::tearDown()
+{
+    if (m_codec_ctx != nullptr)
+    {
+        avcodec_flush_buffers(m_codec_ctx);
+    }
+    m_params.last_frame_time_ms = 0;
+    return 0;
+}
+
+} // namespace bsp_codec
@@ -0,0 +1,83 @@
+#ifndef __FFMPEG_DEC_HPP__
+#define __FFMPEG_DEC_HPP__
+
+#include <bsp_codec/IDecoder.hpp>
+#include <bsp_image/ImageBufferPool.hpp>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include <libavutil/pixdesc.h>
+}
+#include <mutex>
+
+namespace bsp_codec
+{
+
+struct ffmpegDecParams
+{
+    int fps{0};
+    unsigned long last_frame_time_ms{0};
+    enum AVCodecID codec_id{AV_CODEC_ID_NONE};
+    // 0 lets libavcodec pick one thread per core
+    int thread_count{0};
+};
+
+/**
+ * @brief libavcodec software decoder, the CPU reference for the hardware backends.
+ *
+ * Input packets may be split anywhere (Annex B byte stream), a codec parser cuts them into
+ * access units like the MPP split_parse mode. Frame and slice threading are enabled.
+ *
+ * Frames are handed to the callback zero copy: get_buffer2 places every picture in one
+ * pooled AVBuffer with the packed plane layout of bsp_image (row strides and height padded
+ * as the codec requires), the ImageBuffer owns an av_frame_ref of the picture and the block
+ * returns to the pool when the consumer drops it.
+ */
+class ffmpegDec : public IDecoder
+{
+public:
+    static constexpr char LOG_TAG[] {"[ffmpegDec]: "};
+
+    ffmpegDec() = default;
+    ~ffmpegDec();
+
+    int setup(DecodeConfig& cfg) override;
+    void setDecodeReadyCallback(decodeReadyCallback callback, std::any userdata) override
+    {
+        m_callback = callback;
+        m_userdata = userdata;
+    }
+    int decode(DecodePacket& pkt_data) override;
+    int tearDown() override;
+
+private:
+    static int getFrameBuffer(AVCodecContext* ctx, AVFrame* frame, int flags);
+
+    int sendPacket(AVPacket* packet);
+    int receiveFrames();
+    void deliverFrame(AVFrame* frame);
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> wrapFrame(AVFrame* frame);
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> copyFrame(AVFrame* frame);
+    void releaseContext();
+
+private:
+    ffmpegDecParams m_params{};
+    decodeReadyCallback m_callback{nullptr};
+    std::any m_userdata;
+    AVCodecContext* m_codec_ctx{nullptr};
+    AVCodecParserContext* m_parser{nullptr};
+    AVPacket* m_packet{nullptr};
+    AVFrame* m_frame{nullptr};
+
+    // picture pool of get_buffer2, called from the frame threads
+    std::mutex m_pool_mutex;
+    AVBufferPool* m_buffer_pool{nullptr};
+    size_t m_buffer_pool_size{0};
+
+    // frames libavcodec did not allocate through getFrameBuffer (no DR1 support)
+    bsp_perf::bsp_image::ImageBufferPool m_frame_pool{};
+};
+
+} // namespace bsp_codec
+
+#endif // __FFMPEG_DEC_HPP__
@@ -0,0 +1,372 @@
+#include "ffmpegCodecHeader.hpp"
+#include "ffmpegEnc.hpp"
+#include <bsp_image/ImageBuffer.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <typeinfo>
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+namespace bsp_codec
+{
+
+using namespace bsp_perf::bsp_image;
+
+constexpr char ffmpegEnc::LOG_TAG[];
+
+ffmpegEnc::~ffmpegEnc()
+{
+    releaseContext();
+}
+
+void ffmpegEnc::releaseContext()
+{
+    if (m_codec_ctx != nullptr)
+    {
+        avcodec_free_context(&m_codec_ctx);
+    }
+    if (m_packet != nullptr)
+    {
+        av_packet_free(&m_packet);
+    }
+    if (m_frame != nullptr)
+    {
+        av_frame_free(&m_frame);
+    }
+    // input buffers still held by the caller are freed when they are dropped
+    if (m_input_pool != nullptr)
+    {
+        av_buffer_pool_uninit(&m_input_pool);
+    }
+}
+
+int ffmpegEnc::parseConfig(EncodeConfig& cfg)
+{
+    try
+    {
+        m_params.codec_id = ffmpegCodecHeader::getInstance().strToFFmpegCoding(cfg.encodingType);
+        m_params.pix_fmt = ffmpegCodecHeader::getInstance().strToPixelFormat(cfg.frameFormat);
+    }
+    catch (const std::out_of_range& e)
+    {
+        std::cerr << LOG_TAG << "Invalid encoding type " << cfg.encodingType << " or frame format " << cfg.frameFormat << std::endl;
+        return -1;
+    }
+
+    if ((cfg.width == 0) || (cfg.height == 0))
+    {
+        std::cerr << LOG_TAG << "Invalid frame size " << cfg.width << "x" << cfg.height << std::endl;
+        return -1;
+    }
+
+    m_params.frameFormat = cfg.frameFormat;
+    m_params.width = cfg.width;
+    m_params.height = cfg.height;
+    m_params.hor_stride = (cfg.hor_stride > 0) ? cfg.hor_stride : FFALIGN(cfg.width, 16U);
+    m_params.ver_stride = (cfg.ver_stride > 0) ? cfg.ver_stride : FFALIGN(cfg.height, 16U);
+    m_params.fps = (cfg.fps > 0) ? cfg.fps : 30;
+    // same default rate as the rkmpp encoder
+    m_params.bps = static_cast<int64_t>(m_params.width) * m_params.height / 8 * m_params.fps;
+    m_params.gop_len = m_params.fps * 2;
+    m_params.pts = 0;
+
+    m_layout = planeLayout(pixelFormatFromString(m_params.frameFormat), m_params.hor_stride, m_params.ver_stride);
+    m_frame_size = m_layout.totalSize;
+    return 0;
+}
+
+int ffmpegEnc::setup(EncodeConfig& cfg)
+{
+    releaseContext();
+    m_eos = false;
+
+    if (parseConfig(cfg) < 0)
+    {
+        return -1;
+    }
+
+    // prefer the external encoders, they are far faster than the native ones
+    const AVCodec* codec = nullptr;
+    if (m_params.codec_id == AV_CODEC_ID_H264)
+    {
+        codec = avcodec_find_encoder_by_name("libx264");
+    }
+    else if (m_params.codec_id == AV_CODEC_ID_HEVC)
+    {
+        codec = avcodec_find_encoder_by_name("libx265");
+    }
+    if (codec == nullptr)
+    {
+        codec = avcodec_find_encoder(m_params.codec_id);
+    }
+    if (codec == nullptr)
+    {
+        std::cerr << LOG_TAG << "no libavcodec encoder for " << cfg.encodingType << std::endl;
+        return -1;
+    }
+
+    m_codec_ctx = avcodec_alloc_context3(codec);
+    if (m_codec_ctx == nullptr)
+    {
+        std::cerr << LOG_TAG << "avcodec_alloc_context3 failed" << std::endl;
+        return -1;
+    }
+    m_codec_ctx->width = static_cast<int>(m_params.width);
+    m_codec_ctx->height = static_cast<int>(m_params.height);
+    m_codec_ctx->pix_fmt = m_params.pix_fmt;
+    m_codec_ctx->time_base = AVRational{1, m_params.fps};
+    m_codec_ctx->framerate = AVRational{m_params.fps, 1};
+    m_codec_ctx->bit_rate = m_params.bps;
+    m_codec_ctx->gop_size = m_params.gop_len;
+    m_codec_ctx->max_b_frames = 0;
+    m_codec_ctx->thread_count = m_params.thread_count;
+    m_codec_ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    m_codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    AVDictionary* opts = nullptr;
+    if ((std::strcmp(codec->name, "libx264") == 0) || (std::strcmp(codec->name, "libx265") == 0))
+    {
+        // no lookahead / frame threads, one packet out per frame in
+        av_dict_set(&opts, "preset", "veryfast", 0);
+        av_dict_set(&opts, "tune", "zerolatency", 0);
+    }
+    int ret = avcodec_open2(m_codec_ctx, codec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+    {
+        std::cerr << LOG_TAG << "avcodec_open2 " << codec->name << " failed ret: " << ret << std::endl;
+        releaseContext();
+        return -1;
+    }
+
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+    m_input_pool = av_buffer_pool_init(m_frame_size + AV_INPUT_BUFFER_PADDING_SIZE, nullptr);
+    if ((m_packet == nullptr) || (m_frame == nullptr) || (m_input_pool == nullptr))
+    {
+        std::cerr << LOG_TAG << "packet / frame / pool allocation failed" << std::endl;
+        releaseContext();
+        return -1;
+    }
+
+    std::cout << LOG_TAG << "setup " << codec->name << " " << m_params.width << "x" << m_params.height
+              << " stride [" << m_params.hor_stride << ":" << m_params.ver_stride << "] " << m_params.frameFormat
+              << " fps " << m_params.fps << " bps " << m_params.bps << std::endl;
+    return 0;
+}
+
+std::shared_ptr<ImageBuffer> ffmpegEnc::getInputBuffer()
+{
+    if (m_input_pool == nullptr)
+    {
+        std::cerr << LOG_TAG << "getInputBuffer() called before setup()" << std::endl;
+        return nullptr;
+    }
+
+    AVBufferRef* buf = av_buffer_pool_get(m_input_pool);
+    AVFrame* frame = av_frame_alloc();
+    if ((buf == nullptr) || (frame == nullptr))
+    {
+        std::cerr << LOG_TAG << "Failed to get buffer for input frame" << std::endl;
+        av_buffer_unref(&buf);
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    frame->buf[0] = buf;
+    frame->format = m_params.pix_fmt;
+    frame->width = static_cast<int>(m_params.width);
+    frame->height = static_cast<int>(m_params.height);
+    for (uint32_t plane = 0; plane < m_layout.planeCount; ++plane)
+    {
+        frame->data[plane] = buf->data + m_layout.offset[plane];
+        frame->linesize[plane] = static_cast<int>(m_layout.rowStride[plane]);
+    }
+    frame->extended_data = frame->data;
+
+    ImageDesc desc{};
+    desc.width = m_params.width;
+    desc.height = m_params.height;
+    desc.widthStride = m_params.hor_stride;
+    desc.heightStride = m_params.ver_stride;
+    desc.format = m_params.frameFormat;
+    desc.dataSize = m_frame_size;
+
+    // the block goes back to the pool once both the caller and the codec dropped it
+    auto inputBuffer = std::make_shared<ImageBuffer>();
+    inputBuffer->owner = std::shared_ptr<AVFrame>(frame, [](AVFrame* p) { av_frame_free(&p); });
+    inputBuffer->view = makeHostImageView(buf->data, desc, m_layout);
+    inputBuffer->nativeHandle = frame;
+    return inputBuffer;
+}
+
+int ffmpegEnc::setInputFrame(ImageBuffer& input_buf)
+{
+    if (input_buf.nativeHandle.type() == typeid(AVFrame*))
+    {
+        const AVFrame* src = std::any_cast<AVFrame*>(input_buf.nativeHandle);
+        if ((src != nullptr) && (src->buf[0] != nullptr) && (src->format == m_params.pix_fmt) &&
+            (src->width == static_cast<int>(m_params.width)) && (src->height == static_cast<int>(m_params.height)))
+        {
+            return av_frame_ref(m_frame, src);
+        }
+    }
+
+    const auto& view = input_buf.view;
+    if ((view.desc.format != m_params.frameFormat) || (view.desc.width != m_params.width) ||
+        (view.desc.height != m_params.height) || (view.data() == nullptr))
+    {
+        std::cerr << LOG_TAG << "input " << view.desc.format << " " << view.desc.width << "x" << view.desc.height
+                  << " does not match the encoder " << m_params.frameFormat << " " << m_params.width << "x" << m_params.height << std::endl;
+        return -1;
+    }
+
+    // not refcounted, avcodec_send_frame() copies the planes
+    PlaneLayout layout = planeLayout(pixelFormatFromString(view.desc.format),
+                                     view.desc.widthStride > 0 ? view.desc.widthStride : view.desc.width,
+                                     view.desc.heightStride > 0 ? view.desc.heightStride : view.desc.height);
+    const bool viewPlanes = (view.planeCount == layout.planeCount);
+    for (uint32_t plane = 0; plane < layout.planeCount; ++plane)
+    {
+        m_frame->data[plane] = viewPlanes ? view.data(plane) : view.data() + layout.offset[plane];
+        m_frame->linesize[plane] = static_cast<int>(viewPlanes ? view.planes[plane].rowStride : layout.rowStride[plane]);
+    }
+    m_frame->extended_data = m_frame->data;
+    m_frame->format = m_params.pix_fmt;
+    m_frame->width = static_cast<int>(m_params.width);
+    m_frame->height = static_cast<int>(m_params.height);
+    return 0;
+}
+
+int ffmpegEnc::encode(ImageBuffer& input_buf, EncodePacket& out_pkt)
+{
+    out_pkt.pkt_len = 0;
+    if ((m_codec_ctx == nullptr) || m_eos)
+    {
+        std::cerr << LOG_TAG << "encoder not set up or already flushed" << std::endl;
+        return -1;
+    }
+
+    if (out_pkt.pkt_eos)
+    {
+        // EOS only flushes, input_buf is a dummy slot of the caller and is not encoded; the
+        // frames the encoder still holds come out, the context has to be set up again afterwards
+        avcodec_send_frame(m_codec_ctx, nullptr);
+        m_eos = true;
+        return receivePackets(out_pkt);
+    }
+
+    if (setInputFrame(input_buf) < 0)
+    {
+        av_frame_unref(m_frame);
+        return -1;
+    }
+    m_frame->pts = m_params.pts++;
+
+    int ret = avcodec_send_frame(m_codec_ctx, m_frame);
+    av_frame_unref(m_frame);
+    if (ret < 0)
+    {
+        std::cerr << LOG_TAG << "avcodec_send_frame failed ret: " << ret << std::endl;
+        return -1;
+    }
+
+    return receivePackets(out_pkt);
+}
+
+int ffmpegEnc::receivePackets(EncodePacket& out_pkt)
+{
+    size_t out_len = 0;
+    uint8_t* out_ptr = out_pkt.encode_pkt.data();
+    const size_t capacity = std::min(out_pkt.max_size, out_pkt.encode_pkt.size());
+    out_pkt.buffer.reset();
+    out_pkt.key_frame = false;
+
+    while (true)
+    {
+        int ret = avcodec_receive_packet(m_codec_ctx, m_packet);
+        if ((ret == AVERROR(EAGAIN)) || (ret == AVERROR_EOF))
+        {
+            break;
+        }
+        if (ret < 0)
+        {
+            std::cerr << LOG_TAG << "avcodec_receive_packet failed ret: " << ret << std::endl;
+            return -1;
+        }
+
+        if (m_callback != nullptr)
+        {
+            m_callback(m_userdata, reinterpret_cast<const char*>(m_packet->data), m_packet->size);
+        }
+
+        if ((out_ptr != nullptr) && (capacity > 0))
+        {
+            if (out_len + static_cast<size_t>(m_packet->size) <= capacity)
+            {
+                std::memcpy(out_ptr + out_len, m_packet->data, m_packet->size);
+                out_len += m_packet->size;
+            }
+            else
+            {
+                std::cerr << LOG_TAG << "error enc_buf no enough" << std::endl;
+            }
+        }
+        out_pkt.key_frame = out_pkt.key_frame || ((m_packet->flags & AV_PKT_FLAG_KEY) != 0);
+        appendPacket(out_pkt);
+    }
+
+    out_pkt.pkt_len = out_pkt.buffer.size;
+    return static_cast<int>(out_pkt.pkt_len);
+}
+
+void ffmpegEnc::appendPacket(EncodePacket& out_pkt)
+{
+    AVPacket* ref = out_pkt.buffer.empty() ? av_packet_alloc() : nullptr;
+    if (ref != nullptr)
+    {
+        // one packet per frame (no B frames): hand out the packet memory itself
+        av_packet_move_ref(ref, m_packet);
+        std::shared_ptr<void> owner(ref, [](void* p)
+        {
+            AVPacket* pkt = static_cast<AVPacket*>(p);
+            av_packet_free(&pkt);
+        });
+        out_pkt.buffer = bsp_perf::shared::PacketBuffer::wrap(ref->data, ref->size, owner);
+        out_pkt.buffer.padded = true;
+        return;
+    }
+
+    // more packets at the flush, joined into one buffer
+    auto joined = m_packet_pool.acquire(out_pkt.buffer.size + m_packet->size);
+    joined.append(out_pkt.buffer.data, out_pkt.buffer.size);
+    joined.append(m_packet->data, m_packet->size);
+    out_pkt.buffer = joined;
+    av_packet_unref(m_packet);
+}
+
+int ffmpegEnc::getEncoderHeader(std::string& headBuf)
+{
+    if (m_codec_ctx == nullptr)
+    {
+        return -1;
+    }
+
+    headBuf.clear();
+    if ((m_codec_ctx->extradata != nullptr) && (m_codec_ctx->extradata_size > 0))
+    {
+        headBuf.assign(reinterpret_cast<const char*>(m_codec_ctx->extradata), m_codec_ctx->extradata_size);
+    }
+    return 0;
+}
+
+int ffmpegEnc::tearDown()
+{
+    releaseContext();
+    m_eos = false;
+    return 0;
+}
+
+} // namespace bsp_codec
@@ -0,0 +1,98 @@
+#ifndef __FFMPEG_ENC_HPP__
+#define __FFMPEG_ENC_HPP__
+
+#include <bsp_codec/IEncoder.hpp>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+}
+
+namespace bsp_codec
+{
+
+struct ffmpegEncParams
+{
+    enum AVCodecID codec_id{AV_CODEC_ID_H264};
+    enum AVPixelFormat pix_fmt{AV_PIX_FMT_NV12};
+    std::string frameFormat{"YUV420SP"};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t hor_stride{0};
+    uint32_t ver_stride{0};
+    int fps{30};
+    int64_t bps{0};
+    int gop_len{0};
+    // 0 lets libavcodec pick one thread per core
+    int thread_count{0};
+    int64_t pts{0};
+};
+
+/**
+ * @brief libavcodec software encoder (libx264 / libx265 when available, else the native one).
+ *
+ * Tuned for low latency like the hardware backends: no B frames and no lookahead, so every
+ * encode() returns the packet of the frame it was given. SPS / PPS go to the global header
+ * returned by getEncoderHeader().
+ *
+ * getInputBuffer() hands out AVFrames backed by a buffer pool, encode() passes them to the
+ * codec by reference. Buffers carrying an AVFrame in nativeHandle (ffmpegDec output) are
+ * referenced the same way, other host buffers are copied by libavcodec.
+ * EncodePacket::buffer keeps the AVPacket of the frame alive instead of copying it out.
+ */
+class ffmpegEnc : public IEncoder
+{
+public:
+    static constexpr char LOG_TAG[] {"[ffmpegEnc]: "};
+
+    ffmpegEnc() = default;
+
+    ~ffmpegEnc();
+
+    int setup(EncodeConfig& cfg) override;
+
+    void setEncodeReadyCallback(encodeReadyCallback callback, std::any userdata) override
+    {
+        m_callback = callback;
+        m_userdata = userdata;
+    }
+
+    int encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket& out_pkt) override;
+
+    int getEncoderHeader(std::string& headBuf) override;
+
+    int tearDown() override;
+
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> getInputBuffer() override;
+
+    size_t getFrameSize() override
+    {
+        return m_frame_size;
+    }
+
+protected:
+    int parseConfig(EncodeConfig& cfg);
+    int setInputFrame(bsp_perf::bsp_image::ImageBuffer& input_buf);
+    int receivePackets(EncodePacket& out_pkt);
+    void appendPacket(EncodePacket& out_pkt);
+
+private:
+    void releaseContext();
+
+private:
+    encodeReadyCallback m_callback{nullptr};
+    std::any m_userdata{nullptr};
+    ffmpegEncParams m_params{};
+    AVCodecContext* m_codec_ctx{nullptr};
+    AVPacket* m_packet{nullptr};
+    AVFrame* m_frame{nullptr};
+    AVBufferPool* m_input_pool{nullptr};
+    // only used when one frame yields several packets
+    bsp_perf::shared::PacketBufferPool m_packet_pool{};
+    bsp_perf::bsp_image::PlaneLayout m_layout{};
+    size_t m_frame_size{0};
+    bool m_eos{false};
+};
+
+} // namespace bsp_codec
+
+#endif // __FFMPEG_ENC_HPP__
@@ -420,12 +420,12 @@ void nvVideoDec::captureThreadFunc()
             frameDesc.heightStride = m_display_height;
             frameDesc.format = "YUV420SP";
             frameDesc.dataSize = frame_buffer_size;
-            auto frame = bsp_perf::bsp_image::makeHostImageBuffer(frameDesc);
+            auto frame = m_frame_pool.acquire(frameDesc);
 
             // Map the transformed buffer to get virtual address
             NvBufSurface *surf = nullptr;
             ret = NvBufSurfaceFromFd(m_dst_dma_fd, (void**)&surf);
-            if (ret == 0 && surf != nullptr)
+            if (ret == 0 && surf != nullptr && frame != nullptr)
             {
                 // Map Y plane
                 ret = NvBufSurfaceMap(surf, 0, 0, NVBUF_MAP_READ);
@@ -2,6 +2,7 @@
 #define __NVDEC_DEC_HPP__
 
 #include <bsp_codec/IDecoder.hpp>
+#include <bsp_image/ImageBufferPool.hpp>
 #include <NvVideoDecoder.h>
 #include <NvBufSurface.h>
 #include <thread>
@@ -66,6 +67,8 @@ private:
     int m_dmabuf_fds[32]{0};
     int m_num_capture_buffers{0};
     int m_dst_dma_fd{-1};
+    // host copies handed to the callback, recycled once the consumer drops them
+    bsp_perf::bsp_image::ImageBufferPool m_frame_pool{};
 
     // Resolution
     uint32_t m_display_width{0};
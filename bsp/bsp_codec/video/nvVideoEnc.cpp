@@ -269,6 +269,8 @@ int nvVideoEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket
         std::cerr << "Encoder not initialized" << std::endl;
         return -1;
     }
+    out_pkt.buffer.reset();
+    out_pkt.key_frame = false;
 
     // Handle EOS
     if (out_pkt.pkt_eos) {
@@ -406,8 +408,8 @@ int nvVideoEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket
     releaseInputBufferToPool(input_buf.view.data());
 
     // === 同步模式：等待编码完成并返回结果 ===
-    // 如果 out_pkt 有有效的 buffer，等待并填充编码结果
-    if (out_pkt.encode_pkt.size() > 0 && out_pkt.max_size > 0) {
+    // 如果 out_pkt 给出了 max_size，等待并填充编码结果
+    if (out_pkt.max_size > 0) {
         // Initial fill 阶段不等待输出（编码器需要积累几帧才开始输出）
         if (!is_initial_fill || m_output_buffers_queued >= m_encoder->output_plane.getNumBuffers()) {
             struct v4l2_buffer cap_v4l2_buf;
@@ -426,13 +428,17 @@ int nvVideoEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket
                 size_t encoded_size = cap_buffer->planes[0].bytesused;
                 std::cout << "[Encoder Sync] Got encoded frame, size=" << encoded_size << std::endl;
                 
-                // 拷贝编码数据到 out_pkt
+                // 拷贝编码数据到 out_pkt（capture buffer 马上要归还，只拷贝这一次）
                 if (encoded_size <= out_pkt.max_size) {
-                    memcpy(out_pkt.encode_pkt.data(), 
-                           cap_buffer->planes[0].data, 
-                           encoded_size);
+                    out_pkt.buffer = m_packet_pool.copy(cap_buffer->planes[0].data, encoded_size);
+                    if (out_pkt.encode_pkt.size() >= encoded_size) {
+                        memcpy(out_pkt.encode_pkt.data(), 
+                               cap_buffer->planes[0].data, 
+                               encoded_size);
+                    }
                     out_pkt.pkt_len = encoded_size;
                     out_pkt.pkt_eos = (cap_buffer->planes[0].bytesused == 0) ? 1 : 0;
+                    out_pkt.key_frame = (cap_v4l2_buf.flags & V4L2_BUF_FLAG_KEYFRAME) != 0;
                 } else {
                     std::cerr << "[Encoder Sync] ERROR: out_pkt buffer too small (" 
                               << out_pkt.max_size << "), need " << encoded_size << std::endl;
@@ -550,7 +556,7 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> nvVideoEnc::getInputBuffer()
         inputDesc.heightStride = m_params.height;
         inputDesc.format = m_params.frame_format;
         inputDesc.dataSize = m_frame_size;
-        info.input_buf->view = bsp_perf::bsp_image::makeHostImageView(info.buffer.get(), inputDesc, m_params.width);
+        info.input_buf->view = bsp_perf::bsp_image::makeHostImageView(info.buffer.get(), inputDesc);
         info.in_use = true;
 
         m_input_buffer_pool.push_back(info);
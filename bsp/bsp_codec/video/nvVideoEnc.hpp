@@ -58,6 +58,9 @@ private:
     encodeReadyCallback m_callback{nullptr};
     std::any m_userdata;
 
+    // capture buffers are requeued right away, the bitstream is copied out once into these
+    bsp_perf::shared::PacketBufferPool m_packet_pool{};
+
     std::atomic<bool> m_eos_sent{false};
 
     // For managing DMA-BUF file descriptors
@@ -268,11 +268,14 @@ int rkmppDec::decode(DecodePacket& pkt_data)
                         desc.widthStride = static_cast<uint32_t>(hor_stride);
                         desc.heightStride = static_cast<uint32_t>(ver_stride);
                         desc.format = rkmppCodecHeader::getInstance().mppFrameFormatToStr(format);
-                        desc.dataSize = static_cast<size_t>(hor_width) * static_cast<size_t>(ver_height) *
-                            bsp_perf::bsp_image::bytesPerPixel(desc.format);
-                        auto frame = bsp_perf::bsp_image::makeHostImageBuffer(desc);
-                        std::memcpy(frame->view.data(), data_vir, desc.dataSize);
-                        m_callback(m_userdata, frame);
+                        // the MPP buffer keeps the stride padding, copy the full hor_stride x ver_stride layout
+                        desc.dataSize = bsp_perf::bsp_image::imageDataSize(desc);
+                        auto frame = m_frame_pool.acquire(desc);
+                        if (frame != nullptr)
+                        {
+                            std::memcpy(frame->view.data(), data_vir, desc.dataSize);
+                            m_callback(m_userdata, frame);
+                        }
                     }
                     unsigned long cur_time_ms = GetCurrentTimeMS();
                     long time_gap = (1000 / m_params.fps) - (cur_time_ms - m_params.last_frame_time_ms);
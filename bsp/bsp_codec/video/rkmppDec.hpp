@@ -2,6 +2,7 @@
 #define __RKMPP_DEC_HPP__
 
 #include <bsp_codec/IDecoder.hpp>
+#include <bsp_image/ImageBufferPool.hpp>
 #include <rockchip/rk_mpi.h>
 #include <rockchip/mpp_frame.h>
 
@@ -56,6 +57,8 @@ private:
     std::any m_userdata;
     MppPacket m_packet{nullptr};
     MppFrame  m_frame{nullptr};
+    // output frames are fully overwritten by the copy out of the MPP buffer, no zeroing needed
+    bsp_perf::bsp_image::ImageBufferPool m_frame_pool{};
 };
 
 } // namespace bsp_codec
@@ -1,6 +1,7 @@
 #include "rkmppCodecHeader.hpp"
 #include "rkmppEnc.hpp"
 #include <rockchip/rk_venc_rc.h>
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <sys/time.h>
@@ -16,12 +17,6 @@ rkmppEnc::~rkmppEnc()
         m_ctx.mpp_ctx = nullptr;
     }
 
-    if (m_ctx.frm_buf != nullptr)
-    {
-        mpp_buffer_put(m_ctx.frm_buf);
-        m_ctx.frm_buf = nullptr;
-    }
-
     if (m_ctx.pkt_buf)
     {
         mpp_buffer_put(m_ctx.pkt_buf);
@@ -382,14 +377,13 @@ int rkmppEnc::setup(EncodeConfig& cfg)
 
 std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> rkmppEnc::getInputBuffer()
 {
-    if (m_ctx.frm_buf == nullptr)
+    // a fresh buffer per call so several frames can be in flight, put back to the group on release
+    MppBuffer frm_buf{nullptr};
+    int ret = mpp_buffer_get(m_ctx.buf_grp, &frm_buf, m_ctx.frame_size);
+    if (ret != MPP_SUCCESS)
     {
-        int ret = mpp_buffer_get(m_ctx.buf_grp, &m_ctx.frm_buf, m_ctx.frame_size);
-        if (ret != MPP_SUCCESS)
-        {
-            std::cerr << "Failed to get buffer for input frame ret: " << ret << std::endl;
-            return nullptr;
-        }
+        std::cerr << "Failed to get buffer for input frame ret: " << ret << std::endl;
+        return nullptr;
     }
 
     auto inputBuffer = std::make_shared<bsp_perf::bsp_image::ImageBuffer>();
@@ -401,11 +395,12 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> rkmppEnc::getInputBuffer()
     inputBuffer->view.desc.dataSize = m_ctx.frame_size;
     inputBuffer->view.memoryType = bsp_perf::bsp_image::ImageMemoryType::DmaBuf;
     inputBuffer->view.planeCount = 1;
-    inputBuffer->view.planes[0].data = static_cast<uint8_t*>(mpp_buffer_get_ptr(m_ctx.frm_buf));
+    inputBuffer->view.planes[0].data = static_cast<uint8_t*>(mpp_buffer_get_ptr(frm_buf));
     inputBuffer->view.planes[0].size = m_ctx.frame_size;
     inputBuffer->view.planes[0].rowStride = m_params.hor_stride;
-    inputBuffer->view.planes[0].fd = mpp_buffer_get_fd(m_ctx.frm_buf);
-    inputBuffer->nativeHandle = m_ctx.frm_buf;
+    inputBuffer->view.planes[0].fd = mpp_buffer_get_fd(frm_buf);
+    inputBuffer->nativeHandle = frm_buf;
+    inputBuffer->release = [frm_buf]() { mpp_buffer_put(frm_buf); };
     return inputBuffer;
 }
 
@@ -414,6 +409,15 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
     MPP_RET ret;
     RK_U32 frm_eos = 0;
 
+    if (out_pkt.pkt_eos)
+    {
+        // put_frame / get_packet return every packet with its frame, nothing is held back
+        out_pkt.pkt_len = 0;
+        out_pkt.buffer.reset();
+        out_pkt.key_frame = false;
+        return 0;
+    }
+
     MppFrame frame{nullptr};
     ret = mpp_frame_init(&frame);
     if (ret != MPP_OK)
@@ -431,8 +435,22 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
     MppBuffer mpp_buf = std::any_cast<MppBuffer>(input_buf.nativeHandle);
     mpp_frame_set_buffer(frame, mpp_buf);
     MppMeta meta = mpp_frame_get_meta(frame);
+
+    // a fresh output buffer per frame, handed out as out_pkt.buffer and put back once dropped
+    MppBuffer out_buf{nullptr};
+    ret = mpp_buffer_get(m_ctx.buf_grp, &out_buf, m_ctx.frame_size);
+    if (ret != MPP_OK)
+    {
+        std::cerr << "Failed to get buffer for output packet ret: " << ret << std::endl;
+        mpp_frame_deinit(&frame);
+        return -1;
+    }
+    std::shared_ptr<void> out_owner(mpp_buffer_get_ptr(out_buf), [out_buf](void*) { mpp_buffer_put(out_buf); });
+    out_pkt.buffer.reset();
+    out_pkt.key_frame = false;
+
     MppPacket packet{nullptr};
-    mpp_packet_init_with_buffer(&packet, m_ctx.pkt_buf);
+    mpp_packet_init_with_buffer(&packet, out_buf);
     /* NOTE: It is important to clear output packet length!! */
     mpp_packet_set_length(packet, 0);
     mpp_meta_set_packet(meta, KEY_OUTPUT_PACKET, packet);
@@ -488,7 +506,7 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
 
             if (out_ptr != nullptr && out_pkt.max_size > 0)
             {
-                if (out_len + log_len < out_pkt.max_size)
+                if (out_len + len <= std::min(out_pkt.max_size, out_pkt.encode_pkt.size()))
                 {
                     std::memcpy(out_ptr, ptr, len);
                     out_len += len;
@@ -500,6 +518,20 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
                 }
             }
 
+            if (out_pkt.buffer.empty())
+            {
+                // the whole frame in one packet: reference it inside out_buf
+                out_pkt.buffer = bsp_perf::shared::PacketBuffer::wrap(static_cast<uint8_t*>(ptr), len, out_owner);
+            }
+            else
+            {
+                // low delay partitions are joined into one buffer
+                auto joined = m_packet_pool.acquire(out_pkt.buffer.size + len);
+                joined.append(out_pkt.buffer.data, out_pkt.buffer.size);
+                joined.append(static_cast<const uint8_t*>(ptr), len);
+                out_pkt.buffer = joined;
+            }
+
 
             /* for low delay partition encoding */
             if (mpp_packet_is_partition(packet))
@@ -517,6 +549,12 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
                 RK_S32 temporal_id = 0;
                 RK_S32 lt_idx = -1;
                 RK_S32 avg_qp = -1;
+                RK_S32 intra = 0;
+
+                if (MPP_OK == mpp_meta_get_s32(meta, KEY_OUTPUT_INTRA, &intra))
+                {
+                    out_pkt.key_frame = out_pkt.key_frame || (intra != 0);
+                }
 
                 if (MPP_OK == mpp_meta_get_s32(meta, KEY_TEMPORAL_ID, &temporal_id))
                 {
@@ -537,8 +575,8 @@ int rkmppEnc::encode(bsp_perf::bsp_image::ImageBuffer& input_buf, EncodePacket&
         }
     }
     while (!eoi);
-    out_pkt.pkt_len = out_len;
-    return out_len;
+    out_pkt.pkt_len = out_pkt.buffer.size;
+    return out_pkt.pkt_len;
 }
 
 int rkmppEnc::getEncoderHeader(std::string& headBuf)
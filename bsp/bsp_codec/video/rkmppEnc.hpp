@@ -84,8 +84,7 @@ public:
         RK_U32          eos{0};
         MppBufferGroup  frm_grp{nullptr};
         MppBufferGroup  buf_grp{nullptr};
-        MppBuffer       pkt_buf{nullptr};
-        MppBuffer       frm_buf {nullptr};
+        MppBuffer       pkt_buf{nullptr};   // encoder header only, frames get their own buffer
         MppBuffer       md_info{nullptr};
         size_t          mdinfo_size{0};
         size_t          frame_size{0};
@@ -101,6 +100,7 @@ private:
     std::any m_userdata{nullptr};
     mpiContext m_ctx{};
     rkmppEncParams m_params{};
+    bsp_perf::shared::PacketBufferPool m_packet_pool{};
 };
 
 } // namespace bsp_codec
@@ -1,6 +1,7 @@
 #ifndef __CONTAINER_HEADER_HPP__
 #define __CONTAINER_HEADER_HPP__
 
+#include <shared/BspPacketBuffer.hpp>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -81,6 +82,20 @@ struct StreamPacket
     std::vector<uint8_t> pkt_data{};
     size_t useful_pkt_size{0};
     int64_t pos;
+    bool key_frame{false};
+    // decode it but do not show the frame: it precedes the target of an accurate seek
+    bool discard{false};
+
+    /**
+     * @brief Refcounted payload, e.g. the EncodePacket::buffer of an encoder or the demuxer's own
+     * packet in zero copy mode. When set it is muxed by reference and pkt_data / useful_pkt_size
+     * are ignored; it stays valid until the last copy is reset, across later reads.
+     */
+    bsp_perf::shared::PacketBuffer buffer{};
+
+    const uint8_t* payload() const { return buffer.empty() ? pkt_data.data() : buffer.data; }
+
+    size_t payloadSize() const { return buffer.empty() ? useful_pkt_size : buffer.size; }
 };
 
 } // namespace bsp_container
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include "ContainerHeader.hpp"
+#include "KeyframeIndex.hpp"
 #include "StreamWriter.hpp"
 
 namespace bsp_container
@@ -14,15 +15,61 @@ class IDemuxer
 public:
     static std::unique_ptr<IDemuxer> create(const std::string& containerPlatform);
 
+    enum class SeekMode
+    {
+        Keyframe,   // reading resumes at the last keyframe at or before the timestamp
+        Accurate    // same, the packets before the timestamp come marked StreamPacket::discard
+    };
+
     virtual int openContainerDemux(const std::string& path) = 0;
 
     virtual void closeContainerDemux() = 0;
 
     virtual int getContainerInfo(ContainerInfo& containerInfo) = 0;
 
+    /**
+     * @brief Read the next packet of any stream.
+     * @return 0 success, -1 on error or end of file
+     */
     virtual int readStreamPacket(StreamPacket& streamPacket) = 0;
 
-    virtual int seekStreamFrame(int stream_index, int64_t timestamp) = 0;
+    /**
+     * @brief Read up to max_packets packets into packets[0, n), the vector is grown if needed and
+     * never shrunk so the pkt_data storage of a reused vector is kept.
+     * @return n, 0 at the end of the file, -1 on error
+     */
+    virtual int readStreamPackets(std::vector<StreamPacket>& packets, size_t max_packets) = 0;
+
+    /**
+     * @brief Zero copy mode: packets are handed out in StreamPacket::buffer, a reference to the
+     * demuxer's own packet buffer, and pkt_data is not touched. Off by default.
+     * Feed buffer.data / buffer.size to the decoder or pass the packet on to a muxer as is.
+     */
+    virtual void setZeroCopy(bool enable) = 0;
+
+    /**
+     * @brief Seek so the next read returns the last keyframe of the stream at or before timestamp.
+     *
+     * Accurate mode is the seek-then-decode-forward pattern: keep decoding from the keyframe and
+     * drop the frames of packets marked discard, the first frame shown is the one at timestamp.
+     * With a keyframe index set the keyframe comes from the index (byte seek where the format
+     * allows it), otherwise from the container's own seeking.
+     *
+     * @param timestamp pts in the stream time base
+     * @return 0 success, -1 on error
+     */
+    virtual int seekStreamFrame(int stream_index, int64_t timestamp, SeekMode mode = SeekMode::Keyframe) = 0;
+
+    /**
+     * @brief Fill index with the keyframes of every stream, the read position goes back to the start.
+     * @return 0 success, -1 on error
+     */
+    virtual int buildKeyframeIndex(KeyframeIndex& index) = 0;
+
+    /**
+     * @brief Index used by seekStreamFrame(), nullptr drops it.
+     */
+    virtual void setKeyframeIndex(std::shared_ptr<const KeyframeIndex> index) = 0;
 
     virtual std::shared_ptr<StreamWriter> getStreamWriter(int stream_index, const std::string& filename) = 0;
 
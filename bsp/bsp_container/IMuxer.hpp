@@ -21,6 +21,37 @@ public:
     {
         bool ts_recreate{true};
         float video_fps{29.97};
+
+        /**
+         * @brief Fragmented MP4 (moof + mdat every fragment_ms, CMAF style) instead of one moov
+         * written at the end: a crash or power loss only loses the open fragment.
+         */
+        bool fragmented{false};
+        int fragment_ms{1000};
+
+        /**
+         * @brief Start a new segment file on the first keyframe once segment_ms of stream time or
+         * segment_bytes are written, 0 disables the limit. Segments are named
+         * <stem>_000<ext>, <stem>_001<ext>, ... after the path given to openContainerMux().
+         * Packets need StreamPacket::key_frame for the cut.
+         */
+        int segment_ms{0};
+        size_t segment_bytes{0};
+
+        /**
+         * @brief Write the file on a background thread instead of the caller of
+         * writeStreamPacket(), in io_chunk_bytes blocks aligned in the file, each file
+         * preallocated to preallocate_bytes (0 off).
+         */
+        bool async_io{false};
+        size_t preallocate_bytes{0};
+        size_t io_chunk_bytes{256 * 1024};
+
+        /**
+         * @brief Called with the path of every finished segment / file once it is closed, with
+         * async_io on the I/O thread after the data is synced to disk.
+         */
+        std::function<void(const std::string& path)> segment_closed{};
     };
 
     virtual int openContainerMux(const std::string& path, MuxConfig& config) = 0;
@@ -0,0 +1,167 @@
+#ifndef __INTERLEAVED_MUXER_HPP__
+#define __INTERLEAVED_MUXER_HPP__
+
+#include "IMuxer.hpp"
+#include <bsp_pipeline/BoundedQueue.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace bsp_container
+{
+
+/**
+ * @brief IMuxer front-end for many producer threads, e.g. one encoder per camera recording into
+ * one container.
+ *
+ * writeStreamPacket() only puts the packet on the lock-free queue of its stream and returns, a
+ * writer thread feeds the wrapped muxer in DTS order across the streams. The writer holds one
+ * packet per stream and writes the smallest DTS once every stream has one, but a packet waits at
+ * most max_delay_ms for the others, and a stream silent for max_delay_ms is not waited for any
+ * more: a stalled camera delays the rest once by a bounded amount and never blocks them. A
+ * producer only waits while the queue of its own stream is full.
+ *
+ * Streams are added before the first packet. PacketBuffer payloads are queued by reference,
+ * pkt_data is copied. With MuxConfig::async_io the writer thread does not wait on the disk either.
+ *
+ *     InterleavedMuxer muxer(IMuxer::create("FFmpegMuxer"));
+ *     muxer.openContainerMux("cameras.mp4", muxConfig);
+ *     int front = muxer.addStream(frontInfo);
+ *     int rear = muxer.addStream(rearInfo);
+ *     // on every encoder thread
+ *     muxer.writeStreamPacket(packet);
+ *     // producers stopped
+ *     muxer.endStreamMux();
+ *     muxer.closeContainerMux();
+ */
+class InterleavedMuxer : public IMuxer
+{
+public:
+    static constexpr char LOG_TAG[] {"[InterleavedMuxer]: "};
+    static constexpr char THREAD_ROLE[] {"muxer_writer"};
+    static constexpr size_t MAX_STREAMS{16};
+
+    struct Config
+    {
+        size_t queue_capacity{64};      // packets per stream
+        int max_delay_ms{500};          // longest a packet waits for the other streams
+        bool drop_when_full{false};     // drop instead of waiting on a full stream queue
+    };
+
+    struct StreamStats
+    {
+        uint64_t packets{0};            // accepted by writeStreamPacket()
+        uint64_t written{0};
+        uint64_t drops{0};
+        uint64_t late{0};               // written after max_delay_ms without the other streams
+        uint64_t producer_wait_us{0};   // producers waiting on the full queue
+        size_t queue_depth{0};
+    };
+
+    explicit InterleavedMuxer(std::unique_ptr<IMuxer> muxer);
+    InterleavedMuxer(std::unique_ptr<IMuxer> muxer, const Config& config);
+    ~InterleavedMuxer() override;
+
+    int openContainerMux(const std::string& path, MuxConfig& config) override;
+
+    void closeContainerMux() override;
+
+    int addStream(StreamInfo& streamInfo) override;
+
+    /**
+     * @brief The time base of such a stream is unknown, unless MuxConfig::ts_recreate its packets
+     * are written as they come.
+     */
+    int addStream(std::shared_ptr<StreamReader> strReader) override;
+
+    /**
+     * @brief Queue the packet, safe from any thread.
+     * @return 0 queued, 1 dropped on a full queue (drop_when_full), -1 unknown stream, muxer not
+     * open or a write failed
+     */
+    int writeStreamPacket(StreamPacket& streamPacket) override;
+
+    std::shared_ptr<StreamReader> getStreamReader(const std::string& filename) override;
+
+    /**
+     * @brief Write what is queued, then the trailer. Producers must have stopped.
+     */
+    int endStreamMux() override;
+
+    /**
+     * @return stats of the stream, all 0 for an unknown stream
+     */
+    StreamStats stats(int stream_index) const;
+
+private:
+    struct QueuedPacket
+    {
+        StreamPacket packet{};
+        uint64_t enqueue_ns{0};
+    };
+
+    struct Stream
+    {
+        explicit Stream(size_t capacity): queue(capacity) {}
+
+        bsp_pipeline::BoundedQueue<QueuedPacket> queue;
+        double time_base{0.0};          // seconds per DTS tick, 0 unknown
+
+        // writer thread
+        QueuedPacket head{};
+        bool has_head{false};
+        int64_t head_key_us{0};
+        int64_t last_key_us{0};
+        uint64_t popped{0};
+        uint64_t last_pop_ns{0};
+
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> drops{0};
+        std::atomic<uint64_t> late{0};
+        std::atomic<uint64_t> wait_ns{0};
+    };
+
+    int registerStream(int stream_index, double time_base);
+
+    void startWriter();
+
+    void stopWriter();
+
+    void writerLoop();
+
+    /**
+     * @brief Position of the packet in the output in microseconds, the same DTS the wrapped muxer
+     * writes.
+     */
+    int64_t orderKey(Stream& stream, const StreamPacket& packet);
+
+    bool ordered(const Stream& stream) const;
+
+    void wakeWriter();
+
+    static uint64_t nowNs();
+
+private:
+    std::unique_ptr<IMuxer> m_muxer;
+    Config m_config;
+    MuxConfig m_mux_cfg{};
+
+    std::array<std::unique_ptr<Stream>, MAX_STREAMS> m_streams{};
+    std::atomic<int> m_stream_count{0};     // published after m_streams, read by the writer
+    std::atomic<bool> m_started{false};     // a packet is queued, the stream set is fixed
+    std::atomic<bool> m_open{false};
+    std::atomic<bool> m_failed{false};
+
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_cv;
+    std::atomic<bool> m_writer_sleeping{false};
+    std::atomic<bool> m_stopping{false};
+    std::thread m_writer{};
+};
+
+} // namespace bsp_container
+
+#endif // __INTERLEAVED_MUXER_HPP__
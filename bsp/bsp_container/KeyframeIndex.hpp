@@ -0,0 +1,86 @@
+#ifndef __KEYFRAME_INDEX_HPP__
+#define __KEYFRAME_INDEX_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bsp_container
+{
+class IDemuxer;
+
+/**
+ * @brief Keyframe positions of a recording, per stream, for random access without scanning.
+ *
+ * Built once by IDemuxer::buildKeyframeIndex() (from the container's own index when it has a
+ * complete one, otherwise by one pass over the packets without decoding) and persisted next to
+ * the recording as "<recording>.kfidx". The sidecar is stamped with the size and mtime of the
+ * recording and ignored once they no longer match.
+ *
+ *     auto index = KeyframeIndex::loadOrBuild(*demuxer, path);
+ *     demuxer->setKeyframeIndex(index);
+ *     demuxer->seekStreamFrame(stream, pts);      // lands on index->find(stream, pts)
+ */
+class KeyframeIndex
+{
+public:
+    struct Entry
+    {
+        int64_t pts{0};     // stream time base
+        int64_t dts{0};
+        int64_t pos{-1};    // byte offset of the packet, -1 unknown
+    };
+
+    struct StreamIndex
+    {
+        int time_base_num{1};
+        int time_base_den{1};
+        std::vector<Entry> entries{};   // sorted by pts
+    };
+
+    static std::string sidecarPath(const std::string& mediaPath) { return mediaPath + ".kfidx"; }
+
+    /**
+     * @brief Load the sidecar of mediaPath, or build the index with the demuxer (which must
+     * have mediaPath open) and save the sidecar when save is set.
+     * @return nullptr when the index could not be built
+     */
+    static std::shared_ptr<KeyframeIndex> loadOrBuild(IDemuxer& demuxer, const std::string& mediaPath, bool save = true);
+
+    void setTimeBase(int stream_index, int num, int den);
+
+    void addKeyframe(int stream_index, const Entry& entry);
+
+    /**
+     * @brief Last keyframe of the stream with pts <= the given one, binary search.
+     * @return nullptr when the stream has no keyframe at or before pts
+     */
+    const Entry* find(int stream_index, int64_t pts) const;
+
+    const StreamIndex* stream(int stream_index) const;
+
+    size_t size(int stream_index) const;
+
+    bool empty() const { return m_streams.empty(); }
+
+    void clear() { m_streams.clear(); }
+
+    /**
+     * @return 0 success, -1 on I/O error
+     */
+    int save(const std::string& path, const std::string& mediaPath) const;
+
+    /**
+     * @return 0 success, -1 when missing, corrupt or stale for mediaPath
+     */
+    int load(const std::string& path, const std::string& mediaPath);
+
+private:
+    std::unordered_map<int, StreamIndex> m_streams{};
+};
+
+} // namespace bsp_container
+
+#endif // __KEYFRAME_INDEX_HPP__
@@ -3,6 +3,7 @@
 
 #include "ContainerHeader.hpp"
 #include <any>
+#include <vector>
 
 namespace bsp_container
 {
@@ -19,6 +20,16 @@ public:
     virtual std::any getStreamParams() = 0;
     virtual int readPacket(StreamPacket& packet) = 0;
 
+    /**
+     * @brief Batch read, same contract as IDemuxer::readStreamPackets().
+     */
+    virtual int readPackets(std::vector<StreamPacket>& packets, size_t max_packets) = 0;
+
+    /**
+     * @brief Hand packets out by reference in StreamPacket::buffer, see IDemuxer::setZeroCopy().
+     */
+    virtual void setZeroCopy(bool enable) = 0;
+
 };
 } // namespace bsp_container
 
@@ -0,0 +1,347 @@
+#include "AsyncFileWriter.hpp"
+#include <shared/BspThreadConfig.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace bsp_container
+{
+
+constexpr char AsyncFileWriter::LOG_TAG[];
+constexpr char AsyncFileWriter::THREAD_ROLE[];
+
+AsyncFileWriter::AsyncFileWriter(const Options& options):
+    m_options(options)
+{
+    if (m_options.chunk_bytes == 0)
+    {
+        m_options.chunk_bytes = 4096;
+    }
+    // room for a partly filled block while the next one is queued
+    m_options.max_pending_bytes = std::max(m_options.max_pending_bytes, 2 * m_options.chunk_bytes);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    if (m_thread.joinable())
+    {
+        if (!m_closing)
+        {
+            closeAsync();
+        }
+        m_thread.join();
+    }
+}
+
+int AsyncFileWriter::open(const std::string& path)
+{
+    if (m_fd >= 0)
+    {
+        std::cerr << LOG_TAG << "open() called twice: " << path << std::endl;
+        return -1;
+    }
+
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        std::cerr << LOG_TAG << "open " << path << " failed: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    m_path = path;
+
+    if (m_options.preallocate_bytes > 0)
+    {
+        // the blocks are reserved but the file size stays, close() gives back what is unused
+        if (fallocate(m_fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(m_options.preallocate_bytes)) != 0)
+        {
+            std::cerr << LOG_TAG << "fallocate " << path << " failed: " << std::strerror(errno)
+                      << ", writing without preallocation" << std::endl;
+        }
+    }
+
+    m_thread = std::thread([this]()
+    {
+        bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread(THREAD_ROLE);
+        ioLoop();
+    });
+    return 0;
+}
+
+int AsyncFileWriter::write(const uint8_t* data, size_t size)
+{
+    if ((m_fd < 0) || m_closing || m_error.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_space_cv.wait(lock, [this, size]()
+    {
+        return (m_pending_bytes == 0) || (m_pending_bytes + size <= m_options.max_pending_bytes) ||
+               m_error.load(std::memory_order_relaxed);
+    });
+    if (m_error.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+
+    // the muxer writes in small pieces, they are gathered into whole aligned blocks
+    const int64_t chunkBytes = static_cast<int64_t>(m_options.chunk_bytes);
+    const size_t total = size;
+    while (size > 0)
+    {
+        bool append = !m_pending.empty() && ((m_pos % chunkBytes) != 0) &&
+                      (m_pending.back().offset + static_cast<int64_t>(m_pending.back().data.size()) == m_pos);
+        if (!append)
+        {
+            Chunk chunk;
+            chunk.offset = m_pos;
+            if (!m_free.empty())
+            {
+                chunk.data = std::move(m_free.back());
+                m_free.pop_back();
+                chunk.data.clear();
+            }
+            chunk.data.reserve(m_options.chunk_bytes);
+            m_pending.push_back(std::move(chunk));
+        }
+        size_t room = static_cast<size_t>(chunkBytes - (m_pos % chunkBytes));
+        size_t part = std::min(size, room);
+        auto& buffer = m_pending.back().data;
+        buffer.insert(buffer.end(), data, data + part);
+        data += part;
+        size -= part;
+        m_pos += static_cast<int64_t>(part);
+    }
+    m_pending_bytes += total;
+    bool wake = frontComplete();
+    lock.unlock();
+    if (wake)
+    {
+        m_work_cv.notify_one();
+    }
+
+    m_size = std::max(m_size, m_pos);
+    return 0;
+}
+
+bool AsyncFileWriter::frontComplete() const
+{
+    if (m_pending.empty())
+    {
+        return false;
+    }
+    const Chunk& front = m_pending.front();
+    int64_t end = front.offset + static_cast<int64_t>(front.data.size());
+    return (m_pending.size() > 1) || ((end % static_cast<int64_t>(m_options.chunk_bytes)) == 0);
+}
+
+int64_t AsyncFileWriter::seek(int64_t offset, int whence)
+{
+    int64_t pos = -1;
+    switch (whence)
+    {
+        case SEEK_SET:
+            pos = offset;
+            break;
+        case SEEK_CUR:
+            pos = m_pos + offset;
+            break;
+        case SEEK_END:
+            pos = m_size + offset;
+            break;
+        default:
+            break;
+    }
+    if (pos < 0)
+    {
+        return -1;
+    }
+    m_pos = pos;
+    return m_pos;
+}
+
+void AsyncFileWriter::closeAsync(closedCallback done)
+{
+    if (m_fd < 0)
+    {
+        if (done)
+        {
+            done(m_path, -1);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closing)
+        {
+            return;
+        }
+        m_closing = true;
+        m_final_size = m_size;
+        m_done = std::move(done);
+    }
+    m_work_cv.notify_one();
+}
+
+int AsyncFileWriter::close()
+{
+    closeAsync();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    return (m_fd < 0) ? -1 : m_result;
+}
+
+int AsyncFileWriter::writeChunk(const Chunk& chunk)
+{
+    const uint8_t* data = chunk.data.data();
+    size_t left = chunk.data.size();
+    off_t offset = static_cast<off_t>(chunk.offset);
+    while (left > 0)
+    {
+        ssize_t ret = ::pwrite(m_fd, data, left, offset);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << LOG_TAG << "write " << m_path << " failed: " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        data += ret;
+        left -= static_cast<size_t>(ret);
+        offset += ret;
+    }
+    return 0;
+}
+
+void AsyncFileWriter::ioLoop()
+{
+    using clock = std::chrono::steady_clock;
+    const auto syncInterval = std::chrono::milliseconds(m_options.sync_interval_ms);
+    auto lastSync = clock::now();
+    bool unsynced = false;
+    std::deque<Chunk> batch;
+
+    while (true)
+    {
+        bool closing = false;
+        bool syncDue = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto ready = [this]() { return frontComplete() || m_closing; };
+            if ((m_options.sync_interval_ms > 0) && (unsynced || !m_pending.empty()))
+            {
+                m_work_cv.wait_until(lock, lastSync + syncInterval, ready);
+                syncDue = (clock::now() - lastSync >= syncInterval);
+            }
+            else
+            {
+                m_work_cv.wait(lock, ready);
+            }
+            closing = m_closing;
+
+            // whole blocks, the open one only when it has to reach the disk now
+            while (frontComplete())
+            {
+                batch.push_back(std::move(m_pending.front()));
+                m_pending.pop_front();
+            }
+            if ((closing || syncDue) && !m_pending.empty())
+            {
+                batch.push_back(std::move(m_pending.front()));
+                m_pending.pop_front();
+            }
+        }
+
+        size_t written = 0;
+        for (auto& chunk : batch)
+        {
+            if (!m_error.load(std::memory_order_relaxed) && (writeChunk(chunk) < 0))
+            {
+                m_error.store(true, std::memory_order_relaxed);
+            }
+            written += chunk.data.size();
+        }
+        if (written > 0)
+        {
+            unsynced = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& chunk : batch)
+            {
+                if (m_free.size() < FREE_CHUNKS)
+                {
+                    m_free.push_back(std::move(chunk.data));
+                }
+            }
+            m_pending_bytes -= written;
+        }
+        batch.clear();
+        m_space_cv.notify_all();
+
+        if (syncDue)
+        {
+            if (unsynced)
+            {
+                // bounds what a power loss takes to the last interval
+                ::fdatasync(m_fd);
+                unsynced = false;
+            }
+            lastSync = clock::now();
+        }
+
+        if (closing)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty())
+            {
+                break;
+            }
+        }
+    }
+
+    int result = m_error.load(std::memory_order_relaxed) ? -1 : 0;
+    if ((m_options.preallocate_bytes > 0) && (::ftruncate(m_fd, static_cast<off_t>(m_final_size)) != 0))
+    {
+        std::cerr << LOG_TAG << "trim " << m_path << " failed: " << std::strerror(errno) << std::endl;
+        result = -1;
+    }
+    if (::fdatasync(m_fd) != 0)
+    {
+        std::cerr << LOG_TAG << "sync " << m_path << " failed: " << std::strerror(errno) << std::endl;
+        result = -1;
+    }
+    if (::close(m_fd) != 0)
+    {
+        result = -1;
+    }
+    m_result = result;
+
+    closedCallback done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done = std::move(m_done);
+    }
+    if (done)
+    {
+        done(m_path, result);
+    }
+    m_closed.store(true, std::memory_order_release);
+}
+
+} // namespace bsp_container
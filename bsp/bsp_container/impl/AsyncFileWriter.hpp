@@ -0,0 +1,141 @@
+#ifndef __ASYNC_FILE_WRITER_HPP__
+#define __ASYNC_FILE_WRITER_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bsp_container
+{
+
+/**
+ * @brief Writes one file on a background thread.
+ *
+ * write() copies the data into a queue and returns, the I/O thread pwrite()s every chunk at the
+ * offset it was written at, so a seek() back to patch a header keeps its order with the data
+ * around it. Sequential data goes out in chunk_bytes blocks aligned to chunk_bytes in the file,
+ * a partly filled block only when it is due for a sync or on close. The file is preallocated
+ * with fallocate() (size unchanged, so a crash never leaves zeros behind the last written byte)
+ * and trimmed to the written size on close. write() only blocks while max_pending_bytes are
+ * queued.
+ *
+ * write() / seek() / size() / closeAsync() belong to one producer thread.
+ */
+class AsyncFileWriter
+{
+public:
+    static constexpr char LOG_TAG[] {"[AsyncFileWriter]: "};
+    static constexpr char THREAD_ROLE[] {"container_io"};
+
+    struct Options
+    {
+        size_t preallocate_bytes{0};
+        size_t max_pending_bytes{16 * 1024 * 1024};
+        int sync_interval_ms{0};        // fdatasync() period while writing, 0 syncs on close only
+        size_t chunk_bytes{256 * 1024}; // write size and alignment
+    };
+
+    /**
+     * @brief Called on the I/O thread once the file is synced and closed, result 0 or -1.
+     */
+    using closedCallback = std::function<void(const std::string& path, int result)>;
+
+    explicit AsyncFileWriter(const Options& options);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief Create / truncate path and start the I/O thread.
+     * @return 0 success, -1 error
+     */
+    int open(const std::string& path);
+
+    /**
+     * @brief Queue size bytes at the current position.
+     * @return 0 success, -1 when an earlier write failed
+     */
+    int write(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Move the write position, whence is SEEK_SET / SEEK_CUR / SEEK_END.
+     * @return new position, -1 on an invalid position
+     */
+    int64_t seek(int64_t offset, int whence);
+
+    /**
+     * @brief Bytes written so far, including the queued ones.
+     */
+    int64_t size() const { return m_size; }
+
+    /**
+     * @brief Write what is queued, trim, sync and close the file on the I/O thread. Returns at
+     * once, done runs afterwards, the destructor waits for it.
+     */
+    void closeAsync(closedCallback done = nullptr);
+
+    /**
+     * @brief closeAsync() and wait.
+     * @return 0 success, -1 when a write, the sync or the close failed
+     */
+    int close();
+
+    /**
+     * @brief Whether the file is closed and the I/O thread has ended.
+     */
+    bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+private:
+    struct Chunk
+    {
+        int64_t offset{0};
+        std::vector<uint8_t> data{};
+    };
+
+    void ioLoop();
+
+    int writeChunk(const Chunk& chunk);
+
+    /**
+     * @brief Whether the I/O thread may take the front chunk: it reaches the end of its block or
+     * later data follows it. m_mutex held.
+     */
+    bool frontComplete() const;
+
+    static constexpr size_t FREE_CHUNKS{8};
+
+private:
+    Options m_options;
+    std::string m_path{};
+    int m_fd{-1};
+
+    // producer side
+    int64_t m_pos{0};
+    int64_t m_size{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_space_cv;
+    std::deque<Chunk> m_pending{};
+    std::vector<std::vector<uint8_t>> m_free{};
+    size_t m_pending_bytes{0};          // queued or being written
+    bool m_closing{false};
+    int64_t m_final_size{0};
+    closedCallback m_done{};
+
+    std::atomic<bool> m_error{false};
+    std::atomic<bool> m_closed{false};
+    int m_result{0};
+    std::thread m_thread{};
+};
+
+} // namespace bsp_container
+
+#endif // __ASYNC_FILE_WRITER_HPP__
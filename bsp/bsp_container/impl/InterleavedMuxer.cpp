@@ -0,0 +1,377 @@
+#include <bsp_container/InterleavedMuxer.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace bsp_container
+{
+
+constexpr char InterleavedMuxer::LOG_TAG[];
+constexpr char InterleavedMuxer::THREAD_ROLE[];
+
+namespace
+{
+// AV_NOPTS_VALUE, a packet without timestamp
+constexpr int64_t NO_TIMESTAMP{std::numeric_limits<int64_t>::min()};
+} // namespace
+
+InterleavedMuxer::InterleavedMuxer(std::unique_ptr<IMuxer> muxer):
+    InterleavedMuxer(std::move(muxer), Config{})
+{
+}
+
+InterleavedMuxer::InterleavedMuxer(std::unique_ptr<IMuxer> muxer, const Config& config):
+    m_muxer(std::move(muxer)),
+    m_config(config)
+{
+    if (m_config.queue_capacity < 2)
+    {
+        m_config.queue_capacity = 2;
+    }
+    if (m_config.max_delay_ms < 0)
+    {
+        m_config.max_delay_ms = 0;
+    }
+}
+
+InterleavedMuxer::~InterleavedMuxer()
+{
+    stopWriter();
+}
+
+int InterleavedMuxer::openContainerMux(const std::string& path, MuxConfig& config)
+{
+    stopWriter();
+    for (auto& stream : m_streams)
+    {
+        stream.reset();
+    }
+    m_stream_count.store(0, std::memory_order_relaxed);
+    m_started.store(false, std::memory_order_relaxed);
+    m_failed.store(false, std::memory_order_relaxed);
+
+    m_mux_cfg = config;
+    if (m_muxer->openContainerMux(path, config) < 0)
+    {
+        return -1;
+    }
+    startWriter();
+    m_open.store(true, std::memory_order_release);
+    return 0;
+}
+
+void InterleavedMuxer::closeContainerMux()
+{
+    m_open.store(false, std::memory_order_release);
+    stopWriter();
+    m_muxer->closeContainerMux();
+}
+
+int InterleavedMuxer::registerStream(int stream_index, double time_base)
+{
+    if (stream_index < 0)
+    {
+        return -1;
+    }
+    if (static_cast<size_t>(stream_index) >= MAX_STREAMS)
+    {
+        std::cerr << LOG_TAG << "stream " << stream_index << " exceeds " << MAX_STREAMS << " streams" << std::endl;
+        return -1;
+    }
+
+    auto stream = std::make_unique<Stream>(m_config.queue_capacity);
+    stream->time_base = time_base;
+    // waited for from the start, like a stream that has just delivered
+    stream->last_pop_ns = nowNs();
+    m_streams[stream_index] = std::move(stream);
+    if (stream_index >= m_stream_count.load(std::memory_order_relaxed))
+    {
+        m_stream_count.store(stream_index + 1, std::memory_order_release);
+    }
+    return stream_index;
+}
+
+int InterleavedMuxer::addStream(StreamInfo& streamInfo)
+{
+    if (m_started.load(std::memory_order_acquire))
+    {
+        std::cerr << LOG_TAG << "addStream() after the first packet" << std::endl;
+        return -1;
+    }
+
+    // the time base the wrapped muxer gives the stream
+    double time_base = 0.0;
+    if ((streamInfo.codec_params.codec_type == "video") && (streamInfo.codec_params.frame_rate > 0))
+    {
+        time_base = 1.0 / streamInfo.codec_params.frame_rate;
+    }
+    else if ((streamInfo.codec_params.codec_type == "audio") && (streamInfo.codec_params.sample_rate > 0))
+    {
+        time_base = 1.0 / streamInfo.codec_params.sample_rate;
+    }
+    return registerStream(m_muxer->addStream(streamInfo), time_base);
+}
+
+int InterleavedMuxer::addStream(std::shared_ptr<StreamReader> strReader)
+{
+    if (m_started.load(std::memory_order_acquire))
+    {
+        std::cerr << LOG_TAG << "addStream() after the first packet" << std::endl;
+        return -1;
+    }
+    return registerStream(m_muxer->addStream(strReader), 0.0);
+}
+
+int InterleavedMuxer::writeStreamPacket(StreamPacket& streamPacket)
+{
+    if (!m_open.load(std::memory_order_acquire) || m_failed.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+    int index = streamPacket.stream_index;
+    if ((index < 0) || (index >= m_stream_count.load(std::memory_order_acquire)) || (m_streams[index] == nullptr))
+    {
+        std::cerr << LOG_TAG << "unknown stream " << index << std::endl;
+        return -1;
+    }
+    Stream& stream = *m_streams[index];
+    m_started.store(true, std::memory_order_release);
+
+    QueuedPacket item;
+    StreamPacket& packet = item.packet;
+    packet.pts = streamPacket.pts;
+    packet.dts = streamPacket.dts;
+    packet.duration = streamPacket.duration;
+    packet.stream_index = streamPacket.stream_index;
+    packet.pos = streamPacket.pos;
+    packet.key_frame = streamPacket.key_frame;
+    packet.discard = streamPacket.discard;
+    packet.useful_pkt_size = streamPacket.useful_pkt_size;
+    packet.buffer = streamPacket.buffer;
+    if (packet.buffer.empty())
+    {
+        packet.pkt_data.assign(streamPacket.pkt_data.begin(), streamPacket.pkt_data.begin() + streamPacket.useful_pkt_size);
+    }
+    item.enqueue_ns = nowNs();
+
+    if (!stream.queue.tryPush(item))
+    {
+        if (m_config.drop_when_full)
+        {
+            stream.drops.fetch_add(1, std::memory_order_relaxed);
+            return 1;
+        }
+        uint64_t start = nowNs();
+        // let a writer waiting for this stream go on before sleeping on the full queue
+        wakeWriter();
+        if (!stream.queue.push(std::move(item)))
+        {
+            return -1;
+        }
+        stream.wait_ns.fetch_add(nowNs() - start, std::memory_order_relaxed);
+    }
+    stream.packets.fetch_add(1, std::memory_order_relaxed);
+    wakeWriter();
+    return 0;
+}
+
+std::shared_ptr<StreamReader> InterleavedMuxer::getStreamReader(const std::string& filename)
+{
+    return m_muxer->getStreamReader(filename);
+}
+
+int InterleavedMuxer::endStreamMux()
+{
+    stopWriter();
+    int ret = m_muxer->endStreamMux();
+    if (m_failed.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+    return ret;
+}
+
+InterleavedMuxer::StreamStats InterleavedMuxer::stats(int stream_index) const
+{
+    StreamStats stats;
+    if ((stream_index < 0) || (stream_index >= m_stream_count.load(std::memory_order_acquire)) ||
+        (m_streams[stream_index] == nullptr))
+    {
+        return stats;
+    }
+    const Stream& stream = *m_streams[stream_index];
+    stats.packets = stream.packets.load(std::memory_order_relaxed);
+    stats.written = stream.written.load(std::memory_order_relaxed);
+    stats.drops = stream.drops.load(std::memory_order_relaxed);
+    stats.late = stream.late.load(std::memory_order_relaxed);
+    stats.producer_wait_us = stream.wait_ns.load(std::memory_order_relaxed) / 1000;
+    stats.queue_depth = stream.queue.size();
+    return stats;
+}
+
+void InterleavedMuxer::startWriter()
+{
+    m_stopping.store(false, std::memory_order_relaxed);
+    m_writer = std::thread([this]()
+    {
+        bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread(THREAD_ROLE);
+        writerLoop();
+    });
+}
+
+void InterleavedMuxer::stopWriter()
+{
+    if (!m_writer.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wait_mutex);
+        m_stopping.store(true, std::memory_order_release);
+    }
+    m_wait_cv.notify_all();
+    m_writer.join();
+}
+
+bool InterleavedMuxer::ordered(const Stream& stream) const
+{
+    return m_mux_cfg.ts_recreate || (stream.time_base > 0.0);
+}
+
+int64_t InterleavedMuxer::orderKey(Stream& stream, const StreamPacket& packet)
+{
+    stream.popped++;
+    if (m_mux_cfg.ts_recreate)
+    {
+        // the wrapped muxer numbers the packets of every stream at video_fps
+        return static_cast<int64_t>(static_cast<double>(stream.popped - 1) * 1000000.0 / m_mux_cfg.video_fps);
+    }
+    if (stream.time_base <= 0.0)
+    {
+        return std::numeric_limits<int64_t>::min();
+    }
+    int64_t ts = (packet.dts != NO_TIMESTAMP) ? packet.dts : packet.pts;
+    if (ts == NO_TIMESTAMP)
+    {
+        return stream.last_key_us;
+    }
+    stream.last_key_us = static_cast<int64_t>(static_cast<double>(ts) * stream.time_base * 1000000.0);
+    return stream.last_key_us;
+}
+
+void InterleavedMuxer::wakeWriter()
+{
+    // pairs with the fence after the sleeping store of a writer about to re-check the queues
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writer_sleeping.load(std::memory_order_relaxed))
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wait_mutex);
+        }
+        m_wait_cv.notify_one();
+    }
+}
+
+void InterleavedMuxer::writerLoop()
+{
+    const uint64_t maxDelayNs = static_cast<uint64_t>(m_config.max_delay_ms) * 1000000ULL;
+
+    while (true)
+    {
+        // loaded ahead of the scan: once the stop is seen, the last packets of the producers
+        // are seen too, and a scan that finds nothing means the queues are drained
+        bool stopping = m_stopping.load(std::memory_order_acquire);
+        int count = m_stream_count.load(std::memory_order_acquire);
+        uint64_t now = nowNs();
+        Stream* next = nullptr;
+        bool missing = false;       // an active ordered stream has nothing queued
+        for (int i = 0; i < count; i++)
+        {
+            Stream* stream = m_streams[i].get();
+            if (stream == nullptr)
+            {
+                continue;
+            }
+            if (!stream->has_head && stream->queue.tryPop(stream->head))
+            {
+                stream->has_head = true;
+                stream->head_key_us = orderKey(*stream, stream->head.packet);
+                stream->last_pop_ns = now;
+            }
+            if (!stream->has_head)
+            {
+                bool active = (now - stream->last_pop_ns < maxDelayNs);
+                missing = missing || (ordered(*stream) && active);
+                continue;
+            }
+            if ((next == nullptr) || (stream->head_key_us < next->head_key_us))
+            {
+                next = stream;
+            }
+        }
+
+        uint64_t deadline = 0;
+        if (next != nullptr)
+        {
+            uint64_t due = next->head.enqueue_ns + maxDelayNs;
+            if (!missing || stopping || (now >= due))
+            {
+                if (missing && !stopping)
+                {
+                    next->late.fetch_add(1, std::memory_order_relaxed);
+                }
+                // after a failure the queues are still drained, no producer stays blocked
+                if (!m_failed.load(std::memory_order_relaxed) && (m_muxer->writeStreamPacket(next->head.packet) < 0))
+                {
+                    std::cerr << LOG_TAG << "write of stream " << next->head.packet.stream_index << " failed" << std::endl;
+                    m_failed.store(true, std::memory_order_relaxed);
+                }
+                next->written.fetch_add(1, std::memory_order_relaxed);
+                next->head = QueuedPacket{};
+                next->has_head = false;
+                continue;
+            }
+            deadline = due;
+        }
+        else if (stopping)
+        {
+            // producers had stopped before the scan, nothing is left
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wait_mutex);
+        m_writer_sleeping.store(true, std::memory_order_seq_cst);
+        // pairs with the fence in wakeWriter(): the relaxed queue loads below must not move
+        // ahead of the store, or a producer that saw no sleeper leaves a packet unnoticed
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool arrived = false;
+        for (int i = 0; i < count; i++)
+        {
+            Stream* stream = m_streams[i].get();
+            arrived = arrived || ((stream != nullptr) && !stream->has_head && (stream->queue.size() > 0));
+        }
+        if (!arrived && !m_stopping.load(std::memory_order_acquire) &&
+            (m_stream_count.load(std::memory_order_acquire) == count))
+        {
+            if (deadline > 0)
+            {
+                m_wait_cv.wait_for(lock, std::chrono::nanoseconds(deadline - std::min(deadline, nowNs())));
+            }
+            else
+            {
+                m_wait_cv.wait_for(lock, std::chrono::milliseconds(m_config.max_delay_ms + 1));
+            }
+        }
+        m_writer_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+uint64_t InterleavedMuxer::nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace bsp_container
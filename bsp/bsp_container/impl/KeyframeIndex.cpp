@@ -0,0 +1,221 @@
+#include <bsp_container/KeyframeIndex.hpp>
+#include <bsp_container/IDemuxer.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace bsp_container
+{
+
+namespace
+{
+// version 2: fragmented mp4 is scanned, pts no longer taken from the DTS of the sample table
+constexpr char SIDECAR_MAGIC[8] {'B', 'S', 'P', 'K', 'F', 'I', 'D', '2'};
+
+struct MediaStamp
+{
+    uint64_t size{0};
+    int64_t mtime{0};
+};
+
+bool mediaStamp(const std::string& mediaPath, MediaStamp& stamp)
+{
+    std::error_code ec;
+    stamp.size = std::filesystem::file_size(mediaPath, ec);
+    if (ec)
+    {
+        return false;
+    }
+    auto mtime = std::filesystem::last_write_time(mediaPath, ec);
+    if (ec)
+    {
+        return false;
+    }
+    stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+} // namespace
+
+std::shared_ptr<KeyframeIndex> KeyframeIndex::loadOrBuild(IDemuxer& demuxer, const std::string& mediaPath, bool save)
+{
+    auto index = std::make_shared<KeyframeIndex>();
+    const std::string path = sidecarPath(mediaPath);
+    if (index->load(path, mediaPath) == 0)
+    {
+        return index;
+    }
+
+    if (demuxer.buildKeyframeIndex(*index) != 0)
+    {
+        std::cerr << "Could not build keyframe index of " << mediaPath << std::endl;
+        return nullptr;
+    }
+    if (save && (index->save(path, mediaPath) != 0))
+    {
+        // still usable for this session
+        std::cerr << "Could not save keyframe index " << path << std::endl;
+    }
+    return index;
+}
+
+void KeyframeIndex::setTimeBase(int stream_index, int num, int den)
+{
+    auto& streamIndex = m_streams[stream_index];
+    streamIndex.time_base_num = num;
+    streamIndex.time_base_den = den;
+}
+
+void KeyframeIndex::addKeyframe(int stream_index, const Entry& entry)
+{
+    auto& entries = m_streams[stream_index].entries;
+    // demux order is pts order for keyframes in practice, keep the append fast path
+    if (entries.empty() || (entries.back().pts <= entry.pts))
+    {
+        entries.push_back(entry);
+        return;
+    }
+    auto it = std::upper_bound(entries.begin(), entries.end(), entry.pts,
+        [](int64_t pts, const Entry& e) { return pts < e.pts; });
+    entries.insert(it, entry);
+}
+
+const KeyframeIndex::Entry* KeyframeIndex::find(int stream_index, int64_t pts) const
+{
+    auto stream_it = m_streams.find(stream_index);
+    if (stream_it == m_streams.end())
+    {
+        return nullptr;
+    }
+
+    const auto& entries = stream_it->second.entries;
+    auto it = std::upper_bound(entries.begin(), entries.end(), pts,
+        [](int64_t value, const Entry& e) { return value < e.pts; });
+    if (it == entries.begin())
+    {
+        return nullptr;
+    }
+    return &*(it - 1);
+}
+
+const KeyframeIndex::StreamIndex* KeyframeIndex::stream(int stream_index) const
+{
+    auto it = m_streams.find(stream_index);
+    return (it == m_streams.end()) ? nullptr : &it->second;
+}
+
+size_t KeyframeIndex::size(int stream_index) const
+{
+    auto streamIndex = stream(stream_index);
+    return (streamIndex == nullptr) ? 0 : streamIndex->entries.size();
+}
+
+int KeyframeIndex::save(const std::string& path, const std::string& mediaPath) const
+{
+    MediaStamp stamp;
+    if (!mediaStamp(mediaPath, stamp))
+    {
+        return -1;
+    }
+
+    // written aside and renamed, a reader never sees half a sidecar
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return -1;
+        }
+        out.write(SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+        writeValue(out, stamp.size);
+        writeValue(out, stamp.mtime);
+        writeValue(out, static_cast<uint32_t>(m_streams.size()));
+        for (const auto& item : m_streams)
+        {
+            writeValue(out, static_cast<int32_t>(item.first));
+            writeValue(out, static_cast<int32_t>(item.second.time_base_num));
+            writeValue(out, static_cast<int32_t>(item.second.time_base_den));
+            writeValue(out, static_cast<uint64_t>(item.second.entries.size()));
+            out.write(reinterpret_cast<const char*>(item.second.entries.data()),
+                item.second.entries.size() * sizeof(Entry));
+        }
+        if (!out)
+        {
+            return -1;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int KeyframeIndex::load(const std::string& path, const std::string& mediaPath)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        return -1;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char magic[sizeof(SIDECAR_MAGIC)];
+    MediaStamp fileStamp;
+    MediaStamp mediaNow;
+    uint32_t streamCount = 0;
+    if (!in.read(magic, sizeof(magic)) || (std::memcmp(magic, SIDECAR_MAGIC, sizeof(magic)) != 0) ||
+        !readValue(in, fileStamp.size) || !readValue(in, fileStamp.mtime) || !readValue(in, streamCount))
+    {
+        return -1;
+    }
+    if (!mediaStamp(mediaPath, mediaNow) || (mediaNow.size != fileStamp.size) || (mediaNow.mtime != fileStamp.mtime))
+    {
+        // the recording changed since the index was written
+        return -1;
+    }
+
+    std::unordered_map<int, StreamIndex> streams;
+    for (uint32_t i = 0; i < streamCount; i++)
+    {
+        int32_t streamIndex = 0;
+        int32_t num = 0;
+        int32_t den = 0;
+        uint64_t count = 0;
+        if (!readValue(in, streamIndex) || !readValue(in, num) || !readValue(in, den) || !readValue(in, count) ||
+            (count > (fileSize - static_cast<uint64_t>(in.tellg())) / sizeof(Entry)))
+        {
+            return -1;
+        }
+        auto& item = streams[streamIndex];
+        item.time_base_num = num;
+        item.time_base_den = den;
+        item.entries.resize(count);
+        if (!in.read(reinterpret_cast<char*>(item.entries.data()), count * sizeof(Entry)))
+        {
+            return -1;
+        }
+    }
+
+    m_streams = std::move(streams);
+    return 0;
+}
+
+} // namespace bsp_container
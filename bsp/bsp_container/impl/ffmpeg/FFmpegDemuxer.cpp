@@ -3,6 +3,7 @@
 #include <cstring>
 #include "ffmpegCodecHeader.hpp"
 #include "FFmpegStreamWriter.hpp"
+#include "FFmpegPacketBuffer.hpp"
 extern "C" {
 #include <libavutil/dict.h>
 }
@@ -10,6 +11,62 @@ extern "C" {
 namespace bsp_container
 {
 
+namespace
+{
+/**
+ * @brief Walks the ISO BMFF boxes of path (top level and moov), true when the file has movie
+ * fragments: mvex in the moov, moof or mfra. Their samples are only indexed once read.
+ * A file that cannot be walked counts as fragmented, the packet scan is right either way.
+ */
+bool hasMovieFragments(const std::string& path)
+{
+    AVIOContext* pb = nullptr;
+    if (avio_open(&pb, path.c_str(), AVIO_FLAG_READ) < 0)
+    {
+        return true;
+    }
+
+    bool fragmented = true;
+    const int64_t end = avio_size(pb);
+    int64_t pos = 0;
+    while ((end > 0) && (avio_seek(pb, pos, SEEK_SET) >= 0))
+    {
+        if (pos + 8 > end)
+        {
+            // every box walked, none of them announces fragments
+            fragmented = false;
+            break;
+        }
+        uint64_t size = avio_rb32(pb);
+        const uint32_t type = avio_rl32(pb);
+        uint64_t header = 8;
+        if (size == 1)
+        {
+            size = avio_rb64(pb);
+            header = 16;
+        }
+        else if (size == 0)
+        {
+            // the last box, up to the end of the file
+            size = static_cast<uint64_t>(end - pos);
+        }
+        if (avio_feof(pb) || (size < header))
+        {
+            break;
+        }
+        if ((type == MKTAG('m', 'v', 'e', 'x')) || (type == MKTAG('m', 'o', 'o', 'f')) ||
+            (type == MKTAG('m', 'f', 'r', 'a')))
+        {
+            break;
+        }
+        // the children of moov fill it exactly, the walk goes on with the box after it
+        pos += (type == MKTAG('m', 'o', 'o', 'v')) ? static_cast<int64_t>(header) : static_cast<int64_t>(size);
+    }
+    avio_closep(&pb);
+    return fragmented;
+}
+} // namespace
+
 FFmpegDemuxer::~FFmpegDemuxer()
 {
     closeContainerDemux();
@@ -33,6 +90,9 @@ int FFmpegDemuxer::openContainerDemux(const std::string& path)
         return -1;
     }
 
+    // mov / mp4 read the whole sample table at open, unless the samples sit in fragments
+    m_complete_index = (m_format_Ctx->iformat != nullptr) && (std::strstr(m_format_Ctx->iformat->name, "mp4") != nullptr) &&
+                       !hasMovieFragments(path);
     return 0;
 }
 
@@ -40,6 +100,9 @@ void FFmpegDemuxer::closeContainerDemux()
 {
     m_packet.reset();
     m_format_Ctx.reset();
+    m_keyframe_index.reset();
+    m_complete_index = false;
+    m_seek_stream = -1;
 }
 
 int FFmpegDemuxer::getContainerInfo(ContainerInfo& containerInfo)
@@ -169,6 +232,41 @@ void FFmpegDemuxer::getStreamDisposition(const AVStream* stream, std::vector<std
     }
 }
 
+int FFmpegDemuxer::readNextPacket(StreamPacket& streamPacket)
+{
+    if(m_packet == nullptr)
+    {
+        m_packet = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* p) { av_packet_free(&p); });
+    }
+
+    int ret = av_read_frame(m_format_Ctx.get(), m_packet.get());
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    // zero copy moves the packet reference into streamPacket.buffer
+    if (takeAVPacket(m_packet.get(), streamPacket, m_zero_copy) < 0)
+    {
+        std::cerr << "Could not allocate packet." << std::endl;
+        return AVERROR(ENOMEM);
+    }
+
+    if ((m_seek_stream >= 0) && (streamPacket.stream_index == m_seek_stream) && (streamPacket.pts != AV_NOPTS_VALUE))
+    {
+        if (streamPacket.key_frame && (streamPacket.pts > m_seek_target))
+        {
+            // next GOP, nothing shown before the target can follow
+            m_seek_stream = -1;
+        }
+        else
+        {
+            streamPacket.discard = (streamPacket.pts < m_seek_target);
+        }
+    }
+    return 0;
+}
+
 int FFmpegDemuxer::readStreamPacket(StreamPacket& streamPacket)
 {
     if (m_format_Ctx == nullptr)
@@ -177,33 +275,169 @@ int FFmpegDemuxer::readStreamPacket(StreamPacket& streamPacket)
         return -1;
     }
 
-    if(m_packet == nullptr)
+    if (readNextPacket(streamPacket) < 0)
     {
-        m_packet = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* p) { av_packet_free(&p); });
+        std::cerr << "Could not read frame or EOF." << std::endl;
+        return -1;
     }
+    return 0;
+}
 
-    if (av_read_frame(m_format_Ctx.get(), m_packet.get()) < 0)
+int FFmpegDemuxer::readStreamPackets(std::vector<StreamPacket>& packets, size_t max_packets)
+{
+    if (m_format_Ctx == nullptr)
     {
-        std::cerr << "Could not read frame or EOF." << std::endl;
+        std::cerr << "Container not opened." << std::endl;
+        return -1;
+    }
+
+    if (packets.size() < max_packets)
+    {
+        packets.resize(max_packets);
+    }
+
+    size_t count = 0;
+    while (count < max_packets)
+    {
+        int ret = readNextPacket(packets[count]);
+        if (ret == AVERROR_EOF)
+        {
+            break;
+        }
+        if (ret < 0)
+        {
+            if (count > 0)
+            {
+                // hand out what was read, the error shows up again on the next call
+                break;
+            }
+            std::cerr << "Could not read frame." << std::endl;
+            return -1;
+        }
+        ++count;
+    }
+    return static_cast<int>(count);
+}
+
+bool FFmpegDemuxer::hasCompleteIndex() const
+{
+    // seeking there is already a binary search over the sample table
+    return m_complete_index;
+}
+
+int FFmpegDemuxer::seekToKeyframe(int stream_index, const KeyframeIndex::Entry& keyframe)
+{
+    // a byte seek lands on the keyframe packet itself, also in streams without usable timestamps
+    if (!hasCompleteIndex() && (keyframe.pos >= 0) && !(m_format_Ctx->iformat->flags & AVFMT_NO_BYTE_SEEK))
+    {
+        if (av_seek_frame(m_format_Ctx.get(), stream_index, keyframe.pos, AVSEEK_FLAG_BYTE) >= 0)
+        {
+            return 0;
+        }
+    }
+    return av_seek_frame(m_format_Ctx.get(), stream_index, keyframe.pts, AVSEEK_FLAG_BACKWARD);
+}
+
+int FFmpegDemuxer::seekStreamFrame(int stream_index, int64_t timestamp, SeekMode mode)
+{
+    if (m_format_Ctx == nullptr)
+    {
+        std::cerr << "Container not opened." << std::endl;
+        return -1;
+    }
+    if ((stream_index < 0) || (stream_index >= static_cast<int>(m_format_Ctx->nb_streams)))
+    {
+        std::cerr << "Invalid stream index." << std::endl;
         return -1;
     }
 
-    streamPacket.stream_index = m_packet->stream_index;
-    streamPacket.pts = m_packet->pts;
-    streamPacket.dts = m_packet->dts;
-    streamPacket.duration = m_packet->duration;
-    streamPacket.useful_pkt_size = m_packet->size;
-    if(streamPacket.pkt_data.size() < streamPacket.useful_pkt_size)
+    const KeyframeIndex::Entry* keyframe = nullptr;
+    if (m_keyframe_index != nullptr)
     {
-        streamPacket.pkt_data.resize(streamPacket.useful_pkt_size);
+        keyframe = m_keyframe_index->find(stream_index, timestamp);
     }
-    std::memcpy(streamPacket.pkt_data.data(), m_packet->data, streamPacket.useful_pkt_size);
-    streamPacket.pos = m_packet->pos;
+
+    int ret = (keyframe != nullptr) ? seekToKeyframe(stream_index, *keyframe)
+                                    : av_seek_frame(m_format_Ctx.get(), stream_index, timestamp, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0)
+    {
+        std::cerr << "Could not seek stream " << stream_index << " to " << timestamp << std::endl;
+        return -1;
+    }
+
+    if (m_packet != nullptr)
+    {
+        av_packet_unref(m_packet.get());
+    }
+    m_seek_stream = (mode == SeekMode::Accurate) ? stream_index : -1;
+    m_seek_target = timestamp;
     return 0;
 }
 
-int FFmpegDemuxer::seekStreamFrame(int stream_index, int64_t timestamp)
+int FFmpegDemuxer::buildKeyframeIndex(KeyframeIndex& index)
 {
+    if (m_format_Ctx == nullptr)
+    {
+        std::cerr << "Container not opened." << std::endl;
+        return -1;
+    }
+
+    index.clear();
+    for (unsigned int i = 0; i < m_format_Ctx->nb_streams; i++)
+    {
+        AVStream* stream = m_format_Ctx->streams[i];
+        index.setTimeBase(static_cast<int>(i), stream->time_base.num, stream->time_base.den);
+    }
+
+    // the sample table holds DTS, they are the keyframe pts only when no stream reorders frames
+    bool reordered = false;
+    for (unsigned int i = 0; i < m_format_Ctx->nb_streams; i++)
+    {
+        reordered = reordered || (m_format_Ctx->streams[i]->codecpar->video_delay > 0);
+    }
+
+    if (hasCompleteIndex() && !reordered)
+    {
+        for (unsigned int i = 0; i < m_format_Ctx->nb_streams; i++)
+        {
+            AVStream* stream = m_format_Ctx->streams[i];
+            const int count = avformat_index_get_entries_count(stream);
+            for (int j = 0; j < count; j++)
+            {
+                const AVIndexEntry* entry = avformat_index_get_entry(stream, j);
+                if ((entry != nullptr) && (entry->flags & AVINDEX_KEYFRAME))
+                {
+                    index.addKeyframe(static_cast<int>(i), {entry->timestamp, entry->timestamp, entry->pos});
+                }
+            }
+        }
+        return 0;
+    }
+
+    // one pass over the packets, nothing is decoded or copied
+    AVPacket* packet = av_packet_alloc();
+    if (packet == nullptr)
+    {
+        return -1;
+    }
+    while (av_read_frame(m_format_Ctx.get(), packet) >= 0)
+    {
+        int64_t pts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+        if ((packet->flags & AV_PKT_FLAG_KEY) && (pts != AV_NOPTS_VALUE))
+        {
+            index.addKeyframe(packet->stream_index, {pts, packet->dts, packet->pos});
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+
+    const int64_t start = (m_format_Ctx->start_time != AV_NOPTS_VALUE) ? m_format_Ctx->start_time : 0;
+    if ((av_seek_frame(m_format_Ctx.get(), -1, start, AVSEEK_FLAG_BACKWARD) < 0) &&
+        (av_seek_frame(m_format_Ctx.get(), -1, 0, AVSEEK_FLAG_BYTE) < 0))
+    {
+        std::cerr << "Could not rewind after indexing." << std::endl;
+    }
+    m_seek_stream = -1;
     return 0;
 }
 
@@ -22,16 +22,38 @@ public:
 
     int readStreamPacket(StreamPacket& streamPacket) override;
 
-    int seekStreamFrame(int stream_index, int64_t timestamp) override;
+    int readStreamPackets(std::vector<StreamPacket>& packets, size_t max_packets) override;
+
+    void setZeroCopy(bool enable) override { m_zero_copy = enable; }
+
+    int seekStreamFrame(int stream_index, int64_t timestamp, SeekMode mode = SeekMode::Keyframe) override;
+
+    int buildKeyframeIndex(KeyframeIndex& index) override;
+
+    void setKeyframeIndex(std::shared_ptr<const KeyframeIndex> index) override { m_keyframe_index = index; }
 
     std::shared_ptr<StreamWriter> getStreamWriter(int stream_index, const std::string& filename) override;
 
 private:
     void getStreamDisposition(const AVStream* stream, std::vector<std::string>& disposition_list);
 
+    int readNextPacket(StreamPacket& streamPacket);
+
+    int seekToKeyframe(int stream_index, const KeyframeIndex::Entry& keyframe);
+
+    bool hasCompleteIndex() const;
+
 private:
     std::shared_ptr<AVFormatContext> m_format_Ctx{nullptr};
     std::shared_ptr<AVPacket> m_packet{nullptr};
+    bool m_zero_copy{false};
+    std::shared_ptr<const KeyframeIndex> m_keyframe_index{nullptr};
+    // mp4 without movie fragments, the demuxer indexed every sample at open
+    bool m_complete_index{false};
+
+    // accurate seek in progress: packets of that stream before the target are marked discard
+    int m_seek_stream{-1};
+    int64_t m_seek_target{0};
 };
 
 } // namespace bsp_container
@@ -1,10 +1,15 @@
 #include "FFmpegMuxer.hpp"
 #include "ffmpegCodecHeader.hpp"
 #include "FFmpegStreamReader.hpp"
+#include "FFmpegPacketBuffer.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <cstring>
 extern "C" {
 #include <libavutil/dict.h>
+#include <libavutil/mathematics.h>
+#include <libavutil/mem.h>
 }
 namespace bsp_container
 {
@@ -16,33 +21,188 @@ FFmpegMuxer::~FFmpegMuxer()
 
 int FFmpegMuxer::openContainerMux(const std::string& path, MuxConfig& config)
 {
-    int ret = 0;
+    closeContainerMux();
+
+    m_mux_cfg = config;
+    m_base_path = path;
+    m_segment_index = 0;
+    m_segment_start_ms = -1;
+    m_stream_frames_count_map.clear();
+
+    std::string segment_path = segmentPath(m_segment_index);
+    m_format_Ctx = allocOutputContext(segment_path);
+    if (m_format_Ctx == nullptr)
+    {
+        return -1;
+    }
+    m_path = segment_path;
+    m_header_written = false;
+    return 0;
+}
+
+std::shared_ptr<AVFormatContext> FFmpegMuxer::allocOutputContext(const std::string& path) const
+{
     AVFormatContext* format_Ctx = nullptr;
     avformat_alloc_output_context2(&format_Ctx, nullptr, nullptr, path.c_str());
     if (format_Ctx == nullptr)
     {
         std::cerr << "Could not allocate output context." << std::endl;
-        return -1;
+        return nullptr;
     }
 
-    m_format_Ctx = std::shared_ptr<AVFormatContext>(format_Ctx, [](AVFormatContext* p) { avformat_free_context(p); });
-    m_path = path;
-    m_mux_cfg.ts_recreate = config.ts_recreate;
-    m_mux_cfg.video_fps = config.video_fps;
+    if (m_mux_cfg.fragmented)
+    {
+        // hands every finished fragment to the file right away
+        format_Ctx->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+    }
+    return std::shared_ptr<AVFormatContext>(format_Ctx, [](AVFormatContext* p) { avformat_free_context(p); });
 }
 
-void FFmpegMuxer::closeContainerMux()
+std::string FFmpegMuxer::segmentPath(int index) const
 {
-    if (m_format_Ctx == nullptr)
+    if ((m_mux_cfg.segment_ms <= 0) && (m_mux_cfg.segment_bytes == 0))
+    {
+        return m_base_path;
+    }
+
+    size_t name = m_base_path.find_last_of('/');
+    size_t dot = m_base_path.find_last_of('.');
+    if ((dot == std::string::npos) || ((name != std::string::npos) && (dot < name)))
+    {
+        dot = m_base_path.size();
+    }
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%03d", index);
+    return m_base_path.substr(0, dot) + suffix + m_base_path.substr(dot);
+}
+
+int FFmpegMuxer::writeAvioPacket(void* opaque, AvioWriteBuffer buf, int buf_size)
+{
+    auto* writer = static_cast<AsyncFileWriter*>(opaque);
+    if (writer->write(buf, static_cast<size_t>(buf_size)) < 0)
     {
+        return AVERROR(EIO);
+    }
+    return buf_size;
+}
+
+int64_t FFmpegMuxer::seekAvio(void* opaque, int64_t offset, int whence)
+{
+    auto* writer = static_cast<AsyncFileWriter*>(opaque);
+    if (whence & AVSEEK_SIZE)
+    {
+        return writer->size();
+    }
+    int64_t pos = writer->seek(offset, whence & ~AVSEEK_FORCE);
+    return (pos < 0) ? AVERROR(EINVAL) : pos;
+}
+
+int FFmpegMuxer::openOutput()
+{
+    if (m_mux_cfg.async_io)
+    {
+        AsyncFileWriter::Options options;
+        options.preallocate_bytes = m_mux_cfg.preallocate_bytes;
+        options.chunk_bytes = m_mux_cfg.io_chunk_bytes;
+        // a fragment is only worth something once it is on disk
+        options.sync_interval_ms = m_mux_cfg.fragmented ? m_mux_cfg.fragment_ms : 0;
+        auto writer = std::make_unique<AsyncFileWriter>(options);
+        if (writer->open(m_path) < 0)
+        {
+            std::cerr << "Could not open output file." << std::endl;
+            return -1;
+        }
+
+        uint8_t* buffer = static_cast<uint8_t*>(av_malloc(AVIO_BUFFER_SIZE));
+        AVIOContext* pb = (buffer == nullptr) ? nullptr :
+            avio_alloc_context(buffer, AVIO_BUFFER_SIZE, 1, writer.get(), nullptr, writeAvioPacket, seekAvio);
+        if (pb == nullptr)
+        {
+            av_free(buffer);
+            std::cerr << "Could not allocate output io context." << std::endl;
+            return -1;
+        }
+        m_format_Ctx->pb = pb;
+        m_format_Ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        m_writer = std::move(writer);
+    }
+    else if (!(m_format_Ctx->oformat->flags & AVFMT_NOFILE))
+    {
+        if (avio_open(&m_format_Ctx->pb, m_path.c_str(), AVIO_FLAG_WRITE) < 0)
+        {
+            std::cerr << "Could not open output file." << std::endl;
+            return -1;
+        }
+    }
+
+    AVDictionary* options = nullptr;
+    if (m_mux_cfg.fragmented)
+    {
+        // moov without samples up front, then self contained moof + mdat fragments; the moov
+        // waits for the first fragment so that it gets the SPS / PPS of the first keyframe
+        av_dict_set(&options, "movflags", "empty_moov+default_base_moof+delay_moov", 0);
+        av_dict_set(&options, "frag_duration", std::to_string(static_cast<int64_t>(m_mux_cfg.fragment_ms) * 1000).c_str(), 0);
+    }
+    int ret = avformat_write_header(m_format_Ctx.get(), &options);
+    av_dict_free(&options);
+    if (ret < 0)
+    {
+        std::cerr << "Could not write header." << std::endl;
+        return -1;
+    }
+    m_header_written = true;
+    return 0;
+}
+
+void FFmpegMuxer::closeOutput()
+{
+    if ((m_format_Ctx == nullptr) || (m_format_Ctx->pb == nullptr))
+    {
+        return;
+    }
+
+    auto notify = m_mux_cfg.segment_closed;
+    if (m_writer != nullptr)
+    {
+        avio_flush(m_format_Ctx->pb);
+        av_freep(&m_format_Ctx->pb->buffer);
+        avio_context_free(&m_format_Ctx->pb);
+
+        m_writer->closeAsync([notify](const std::string& path, int result)
+        {
+            if ((result == 0) && notify)
+            {
+                notify(path);
+            }
+        });
+        m_closing_writers.push_back(std::move(m_writer));
+        m_closing_writers.erase(std::remove_if(m_closing_writers.begin(), m_closing_writers.end(),
+            [](const std::unique_ptr<AsyncFileWriter>& writer) { return writer->closed(); }), m_closing_writers.end());
         return;
     }
 
     if (!(m_format_Ctx->oformat->flags & AVFMT_NOFILE))
     {
         avio_closep(&m_format_Ctx->pb);
+        if (notify)
+        {
+            notify(m_path);
+        }
+    }
+}
+
+void FFmpegMuxer::closeContainerMux()
+{
+    if (m_format_Ctx == nullptr)
+    {
+        return;
     }
+
+    closeOutput();
     m_format_Ctx.reset();
+    m_header_written = false;
+    // the last segments are on disk once this returns
+    m_closing_writers.clear();
 }
 
 void FFmpegMuxer::setupVideoStreamParams(AVStream* out_stream, StreamInfo& streamInfo)
@@ -61,6 +221,18 @@ void FFmpegMuxer::setupVideoStreamParams(AVStream* out_stream, StreamInfo& strea
     out_stream->codecpar->width = streamInfo.codec_params.width;
     out_stream->codecpar->height = streamInfo.codec_params.height;
     out_stream->time_base = {1, streamInfo.codec_params.frame_rate};
+
+    // SPS / PPS of an encoder with a global header (ffmpegEnc), not repeated in its packets
+    const auto& extraData = streamInfo.codec_params.extra_data;
+    if (!extraData.empty())
+    {
+        out_stream->codecpar->extradata = static_cast<uint8_t*>(av_mallocz(extraData.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (out_stream->codecpar->extradata != nullptr)
+        {
+            std::memcpy(out_stream->codecpar->extradata, extraData.data(), extraData.size());
+            out_stream->codecpar->extradata_size = static_cast<int>(extraData.size());
+        }
+    }
 }
 
 void FFmpegMuxer::setupAudioStreamParams(AVStream* out_stream, StreamInfo& streamInfo)
@@ -173,50 +345,110 @@ int64_t FFmpegMuxer::recreateDTS(int stream_index)
 }
 
 
-int FFmpegMuxer::writeStreamPacket(StreamPacket& streamPacket)
+bool FFmpegMuxer::segmentFull(const StreamPacket& streamPacket)
 {
-    if (m_header_written == false)
+    if ((m_mux_cfg.segment_bytes > 0) && (m_format_Ctx->pb != nullptr))
+    {
+        int64_t written = (m_writer != nullptr) ? m_writer->size() : avio_tell(m_format_Ctx->pb);
+        if (written >= static_cast<int64_t>(m_mux_cfg.segment_bytes))
+        {
+            return true;
+        }
+    }
+
+    if ((m_mux_cfg.segment_ms > 0) && (m_segment_start_ms >= 0))
+    {
+        int64_t pts = m_mux_cfg.ts_recreate ? recreatePTS(streamPacket.stream_index) : streamPacket.pts;
+        if ((pts < 0) || (pts == AV_NOPTS_VALUE))
+        {
+            return false;
+        }
+        AVRational time_base = m_format_Ctx->streams[streamPacket.stream_index]->time_base;
+        return (av_rescale_q(pts, time_base, {1, 1000}) - m_segment_start_ms) >= m_mux_cfg.segment_ms;
+    }
+    return false;
+}
+
+int FFmpegMuxer::rotateSegment()
+{
+    std::string path = segmentPath(m_segment_index + 1);
+    std::shared_ptr<AVFormatContext> next = allocOutputContext(path);
+    if (next == nullptr)
     {
-        if (m_format_Ctx == nullptr)
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < m_format_Ctx->nb_streams; i++)
+    {
+        AVStream* in_stream = m_format_Ctx->streams[i];
+        AVStream* out_stream = avformat_new_stream(next.get(), nullptr);
+        if ((out_stream == nullptr) || (avcodec_parameters_copy(out_stream->codecpar, in_stream->codecpar) < 0))
         {
-            std::cerr << "Output format context is null." << std::endl;
+            std::cerr << "Could not copy stream to the next segment." << std::endl;
             return -1;
         }
+        out_stream->id = in_stream->id;
+        out_stream->time_base = in_stream->time_base;
+        out_stream->codecpar->codec_tag = 0;
+    }
 
-        if(!(m_format_Ctx->oformat->flags & AVFMT_NOFILE))
+    av_write_trailer(m_format_Ctx.get());
+    closeOutput();
+
+    m_format_Ctx = next;
+    m_path = path;
+    m_header_written = false;
+    m_segment_index++;
+    m_segment_start_ms = -1;
+    for (auto& count : m_stream_frames_count_map)
+    {
+        count.second = 0;
+    }
+    return 0;
+}
+
+int FFmpegMuxer::writeStreamPacket(StreamPacket& streamPacket)
+{
+    if (m_format_Ctx == nullptr)
+    {
+        std::cerr << "Output format context is null." << std::endl;
+        return -1;
+    }
+
+    // cut in front of a keyframe, every segment starts decodable and no frame is lost
+    if (m_header_written && streamPacket.key_frame && segmentFull(streamPacket))
+    {
+        if (rotateSegment() < 0)
         {
-            if (avio_open(&m_format_Ctx->pb, m_path.c_str(), AVIO_FLAG_WRITE) < 0)
-            {
-                std::cerr << "Could not open output file." << std::endl;
-                return -1;
-            }
+            return -1;
         }
+    }
 
-        if (avformat_write_header(m_format_Ctx.get(), nullptr) < 0)
+    if (m_header_written == false)
+    {
+        if (openOutput() < 0)
         {
-            std::cerr << "Could not write header." << std::endl;
             return -1;
         }
-        m_header_written = true;
     }
 
     if (m_packet == nullptr)
     {
         AVPacket* tmp_packet = av_packet_alloc();
         m_packet = std::shared_ptr<AVPacket>(tmp_packet, [](AVPacket* p) { av_packet_free(&p); });
-        av_new_packet(m_packet.get(), streamPacket.useful_pkt_size);
     }
 
-    if (m_packet->size < streamPacket.useful_pkt_size)
+    // a PacketBuffer payload is handed to the muxer by reference, no copy
+    if (fillAVPacket(m_packet.get(), streamPacket) < 0)
     {
-        // padding the small packet
-        int grow_by = FFALIGN(streamPacket.useful_pkt_size, 64) + 1024;
-        av_grow_packet(m_packet.get(), grow_by);
-        m_packet->size = streamPacket.useful_pkt_size;
+        std::cerr << "Could not allocate packet." << std::endl;
+        return -1;
     }
-
-    std::memcpy(m_packet->data, streamPacket.pkt_data.data(), streamPacket.useful_pkt_size);
     m_packet->stream_index = streamPacket.stream_index;
+    if (streamPacket.key_frame)
+    {
+        m_packet->flags |= AV_PKT_FLAG_KEY;
+    }
 
     if (true == m_mux_cfg.ts_recreate)
     {
@@ -230,6 +462,13 @@ int FFmpegMuxer::writeStreamPacket(StreamPacket& streamPacket)
     }
     m_packet->pos = -1;
 
+    if ((m_segment_start_ms < 0) && (m_packet->pts != AV_NOPTS_VALUE))
+    {
+        AVRational time_base = m_format_Ctx->streams[streamPacket.stream_index]->time_base;
+        m_segment_start_ms = av_rescale_q(m_packet->pts, time_base, {1, 1000});
+    }
+
+    // takes the packet reference, m_packet is blank again afterwards
     if (av_interleaved_write_frame(m_format_Ctx.get(), m_packet.get()) < 0)
     {
         std::cerr << "Could not write frame." << std::endl;
@@ -267,9 +506,14 @@ int FFmpegMuxer::endStreamMux()
         return -1;
     }
 
-    av_write_trailer(m_format_Ctx.get());
+    int ret = 0;
+    if (m_header_written)
+    {
+        ret = (av_write_trailer(m_format_Ctx.get()) < 0) ? -1 : 0;
+    }
     m_packet.reset();
     m_header_written = false;
+    return ret;
 }
 
-} // namespace bsp_container
\ No newline at end of file
+} // namespace bsp_container
@@ -2,8 +2,10 @@
 #define __FFMPEG_MUXER_HPP__
 
 #include <bsp_container/IMuxer.hpp>
+#include "../AsyncFileWriter.hpp"
 #include <memory>
 #include <string>
+#include <vector>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -11,6 +13,14 @@ extern "C" {
 
 namespace bsp_container
 {
+
+// the AVIO write callback takes a const buffer since libavformat 61
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+using AvioWriteBuffer = const uint8_t*;
+#else
+using AvioWriteBuffer = uint8_t*;
+#endif
+
 class FFmpegMuxer : public IMuxer
 {
 public:
@@ -40,6 +50,34 @@ private:
 
     int64_t recreateDTS(int stream_index);
 
+    std::shared_ptr<AVFormatContext> allocOutputContext(const std::string& path) const;
+
+    /**
+     * @brief Open the file of the current segment and write the header.
+     */
+    int openOutput();
+
+    /**
+     * @brief Close the file of the current segment, with async_io it is synced and closed on
+     * the writer thread while muxing goes on.
+     */
+    void closeOutput();
+
+    bool segmentFull(const StreamPacket& streamPacket);
+
+    /**
+     * @brief Finish the current segment and continue with the same streams in the next one.
+     */
+    int rotateSegment();
+
+    std::string segmentPath(int index) const;
+
+    static int writeAvioPacket(void* opaque, AvioWriteBuffer buf, int buf_size);
+
+    static int64_t seekAvio(void* opaque, int64_t offset, int whence);
+
+    static constexpr int AVIO_BUFFER_SIZE{64 * 1024};
+
 private:
     std::shared_ptr<AVFormatContext> m_format_Ctx{nullptr};
     bool m_header_written{false};
@@ -47,6 +85,13 @@ private:
     std::shared_ptr<AVPacket> m_packet{nullptr};
     MuxConfig m_mux_cfg{};
     std::unordered_map<int, int> m_stream_frames_count_map{};
+
+    std::string m_base_path{};
+    int m_segment_index{0};
+    int64_t m_segment_start_ms{-1};
+    std::unique_ptr<AsyncFileWriter> m_writer{nullptr};
+    // finished segments still being synced and closed
+    std::vector<std::unique_ptr<AsyncFileWriter>> m_closing_writers{};
 };
 
 } // namespace bsp_container
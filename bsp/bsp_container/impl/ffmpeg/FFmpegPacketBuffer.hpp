@@ -0,0 +1,130 @@
+#ifndef __FFMPEG_PACKET_BUFFER_HPP__
+#define __FFMPEG_PACKET_BUFFER_HPP__
+
+#include <bsp_container/ContainerHeader.hpp>
+#include <cstring>
+#include <memory>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+}
+
+namespace bsp_container
+{
+
+/**
+ * @brief AVBufferRef over the PacketBuffer memory, no copy. It keeps a reference to the owner
+ * until FFmpeg frees the AVBufferRef.
+ *
+ * The memory stays shared with the caller (encoder pool, muxer queues), so the ref is read only:
+ * av_packet_make_writable() and a BSF copy it before changing the payload.
+ */
+inline AVBufferRef* wrapPacketBuffer(const bsp_perf::shared::PacketBuffer& buffer)
+{
+    if (buffer.empty())
+    {
+        return nullptr;
+    }
+
+    auto* owner = new std::shared_ptr<void>(buffer.owner);
+    AVBufferRef* ref = av_buffer_create(buffer.data, static_cast<int>(buffer.size),
+        [](void* opaque, uint8_t* /*data*/) { delete static_cast<std::shared_ptr<void>*>(opaque); },
+        owner, AV_BUFFER_FLAG_READONLY);
+    if (ref == nullptr)
+    {
+        delete owner;
+    }
+    return ref;
+}
+
+/**
+ * @brief PacketBuffer over the payload of pkt, no copy. The packet reference moves into the
+ * buffer owner, pkt is blank afterwards.
+ */
+inline bsp_perf::shared::PacketBuffer takePacketBuffer(AVPacket* pkt)
+{
+    AVPacket* ref = av_packet_alloc();
+    if (ref == nullptr)
+    {
+        return bsp_perf::shared::PacketBuffer{};
+    }
+    av_packet_move_ref(ref, pkt);
+
+    std::shared_ptr<void> owner(ref, [](void* p)
+    {
+        AVPacket* packet = static_cast<AVPacket*>(p);
+        av_packet_free(&packet);
+    });
+    auto buffer = bsp_perf::shared::PacketBuffer::wrap(ref->data, static_cast<size_t>(ref->size), owner);
+    // refcounted demuxer packets come with AV_INPUT_BUFFER_PADDING_SIZE zeroed bytes
+    buffer.padded = (ref->buf != nullptr);
+    return buffer;
+}
+
+/**
+ * @brief Move a packet read by av_read_frame() into streamPacket, pkt is blank afterwards.
+ * zeroCopy hands the AVPacket buffer over as StreamPacket::buffer and leaves pkt_data alone,
+ * otherwise the payload is copied into pkt_data.
+ * @return 0 success, -1 on allocation failure
+ */
+inline int takeAVPacket(AVPacket* pkt, StreamPacket& streamPacket, bool zeroCopy)
+{
+    streamPacket.stream_index = pkt->stream_index;
+    streamPacket.pts = pkt->pts;
+    streamPacket.dts = pkt->dts;
+    streamPacket.duration = pkt->duration;
+    streamPacket.pos = pkt->pos;
+    streamPacket.useful_pkt_size = static_cast<size_t>(pkt->size);
+    streamPacket.key_frame = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+    streamPacket.discard = false;
+
+    if (zeroCopy)
+    {
+        streamPacket.buffer = takePacketBuffer(pkt);
+        return ((pkt->size > 0) && streamPacket.buffer.empty()) ? -1 : 0;
+    }
+
+    streamPacket.buffer.reset();
+    if (streamPacket.pkt_data.size() < streamPacket.useful_pkt_size)
+    {
+        streamPacket.pkt_data.resize(streamPacket.useful_pkt_size);
+    }
+    std::memcpy(streamPacket.pkt_data.data(), pkt->data, streamPacket.useful_pkt_size);
+    av_packet_unref(pkt);
+    return 0;
+}
+
+/**
+ * @brief Point pkt at the payload of streamPacket: by reference when it carries a padded
+ * PacketBuffer, otherwise the payload (pkt_data, or a buffer without the zeroed tail the FFmpeg
+ * parsers and bitstream filters overread into, e.g. rkmpp output) is copied into a new packet
+ * buffer. Timestamps are left to the caller.
+ * @return 0 success, -1 on allocation failure
+ */
+inline int fillAVPacket(AVPacket* pkt, const StreamPacket& streamPacket)
+{
+    av_packet_unref(pkt);
+    if (!streamPacket.buffer.empty() && streamPacket.buffer.padded)
+    {
+        pkt->buf = wrapPacketBuffer(streamPacket.buffer);
+        if (pkt->buf == nullptr)
+        {
+            return -1;
+        }
+        pkt->data = streamPacket.buffer.data;
+        pkt->size = static_cast<int>(streamPacket.buffer.size);
+        return 0;
+    }
+
+    // av_new_packet() zeroes the padding
+    if (av_new_packet(pkt, static_cast<int>(streamPacket.payloadSize())) < 0)
+    {
+        return -1;
+    }
+    std::memcpy(pkt->data, streamPacket.payload(), streamPacket.payloadSize());
+    return 0;
+}
+
+} // namespace bsp_container
+
+#endif // __FFMPEG_PACKET_BUFFER_HPP__
@@ -1,4 +1,5 @@
 #include "FFmpegStreamReader.hpp"
+#include "FFmpegPacketBuffer.hpp"
 #include <iostream>
 #include <cstring>
 
@@ -72,17 +73,44 @@ int FFmpegStreamReader::readPacket(StreamPacket& packet)
         return -1;
     }
 
-    packet.stream_index = m_packet->stream_index;
-    packet.pts = m_packet->pts;
-    packet.dts = m_packet->dts;
-    packet.useful_pkt_size = m_packet->size;
-    if (packet.pkt_data.size() < packet.useful_pkt_size)
+    return takeAVPacket(m_packet.get(), packet, m_zero_copy);
+}
+
+int FFmpegStreamReader::readPackets(std::vector<StreamPacket>& packets, size_t max_packets)
+{
+    if (m_format_Ctx == nullptr)
+    {
+        std::cerr << "Input context not allocated." << std::endl;
+        return -1;
+    }
+
+    if (m_packet == nullptr)
+    {
+        AVPacket* tmp_packet = av_packet_alloc();
+        m_packet = std::shared_ptr<AVPacket>(tmp_packet, [](AVPacket* p) { av_packet_free(&p); });
+    }
+
+    if (packets.size() < max_packets)
+    {
+        packets.resize(max_packets);
+    }
+
+    size_t count = 0;
+    while (count < max_packets)
     {
-        packet.pkt_data.resize(packet.useful_pkt_size);
+        int ret = av_read_frame(m_format_Ctx.get(), m_packet.get());
+        if ((ret == AVERROR_EOF) || ((ret < 0) && (count > 0)))
+        {
+            break;
+        }
+        if ((ret < 0) || (takeAVPacket(m_packet.get(), packets[count], m_zero_copy) < 0))
+        {
+            std::cerr << "Could not read frame." << std::endl;
+            return (count > 0) ? static_cast<int>(count) : -1;
+        }
+        ++count;
     }
-    std::memcpy(packet.pkt_data.data(), m_packet->data, packet.useful_pkt_size);
-    packet.pos = m_packet->pos;
-    return ret;
+    return static_cast<int>(count);
 }
 
 }
\ No newline at end of file
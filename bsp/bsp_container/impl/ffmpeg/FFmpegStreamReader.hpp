@@ -26,10 +26,14 @@ public:
 
     int readPacket(StreamPacket& packet) override;
 
+    int readPackets(std::vector<StreamPacket>& packets, size_t max_packets) override;
+
+    void setZeroCopy(bool enable) override { m_zero_copy = enable; }
 
 private:
     std::shared_ptr<AVFormatContext> m_format_Ctx{nullptr};
     std::shared_ptr<AVPacket> m_packet{nullptr};
+    bool m_zero_copy{false};
 };
 
 }
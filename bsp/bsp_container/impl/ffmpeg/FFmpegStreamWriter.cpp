@@ -1,4 +1,5 @@
 #include "FFmpegStreamWriter.hpp"
+#include "FFmpegPacketBuffer.hpp"
 #include <iostream>
 #include <cstring>
 
@@ -94,16 +95,13 @@ int FFmpegStreamWriter::writePacket(const StreamPacket &packet)
     {
         AVPacket* tmp_packet = av_packet_alloc();
         m_packet = std::shared_ptr<AVPacket>(tmp_packet, [](AVPacket* p) { av_packet_free(&p); });
-        av_new_packet(m_packet.get(), packet.useful_pkt_size);
     }
 
-    if (m_packet->size < packet.useful_pkt_size)
+    if (fillAVPacket(m_packet.get(), packet) < 0)
     {
-        av_grow_packet(m_packet.get(), packet.useful_pkt_size);
-        m_packet->size = packet.useful_pkt_size;
+        std::cerr << "Could not allocate packet." << std::endl;
+        return -1;
     }
-
-    std::memcpy(m_packet->data, packet.pkt_data.data(), m_packet->size);
     m_packet->pts = packet.pts;
     m_packet->dts = packet.dts;
     std::cerr << "FFmpegStreamWriter::writePacket: m_packet->pts: " << m_packet->pts << std::endl;
@@ -0,0 +1,104 @@
+#include <bsp_container/InterleavedMuxer.hpp>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace bsp_container;
+
+namespace
+{
+
+constexpr char LOG_TAG[] {"[InterleavedMuxerTest]: "};
+
+// counts the packets the writer thread hands over, nothing is written
+class CountingMuxer : public IMuxer
+{
+public:
+    explicit CountingMuxer(std::atomic<size_t>& written):
+        m_written(written)
+    {
+    }
+
+    int openContainerMux(const std::string&, MuxConfig&) override { return 0; }
+    void closeContainerMux() override {}
+    int addStream(StreamInfo&) override { return m_streams++; }
+    int addStream(std::shared_ptr<StreamReader>) override { return m_streams++; }
+    int writeStreamPacket(StreamPacket&) override
+    {
+        m_written.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    std::shared_ptr<StreamReader> getStreamReader(const std::string&) override { return nullptr; }
+    int endStreamMux() override { return 0; }
+
+private:
+    std::atomic<size_t>& m_written;
+    int m_streams{0};
+};
+
+/**
+ * @brief One producer pushes packets and ends the mux right after the last one, every packet
+ * queued before endStreamMux() has to reach the wrapped muxer.
+ */
+int pushThenStop(int rounds, size_t packets)
+{
+    for (int round = 0; round < rounds; round++)
+    {
+        std::atomic<size_t> written{0};
+        InterleavedMuxer::Config config;
+        config.max_delay_ms = 0;
+        InterleavedMuxer muxer(std::make_unique<CountingMuxer>(written), config);
+        IMuxer::MuxConfig muxConfig{false, 30};
+        if (muxer.openContainerMux("interleaved_muxer_test.mp4", muxConfig) < 0)
+        {
+            std::cerr << LOG_TAG << "openContainerMux() failed" << std::endl;
+            return -1;
+        }
+        StreamInfo streamInfo;
+        streamInfo.codec_params.codec_type = "video";
+        streamInfo.codec_params.frame_rate = 30;
+        if (muxer.addStream(streamInfo) < 0)
+        {
+            std::cerr << LOG_TAG << "addStream() failed" << std::endl;
+            return -1;
+        }
+
+        std::thread producer([&muxer, packets]()
+        {
+            StreamPacket packet;
+            packet.stream_index = 0;
+            packet.pkt_data = {0x00, 0x00, 0x01, 0x65};
+            packet.useful_pkt_size = packet.pkt_data.size();
+            for (size_t i = 0; i < packets; i++)
+            {
+                packet.pts = static_cast<int64_t>(i);
+                packet.dts = static_cast<int64_t>(i);
+                muxer.writeStreamPacket(packet);
+            }
+            muxer.endStreamMux();
+        });
+        producer.join();
+        muxer.closeContainerMux();
+
+        if (written.load(std::memory_order_relaxed) != packets)
+        {
+            std::cerr << LOG_TAG << "round " << round << ": " << written.load(std::memory_order_relaxed)
+                      << " of " << packets << " packets written" << std::endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main()
+{
+    if ((pushThenStop(500, 1) < 0) || (pushThenStop(500, 64) < 0))
+    {
+        return 1;
+    }
+    std::cout << LOG_TAG << "passed" << std::endl;
+    return 0;
+}
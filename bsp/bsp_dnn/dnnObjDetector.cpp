@@ -109,11 +109,11 @@ int dnnObjDetector::runObjDetect(ObjDetectParams& params)
     m_dnnEngine->runInference();
     std::vector<IDnnEngine::dnnOutput> dnn_output_vector{};
     m_dnnEngine->popOutputData(dnn_output_vector);
-    m_logger->printStdoutLog(BspLogger::LogLevel::Info, "dnn_output_vector.size(): {}", dnn_output_vector.size());
+    BSP_LOG(m_logger, printStdoutLog, Debug, "dnn_output_vector.size(): {}", dnn_output_vector.size());
     for (const auto& dnn_output : dnn_output_vector)
     {
-        m_logger->printStdoutLog(BspLogger::LogLevel::Info, "dnn_output.index: {}, dnn_output.size: {}", dnn_output.index, dnn_output.size);
-        m_logger->printStdoutLog(BspLogger::LogLevel::Info, "dnn_output.dataType: {}", dnn_output.dataType);
+        BSP_LOG(m_logger, printStdoutLog, Debug, "dnn_output.index: {}, dnn_output.size: {}", dnn_output.index, dnn_output.size);
+        BSP_LOG(m_logger, printStdoutLog, Debug, "dnn_output.dataType: {}", dnn_output.dataType);
     }
     m_dataOutputVector.clear();
     int ret = m_dnnPluginHandle->postProcess(m_labelTextPath, params,
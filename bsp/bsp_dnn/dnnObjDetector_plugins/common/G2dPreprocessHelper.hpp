@@ -1,6 +1,7 @@
 #ifndef __G2D_PREPROCESS_HELPER_HPP__
 #define __G2D_PREPROCESS_HELPER_HPP__
 
+#include <bsp_dnn/IDnnObjDetectorPlugin.hpp>
 #include <bsp_g2d/IGraphics2D.hpp>
 #include <bsp_image/ImageBuffer.hpp>
 #include <cstdint>
@@ -28,7 +29,7 @@ inline int g2dResizeToHost(bsp_g2d::IGraphics2D& g2d,
     outputDesc.dataSize = bsp_perf::bsp_image::imageDataSize(outputDesc);
 
     outputStorage.resize(outputDesc.dataSize);
-    output = bsp_perf::bsp_image::makeHostImageView(outputStorage.data(), outputDesc, outputDesc.widthStride);
+    output = bsp_perf::bsp_image::makeHostImageView(outputStorage.data(), outputDesc);
 
     auto inputBuffer = g2d.createBuffer(bsp_g2d::IGraphics2D::BufferType::Mapped, input);
     auto outputBuffer = g2d.createBuffer(bsp_g2d::IGraphics2D::BufferType::Mapped, output);
@@ -48,6 +49,55 @@ inline int g2dResizeToHost(bsp_g2d::IGraphics2D& g2d,
     return ret;
 }
 
+/**
+ * @brief Letterbox / resize / color convert / normalize input into outputData.buf in one
+ * IGraphics2D::imagePreprocess call, and store the scale and pads in params for postProcess.
+ * outputData.buf keeps its allocation across frames.
+ */
+inline int g2dPreprocessToTensor(bsp_g2d::IGraphics2D& g2d,
+                                 const bsp_perf::bsp_image::ImageView& input,
+                                 const bsp_g2d::IGraphics2D::PreprocessParams& preprocessParams,
+                                 ObjDetectParams& params,
+                                 IDnnEngine::dnnInput& outputData)
+{
+    const bool isFloat = (preprocessParams.data_type == bsp_g2d::IGraphics2D::TensorDataType::FLOAT32);
+    outputData.index = 0;
+    outputData.shape.width = params.model_input_width;
+    outputData.shape.height = params.model_input_height;
+    outputData.shape.channel = params.model_input_channel;
+    outputData.size = params.model_input_width * params.model_input_height * 3 * (isFloat ? sizeof(float) : 1);
+    outputData.dataType = isFloat ? "float32" : "UINT8";
+    if (outputData.buf.size() != outputData.size)
+    {
+        outputData.buf.resize(outputData.size);
+    }
+
+    auto inputBuffer = g2d.createBuffer(bsp_g2d::IGraphics2D::BufferType::Mapped, input);
+    if (!inputBuffer)
+    {
+        return -1;
+    }
+
+    bsp_g2d::IGraphics2D::PreprocessResult result{};
+    int ret = g2d.imagePreprocess(inputBuffer, outputData.buf.data(), outputData.buf.size(),
+                                  static_cast<uint32_t>(params.model_input_width),
+                                  static_cast<uint32_t>(params.model_input_height),
+                                  preprocessParams, result);
+    g2d.releaseBuffer(inputBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    params.scale_width = result.scale_width;
+    params.scale_height = result.scale_height;
+    params.pads.left = result.pad_left;
+    params.pads.top = result.pad_top;
+    params.pads.right = result.pad_right;
+    params.pads.bottom = result.pad_bottom;
+    return 0;
+}
+
 } // namespace bsp_dnn
 
 #endif // __G2D_PREPROCESS_HELPER_HPP__
@@ -26,18 +26,6 @@ int NvVicResnet18TrafficCamNet::preProcess(ObjDetectParams& params, ObjDetectInp
         return -1;
     }
 
-    // 计算缩放参数（直接拉伸，不保持宽高比）
-    params.scale_width = static_cast<float>(params.model_input_width) / inputImage.desc.width;
-    params.scale_height = static_cast<float>(params.model_input_height) / inputImage.desc.height;
-    params.pads.left = 0;
-    params.pads.top = 0;
-    params.pads.right = 0;
-    params.pads.bottom = 0;
-
-    std::cout << "[NvVicResnet18TrafficCamNet] Input: " << inputImage.desc.width << "x" << inputImage.desc.height
-              << " → Model: " << params.model_input_width << "x" << params.model_input_height 
-              << ", Scale: " << params.scale_width << "x" << params.scale_height << std::endl;
-
     // 修复 stride 为 0 的问题
     size_t input_width_stride = inputImage.desc.widthStride > 0 ?
                                 static_cast<size_t>(inputImage.desc.widthStride) :
@@ -49,79 +37,28 @@ int NvVicResnet18TrafficCamNet::preProcess(ObjDetectParams& params, ObjDetectInp
     inputImage.desc.widthStride = static_cast<uint32_t>(input_width_stride);
     inputImage.desc.heightStride = static_cast<uint32_t>(input_height_stride);
 
-    bsp_perf::bsp_image::ImageView rgbaImage{};
-    int ret = g2dResizeToHost(*m_g2d, inputImage, m_rgb_buffer,
-                              static_cast<uint32_t>(params.model_input_width),
-                              static_cast<uint32_t>(params.model_input_height),
-                              "RGBA8888", rgbaImage);
-    if (ret != 0)
+    // 直接拉伸（不保持宽高比），归一化到 [0, 1]，CHW planar float32
+    // NVIDIA VIC 的 RGBA 表面按 BGRA 字节序输出，按 BGR 取通道即得到 R,G,B
+    IGraphics2D::PreprocessParams preprocessParams{};
+    preprocessParams.tensor_format = "BGR888";
+    preprocessParams.layout = IGraphics2D::TensorLayout::NCHW;
+    preprocessParams.data_type = IGraphics2D::TensorDataType::FLOAT32;
+    preprocessParams.keep_aspect = false;
+    for (int c = 0; c < 3; c++)
     {
-        std::cerr << "[NvVicResnet18TrafficCamNet] Error: imageResize failed with code " << ret << std::endl;
-        return ret;
+        preprocessParams.std[c] = 255.0F;
     }
 
-    std::cout << "[NvVicResnet18TrafficCamNet] Hardware conversion completed" << std::endl;
-
-    // 步骤5: 归一化并转换为 CHW planar 格式 (float32)
-    const float scaleFactor = 0.00392156862745098f; // 1/255
-
-    // 分配输出缓冲区 (CHW格式的float32数据)
-    size_t totalSize = params.model_input_width * params.model_input_height * params.model_input_channel;
-    size_t bytesPerChannel = params.model_input_width * params.model_input_height;
-
-    outputData.index = 0;
-    outputData.shape.width = params.model_input_width;
-    outputData.shape.height = params.model_input_height;
-    outputData.shape.channel = params.model_input_channel;
-    outputData.size = totalSize * sizeof(float);
-    outputData.dataType = "float32";
-
-    if (outputData.buf.size() != outputData.size)
+    int ret = g2dPreprocessToTensor(*m_g2d, inputImage, preprocessParams, params, outputData);
+    if (ret != 0)
     {
-        outputData.buf.resize(outputData.size);
+        std::cerr << "[NvVicResnet18TrafficCamNet] Error: imagePreprocess failed with code " << ret << std::endl;
+        return ret;
     }
 
-    // 转换为 CHW planar 格式并归一化
-    // 注意：输入是 RGBA 格式（4通道），需要提取 RGB 三个通道
-    float* floatPtr = reinterpret_cast<float*>(outputData.buf.data());
-    const uint8_t* rgbaPtr = m_rgb_buffer.data();
-
-    // 使用 BGR 顺序（NVIDIA VIC 输出 BGRA）
-    const bool USE_BGR_ORDER = true;
-    
-    if (USE_BGR_ORDER)
-    {
-        // BGR 顺序：通道映射 [2,1,0] → [R,G,B]
-        for (int c = 0; c < 3; c++)
-        {
-            int srcChannel = 2 - c;  // 反转：B=2, G=1, R=0
-            for (int h = 0; h < params.model_input_height; h++)
-            {
-                for (int w = 0; w < params.model_input_width; w++)
-                {
-                    int srcIndex = (h * params.model_input_width + w) * 4 + srcChannel;
-                    int dstIndex = c * bytesPerChannel + h * params.model_input_width + w;
-                    floatPtr[dstIndex] = rgbaPtr[srcIndex] * scaleFactor;
-                }
-            }
-        }
-    }
-    else
-    {
-        // RGB 顺序（标准）
-        for (int c = 0; c < 3; c++)
-        {
-            for (int h = 0; h < params.model_input_height; h++)
-            {
-                for (int w = 0; w < params.model_input_width; w++)
-                {
-                    int srcIndex = (h * params.model_input_width + w) * 4 + c;
-                    int dstIndex = c * bytesPerChannel + h * params.model_input_width + w;
-                    floatPtr[dstIndex] = rgbaPtr[srcIndex] * scaleFactor;
-                }
-            }
-        }
-    }
+    std::cout << "[NvVicResnet18TrafficCamNet] Input: " << inputImage.desc.width << "x" << inputImage.desc.height
+              << " → Model: " << params.model_input_width << "x" << params.model_input_height
+              << ", Scale: " << params.scale_width << "x" << params.scale_height << std::endl;
 
     std::cout << "[NvVicResnet18TrafficCamNet] Preprocessing completed successfully" << std::endl;
 
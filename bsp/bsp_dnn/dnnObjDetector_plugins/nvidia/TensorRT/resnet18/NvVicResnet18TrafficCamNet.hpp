@@ -120,7 +120,6 @@ private:
 
 private:
     std::unique_ptr<IGraphics2D> m_g2d{nullptr};
-    std::vector<uint8_t> m_rgb_buffer{};  // RGBA buffer for intermediate processing (NvVic output)
     std::vector<std::string> m_labels;
     bool m_labelsLoaded{false};
 
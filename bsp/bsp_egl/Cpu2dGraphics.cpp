@@ -23,12 +23,18 @@ SOFTWARE.
 */
 
 #include "Cpu2dGraphics.hpp"
+#include <shared/BspParallel.hpp>
 #include <algorithm>
 #include <cstring>
 #include <cmath>
 
 namespace bsp_egl {
 
+using bsp_perf::shared::BspParallel;
+
+// 每个分块的最少行数，行数更少时拆分的开销大于收益
+constexpr int MIN_CHUNK_ROWS = 16;
+
 // 静态辅助函数：HSV到RGB转换
 Cpu2dGraphics::Color Cpu2dGraphics::Color::fromHSV(float h, float s, float v) {
     // 确保参数在有效范围内
@@ -119,28 +125,34 @@ void Cpu2dGraphics::fillRectGradient(int x, int y, int width, int height,
     int x2 = std::min(static_cast<int>(m_width), x + width);
     int y2 = std::min(static_cast<int>(m_height), y + height);
 
-    // 水平渐变
-    for (int row = y1; row < y2; ++row) {
-        uint32_t* line = &m_framebuffer[row * m_width];
-        for (int col = x1; col < x2; ++col) {
-            // 计算插值比例
-            float t = static_cast<float>(col - x) / width;
-            t = std::clamp(t, 0.0f, 1.0f);
-
-            // 插值颜色
-            Color c;
-            c.r = colorLeft.r + static_cast<uint8_t>((colorRight.r - colorLeft.r) * t);
-            c.g = colorLeft.g + static_cast<uint8_t>((colorRight.g - colorLeft.g) * t);
-            c.b = colorLeft.b + static_cast<uint8_t>((colorRight.b - colorLeft.b) * t);
-            c.a = colorLeft.a + static_cast<uint8_t>((colorRight.a - colorLeft.a) * t);
-
-            if (c.a == 255) {
-                line[col] = colorToUint32(c);
-            } else {
-                line[col] = blendColor(line[col], c);
+    // 水平渐变：每列颜色与行无关，先算一行颜色再按行分块并行填充
+    std::vector<Color> colors(x2 - x1);
+    for (int col = x1; col < x2; ++col) {
+        // 计算插值比例
+        float t = static_cast<float>(col - x) / width;
+        t = std::clamp(t, 0.0f, 1.0f);
+
+        // 插值颜色
+        Color& c = colors[col - x1];
+        c.r = colorLeft.r + static_cast<uint8_t>((colorRight.r - colorLeft.r) * t);
+        c.g = colorLeft.g + static_cast<uint8_t>((colorRight.g - colorLeft.g) * t);
+        c.b = colorLeft.b + static_cast<uint8_t>((colorRight.b - colorLeft.b) * t);
+        c.a = colorLeft.a + static_cast<uint8_t>((colorRight.a - colorLeft.a) * t);
+    }
+
+    BspParallel::getInstance().parallelFor(y2 - y1, MIN_CHUNK_ROWS, 1, [&](int begin, int end) {
+        for (int row = y1 + begin; row < y1 + end; ++row) {
+            uint32_t* line = &m_framebuffer[row * m_width];
+            for (int col = x1; col < x2; ++col) {
+                const Color& c = colors[col - x1];
+                if (c.a == 255) {
+                    line[col] = colorToUint32(c);
+                } else {
+                    line[col] = blendColor(line[col], c);
+                }
             }
         }
-    }
+    });
 }
 
 void Cpu2dGraphics::setPixel(int x, int y, const Color& color)
@@ -166,50 +178,56 @@ void Cpu2dGraphics::fillRainbow(RainbowDirection direction,
     saturation = std::clamp(saturation, 0.0f, 1.0f);
     brightness = std::clamp(brightness, 0.0f, 1.0f);
 
+    auto& parallel = BspParallel::getInstance();
     switch (direction) {
         case RainbowDirection::Horizontal: {
-            // 水平彩虹：从左（红色，H=0）到右（紫色，H=300）
-            for (uint32_t y = 0; y < m_height; ++y) {
-                uint32_t* line = &m_framebuffer[y * m_width];
-                for (uint32_t x = 0; x < m_width; ++x) {
-                    float t = static_cast<float>(x) / (m_width - 1);
-                    float hue = t * 300.0f;  // 0-300度，完整彩虹色谱
-                    Color c = Color::fromHSV(hue, saturation, brightness);
-                    line[x] = colorToUint32(c);
-                }
+            // 水平彩虹：从左（红色，H=0）到右（紫色，H=300），每行相同，算一行后拷贝
+            std::vector<uint32_t> pixels(m_width);
+            for (uint32_t x = 0; x < m_width; ++x) {
+                float t = static_cast<float>(x) / (m_width - 1);
+                float hue = t * 300.0f;  // 0-300度，完整彩虹色谱
+                Color c = Color::fromHSV(hue, saturation, brightness);
+                pixels[x] = colorToUint32(c);
             }
+            parallel.parallelFor(m_height, MIN_CHUNK_ROWS, 1, [&](int begin, int end) {
+                for (int y = begin; y < end; ++y) {
+                    std::memcpy(&m_framebuffer[y * m_width], pixels.data(), m_width * sizeof(uint32_t));
+                }
+            });
             break;
         }
 
         case RainbowDirection::Vertical: {
             // 垂直彩虹：从上（红色）到下（紫色）
-            for (uint32_t y = 0; y < m_height; ++y) {
-                float t = static_cast<float>(y) / (m_height - 1);
-                float hue = t * 300.0f;
-                Color c = Color::fromHSV(hue, saturation, brightness);
-                uint32_t pixel = colorToUint32(c);
+            parallel.parallelFor(m_height, MIN_CHUNK_ROWS, 1, [&](int begin, int end) {
+                for (int y = begin; y < end; ++y) {
+                    float t = static_cast<float>(y) / (m_height - 1);
+                    float hue = t * 300.0f;
+                    Color c = Color::fromHSV(hue, saturation, brightness);
+                    uint32_t pixel = colorToUint32(c);
 
-                uint32_t* line = &m_framebuffer[y * m_width];
-                for (uint32_t x = 0; x < m_width; ++x) {
-                    line[x] = pixel;
+                    uint32_t* line = &m_framebuffer[y * m_width];
+                    std::fill(line, line + m_width, pixel);
                 }
-            }
+            });
             break;
         }
 
         case RainbowDirection::Diagonal: {
             // 对角彩虹：从左上到右下
             float maxDist = std::sqrt(m_width * m_width + m_height * m_height);
-            for (uint32_t y = 0; y < m_height; ++y) {
-                uint32_t* line = &m_framebuffer[y * m_width];
-                for (uint32_t x = 0; x < m_width; ++x) {
-                    float dist = std::sqrt(x * x + y * y);
-                    float t = dist / maxDist;
-                    float hue = t * 300.0f;
-                    Color c = Color::fromHSV(hue, saturation, brightness);
-                    line[x] = colorToUint32(c);
+            parallel.parallelFor(m_height, MIN_CHUNK_ROWS, 1, [&](int begin, int end) {
+                for (uint32_t y = begin; y < static_cast<uint32_t>(end); ++y) {
+                    uint32_t* line = &m_framebuffer[y * m_width];
+                    for (uint32_t x = 0; x < m_width; ++x) {
+                        float dist = std::sqrt(x * x + y * y);
+                        float t = dist / maxDist;
+                        float hue = t * 300.0f;
+                        Color c = Color::fromHSV(hue, saturation, brightness);
+                        line[x] = colorToUint32(c);
+                    }
                 }
-            }
+            });
             break;
         }
 
@@ -219,18 +237,20 @@ void Cpu2dGraphics::fillRainbow(RainbowDirection direction,
             float centerY = m_height / 2.0f;
             float maxRadius = std::sqrt(centerX * centerX + centerY * centerY);
 
-            for (uint32_t y = 0; y < m_height; ++y) {
-                uint32_t* line = &m_framebuffer[y * m_width];
-                for (uint32_t x = 0; x < m_width; ++x) {
-                    float dx = x - centerX;
-                    float dy = y - centerY;
-                    float radius = std::sqrt(dx * dx + dy * dy);
-                    float t = radius / maxRadius;
-                    float hue = t * 300.0f;
-                    Color c = Color::fromHSV(hue, saturation, brightness);
-                    line[x] = colorToUint32(c);
+            parallel.parallelFor(m_height, MIN_CHUNK_ROWS, 1, [&](int begin, int end) {
+                for (uint32_t y = begin; y < static_cast<uint32_t>(end); ++y) {
+                    uint32_t* line = &m_framebuffer[y * m_width];
+                    for (uint32_t x = 0; x < m_width; ++x) {
+                        float dx = x - centerX;
+                        float dy = y - centerY;
+                        float radius = std::sqrt(dx * dx + dy * dy);
+                        float t = radius / maxRadius;
+                        float hue = t * 300.0f;
+                        Color c = Color::fromHSV(hue, saturation, brightness);
+                        line[x] = colorToUint32(c);
+                    }
                 }
-            }
+            });
             break;
         }
     }
@@ -46,6 +46,70 @@ private:
     void* m_data{nullptr};
 };
 
+/**
+ * @brief RAII host view of a buffer, mapping DmaBuf / hardware memory on demand
+ *
+ * Host buffers are passed through untouched. Other buffers are mapped with
+ * IGraphics2D::mapBuffer for the lifetime of the object, the host view keeps the
+ * desc and row stride of the buffer view, so e.g. OpenCvImageAdapter::toMat can
+ * wrap it without a copy.
+ *
+ * @param g2d IGraphics2D instance that created the buffer
+ * @param buffer Buffer to access from the CPU
+ * @param access_mode Access mode: "readwrite", "read", "write"
+ */
+class MappedImageView
+{
+public:
+    MappedImageView(IGraphics2D* g2d,
+                    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer,
+                    const std::string& access_mode = "readwrite")
+        : m_g2d(g2d), m_buffer(buffer)
+    {
+        if (!m_buffer) {
+            return;
+        }
+        if (m_buffer->view.memoryType == bsp_perf::bsp_image::ImageMemoryType::Host) {
+            m_view = m_buffer->view;
+            return;
+        }
+        if (!m_g2d) {
+            return;
+        }
+
+        void* data = m_g2d->mapBuffer(m_buffer, access_mode);
+        if (data == nullptr) {
+            return;
+        }
+        m_mapped = true;
+        const auto access = access_mode == "read" ? bsp_perf::bsp_image::ImageAccess::ReadOnly :
+            (access_mode == "write" ? bsp_perf::bsp_image::ImageAccess::WriteOnly :
+                                      bsp_perf::bsp_image::ImageAccess::ReadWrite);
+        m_view = bsp_perf::bsp_image::makeHostImageView(static_cast<uint8_t*>(data), m_buffer->view.desc,
+                                                        m_buffer->view.planes[0].rowStride, access);
+    }
+
+    ~MappedImageView()
+    {
+        if (m_mapped) {
+            m_g2d->unmapBuffer(m_buffer);
+        }
+    }
+
+    const bsp_perf::bsp_image::ImageView& view() const { return m_view; }
+    explicit operator bool() const { return !m_view.empty(); }
+
+    // Disable copy
+    MappedImageView(const MappedImageView&) = delete;
+    MappedImageView& operator=(const MappedImageView&) = delete;
+
+private:
+    IGraphics2D* m_g2d;
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> m_buffer;
+    bsp_perf::bsp_image::ImageView m_view{};
+    bool m_mapped{false};
+};
+
 /**
  * @brief RAII guard class for managing buffer synchronization
  * 
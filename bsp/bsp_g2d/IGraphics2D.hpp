@@ -1,21 +1,31 @@
 #ifndef __IGRAPHICS2D_HPP__
 #define __IGRAPHICS2D_HPP__
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 #include <any>
 #include <bsp_image/ImageBuffer.hpp>
 
 namespace bsp_g2d
 {
 
+namespace impl
+{
+class G2dBufferCache;
+} // namespace impl
+
+class ImageOpGraph;
+
 class IGraphics2D
 {
 public:
     // ========== Factory ==========
     /**
      * @brief Factory function to create an instance of IGraphics2D.
-     * @param g2dPlatform Graphics platform: "rkrga", "nvvic"
+     * @param g2dPlatform Graphics platform: "rkrga", "nvvic", "cpu"
      * @return std::unique_ptr<IGraphics2D>
      */
     static std::unique_ptr<IGraphics2D> create(const std::string& g2dPlatform);
@@ -57,6 +67,58 @@ public:
         Bidirectional   // 双向同步
     };
 
+    /**
+     * @brief 缩放插值方式
+     */
+    enum class Interpolation
+    {
+        Bilinear,
+        Nearest
+    };
+
+    /**
+     * @brief DNN 输入张量布局与数据类型
+     */
+    enum class TensorLayout
+    {
+        NHWC,
+        NCHW
+    };
+
+    enum class TensorDataType
+    {
+        UINT8,
+        FLOAT32
+    };
+
+    /**
+     * @brief 融合预处理参数（缩放 + 颜色转换 + letterbox + 归一化）
+     */
+    struct PreprocessParams
+    {
+        std::string tensor_format{"RGB888"};    // 张量通道顺序: "RGB888" 或 "BGR888"
+        TensorLayout layout{TensorLayout::NHWC};
+        TensorDataType data_type{TensorDataType::UINT8};
+        bool keep_aspect{true};                 // true: 等比缩放并居中填充, false: 直接拉伸
+        uint8_t pad_value{114};                 // 填充像素值（归一化前）
+        float mean[3]{0.0F, 0.0F, 0.0F};        // FLOAT32: (pixel - mean) / std，按张量通道顺序
+        float std[3]{1.0F, 1.0F, 1.0F};
+        Interpolation interpolation{Interpolation::Bilinear};
+    };
+
+    /**
+     * @brief 预处理结果，与 ObjDetectParams 的 scale_width/scale_height/pads 对应
+     */
+    struct PreprocessResult
+    {
+        float scale_width{1.0F};
+        float scale_height{1.0F};
+        int pad_left{0};
+        int pad_top{0};
+        int pad_right{0};
+        int pad_bottom{0};
+    };
+
     struct ImageRect
     {
         int x;        /* upper-left x */
@@ -65,6 +127,19 @@ public:
         int height;   /* height */
     };
 
+    /**
+     * @brief ImageView 重载的缓冲区注册缓存统计
+     */
+    struct BufferCacheStats
+    {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};      // 超出容量被 LRU 淘汰
+        uint64_t invalidations{0};  // 被 invalidateBufferCache 移除
+        size_t entries{0};
+        size_t capacity{0};
+    };
+
     // ========== Buffer Management (New Interface) ==========
     
     /**
@@ -143,6 +218,34 @@ public:
      */
     virtual void unmapBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer) = 0;
 
+    // ========== Buffer Registration Cache ==========
+
+    /**
+     * @brief 设置 ImageView 重载（imageResize / imageCopy / imageCvtColor / imageCvtColorToHost）的缓冲区缓存容量
+     *
+     * 启用后按（数据指针或 fd + offset，ImageDesc，BufferType）做 LRU 缓存，
+     * 同一块解码输出 / 编码输入内存只导入一次，避免每帧 createBuffer / releaseBuffer。
+     * 命中的 Mapped 源缓冲区会先 syncBuffer(CpuToDevice)（VIC 需要重新拷贝主机数据）。
+     *
+     * ⚠️ 缓存只认内存地址：释放或重新分配了已缓存的内存后，必须调用 invalidateBufferCache(view)，
+     * 否则新内存恰好复用同一地址时会命中旧的导入。逐帧分配的临时内存用完即应失效。
+     *
+     * @param capacity 最大缓存条目数，0 关闭缓存（默认）
+     */
+    void setBufferCacheCapacity(size_t capacity);
+
+    /**
+     * @brief 释放所有缓存的缓冲区
+     */
+    void invalidateBufferCache();
+
+    /**
+     * @brief 释放与 image 共用内存的缓存条目（不区分 desc / BufferType）
+     */
+    void invalidateBufferCache(const bsp_perf::bsp_image::ImageView& image);
+
+    BufferCacheStats getBufferCacheStats() const;
+
     // ========== Platform Capabilities ==========
     
     /**
@@ -157,7 +260,7 @@ public:
 
     /**
      * @brief 获取平台名称
-     * @return "rkrga", "nvvic"
+     * @return "rkrga", "nvvic", "cpu"
      */
     virtual std::string getPlatformName() const = 0;
     // ========== Image Operations ==========
@@ -174,21 +277,39 @@ public:
         std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
         std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst) = 0;
 
+    /**
+     * @brief 指定插值方式的图像缩放
+     *
+     * 平台支持：
+     * - CPU: ✅ Bilinear / Nearest
+     * - RGA / VIC: 由硬件决定插值方式，interpolation 被忽略
+     */
+    virtual int imageResize(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+        Interpolation interpolation)
+    {
+        (void)interpolation;
+        return imageResize(src, dst);
+    }
+
     int imageResize(const bsp_perf::bsp_image::ImageView& src,
                     const bsp_perf::bsp_image::ImageView& dst,
                     BufferType type = BufferType::Mapped)
     {
-        auto srcBuffer = createBuffer(type, src);
-        auto dstBuffer = createBuffer(type, dst);
+        bool srcCached = false;
+        bool dstCached = false;
+        auto srcBuffer = acquireViewBuffer(type, src, true, srcCached);
+        auto dstBuffer = acquireViewBuffer(type, dst, false, dstCached);
         if (!srcBuffer || !dstBuffer) {
-            releaseBuffer(srcBuffer);
-            releaseBuffer(dstBuffer);
+            releaseViewBuffer(srcBuffer, srcCached);
+            releaseViewBuffer(dstBuffer, dstCached);
             return -1;
         }
 
         const int ret = imageResize(srcBuffer, dstBuffer);
-        releaseBuffer(srcBuffer);
-        releaseBuffer(dstBuffer);
+        releaseViewBuffer(srcBuffer, srcCached);
+        releaseViewBuffer(dstBuffer, dstCached);
         return ret;
     }
 
@@ -208,17 +329,19 @@ public:
                   const bsp_perf::bsp_image::ImageView& dst,
                   BufferType type = BufferType::Mapped)
     {
-        auto srcBuffer = createBuffer(type, src);
-        auto dstBuffer = createBuffer(type, dst);
+        bool srcCached = false;
+        bool dstCached = false;
+        auto srcBuffer = acquireViewBuffer(type, src, true, srcCached);
+        auto dstBuffer = acquireViewBuffer(type, dst, false, dstCached);
         if (!srcBuffer || !dstBuffer) {
-            releaseBuffer(srcBuffer);
-            releaseBuffer(dstBuffer);
+            releaseViewBuffer(srcBuffer, srcCached);
+            releaseViewBuffer(dstBuffer, dstCached);
             return -1;
         }
 
         const int ret = imageCopy(srcBuffer, dstBuffer);
-        releaseBuffer(srcBuffer);
-        releaseBuffer(dstBuffer);
+        releaseViewBuffer(srcBuffer, srcCached);
+        releaseViewBuffer(dstBuffer, dstCached);
         return ret;
     }
 
@@ -240,17 +363,19 @@ public:
                       const bsp_perf::bsp_image::ImageView& dst,
                       BufferType type = BufferType::Mapped)
     {
-        auto srcBuffer = createBuffer(type, src);
-        auto dstBuffer = createBuffer(type, dst);
+        bool srcCached = false;
+        bool dstCached = false;
+        auto srcBuffer = acquireViewBuffer(type, src, true, srcCached);
+        auto dstBuffer = acquireViewBuffer(type, dst, false, dstCached);
         if (!srcBuffer || !dstBuffer) {
-            releaseBuffer(srcBuffer);
-            releaseBuffer(dstBuffer);
+            releaseViewBuffer(srcBuffer, srcCached);
+            releaseViewBuffer(dstBuffer, dstCached);
             return -1;
         }
 
         const int ret = imageCvtColor(srcBuffer, dstBuffer, src.desc.format, dst.desc.format);
-        releaseBuffer(srcBuffer);
-        releaseBuffer(dstBuffer);
+        releaseViewBuffer(srcBuffer, srcCached);
+        releaseViewBuffer(dstBuffer, dstCached);
         return ret;
     }
 
@@ -259,11 +384,13 @@ public:
                             BufferType type = BufferType::Mapped,
                             bool syncDstToCpu = true)
     {
-        auto srcBuffer = createBuffer(type, src);
-        auto dstBuffer = createBuffer(type, dst);
+        bool srcCached = false;
+        bool dstCached = false;
+        auto srcBuffer = acquireViewBuffer(type, src, true, srcCached);
+        auto dstBuffer = acquireViewBuffer(type, dst, false, dstCached);
         if (!srcBuffer || !dstBuffer) {
-            releaseBuffer(srcBuffer);
-            releaseBuffer(dstBuffer);
+            releaseViewBuffer(srcBuffer, srcCached);
+            releaseViewBuffer(dstBuffer, dstCached);
             return -1;
         }
 
@@ -272,8 +399,8 @@ public:
             ret = syncBuffer(dstBuffer, SyncDirection::DeviceToCpu);
         }
 
-        releaseBuffer(srcBuffer);
-        releaseBuffer(dstBuffer);
+        releaseViewBuffer(srcBuffer, srcCached);
+        releaseViewBuffer(dstBuffer, dstCached);
         return ret;
     }
 
@@ -283,6 +410,7 @@ public:
      * 平台支持：
      * - RGA: ✅ 支持（imrectangle）
      * - VIC: ❌ 不支持（返回 -1）
+     * - CPU: ✅ 支持（软件绘制，thickness <= 0 时填充）
      * 
      * @param dst 目标缓冲区
      * @param rect 矩形区域
@@ -296,12 +424,106 @@ public:
         uint32_t color,
         int thickness) = 0;
 
-    virtual ~IGraphics2D() = default;
+    // ========== Batch Operations ==========
+
+    /**
+     * @brief 批量缩放：srcs[i] → dsts[i]，作为一个任务提交
+     *
+     * 平台支持：
+     * - RGA: ✅ im2d job（imbeginJob / improcessTask / imendJob）
+     * - VIC: ✅ NvBufSurfTransformAsync 流水提交，最后统一等待
+     * - CPU: ✅ 任务在工作线程间并行
+     *
+     * @param srcs 源缓冲区
+     * @param dsts 目标缓冲区（数量与 srcs 相同，可以是同一个缓冲区）
+     * @param dst_rects 可选，写入 dsts[i] 中的区域（拼接马赛克）；为空时写满整个 dst
+     * @return 0 成功，-1 失败
+     */
+    virtual int imageResizeBatch(
+        const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+        const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+        const std::vector<ImageRect>& dst_rects = {});
+
+    /**
+     * @brief 批量裁剪缩放：src 中的 rois[i] → dsts[i]（如二级分类器的 N 个检测框）
+     *
+     * ROI 超出 src 的部分被裁掉；YUV420 格式的 ROI 起点向下对齐到偶数
+     *
+     * @return 0 成功，-1 失败/不支持
+     */
+    virtual int imageCropResizeBatch(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+        const std::vector<ImageRect>& rois,
+        const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts);
+
+    /**
+     * @brief 批量绘制矩形
+     *
+     * 平台支持：
+     * - RGA: ✅ imrectangleArray（一次提交）
+     * - VIC: ❌ 不支持（返回 -1）
+     * - CPU: ✅ 支持
+     *
+     * @return 0 成功，-1 失败/不支持
+     */
+    virtual int imageDrawRectangles(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+        const std::vector<ImageRect>& rects,
+        uint32_t color,
+        int thickness);
+
+    /**
+     * @brief DNN 融合预处理：缩放 + 颜色转换 + letterbox + 归一化，直接写入推理引擎输入缓冲区
+     *
+     * 平台支持：
+     * - CPU: ✅ 单次遍历（逐行缩放、转换并写入张量，无整帧中间图像）
+     * - RGA / VIC: 默认实现，硬件缩放到 RGBA8888 中间图像后由 CPU 写入张量
+     *
+     * @param src 源缓冲区（NV12/NV21/I420 或 RGB 系列）
+     * @param dst 张量内存，大小至少 dst_width * dst_height * 3 * sizeof(元素)
+     * @param dst_size dst 字节数
+     * @param dst_width 模型输入宽度
+     * @param dst_height 模型输入高度
+     * @param params 预处理参数
+     * @param result 输出缩放比例与填充
+     * @return 0 成功，-1 失败
+     */
+    virtual int imagePreprocess(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+        void* dst,
+        size_t dst_size,
+        uint32_t dst_width,
+        uint32_t dst_height,
+        const PreprocessParams& params,
+        PreprocessResult& result);
+
+    virtual ~IGraphics2D();
 
 protected:
-    IGraphics2D() = default;
+    IGraphics2D();
     IGraphics2D(const IGraphics2D&) = delete;
     IGraphics2D& operator=(const IGraphics2D&) = delete;
+
+    /**
+     * @brief ImageView 重载使用：缓存启用时返回缓存的缓冲区（cached = true），否则 createBuffer
+     * @param input true 表示源缓冲区，命中时同步到设备
+     */
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> acquireViewBuffer(
+        BufferType type,
+        const bsp_perf::bsp_image::ImageView& image,
+        bool input,
+        bool& cached);
+
+    /**
+     * @brief 与 acquireViewBuffer 配对：缓存的缓冲区保留，其余 releaseBuffer
+     */
+    void releaseViewBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer, bool cached);
+
+    // 操作图在阶段之间直接传递缓冲区，同样经过缓冲区缓存
+    friend class ImageOpGraph;
+
+private:
+    std::unique_ptr<impl::G2dBufferCache> m_bufferCache;
 };
 
 } // namespace bsp_g2d
@@ -0,0 +1,152 @@
+#ifndef __IMAGE_OP_GRAPH_HPP__
+#define __IMAGE_OP_GRAPH_HPP__
+
+#include "IGraphics2D.hpp"
+#include <bsp_image/ImageBufferPool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bsp_g2d
+{
+
+/**
+ * @brief Declarative chain of IGraphics2D operations, planned once and run per frame
+ *
+ *     ImageOpGraph graph(*g2d);
+ *     graph.crop(roi).cvtColor("RGB888").resize(640, 640);
+ *     graph.plan(frame.desc);
+ *     graph.run(frame, output);      // per frame
+ *
+ * plan() resolves the format and size after every op and fuses runs of crop / cvtColor /
+ * resize into stages, each stage is a single backend call (the cpu backend resamples and
+ * converts in one row pass, RGA / VIC do both in one job). A trailing preprocess absorbs
+ * the color conversions in front of it. Stages run back to back on backend buffers, only
+ * the final output is synced to the CPU. Intermediate images come from an ImageBufferPool
+ * and stay imported through the IGraphics2D buffer cache, so steady state frames allocate
+ * and import nothing.
+ *
+ * Not thread safe, use one graph per thread (they may share the IGraphics2D).
+ */
+class ImageOpGraph
+{
+public:
+    static constexpr char LOG_TAG[] {"[ImageOpGraph]: "};
+
+    /**
+     * @brief One backend call of the planned graph.
+     */
+    struct Stage
+    {
+        std::string ops{};                  // fused ops, e.g. "crop+cvtColor+resize"
+        bool crop{false};
+        IGraphics2D::ImageRect rect{};      // crop in stage input coordinates, clamped
+        bool preprocess{false};
+        IGraphics2D::Interpolation interpolation{IGraphics2D::Interpolation::Bilinear};
+        bsp_perf::bsp_image::ImageDesc input{};
+        bsp_perf::bsp_image::ImageDesc output{};    // tensor stage: model input size
+    };
+
+    explicit ImageOpGraph(IGraphics2D& g2d);
+    ~ImageOpGraph();
+
+    ImageOpGraph(const ImageOpGraph&) = delete;
+    ImageOpGraph& operator=(const ImageOpGraph&) = delete;
+
+    // ========== Building (invalidates the plan) ==========
+
+    ImageOpGraph& crop(const IGraphics2D::ImageRect& rect);
+    ImageOpGraph& cvtColor(const std::string& format);
+    ImageOpGraph& resize(uint32_t width, uint32_t height,
+                         IGraphics2D::Interpolation interpolation = IGraphics2D::Interpolation::Bilinear);
+
+    /**
+     * @brief DNN preprocess into a tensor, must be the last op (see IGraphics2D::imagePreprocess).
+     */
+    ImageOpGraph& preprocess(uint32_t width, uint32_t height, const IGraphics2D::PreprocessParams& params);
+
+    void clear();
+
+    // ========== Planning ==========
+
+    /**
+     * @brief Resolve formats and sizes for inputs described by input and fuse the ops into stages.
+     * Raises the IGraphics2D buffer cache capacity to hold the input, output and intermediates.
+     * @return 0 success, -1 empty graph, preprocess not last or crop outside of the image
+     */
+    int plan(const bsp_perf::bsp_image::ImageDesc& input);
+
+    bool planned() const { return m_planned; }
+    const std::vector<Stage>& stages() const { return m_stages; }
+
+    /**
+     * @brief Image produced by run(input, output), the desc output must match (strides may differ).
+     */
+    const bsp_perf::bsp_image::ImageDesc& outputDesc() const { return m_outputDesc; }
+
+    // ========== Running ==========
+
+    /**
+     * @brief Run an image graph (no preprocess), input must match the planned desc.
+     * @return 0 success, -1 failure
+     */
+    int run(const bsp_perf::bsp_image::ImageView& input, const bsp_perf::bsp_image::ImageView& output);
+
+    /**
+     * @brief Run a graph ending in preprocess, tensor is written like IGraphics2D::imagePreprocess.
+     * @return 0 success, -1 failure
+     */
+    int run(const bsp_perf::bsp_image::ImageView& input, void* tensor, size_t tensorSize,
+            IGraphics2D::PreprocessResult& result);
+
+    bsp_perf::bsp_image::ImageBufferPool::Stats poolStats() const { return m_pool->stats(); }
+
+private:
+    enum class OpType
+    {
+        Crop,
+        CvtColor,
+        Resize,
+        Preprocess
+    };
+
+    struct Op
+    {
+        OpType type{OpType::CvtColor};
+        IGraphics2D::ImageRect rect{};
+        std::string format{};
+        uint32_t width{0};
+        uint32_t height{0};
+        IGraphics2D::Interpolation interpolation{IGraphics2D::Interpolation::Bilinear};
+        IGraphics2D::PreprocessParams params{};
+    };
+
+    ImageOpGraph& addOp(Op op);
+
+    /**
+     * @brief Execute the stages, the last one writes to output (image graph) or the tensor.
+     */
+    int execute(const bsp_perf::bsp_image::ImageView& input, const bsp_perf::bsp_image::ImageView* output,
+                void* tensor, size_t tensorSize, IGraphics2D::PreprocessResult* result);
+
+    int runStage(const Stage& stage, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+                 std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                 void* tensor, size_t tensorSize, IGraphics2D::PreprocessResult* result);
+
+private:
+    IGraphics2D& m_g2d;
+    std::vector<Op> m_ops;
+    std::vector<Stage> m_stages;
+    bool m_planned{false};
+    bool m_tensorOutput{false};
+    IGraphics2D::PreprocessParams m_preprocessParams{};
+    bsp_perf::bsp_image::ImageDesc m_inputDesc{};
+    bsp_perf::bsp_image::ImageDesc m_outputDesc{};
+    std::unique_ptr<bsp_perf::bsp_image::ImageBufferPool> m_pool;
+};
+
+} // namespace bsp_g2d
+
+#endif // __IMAGE_OP_GRAPH_HPP__
@@ -0,0 +1,107 @@
+#ifndef __OVERLAY_COMPOSITOR_HPP__
+#define __OVERLAY_COMPOSITOR_HPP__
+
+#include "IGraphics2D.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bsp_g2d
+{
+
+/**
+ * @brief CPU overlay renderer for annotating frames in their own format
+ *
+ * Boxes, filled label backgrounds and 5x7 bitmap font text are queued for a frame and
+ * drawn by one render() call straight into the planes of NV12 / NV21 / I420 or packed
+ * RGB888 / BGR888 / RGBA8888 / BGRA8888 host images, so detection results can be
+ * annotated without converting the frame to RGB and back. Colors are ARGB8888 like
+ * IGraphics2D::imageDrawRectangle, alpha < 0xff blends with the image using the SIMD
+ * row kernels of the cpu backend. On 4:2:0 images chroma is drawn at chroma resolution:
+ * box edges are rounded outward to even pixels and text colors every chroma sample that
+ * covers a glyph pixel.
+ *
+ * Items are drawn in the order they were added. Not thread safe, use one per thread.
+ */
+class OverlayCompositor
+{
+public:
+    static constexpr char LOG_TAG[] {"[OverlayCompositor]: "};
+    static constexpr int GLYPH_WIDTH{5};
+    static constexpr int GLYPH_HEIGHT{7};
+    static constexpr int GLYPH_ADVANCE{GLYPH_WIDTH + 1};
+
+    OverlayCompositor() = default;
+    OverlayCompositor(const OverlayCompositor&) = delete;
+    OverlayCompositor& operator=(const OverlayCompositor&) = delete;
+    ~OverlayCompositor() = default;
+
+    /**
+     * @brief Rectangle outline, thickness <= 0 fills it.
+     */
+    void addRectangle(const IGraphics2D::ImageRect& rect, uint32_t color, int thickness);
+
+    /**
+     * @brief Text with its top left corner at (x, y), each font pixel drawn as scale x scale.
+     * A background alpha > 0 fills the text bounds plus a scale pixel margin first.
+     * Characters outside printable ASCII are drawn as '?'.
+     */
+    void addText(int x, int y, const std::string& text, uint32_t color, int scale = 1, uint32_t background = 0);
+
+    /**
+     * @brief Detection style box: outline in color plus the label on a color filled tab
+     * above the box (inside it when there is no room above the image top).
+     */
+    void addLabeledBox(const IGraphics2D::ImageRect& rect, const std::string& label, uint32_t color,
+                       uint32_t textColor = 0xffffffff, int thickness = 2, int scale = 1);
+
+    /**
+     * @brief Draw every queued item into a host image, the queue is kept (see clear()).
+     * @return 0 success, -1 unsupported format / non host memory
+     */
+    int render(const bsp_perf::bsp_image::ImageView& image);
+
+    void clear();
+    size_t size() const { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+
+    static int textWidth(const std::string& text, int scale = 1);
+    static int textHeight(int scale = 1);
+
+private:
+    enum class ItemType
+    {
+        Rectangle,
+        Text
+    };
+
+    struct Item
+    {
+        ItemType type{ItemType::Rectangle};
+        IGraphics2D::ImageRect rect{};
+        uint32_t color{0};
+        int thickness{0};
+        int scale{1};
+        std::string text{};
+    };
+
+    struct Plane;
+    struct Target;
+
+    void renderRectangle(Target& target, const Item& item);
+    void renderText(Target& target, const Item& item);
+    void blendSpan(Plane& plane, uint32_t color, int row, int x0, int x1);
+
+private:
+    std::vector<Item> m_items;
+    // scratch reused across frames: one color row per plane and the text coverage mask
+    std::array<std::vector<uint8_t>, 3> m_colorRows;
+    std::vector<uint8_t> m_mask;
+    std::vector<uint8_t> m_maskRow;
+};
+
+} // namespace bsp_g2d
+
+#endif // __OVERLAY_COMPOSITOR_HPP__
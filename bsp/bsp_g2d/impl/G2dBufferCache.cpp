@@ -0,0 +1,173 @@
+#include "G2dBufferCache.hpp"
+#include <algorithm>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+bool G2dBufferCache::Key::operator==(const Key& other) const
+{
+    if ((type != other.type) || (memoryType != other.memoryType) || (planeCount != other.planeCount))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < planeCount; ++i)
+    {
+        if ((data[i] != other.data[i]) || (fd[i] != other.fd[i]) ||
+            (offset[i] != other.offset[i]) || (rowStride[i] != other.rowStride[i]))
+        {
+            return false;
+        }
+    }
+    return (width == other.width) && (height == other.height) &&
+           (widthStride == other.widthStride) && (heightStride == other.heightStride) &&
+           (dataSize == other.dataSize) && (format == other.format);
+}
+
+bool G2dBufferCache::Key::sameMemory(const Key& other) const
+{
+    if ((fd[0] >= 0) || (other.fd[0] >= 0))
+    {
+        return (fd[0] == other.fd[0]) && (offset[0] == other.offset[0]);
+    }
+    return data[0] == other.data[0];
+}
+
+G2dBufferCache::Key G2dBufferCache::makeKey(IGraphics2D::BufferType type, const bsp_perf::bsp_image::ImageView& image)
+{
+    Key key{};
+    key.type = type;
+    key.memoryType = image.memoryType;
+    key.planeCount = std::min<uint32_t>(image.planeCount, static_cast<uint32_t>(image.planes.size()));
+    for (uint32_t i = 0; i < key.planeCount; ++i)
+    {
+        key.data[i] = image.planes[i].data;
+        key.fd[i] = image.planes[i].fd;
+        key.offset[i] = image.planes[i].offset;
+        key.rowStride[i] = image.planes[i].rowStride;
+    }
+    key.width = image.desc.width;
+    key.height = image.desc.height;
+    key.widthStride = image.desc.widthStride;
+    key.heightStride = image.desc.heightStride;
+    key.dataSize = image.desc.dataSize;
+    key.format = image.desc.format;
+    return key;
+}
+
+std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> G2dBufferCache::lookup(IGraphics2D::BufferType type,
+                                                                          const bsp_perf::bsp_image::ImageView& image)
+{
+    const Key key = makeKey(type, image);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const Entry& entry) {return entry.key == key;});
+    if (it == m_entries.end())
+    {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return m_entries.front().buffer;
+}
+
+std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> G2dBufferCache::insert(IGraphics2D::BufferType type,
+    const bsp_perf::bsp_image::ImageView& image, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer)
+{
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> evicted;
+    Key key = makeKey(type, image);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0)
+    {
+        evicted.push_back(std::move(buffer));
+        return evicted;
+    }
+
+    // another thread may have inserted the same view meanwhile, keep the newest buffer
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const Entry& entry) {return entry.key == key;});
+    if (it != m_entries.end())
+    {
+        evicted.push_back(std::move(it->buffer));
+        m_entries.erase(it);
+    }
+    m_entries.push_front(Entry{std::move(key), std::move(buffer)});
+    trim(evicted);
+    return evicted;
+}
+
+std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> G2dBufferCache::invalidate(const bsp_perf::bsp_image::ImageView& image)
+{
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> removed;
+    const Key key = makeKey(IGraphics2D::BufferType::Mapped, image);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (it->key.sameMemory(key))
+        {
+            removed.push_back(std::move(it->buffer));
+            it = m_entries.erase(it);
+            ++m_invalidations;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> G2dBufferCache::clear()
+{
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> removed;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    removed.reserve(m_entries.size());
+    for (auto& entry : m_entries)
+    {
+        removed.push_back(std::move(entry.buffer));
+    }
+    m_invalidations += m_entries.size();
+    m_entries.clear();
+    return removed;
+}
+
+std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> G2dBufferCache::setCapacity(size_t capacity)
+{
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> evicted;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    trim(evicted);
+    return evicted;
+}
+
+bool G2dBufferCache::enabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity > 0;
+}
+
+IGraphics2D::BufferCacheStats G2dBufferCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    IGraphics2D::BufferCacheStats stats{};
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.invalidations = m_invalidations;
+    stats.entries = m_entries.size();
+    stats.capacity = m_capacity;
+    return stats;
+}
+
+void G2dBufferCache::trim(std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& evicted)
+{
+    while (m_entries.size() > m_capacity)
+    {
+        evicted.push_back(std::move(m_entries.back().buffer));
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+} // namespace impl
+} // namespace bsp_g2d
@@ -0,0 +1,111 @@
+#ifndef __G2D_BUFFER_CACHE_HPP__
+#define __G2D_BUFFER_CACHE_HPP__
+
+#include <bsp_g2d/IGraphics2D.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+/**
+ * @brief LRU cache of buffers created for the ImageView overloads of IGraphics2D.
+ *
+ * Entries are keyed on the view memory (plane data pointers or dma-buf fds + offsets),
+ * the image desc and the buffer type, so the same decoder output / encoder input
+ * memory is imported once instead of on every frame. The cache only keeps the
+ * bookkeeping, creating and releasing buffers stays with IGraphics2D.
+ */
+class G2dBufferCache
+{
+public:
+    explicit G2dBufferCache(size_t capacity = 0): m_capacity(capacity) {}
+    G2dBufferCache(const G2dBufferCache&) = delete;
+    G2dBufferCache& operator=(const G2dBufferCache&) = delete;
+    ~G2dBufferCache() = default;
+
+    /**
+     * @brief Cached buffer for the view or nullptr, a hit moves the entry to the front.
+     */
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> lookup(IGraphics2D::BufferType type,
+                                                              const bsp_perf::bsp_image::ImageView& image);
+
+    /**
+     * @brief Add a buffer, returns the entries pushed out to stay within the capacity.
+     */
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> insert(IGraphics2D::BufferType type,
+        const bsp_perf::bsp_image::ImageView& image, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer);
+
+    /**
+     * @brief Drop every entry sharing memory with the view (any desc / buffer type).
+     */
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> invalidate(const bsp_perf::bsp_image::ImageView& image);
+
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> clear();
+
+    /**
+     * @brief Change the capacity, 0 disables caching. Returns the entries that no longer fit.
+     */
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> setCapacity(size_t capacity);
+
+    bool enabled() const;
+
+    IGraphics2D::BufferCacheStats stats() const;
+
+private:
+    struct Key
+    {
+        IGraphics2D::BufferType type{IGraphics2D::BufferType::Mapped};
+        bsp_perf::bsp_image::ImageMemoryType memoryType{bsp_perf::bsp_image::ImageMemoryType::Host};
+        uint32_t planeCount{0};
+        const uint8_t* data[4]{};
+        int fd[4]{-1, -1, -1, -1};
+        size_t offset[4]{};
+        uint32_t rowStride[4]{};
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t widthStride{0};
+        uint32_t heightStride{0};
+        size_t dataSize{0};
+        std::string format{};
+
+        bool operator==(const Key& other) const;
+
+        /**
+         * @brief True when both keys reference the same first plane memory.
+         */
+        bool sameMemory(const Key& other) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer;
+    };
+
+    static Key makeKey(IGraphics2D::BufferType type, const bsp_perf::bsp_image::ImageView& image);
+
+    void trim(std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& evicted);
+
+private:
+    mutable std::mutex m_mutex;
+    size_t m_capacity{0};
+    // most recently used first, capacities are small so a linear search beats hashing the key
+    std::list<Entry> m_entries;
+    uint64_t m_hits{0};
+    uint64_t m_misses{0};
+    uint64_t m_evictions{0};
+    uint64_t m_invalidations{0};
+};
+
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __G2D_BUFFER_CACHE_HPP__
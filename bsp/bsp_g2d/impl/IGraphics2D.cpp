@@ -1,4 +1,7 @@
 #include <bsp_g2d/IGraphics2D.hpp>
+#include "cpu/Cpu2dGraphics2D.hpp"
+#include "PreprocessTensor.hpp"
+#include "G2dBufferCache.hpp"
 
 #ifdef BUILD_PLATFORM_RK35XX
 #include "rk_rga/rkrga.hpp"
@@ -8,12 +11,18 @@
 #include "nv_vic/NvVicGraphics2D.hpp"
 #endif
 
+#include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <vector>
 namespace bsp_g2d
 {
 std::unique_ptr<IGraphics2D> IGraphics2D::create(const std::string& g2dPlatform)
 {
+    if (g2dPlatform.compare("cpu") == 0)
+    {
+        return std::make_unique<Cpu2dGraphics2D>();
+    }
 #ifdef BUILD_PLATFORM_RK35XX
     if (g2dPlatform.compare("rkrga") == 0)
     {
@@ -26,10 +35,197 @@ std::unique_ptr<IGraphics2D> IGraphics2D::create(const std::string& g2dPlatform)
         return std::make_unique<NvVicGraphics2D>();
     }
 #endif
-    else
+    throw std::invalid_argument("Invalid G2D platform specified: " + g2dPlatform);
+}
+
+IGraphics2D::IGraphics2D()
+    : m_bufferCache(std::make_unique<impl::G2dBufferCache>())
+{
+}
+
+// cached entries are dropped without releaseBuffer here, the backend is already gone; backends
+// free what they created in their own destructor or through ImageBuffer::release
+IGraphics2D::~IGraphics2D() = default;
+
+void IGraphics2D::setBufferCacheCapacity(size_t capacity)
+{
+    for (auto& buffer : m_bufferCache->setCapacity(capacity))
+    {
+        releaseBuffer(buffer);
+    }
+}
+
+void IGraphics2D::invalidateBufferCache()
+{
+    for (auto& buffer : m_bufferCache->clear())
+    {
+        releaseBuffer(buffer);
+    }
+}
+
+void IGraphics2D::invalidateBufferCache(const bsp_perf::bsp_image::ImageView& image)
+{
+    for (auto& buffer : m_bufferCache->invalidate(image))
+    {
+        releaseBuffer(buffer);
+    }
+}
+
+IGraphics2D::BufferCacheStats IGraphics2D::getBufferCacheStats() const
+{
+    return m_bufferCache->stats();
+}
+
+std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> IGraphics2D::acquireViewBuffer(
+    BufferType type, const bsp_perf::bsp_image::ImageView& image, bool input, bool& cached)
+{
+    cached = false;
+    if (!m_bufferCache->enabled())
+    {
+        return createBuffer(type, image);
+    }
+
+    auto buffer = m_bufferCache->lookup(type, image);
+    if (buffer)
+    {
+        // backends that copy Mapped data in at createBuffer (VIC) must see the new frame contents
+        if (input && (type == BufferType::Mapped) && (syncBuffer(buffer, SyncDirection::CpuToDevice) != 0))
+        {
+            return nullptr;
+        }
+        cached = true;
+        return buffer;
+    }
+
+    buffer = createBuffer(type, image);
+    if (!buffer)
+    {
+        return nullptr;
+    }
+    // the capacity may drop to 0 concurrently, then the new buffer comes straight back
+    cached = true;
+    for (auto& evicted : m_bufferCache->insert(type, image, buffer))
+    {
+        if (evicted == buffer)
+        {
+            cached = false;
+            continue;
+        }
+        releaseBuffer(evicted);
+    }
+    return buffer;
+}
+
+void IGraphics2D::releaseViewBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer, bool cached)
+{
+    if (!cached)
     {
-        throw std::invalid_argument("Invalid G2D platform specified: " + g2dPlatform);
+        releaseBuffer(buffer);
     }
 }
 
-}
\ No newline at end of file
+int IGraphics2D::imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+                                  const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+                                  const std::vector<ImageRect>& dst_rects)
+{
+    if ((srcs.size() != dsts.size()) || (!dst_rects.empty() && (dst_rects.size() != dsts.size())))
+    {
+        std::cerr << "IGraphics2D: imageResizeBatch needs one dst (and dst rect) per src" << std::endl;
+        return -1;
+    }
+    if (!dst_rects.empty())
+    {
+        std::cerr << "IGraphics2D: " << getPlatformName() << " does not support imageResizeBatch dst_rects" << std::endl;
+        return -1;
+    }
+
+    for (size_t i = 0; i < srcs.size(); ++i)
+    {
+        if (imageResize(srcs[i], dsts[i]) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int IGraphics2D::imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+                                      const std::vector<ImageRect>& rois,
+                                      const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts)
+{
+    (void)src;
+    (void)rois;
+    (void)dsts;
+    std::cerr << "IGraphics2D: " << getPlatformName() << " does not support imageCropResizeBatch" << std::endl;
+    return -1;
+}
+
+int IGraphics2D::imageDrawRectangles(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                                     const std::vector<ImageRect>& rects, uint32_t color, int thickness)
+{
+    for (auto rect : rects)
+    {
+        if (imageDrawRectangle(dst, rect, color, thickness) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int IGraphics2D::imagePreprocess(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, void* dst, size_t dst_size,
+                                 uint32_t dst_width, uint32_t dst_height, const PreprocessParams& params, PreprocessResult& result)
+{
+    if (!src)
+    {
+        return -1;
+    }
+
+    impl::LetterboxGeometry geometry;
+    impl::TensorWriter writer;
+    if ((impl::computeLetterbox(src->view.desc.width, src->view.desc.height, dst_width, dst_height, params.keep_aspect, geometry) != 0) ||
+        (writer.init(dst, dst_size, dst_width, dst_height, params) != 0))
+    {
+        return -1;
+    }
+
+    // hardware scales and converts into an RGBA8888 image (every engine supports it), the tensor pass runs on the cpu
+    bsp_perf::bsp_image::ImageDesc desc{};
+    desc.width = static_cast<uint32_t>(geometry.content_width);
+    desc.height = static_cast<uint32_t>(geometry.content_height);
+    desc.widthStride = desc.width;
+    desc.heightStride = desc.height;
+    desc.format = "RGBA8888";
+    desc.dataSize = bsp_perf::bsp_image::imageDataSize(desc);
+
+    thread_local std::vector<uint8_t> storage;
+    storage.resize(desc.dataSize);
+    auto resized = createBuffer(BufferType::Mapped, bsp_perf::bsp_image::makeHostImageView(storage.data(), desc));
+    if (!resized)
+    {
+        return -1;
+    }
+
+    int ret = imageResize(src, resized, params.interpolation);
+    if (ret == 0)
+    {
+        ret = syncBuffer(resized, SyncDirection::DeviceToCpu);
+    }
+    releaseBuffer(resized);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    const size_t row_bytes = static_cast<size_t>(geometry.content_width) * 4;
+    for (int y = 0; y < geometry.content_height; ++y)
+    {
+        writer.writePixels(geometry.result.pad_top + y, geometry.result.pad_left, storage.data() + y * row_bytes,
+                           geometry.content_width, 4, 0);
+    }
+    writer.fillPadding(geometry, 0, static_cast<int>(dst_height));
+    result = geometry.result;
+    return 0;
+}
+
+}
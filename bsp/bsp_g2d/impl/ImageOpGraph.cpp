@@ -0,0 +1,432 @@
+#include <bsp_g2d/ImageOpGraph.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace bsp_g2d
+{
+
+constexpr char ImageOpGraph::LOG_TAG[];
+
+namespace
+{
+
+using bsp_perf::bsp_image::ImageBuffer;
+using bsp_perf::bsp_image::ImageDesc;
+using bsp_perf::bsp_image::ImageView;
+using bsp_perf::bsp_image::PixelFormat;
+
+bool isYuv420(const std::string& format)
+{
+    const auto& info = bsp_perf::bsp_image::pixelFormatInfo(bsp_perf::bsp_image::pixelFormatFromString(format));
+    return info.yuv && (info.planeCount > 1) && (info.planes[1].hsub == 2) && (info.planes[1].vsub == 2);
+}
+
+ImageDesc makeDesc(uint32_t width, uint32_t height, const std::string& format)
+{
+    ImageDesc desc{};
+    desc.width = width;
+    desc.height = height;
+    desc.widthStride = width;
+    desc.heightStride = height;
+    desc.format = format;
+    desc.dataSize = bsp_perf::bsp_image::imageDataSize(desc);
+    return desc;
+}
+
+bool sameImage(const ImageDesc& a, const ImageDesc& b)
+{
+    return (a.width == b.width) && (a.height == b.height) && (a.format == b.format);
+}
+
+void appendOp(std::string& ops, const char* name)
+{
+    if (!ops.empty())
+    {
+        ops += "+";
+    }
+    ops += name;
+}
+
+} // namespace
+
+ImageOpGraph::ImageOpGraph(IGraphics2D& g2d):
+    m_g2d(g2d)
+{
+    bsp_perf::bsp_image::ImageBufferPool::Options options{};
+    // a recycled block may come back at the same address with another desc, drop its import first
+    options.onFree = [this](uint8_t* data) {
+        m_g2d.invalidateBufferCache(bsp_perf::bsp_image::makeHostImageView(data, ImageDesc{}));
+    };
+    m_pool = std::make_unique<bsp_perf::bsp_image::ImageBufferPool>(options);
+}
+
+ImageOpGraph::~ImageOpGraph()
+{
+    // ~ImageBufferPool does not call onFree, trim so the cached imports of intermediates go too
+    m_pool->trim();
+}
+
+ImageOpGraph& ImageOpGraph::addOp(Op op)
+{
+    m_ops.push_back(std::move(op));
+    m_planned = false;
+    return *this;
+}
+
+ImageOpGraph& ImageOpGraph::crop(const IGraphics2D::ImageRect& rect)
+{
+    Op op{};
+    op.type = OpType::Crop;
+    op.rect = rect;
+    return addOp(std::move(op));
+}
+
+ImageOpGraph& ImageOpGraph::cvtColor(const std::string& format)
+{
+    Op op{};
+    op.type = OpType::CvtColor;
+    op.format = format;
+    return addOp(std::move(op));
+}
+
+ImageOpGraph& ImageOpGraph::resize(uint32_t width, uint32_t height, IGraphics2D::Interpolation interpolation)
+{
+    Op op{};
+    op.type = OpType::Resize;
+    op.width = width;
+    op.height = height;
+    op.interpolation = interpolation;
+    return addOp(std::move(op));
+}
+
+ImageOpGraph& ImageOpGraph::preprocess(uint32_t width, uint32_t height, const IGraphics2D::PreprocessParams& params)
+{
+    Op op{};
+    op.type = OpType::Preprocess;
+    op.width = width;
+    op.height = height;
+    op.params = params;
+    return addOp(std::move(op));
+}
+
+void ImageOpGraph::clear()
+{
+    m_ops.clear();
+    m_stages.clear();
+    m_planned = false;
+}
+
+int ImageOpGraph::plan(const ImageDesc& input)
+{
+    m_planned = false;
+    m_stages.clear();
+    m_tensorOutput = false;
+    if (m_ops.empty() || input.empty())
+    {
+        std::cerr << LOG_TAG << "plan needs ops and an input image" << std::endl;
+        return -1;
+    }
+
+    m_inputDesc = input;
+    ImageDesc current = makeDesc(input.width, input.height, input.format);
+    Stage stage{};
+    stage.input = current;
+    bool resized = false;
+    bool converted = false;
+
+    // a stage that changes nothing is dropped, the next one reads its input directly
+    auto closeStage = [&]() {
+        stage.output = current;
+        if (stage.crop || !sameImage(stage.input, stage.output))
+        {
+            m_stages.push_back(stage);
+        }
+        stage = Stage{};
+        stage.input = current;
+        resized = false;
+        converted = false;
+    };
+
+    for (size_t i = 0; i < m_ops.size(); ++i)
+    {
+        const Op& op = m_ops[i];
+        switch (op.type)
+        {
+        case OpType::Crop:
+        {
+            // crop reads the stage input, it cannot follow a resize or a color change in the same call
+            if (stage.crop || resized || converted)
+            {
+                closeStage();
+            }
+
+            const int width = static_cast<int>(current.width);
+            const int height = static_cast<int>(current.height);
+            int x0 = std::clamp(op.rect.x, 0, width);
+            int y0 = std::clamp(op.rect.y, 0, height);
+            const int x1 = std::clamp(op.rect.x + op.rect.width, 0, width);
+            const int y1 = std::clamp(op.rect.y + op.rect.height, 0, height);
+            if (isYuv420(current.format))
+            {
+                // same alignment as the backends apply to 4:2:0 sources
+                x0 &= ~1;
+                y0 &= ~1;
+            }
+            if ((x0 >= x1) || (y0 >= y1))
+            {
+                std::cerr << LOG_TAG << "crop (" << op.rect.x << "," << op.rect.y << " " << op.rect.width << "x"
+                          << op.rect.height << ") outside of the " << width << "x" << height << " image" << std::endl;
+                return -1;
+            }
+            stage.crop = true;
+            stage.rect = IGraphics2D::ImageRect{x0, y0, x1 - x0, y1 - y0};
+            // the backends crop with their default (bilinear) filter
+            stage.interpolation = IGraphics2D::Interpolation::Bilinear;
+            appendOp(stage.ops, "crop");
+            current = makeDesc(static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0), current.format);
+            break;
+        }
+        case OpType::CvtColor:
+            if (bsp_perf::bsp_image::pixelFormatFromString(op.format) == PixelFormat::Unknown)
+            {
+                std::cerr << LOG_TAG << "cvtColor to unknown format " << op.format << std::endl;
+                return -1;
+            }
+            appendOp(stage.ops, "cvtColor");
+            converted = converted || (op.format != current.format);
+            current = makeDesc(current.width, current.height, op.format);
+            break;
+        case OpType::Resize:
+            if ((op.width == 0) || (op.height == 0))
+            {
+                std::cerr << LOG_TAG << "resize to an empty size" << std::endl;
+                return -1;
+            }
+            if (resized)
+            {
+                closeStage();
+            }
+            if (!stage.crop)
+            {
+                stage.interpolation = op.interpolation;
+            }
+            appendOp(stage.ops, "resize");
+            resized = true;
+            current = makeDesc(op.width, op.height, current.format);
+            break;
+        case OpType::Preprocess:
+        {
+            if (i + 1 != m_ops.size())
+            {
+                std::cerr << LOG_TAG << "preprocess must be the last op" << std::endl;
+                return -1;
+            }
+            if ((op.width == 0) || (op.height == 0))
+            {
+                std::cerr << LOG_TAG << "preprocess to an empty tensor" << std::endl;
+                return -1;
+            }
+
+            Stage tensorStage{};
+            if (!stage.crop && !resized)
+            {
+                // preprocess converts to the tensor format itself, color changes in front of it are free
+                tensorStage.ops = stage.ops;
+                tensorStage.input = stage.input;
+                stage = Stage{};
+            }
+            else
+            {
+                closeStage();
+                tensorStage.input = current;
+            }
+            appendOp(tensorStage.ops, "preprocess");
+            tensorStage.preprocess = true;
+            tensorStage.interpolation = op.params.interpolation;
+            tensorStage.output = makeDesc(op.width, op.height, op.params.tensor_format);
+            m_stages.push_back(tensorStage);
+            m_preprocessParams = op.params;
+            m_tensorOutput = true;
+            current = tensorStage.output;
+            break;
+        }
+        }
+    }
+
+    if (!m_tensorOutput)
+    {
+        closeStage();
+        if (m_stages.empty())
+        {
+            // every op was a no-op, run(input, output) still has to fill the output
+            Stage copyStage{};
+            copyStage.ops = "copy";
+            copyStage.input = current;
+            copyStage.output = current;
+            m_stages.push_back(copyStage);
+        }
+    }
+    m_outputDesc = current;
+
+    // the input, the output and every intermediate stay imported between frames
+    const size_t wanted = m_stages.size() + 1;
+    auto cacheStats = m_g2d.getBufferCacheStats();
+    if (cacheStats.capacity < wanted)
+    {
+        m_g2d.setBufferCacheCapacity(wanted);
+    }
+
+    m_planned = true;
+    return 0;
+}
+
+int ImageOpGraph::run(const ImageView& input, const ImageView& output)
+{
+    if (m_planned && m_tensorOutput)
+    {
+        std::cerr << LOG_TAG << "graph ends in preprocess, run it with a tensor" << std::endl;
+        return -1;
+    }
+    if (!sameImage(output.desc, m_outputDesc))
+    {
+        std::cerr << LOG_TAG << "output " << output.desc.width << "x" << output.desc.height << " " << output.desc.format
+                  << " does not match the planned " << m_outputDesc.width << "x" << m_outputDesc.height << " "
+                  << m_outputDesc.format << std::endl;
+        return -1;
+    }
+    return execute(input, &output, nullptr, 0, nullptr);
+}
+
+int ImageOpGraph::run(const ImageView& input, void* tensor, size_t tensorSize, IGraphics2D::PreprocessResult& result)
+{
+    if (m_planned && !m_tensorOutput)
+    {
+        std::cerr << LOG_TAG << "graph does not end in preprocess" << std::endl;
+        return -1;
+    }
+    return execute(input, nullptr, tensor, tensorSize, &result);
+}
+
+int ImageOpGraph::execute(const ImageView& input, const ImageView* output, void* tensor, size_t tensorSize,
+                          IGraphics2D::PreprocessResult* result)
+{
+    if (!m_planned)
+    {
+        std::cerr << LOG_TAG << "run before plan" << std::endl;
+        return -1;
+    }
+    if (!sameImage(input.desc, m_inputDesc))
+    {
+        std::cerr << LOG_TAG << "input " << input.desc.width << "x" << input.desc.height << " " << input.desc.format
+                  << " does not match the planned input" << std::endl;
+        return -1;
+    }
+
+    constexpr auto MAPPED = IGraphics2D::BufferType::Mapped;
+    bool inputCached = false;
+    auto inputBuffer = m_g2d.acquireViewBuffer(MAPPED, input, true, inputCached);
+    if (!inputBuffer)
+    {
+        return -1;
+    }
+
+    // at most two intermediates are alive: the one a stage reads and the one it writes,
+    // both are handed between stages as g2d buffers so hardware stages need no syncs
+    std::shared_ptr<ImageBuffer> src = inputBuffer;
+    std::shared_ptr<ImageBuffer> srcHost;
+    bool srcCached = false;
+    int ret = 0;
+    for (size_t i = 0; (i < m_stages.size()) && (ret == 0); ++i)
+    {
+        const Stage& stage = m_stages[i];
+        const bool last = (i + 1 == m_stages.size());
+
+        if (stage.preprocess)
+        {
+            ret = runStage(stage, src, nullptr, tensor, tensorSize, result);
+            break;
+        }
+
+        std::shared_ptr<ImageBuffer> dstHost;
+        ImageView dstView{};
+        if (last)
+        {
+            dstView = *output;
+        }
+        else
+        {
+            dstHost = m_pool->acquire(stage.output);
+            if (!dstHost)
+            {
+                std::cerr << LOG_TAG << "no memory for the " << stage.ops << " intermediate" << std::endl;
+                ret = -1;
+                break;
+            }
+            dstView = dstHost->view;
+        }
+
+        bool dstCached = false;
+        auto dst = m_g2d.acquireViewBuffer(MAPPED, dstView, false, dstCached);
+        if (!dst)
+        {
+            ret = -1;
+            break;
+        }
+
+        ret = runStage(stage, src, dst, nullptr, 0, nullptr);
+        if ((ret == 0) && last)
+        {
+            ret = m_g2d.syncBuffer(dst, IGraphics2D::SyncDirection::DeviceToCpu);
+        }
+
+        if (src != inputBuffer)
+        {
+            m_g2d.releaseViewBuffer(src, srcCached);
+        }
+        src = dst;
+        srcHost = dstHost;
+        srcCached = dstCached;
+    }
+
+    if (src != inputBuffer)
+    {
+        m_g2d.releaseViewBuffer(src, srcCached);
+    }
+    m_g2d.releaseViewBuffer(inputBuffer, inputCached);
+    return ret;
+}
+
+int ImageOpGraph::runStage(const Stage& stage, std::shared_ptr<ImageBuffer> src, std::shared_ptr<ImageBuffer> dst,
+                           void* tensor, size_t tensorSize, IGraphics2D::PreprocessResult* result)
+{
+    int ret = 0;
+    if (stage.preprocess)
+    {
+        ret = m_g2d.imagePreprocess(src, tensor, tensorSize, stage.output.width, stage.output.height,
+                                    m_preprocessParams, *result);
+    }
+    else if (stage.crop)
+    {
+        ret = m_g2d.imageCropResizeBatch(src, {stage.rect}, {dst});
+    }
+    else if ((stage.input.width != stage.output.width) || (stage.input.height != stage.output.height))
+    {
+        ret = m_g2d.imageResize(src, dst, stage.interpolation);
+    }
+    else if (stage.input.format != stage.output.format)
+    {
+        ret = m_g2d.imageCvtColor(src, dst, stage.input.format, stage.output.format);
+    }
+    else
+    {
+        ret = m_g2d.imageCopy(src, dst);
+    }
+
+    if (ret != 0)
+    {
+        std::cerr << LOG_TAG << "stage " << stage.ops << " failed on " << m_g2d.getPlatformName() << std::endl;
+    }
+    return ret;
+}
+
+} // namespace bsp_g2d
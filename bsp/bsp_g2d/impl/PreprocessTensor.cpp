@@ -0,0 +1,208 @@
+#include "PreprocessTensor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+constexpr char TensorWriter::LOG_TAG[];
+
+int computeLetterbox(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height,
+                     bool keep_aspect, LetterboxGeometry& geometry)
+{
+    if ((src_width == 0) || (src_height == 0) || (dst_width == 0) || (dst_height == 0))
+    {
+        return -1;
+    }
+
+    geometry = LetterboxGeometry{};
+    auto& result = geometry.result;
+    if (!keep_aspect)
+    {
+        geometry.content_width = static_cast<int>(dst_width);
+        geometry.content_height = static_cast<int>(dst_height);
+        result.scale_width = static_cast<float>(dst_width) / static_cast<float>(src_width);
+        result.scale_height = static_cast<float>(dst_height) / static_cast<float>(src_height);
+        return 0;
+    }
+
+    const float scale = std::min(static_cast<float>(dst_width) / static_cast<float>(src_width),
+                                 static_cast<float>(dst_height) / static_cast<float>(src_height));
+    geometry.content_width = std::clamp(static_cast<int>(std::lround(src_width * scale)), 1, static_cast<int>(dst_width));
+    geometry.content_height = std::clamp(static_cast<int>(std::lround(src_height * scale)), 1, static_cast<int>(dst_height));
+    result.scale_width = scale;
+    result.scale_height = scale;
+
+    const int pad_width = static_cast<int>(dst_width) - geometry.content_width;
+    const int pad_height = static_cast<int>(dst_height) - geometry.content_height;
+    result.pad_left = pad_width / 2;
+    result.pad_right = pad_width - result.pad_left;
+    result.pad_top = pad_height / 2;
+    result.pad_bottom = pad_height - result.pad_top;
+    return 0;
+}
+
+int TensorWriter::init(void* dst, size_t dst_size, uint32_t width, uint32_t height, const IGraphics2D::PreprocessParams& params)
+{
+    if ((params.tensor_format != "RGB888") && (params.tensor_format != "BGR888"))
+    {
+        std::cerr << LOG_TAG << "unsupported tensor_format: " << params.tensor_format << std::endl;
+        return -1;
+    }
+
+    const size_t element_size = (params.data_type == IGraphics2D::TensorDataType::FLOAT32) ? sizeof(float) : 1;
+    const size_t required = static_cast<size_t>(width) * height * 3 * element_size;
+    if ((dst == nullptr) || (dst_size < required))
+    {
+        std::cerr << LOG_TAG << "tensor buffer of " << dst_size << " bytes too small, need " << required << std::endl;
+        return -1;
+    }
+
+    m_dst = static_cast<uint8_t*>(dst);
+    m_width = static_cast<int>(width);
+    m_height = static_cast<int>(height);
+    m_plane_size = static_cast<size_t>(width) * height;
+    m_layout = params.layout;
+    m_data_type = params.data_type;
+    m_bgr = (params.tensor_format == "BGR888");
+    m_pad_value = params.pad_value;
+
+    if (m_data_type == IGraphics2D::TensorDataType::FLOAT32)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            const float inv_std = (params.std[c] != 0.0F) ? 1.0F / params.std[c] : 1.0F;
+            for (int v = 0; v < 256; ++v)
+            {
+                m_lut[c][v] = (static_cast<float>(v) - params.mean[c]) * inv_std;
+            }
+        }
+    }
+    return 0;
+}
+
+void TensorWriter::writePixels(int y, int x, const uint8_t* pixels, int count, int pixel_stride, int red_index)
+{
+    // source byte feeding tensor channel 0 / 1 / 2
+    const int first = m_bgr ? (2 - red_index) : red_index;
+    const int src_index[3]{first, 1, 2 - first};
+    const size_t offset = static_cast<size_t>(y) * m_width + x;
+
+    if (m_layout == IGraphics2D::TensorLayout::NHWC)
+    {
+        if (m_data_type == IGraphics2D::TensorDataType::UINT8)
+        {
+            uint8_t* out = m_dst + offset * 3;
+            if ((pixel_stride == 3) && (first == 0))
+            {
+                std::memcpy(out, pixels, static_cast<size_t>(count) * 3);
+                return;
+            }
+            for (int i = 0; i < count; ++i, pixels += pixel_stride, out += 3)
+            {
+                out[0] = pixels[src_index[0]];
+                out[1] = pixels[src_index[1]];
+                out[2] = pixels[src_index[2]];
+            }
+            return;
+        }
+
+        float* out = reinterpret_cast<float*>(m_dst) + offset * 3;
+        for (int i = 0; i < count; ++i, pixels += pixel_stride, out += 3)
+        {
+            out[0] = m_lut[0][pixels[src_index[0]]];
+            out[1] = m_lut[1][pixels[src_index[1]]];
+            out[2] = m_lut[2][pixels[src_index[2]]];
+        }
+        return;
+    }
+
+    if (m_data_type == IGraphics2D::TensorDataType::UINT8)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            uint8_t* out = m_dst + c * m_plane_size + offset;
+            const uint8_t* in = pixels + src_index[c];
+            for (int i = 0; i < count; ++i)
+            {
+                out[i] = in[i * pixel_stride];
+            }
+        }
+        return;
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        float* out = reinterpret_cast<float*>(m_dst) + c * m_plane_size + offset;
+        const uint8_t* in = pixels + src_index[c];
+        const float* lut = m_lut[c];
+        for (int i = 0; i < count; ++i)
+        {
+            out[i] = lut[in[i * pixel_stride]];
+        }
+    }
+}
+
+void TensorWriter::fillPad(int y, int x, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    const size_t offset = static_cast<size_t>(y) * m_width + x;
+    if (m_data_type == IGraphics2D::TensorDataType::UINT8)
+    {
+        // same value in every channel, layout does not matter
+        if (m_layout == IGraphics2D::TensorLayout::NHWC)
+        {
+            std::memset(m_dst + offset * 3, m_pad_value, static_cast<size_t>(count) * 3);
+            return;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            std::memset(m_dst + c * m_plane_size + offset, m_pad_value, count);
+        }
+        return;
+    }
+
+    float* tensor = reinterpret_cast<float*>(m_dst);
+    if (m_layout == IGraphics2D::TensorLayout::NHWC)
+    {
+        float* out = tensor + offset * 3;
+        for (int i = 0; i < count; ++i, out += 3)
+        {
+            out[0] = m_lut[0][m_pad_value];
+            out[1] = m_lut[1][m_pad_value];
+            out[2] = m_lut[2][m_pad_value];
+        }
+        return;
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        std::fill_n(tensor + c * m_plane_size + offset, count, m_lut[c][m_pad_value]);
+    }
+}
+
+void TensorWriter::fillPadding(const LetterboxGeometry& geometry, int y_begin, int y_end)
+{
+    const auto& result = geometry.result;
+    const int content_end = result.pad_top + geometry.content_height;
+    for (int y = std::max(y_begin, 0); y < std::min(y_end, m_height); ++y)
+    {
+        if ((y < result.pad_top) || (y >= content_end))
+        {
+            fillPad(y, 0, m_width);
+            continue;
+        }
+        fillPad(y, 0, result.pad_left);
+        fillPad(y, result.pad_left + geometry.content_width, result.pad_right);
+    }
+}
+
+} // namespace impl
+} // namespace bsp_g2d
@@ -0,0 +1,68 @@
+#ifndef __PREPROCESS_TENSOR_HPP__
+#define __PREPROCESS_TENSOR_HPP__
+
+#include <bsp_g2d/IGraphics2D.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+/**
+ * @brief Where the resized image lands inside the model input, plus the scale / pads
+ * handed back to the detector.
+ */
+struct LetterboxGeometry
+{
+    int content_width{0};
+    int content_height{0};
+    IGraphics2D::PreprocessResult result{};
+};
+
+int computeLetterbox(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height,
+                     bool keep_aspect, LetterboxGeometry& geometry);
+
+/**
+ * @brief Writes packed 8 bit pixels into a DNN input tensor: channel order, NHWC / NCHW,
+ * uint8 / float32 with mean / std normalization, and the letterbox padding.
+ * Rows are independent, so bands of rows may be written from several threads.
+ */
+class TensorWriter
+{
+public:
+    static constexpr char LOG_TAG[] {"[TensorWriter]: "};
+
+    int init(void* dst, size_t dst_size, uint32_t width, uint32_t height, const IGraphics2D::PreprocessParams& params);
+
+    /**
+     * @brief Write count pixels starting at tensor (x, y). Source pixels are pixel_stride bytes
+     * apart with R at red_index, G at 1 and B at 2 - red_index.
+     */
+    void writePixels(int y, int x, const uint8_t* pixels, int count, int pixel_stride, int red_index);
+
+    /**
+     * @brief Fill the letterbox border of tensor rows [y_begin, y_end) with the pad value.
+     */
+    void fillPadding(const LetterboxGeometry& geometry, int y_begin, int y_end);
+
+private:
+    void fillPad(int y, int x, int count);
+
+private:
+    uint8_t* m_dst{nullptr};
+    int m_width{0};
+    int m_height{0};
+    size_t m_plane_size{0};
+    IGraphics2D::TensorLayout m_layout{IGraphics2D::TensorLayout::NHWC};
+    IGraphics2D::TensorDataType m_data_type{IGraphics2D::TensorDataType::UINT8};
+    bool m_bgr{false};
+    uint8_t m_pad_value{0};
+    float m_lut[3][256]{};
+};
+
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __PREPROCESS_TENSOR_HPP__
@@ -0,0 +1,1263 @@
+#include "Cpu2dGraphics2D.hpp"
+#include <shared/BspParallel.hpp>
+#include <bsp_g2d/impl/PreprocessTensor.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+namespace bsp_g2d
+{
+
+constexpr char Cpu2dGraphics2D::LOG_TAG[];
+
+namespace
+{
+
+using bsp_perf::bsp_image::ImageBuffer;
+using impl::Cpu2dChroma;
+using impl::Cpu2dKernels;
+using bsp_perf::shared::BspParallel;
+
+// rows per band below which splitting a job costs more than it saves
+constexpr int MIN_BAND_ROWS{16};
+
+enum class CpuFormat
+{
+    Unknown,
+    RGB888,
+    BGR888,
+    RGBA8888,
+    BGRA8888,
+    NV12,
+    NV21,
+    I420
+};
+
+CpuFormat toCpuFormat(const std::string& format)
+{
+    static const std::unordered_map<std::string, CpuFormat> formats{
+        {"RGB888", CpuFormat::RGB888},
+        {"BGR888", CpuFormat::BGR888},
+        {"RGBA8888", CpuFormat::RGBA8888},
+        {"BGRA8888", CpuFormat::BGRA8888},
+        {"YUV420SP", CpuFormat::NV12},
+        {"YCbCr_420_SP", CpuFormat::NV12},
+        {"YCrCb_420_SP", CpuFormat::NV21},
+        {"YUV420P", CpuFormat::I420},
+        {"YCbCr_420_P", CpuFormat::I420},
+    };
+    auto it = formats.find(format);
+    return (it == formats.end()) ? CpuFormat::Unknown : it->second;
+}
+
+bool isYuv420(CpuFormat format)
+{
+    return (format == CpuFormat::NV12) || (format == CpuFormat::NV21) || (format == CpuFormat::I420);
+}
+
+int packedChannels(CpuFormat format)
+{
+    switch (format)
+    {
+    case CpuFormat::RGB888:
+    case CpuFormat::BGR888:
+        return 3;
+    case CpuFormat::RGBA8888:
+    case CpuFormat::BGRA8888:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// byte index of R / B inside a packed pixel
+int redIndex(CpuFormat format)
+{
+    return ((format == CpuFormat::BGR888) || (format == CpuFormat::BGRA8888)) ? 2 : 0;
+}
+
+Cpu2dChroma toChroma(CpuFormat format)
+{
+    if (format == CpuFormat::NV21)
+    {
+        return Cpu2dChroma::NV21;
+    }
+    return (format == CpuFormat::I420) ? Cpu2dChroma::I420 : Cpu2dChroma::NV12;
+}
+
+struct CpuPlane
+{
+    uint8_t* data{nullptr};
+    size_t stride{0};
+    int width{0};
+    int height{0};
+    int channels{0};
+};
+
+struct CpuImage
+{
+    CpuFormat format{CpuFormat::Unknown};
+    int width{0};
+    int height{0};
+    int planeCount{0};
+    CpuPlane planes[3]{};
+};
+
+/**
+ * @brief Plane layout follows the RGA convention: widthStride / heightStride in pixels,
+ * 4:2:0 chroma right after the luma plane with half strides.
+ */
+bool makeCpuImage(uint8_t* data, CpuFormat format, int width, int height, int width_stride, int height_stride,
+                  size_t data_size, CpuImage& image)
+{
+    if ((data == nullptr) || (format == CpuFormat::Unknown) || (width <= 0) || (height <= 0))
+    {
+        return false;
+    }
+
+    image = CpuImage{};
+    image.format = format;
+    image.width = width;
+    image.height = height;
+    width_stride = std::max(width_stride, width);
+    height_stride = std::max(height_stride, height);
+    if (isYuv420(format) && (((width_stride | height_stride) & 1) != 0))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "4:2:0 formats need even strides, got " << width_stride << "x" << height_stride << std::endl;
+        return false;
+    }
+    const size_t luma_size = static_cast<size_t>(width_stride) * height_stride;
+    const int chroma_width = (width + 1) / 2;
+    const int chroma_height = (height + 1) / 2;
+    size_t required = 0;
+
+    if (!isYuv420(format))
+    {
+        const int channels = packedChannels(format);
+        image.planeCount = 1;
+        image.planes[0] = {data, static_cast<size_t>(width_stride) * channels, width, height, channels};
+        required = luma_size * channels;
+    }
+    else if (format == CpuFormat::I420)
+    {
+        const size_t chroma_stride = width_stride / 2;
+        const size_t chroma_size = chroma_stride * (height_stride / 2);
+        image.planeCount = 3;
+        image.planes[0] = {data, static_cast<size_t>(width_stride), width, height, 1};
+        image.planes[1] = {data + luma_size, chroma_stride, chroma_width, chroma_height, 1};
+        image.planes[2] = {data + luma_size + chroma_size, chroma_stride, chroma_width, chroma_height, 1};
+        required = luma_size + chroma_size * 2;
+    }
+    else
+    {
+        image.planeCount = 2;
+        image.planes[0] = {data, static_cast<size_t>(width_stride), width, height, 1};
+        image.planes[1] = {data + luma_size, static_cast<size_t>(width_stride), chroma_width, chroma_height, 2};
+        required = luma_size + luma_size / 2;
+    }
+
+    if ((data_size > 0) && (data_size < required))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "buffer of " << data_size << " bytes too small, need " << required << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint8_t* hostData(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    auto g2dBuffer = impl::getG2DBufferInternal(buffer);
+    if (g2dBuffer && g2dBuffer->hostPtr)
+    {
+        return g2dBuffer->hostPtr;
+    }
+    return buffer ? buffer->view.data() : nullptr;
+}
+
+bool getCpuImage(const std::shared_ptr<ImageBuffer>& buffer, const std::string& format, CpuImage& image)
+{
+    if (!buffer)
+    {
+        return false;
+    }
+    const auto& view = buffer->view;
+    const auto& desc = view.desc;
+    uint8_t* data = hostData(buffer);
+    if (!makeCpuImage(data, toCpuFormat(format), static_cast<int>(desc.width), static_cast<int>(desc.height),
+                      static_cast<int>(desc.widthStride), static_cast<int>(desc.heightStride), desc.dataSize, image))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "unsupported buffer: " << format << " " << desc.width << "x" << desc.height << std::endl;
+        return false;
+    }
+
+    // planes described by the view (e.g. a decoder frame with padded chroma) win over the packed layout
+    if ((view.planeCount > 1) && (static_cast<int>(view.planeCount) == image.planeCount))
+    {
+        for (int i = 0; i < image.planeCount; ++i)
+        {
+            const auto& plane = view.planes[i];
+            if ((plane.offset < view.planes[0].offset) || (plane.rowStride == 0))
+            {
+                continue;
+            }
+            const size_t offset = plane.offset - view.planes[0].offset;
+            const size_t stride = plane.rowStride;
+            const size_t end = offset + stride * (image.planes[i].height - 1) +
+                               static_cast<size_t>(image.planes[i].width) * image.planes[i].channels;
+            if ((stride < static_cast<size_t>(image.planes[i].width) * image.planes[i].channels) ||
+                ((desc.dataSize > 0) && (end > desc.dataSize)))
+            {
+                std::cerr << Cpu2dGraphics2D::LOG_TAG << "plane " << i << " layout outside of the buffer" << std::endl;
+                return false;
+            }
+            image.planes[i].data = data + offset;
+            image.planes[i].stride = stride;
+        }
+    }
+    return true;
+}
+
+// ========== Resize ==========
+
+void buildLinearTable(int src_len, int dst_len, std::vector<int>& idx0, std::vector<int>& idx1, std::vector<int>& weight)
+{
+    idx0.resize(dst_len);
+    idx1.resize(dst_len);
+    weight.resize(dst_len);
+    const double scale = static_cast<double>(src_len) / dst_len;
+    for (int d = 0; d < dst_len; ++d)
+    {
+        // pixel centers aligned, same mapping as cv::INTER_LINEAR and RGA
+        const double f = (d + 0.5) * scale - 0.5;
+        int s = static_cast<int>(std::floor(f));
+        double a = f - s;
+        if (s < 0)
+        {
+            s = 0;
+            a = 0.0;
+        }
+        if (s >= src_len - 1)
+        {
+            s = src_len - 1;
+            a = 0.0;
+        }
+        idx0[d] = s;
+        idx1[d] = std::min(s + 1, src_len - 1);
+        weight[d] = static_cast<int>(std::lround(a * impl::CPU2D_LERP_ONE));
+    }
+}
+
+template <int CH>
+void horizontalLerp(const uint8_t* src, const int* x0, const int* x1, const int* wx, uint16_t* dst, int width)
+{
+    for (int dx = 0; dx < width; ++dx)
+    {
+        const uint8_t* p0 = src + x0[dx];
+        const uint8_t* p1 = src + x1[dx];
+        const int w1 = wx[dx];
+        const int w0 = impl::CPU2D_LERP_ONE - w1;
+        for (int c = 0; c < CH; ++c)
+        {
+            dst[dx * CH + c] = static_cast<uint16_t>(p0[c] * w0 + p1[c] * w1);
+        }
+    }
+}
+
+/**
+ * @brief Separable sampling tables of one plane, x offsets already in bytes.
+ * Nearest is expressed as zero weights so the fused preprocess can share the row path.
+ */
+struct ResizeTables
+{
+    int channels{0};
+    int width{0};
+    std::vector<int> x0, x1, wx, y0, y1, wy;
+};
+
+void buildResizeTables(const CpuPlane& src, int dst_width, int dst_height, IGraphics2D::Interpolation interpolation,
+                       ResizeTables& tables)
+{
+    tables.channels = src.channels;
+    tables.width = dst_width;
+    if (interpolation == IGraphics2D::Interpolation::Nearest)
+    {
+        auto nearest = [](int src_len, int dst_len, std::vector<int>& idx0, std::vector<int>& idx1, std::vector<int>& weight) {
+            idx0.resize(dst_len);
+            weight.assign(dst_len, 0);
+            for (int d = 0; d < dst_len; ++d)
+            {
+                idx0[d] = std::min(static_cast<int>(static_cast<int64_t>(d) * src_len / dst_len), src_len - 1);
+            }
+            idx1 = idx0;
+        };
+        nearest(src.width, dst_width, tables.x0, tables.x1, tables.wx);
+        nearest(src.height, dst_height, tables.y0, tables.y1, tables.wy);
+    }
+    else
+    {
+        buildLinearTable(src.width, dst_width, tables.x0, tables.x1, tables.wx);
+        buildLinearTable(src.height, dst_height, tables.y0, tables.y1, tables.wy);
+    }
+    for (int dx = 0; dx < dst_width; ++dx)
+    {
+        tables.x0[dx] *= src.channels;
+        tables.x1[dx] *= src.channels;
+    }
+}
+
+/**
+ * @brief Per band state of a plane resize. Keeps the last two horizontally interpolated
+ * source rows, so output rows sharing a source row run the horizontal pass once.
+ */
+class RowResampler
+{
+public:
+    RowResampler(const CpuPlane& src, const ResizeTables& tables, const Cpu2dKernels& kernels):
+        m_src(src),
+        m_tables(tables),
+        m_kernels(kernels),
+        m_row_len(static_cast<size_t>(tables.width) * tables.channels)
+    {
+        m_rows[0].resize(m_row_len);
+        m_rows[1].resize(m_row_len);
+    }
+
+    void resampleRow(int dy, uint8_t* dst)
+    {
+        const uint16_t* r0 = fetch(m_tables.y0[dy], m_tables.y1[dy]);
+        const uint16_t* r1 = fetch(m_tables.y1[dy], m_tables.y0[dy]);
+        m_kernels.lerpRows(r0, r1, dst, static_cast<int>(m_row_len), m_tables.wy[dy]);
+    }
+
+private:
+    // horizontally interpolated source row, evicting the slot that does not hold `keep`
+    const uint16_t* fetch(int sy, int keep)
+    {
+        for (int slot = 0; slot < 2; ++slot)
+        {
+            if (m_cached[slot] == sy)
+            {
+                return m_rows[slot].data();
+            }
+        }
+        const int slot = (m_cached[0] == keep) ? 1 : 0;
+        const uint8_t* row = m_src.data + static_cast<size_t>(sy) * m_src.stride;
+        const int* x0 = m_tables.x0.data();
+        const int* x1 = m_tables.x1.data();
+        const int* wx = m_tables.wx.data();
+        uint16_t* out = m_rows[slot].data();
+        switch (m_tables.channels)
+        {
+        case 1:
+            horizontalLerp<1>(row, x0, x1, wx, out, m_tables.width);
+            break;
+        case 2:
+            horizontalLerp<2>(row, x0, x1, wx, out, m_tables.width);
+            break;
+        case 3:
+            horizontalLerp<3>(row, x0, x1, wx, out, m_tables.width);
+            break;
+        default:
+            horizontalLerp<4>(row, x0, x1, wx, out, m_tables.width);
+            break;
+        }
+        m_cached[slot] = sy;
+        return out;
+    }
+
+private:
+    const CpuPlane& m_src;
+    const ResizeTables& m_tables;
+    const Cpu2dKernels& m_kernels;
+    size_t m_row_len{0};
+    std::vector<uint16_t> m_rows[2];
+    int m_cached[2]{-1, -1};
+};
+
+void resizePlaneBilinear(const CpuPlane& src, const CpuPlane& dst, const Cpu2dKernels& kernels)
+{
+    ResizeTables tables;
+    buildResizeTables(src, dst.width, dst.height, IGraphics2D::Interpolation::Bilinear, tables);
+
+    BspParallel::getInstance().parallelFor(dst.height, MIN_BAND_ROWS, 1, [&](int begin, int end) {
+        RowResampler resampler(src, tables, kernels);
+        for (int dy = begin; dy < end; ++dy)
+        {
+            resampler.resampleRow(dy, dst.data + static_cast<size_t>(dy) * dst.stride);
+        }
+    });
+}
+
+void resizePlaneNearest(const CpuPlane& src, const CpuPlane& dst)
+{
+    const int ch = src.channels;
+    std::vector<int> xofs(dst.width);
+    for (int dx = 0; dx < dst.width; ++dx)
+    {
+        xofs[dx] = std::min(static_cast<int>(static_cast<int64_t>(dx) * src.width / dst.width), src.width - 1) * ch;
+    }
+
+    BspParallel::getInstance().parallelFor(dst.height, MIN_BAND_ROWS, 1, [&](int begin, int end) {
+        for (int dy = begin; dy < end; ++dy)
+        {
+            const int sy = std::min(static_cast<int>(static_cast<int64_t>(dy) * src.height / dst.height), src.height - 1);
+            const uint8_t* s = src.data + static_cast<size_t>(sy) * src.stride;
+            uint8_t* d = dst.data + static_cast<size_t>(dy) * dst.stride;
+            switch (ch)
+            {
+            case 1:
+                for (int dx = 0; dx < dst.width; ++dx)
+                {
+                    d[dx] = s[xofs[dx]];
+                }
+                break;
+            case 2:
+                for (int dx = 0; dx < dst.width; ++dx)
+                {
+                    std::memcpy(d + dx * 2, s + xofs[dx], 2);
+                }
+                break;
+            case 3:
+                for (int dx = 0; dx < dst.width; ++dx)
+                {
+                    std::memcpy(d + dx * 3, s + xofs[dx], 3);
+                }
+                break;
+            default:
+                for (int dx = 0; dx < dst.width; ++dx)
+                {
+                    std::memcpy(d + dx * 4, s + xofs[dx], 4);
+                }
+                break;
+            }
+        }
+    });
+}
+
+void resizeImage(const CpuImage& src, const CpuImage& dst, IGraphics2D::Interpolation interpolation, const Cpu2dKernels& kernels)
+{
+    for (int i = 0; i < src.planeCount; ++i)
+    {
+        if (interpolation == IGraphics2D::Interpolation::Nearest)
+        {
+            resizePlaneNearest(src.planes[i], dst.planes[i]);
+        }
+        else
+        {
+            resizePlaneBilinear(src.planes[i], dst.planes[i], kernels);
+        }
+    }
+}
+
+// ========== Copy / color conversion ==========
+
+void copyImage(const CpuImage& src, const CpuImage& dst)
+{
+    for (int i = 0; i < src.planeCount; ++i)
+    {
+        const CpuPlane& s = src.planes[i];
+        const CpuPlane& d = dst.planes[i];
+        const size_t row_bytes = static_cast<size_t>(s.width) * s.channels;
+        if ((s.stride == d.stride) && (s.stride == row_bytes))
+        {
+            BspParallel::getInstance().parallelFor(s.height, MIN_BAND_ROWS * 4, 1, [&](int begin, int end) {
+                std::memcpy(d.data + begin * row_bytes, s.data + begin * row_bytes, (end - begin) * row_bytes);
+            });
+            continue;
+        }
+        BspParallel::getInstance().parallelFor(s.height, MIN_BAND_ROWS * 4, 1, [&](int begin, int end) {
+            for (int y = begin; y < end; ++y)
+            {
+                std::memcpy(d.data + y * d.stride, s.data + y * s.stride, row_bytes);
+            }
+        });
+    }
+}
+
+void yuvToPacked(const CpuImage& src, const CpuImage& dst, const Cpu2dKernels& kernels)
+{
+    const Cpu2dChroma chroma = toChroma(src.format);
+    const int channels = packedChannels(dst.format);
+    const bool swap_rb = (redIndex(dst.format) == 2);
+
+    BspParallel::getInstance().parallelFor(src.height, MIN_BAND_ROWS, 2, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y)
+        {
+            const uint8_t* y_row = src.planes[0].data + y * src.planes[0].stride;
+            const uint8_t* u_row = src.planes[1].data + (y / 2) * src.planes[1].stride;
+            const uint8_t* v_row = (chroma == Cpu2dChroma::I420) ? src.planes[2].data + (y / 2) * src.planes[2].stride : nullptr;
+            kernels.yuv420ToRgbRow(y_row, u_row, v_row, chroma, dst.planes[0].data + y * dst.planes[0].stride,
+                                   src.width, channels, swap_rb);
+        }
+    });
+}
+
+inline void rgbToYuv(int r, int g, int b, uint8_t& y, uint8_t& u, uint8_t& v)
+{
+    // BT.601 limited range, the inverse of the conversion in Cpu2dKernels
+    y = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    u = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    v = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+void writeChroma(const CpuImage& dst, int cx, int cy, uint8_t u, uint8_t v)
+{
+    if (dst.format == CpuFormat::I420)
+    {
+        dst.planes[1].data[cy * dst.planes[1].stride + cx] = u;
+        dst.planes[2].data[cy * dst.planes[2].stride + cx] = v;
+        return;
+    }
+    uint8_t* uv = dst.planes[1].data + cy * dst.planes[1].stride + cx * 2;
+    uv[0] = (dst.format == CpuFormat::NV12) ? u : v;
+    uv[1] = (dst.format == CpuFormat::NV12) ? v : u;
+}
+
+void readChroma(const CpuImage& src, int cx, int cy, uint8_t& u, uint8_t& v)
+{
+    if (src.format == CpuFormat::I420)
+    {
+        u = src.planes[1].data[cy * src.planes[1].stride + cx];
+        v = src.planes[2].data[cy * src.planes[2].stride + cx];
+        return;
+    }
+    const uint8_t* uv = src.planes[1].data + cy * src.planes[1].stride + cx * 2;
+    u = (src.format == CpuFormat::NV12) ? uv[0] : uv[1];
+    v = (src.format == CpuFormat::NV12) ? uv[1] : uv[0];
+}
+
+void packedToYuv(const CpuImage& src, const CpuImage& dst)
+{
+    const int channels = packedChannels(src.format);
+    const int r_idx = redIndex(src.format);
+    const int b_idx = 2 - r_idx;
+
+    BspParallel::getInstance().parallelFor(src.height, MIN_BAND_ROWS, 2, [&](int begin, int end) {
+        for (int y = begin; y < end; y += 2)
+        {
+            const int y_next = std::min(y + 1, src.height - 1);
+            const uint8_t* rows[2]{src.planes[0].data + y * src.planes[0].stride,
+                                   src.planes[0].data + y_next * src.planes[0].stride};
+            uint8_t* y_rows[2]{dst.planes[0].data + y * dst.planes[0].stride,
+                               dst.planes[0].data + y_next * dst.planes[0].stride};
+
+            for (int x = 0; x < src.width; x += 2)
+            {
+                const int x_next = std::min(x + 1, src.width - 1);
+                int r_sum = 0;
+                int g_sum = 0;
+                int b_sum = 0;
+                uint8_t u = 0;
+                uint8_t v = 0;
+                for (int row = 0; row < 2; ++row)
+                {
+                    for (int px : {x, x_next})
+                    {
+                        const uint8_t* p = rows[row] + px * channels;
+                        rgbToYuv(p[r_idx], p[1], p[b_idx], y_rows[row][px], u, v);
+                        r_sum += p[r_idx];
+                        g_sum += p[1];
+                        b_sum += p[b_idx];
+                    }
+                }
+                uint8_t luma = 0;
+                rgbToYuv((r_sum + 2) >> 2, (g_sum + 2) >> 2, (b_sum + 2) >> 2, luma, u, v);
+                writeChroma(dst, x / 2, y / 2, u, v);
+            }
+        }
+    });
+}
+
+void packedToPacked(const CpuImage& src, const CpuImage& dst)
+{
+    const int src_ch = packedChannels(src.format);
+    const int dst_ch = packedChannels(dst.format);
+    const int src_r = redIndex(src.format);
+    const int dst_r = redIndex(dst.format);
+
+    BspParallel::getInstance().parallelFor(src.height, MIN_BAND_ROWS, 1, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y)
+        {
+            const uint8_t* s = src.planes[0].data + y * src.planes[0].stride;
+            uint8_t* d = dst.planes[0].data + y * dst.planes[0].stride;
+            for (int x = 0; x < src.width; ++x, s += src_ch, d += dst_ch)
+            {
+                const uint8_t r = s[src_r];
+                const uint8_t g = s[1];
+                const uint8_t b = s[2 - src_r];
+                d[dst_r] = r;
+                d[1] = g;
+                d[2 - dst_r] = b;
+                if (dst_ch == 4)
+                {
+                    d[3] = (src_ch == 4) ? s[3] : 0xff;
+                }
+            }
+        }
+    });
+}
+
+void yuvToYuv(const CpuImage& src, const CpuImage& dst)
+{
+    CpuImage luma_src = src;
+    CpuImage luma_dst = dst;
+    luma_src.planeCount = 1;
+    luma_dst.planeCount = 1;
+    copyImage(luma_src, luma_dst);
+
+    const CpuPlane& chroma = src.planes[1];
+    BspParallel::getInstance().parallelFor(chroma.height, MIN_BAND_ROWS, 1, [&](int begin, int end) {
+        for (int cy = begin; cy < end; ++cy)
+        {
+            for (int cx = 0; cx < chroma.width; ++cx)
+            {
+                uint8_t u = 0;
+                uint8_t v = 0;
+                readChroma(src, cx, cy, u, v);
+                writeChroma(dst, cx, cy, u, v);
+            }
+        }
+    });
+}
+
+int cvtColorImage(const CpuImage& src, const CpuImage& dst, const Cpu2dKernels& kernels)
+{
+    if ((src.width != dst.width) || (src.height != dst.height))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "imageCvtColor needs equal sizes, use imageResize first" << std::endl;
+        return -1;
+    }
+
+    if (src.format == dst.format)
+    {
+        copyImage(src, dst);
+    }
+    else if (isYuv420(src.format) && isYuv420(dst.format))
+    {
+        yuvToYuv(src, dst);
+    }
+    else if (isYuv420(src.format))
+    {
+        yuvToPacked(src, dst, kernels);
+    }
+    else if (isYuv420(dst.format))
+    {
+        packedToYuv(src, dst);
+    }
+    else
+    {
+        packedToPacked(src, dst);
+    }
+    return 0;
+}
+
+// ========== DNN preprocess ==========
+
+/**
+ * @brief One pass over the output tensor: every row is resampled, converted to RGB and
+ * written (with its letterbox border) straight into the tensor, no full frame intermediates.
+ * 4:2:0 sources resample luma and chroma planes separately and convert the resized rows.
+ */
+void preprocessImage(const CpuImage& src, impl::TensorWriter& writer, const impl::LetterboxGeometry& geometry,
+                     IGraphics2D::Interpolation interpolation, const Cpu2dKernels& kernels, int dst_height)
+{
+    const int content_width = geometry.content_width;
+    const int content_height = geometry.content_height;
+    const int chroma_width = (content_width + 1) / 2;
+    const int pad_left = geometry.result.pad_left;
+    const int pad_top = geometry.result.pad_top;
+    const bool yuv = isYuv420(src.format);
+    const bool i420 = (src.format == CpuFormat::I420);
+
+    ResizeTables tables[3];
+    buildResizeTables(src.planes[0], content_width, content_height, interpolation, tables[0]);
+    for (int i = 1; i < src.planeCount; ++i)
+    {
+        buildResizeTables(src.planes[i], chroma_width, (content_height + 1) / 2, interpolation, tables[i]);
+    }
+
+    BspParallel::getInstance().parallelFor(dst_height, MIN_BAND_ROWS, 2, [&](int begin, int end) {
+        writer.fillPadding(geometry, begin, end);
+        const int row_begin = std::max(begin - pad_top, 0);
+        const int row_end = std::min(end - pad_top, content_height);
+        if (row_begin >= row_end)
+        {
+            return;
+        }
+
+        RowResampler luma(src.planes[0], tables[0], kernels);
+        if (!yuv)
+        {
+            const int channels = src.planes[0].channels;
+            std::vector<uint8_t> row(static_cast<size_t>(content_width) * channels);
+            for (int dy = row_begin; dy < row_end; ++dy)
+            {
+                luma.resampleRow(dy, row.data());
+                writer.writePixels(pad_top + dy, pad_left, row.data(), content_width, channels, redIndex(src.format));
+            }
+            return;
+        }
+
+        RowResampler chroma_u(src.planes[1], tables[1], kernels);
+        std::optional<RowResampler> chroma_v;
+        if (i420)
+        {
+            chroma_v.emplace(src.planes[2], tables[2], kernels);
+        }
+        std::vector<uint8_t> y_row(content_width);
+        std::vector<uint8_t> u_row(static_cast<size_t>(chroma_width) * src.planes[1].channels);
+        std::vector<uint8_t> v_row(i420 ? chroma_width : 0);
+        std::vector<uint8_t> rgb_row(static_cast<size_t>(content_width) * 3);
+        int chroma_row = -1;
+        for (int dy = row_begin; dy < row_end; ++dy)
+        {
+            luma.resampleRow(dy, y_row.data());
+            if ((dy / 2) != chroma_row)
+            {
+                chroma_row = dy / 2;
+                chroma_u.resampleRow(chroma_row, u_row.data());
+                if (chroma_v)
+                {
+                    chroma_v->resampleRow(chroma_row, v_row.data());
+                }
+            }
+            kernels.yuv420ToRgbRow(y_row.data(), u_row.data(), i420 ? v_row.data() : nullptr, toChroma(src.format),
+                                   rgb_row.data(), content_width, 3, false);
+            writer.writePixels(pad_top + dy, pad_left, rgb_row.data(), content_width, 3, 0);
+        }
+    });
+}
+
+// ========== Drawing ==========
+
+void fillRect(const CpuImage& image, int x0, int y0, int x1, int y1, uint32_t color)
+{
+    if ((x0 >= x1) || (y0 >= y1))
+    {
+        return;
+    }
+
+    const uint8_t a = static_cast<uint8_t>(color >> 24);
+    const uint8_t r = static_cast<uint8_t>(color >> 16);
+    const uint8_t g = static_cast<uint8_t>(color >> 8);
+    const uint8_t b = static_cast<uint8_t>(color);
+
+    if (!isYuv420(image.format))
+    {
+        const int channels = packedChannels(image.format);
+        uint8_t pixel[4]{};
+        pixel[redIndex(image.format)] = r;
+        pixel[1] = g;
+        pixel[2 - redIndex(image.format)] = b;
+        pixel[3] = a;
+        for (int y = y0; y < y1; ++y)
+        {
+            uint8_t* row = image.planes[0].data + y * image.planes[0].stride;
+            for (int x = x0; x < x1; ++x)
+            {
+                std::memcpy(row + x * channels, pixel, channels);
+            }
+        }
+        return;
+    }
+
+    uint8_t luma = 0;
+    uint8_t u = 0;
+    uint8_t v = 0;
+    rgbToYuv(r, g, b, luma, u, v);
+    for (int y = y0; y < y1; ++y)
+    {
+        std::memset(image.planes[0].data + y * image.planes[0].stride + x0, luma, x1 - x0);
+    }
+    for (int cy = y0 / 2; cy < (y1 + 1) / 2; ++cy)
+    {
+        for (int cx = x0 / 2; cx < (x1 + 1) / 2; ++cx)
+        {
+            writeChroma(image, cx, cy, u, v);
+        }
+    }
+}
+
+int drawRectangle(const CpuImage& image, const IGraphics2D::ImageRect& rect, uint32_t color, int thickness)
+{
+    const int x0 = std::clamp(rect.x, 0, image.width);
+    const int y0 = std::clamp(rect.y, 0, image.height);
+    const int x1 = std::clamp(rect.x + rect.width, 0, image.width);
+    const int y1 = std::clamp(rect.y + rect.height, 0, image.height);
+    if ((x0 >= x1) || (y0 >= y1))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "imageDrawRectangle rect outside of the image" << std::endl;
+        return -1;
+    }
+
+    if (thickness <= 0)
+    {
+        fillRect(image, x0, y0, x1, y1, color);
+        return 0;
+    }
+
+    fillRect(image, x0, y0, x1, std::min(y0 + thickness, y1), color);
+    fillRect(image, x0, std::max(y1 - thickness, y0), x1, y1, color);
+    fillRect(image, x0, y0, std::min(x0 + thickness, x1), y1, color);
+    fillRect(image, std::max(x1 - thickness, x0), y0, x1, y1, color);
+    return 0;
+}
+
+// ========== Regions / batches ==========
+
+/**
+ * @brief View of rect inside image, clipped to the image. 4:2:0 rects start on even
+ * pixels so the chroma planes stay aligned with luma.
+ */
+bool cropCpuImage(const CpuImage& image, const IGraphics2D::ImageRect& rect, CpuImage& crop)
+{
+    int x0 = std::clamp(rect.x, 0, image.width);
+    int y0 = std::clamp(rect.y, 0, image.height);
+    const int x1 = std::clamp(rect.x + rect.width, 0, image.width);
+    const int y1 = std::clamp(rect.y + rect.height, 0, image.height);
+    if (isYuv420(image.format))
+    {
+        x0 &= ~1;
+        y0 &= ~1;
+    }
+    if ((x0 >= x1) || (y0 >= y1))
+    {
+        std::cerr << Cpu2dGraphics2D::LOG_TAG << "rect (" << rect.x << "," << rect.y << " " << rect.width << "x" << rect.height
+                  << ") outside of the image" << std::endl;
+        return false;
+    }
+
+    const CpuImage parent = image;
+    crop = parent;
+    crop.width = x1 - x0;
+    crop.height = y1 - y0;
+    for (int i = 0; i < crop.planeCount; ++i)
+    {
+        CpuPlane& plane = crop.planes[i];
+        const bool chroma = (i > 0);
+        const int x = chroma ? x0 / 2 : x0;
+        const int y = chroma ? y0 / 2 : y0;
+        plane.data = parent.planes[i].data + static_cast<size_t>(y) * plane.stride + static_cast<size_t>(x) * plane.channels;
+        plane.width = chroma ? (crop.width + 1) / 2 : crop.width;
+        plane.height = chroma ? (crop.height + 1) / 2 : crop.height;
+    }
+    return true;
+}
+
+/**
+ * @brief 4:2:0 -> packed RGB resize and convert in one pass: luma and chroma rows are resampled
+ * band by band and converted straight into dst, the row path of the fused preprocess, so no
+ * source sized RGB intermediate is written and read back.
+ */
+void resizeYuvToPacked(const CpuImage& src, const CpuImage& dst, IGraphics2D::Interpolation interpolation,
+                       const Cpu2dKernels& kernels)
+{
+    const int chroma_width = (dst.width + 1) / 2;
+    const bool i420 = (src.format == CpuFormat::I420);
+    const Cpu2dChroma chroma = toChroma(src.format);
+    const int channels = packedChannels(dst.format);
+    const bool swap_rb = (redIndex(dst.format) == 2);
+
+    ResizeTables tables[3];
+    buildResizeTables(src.planes[0], dst.width, dst.height, interpolation, tables[0]);
+    for (int i = 1; i < src.planeCount; ++i)
+    {
+        buildResizeTables(src.planes[i], chroma_width, (dst.height + 1) / 2, interpolation, tables[i]);
+    }
+
+    BspParallel::getInstance().parallelFor(dst.height, MIN_BAND_ROWS, 2, [&](int begin, int end) {
+        RowResampler luma(src.planes[0], tables[0], kernels);
+        RowResampler chroma_u(src.planes[1], tables[1], kernels);
+        std::optional<RowResampler> chroma_v;
+        if (i420)
+        {
+            chroma_v.emplace(src.planes[2], tables[2], kernels);
+        }
+        std::vector<uint8_t> y_row(dst.width);
+        std::vector<uint8_t> u_row(static_cast<size_t>(chroma_width) * src.planes[1].channels);
+        std::vector<uint8_t> v_row(i420 ? chroma_width : 0);
+        int chroma_row = -1;
+        for (int dy = begin; dy < end; ++dy)
+        {
+            luma.resampleRow(dy, y_row.data());
+            if ((dy / 2) != chroma_row)
+            {
+                chroma_row = dy / 2;
+                chroma_u.resampleRow(chroma_row, u_row.data());
+                if (chroma_v)
+                {
+                    chroma_v->resampleRow(chroma_row, v_row.data());
+                }
+            }
+            kernels.yuv420ToRgbRow(y_row.data(), u_row.data(), i420 ? v_row.data() : nullptr, chroma,
+                                   dst.planes[0].data + static_cast<size_t>(dy) * dst.planes[0].stride,
+                                   dst.width, channels, swap_rb);
+        }
+    });
+}
+
+int resizeConvertImage(const CpuImage& src, const CpuImage& dst, IGraphics2D::Interpolation interpolation, const Cpu2dKernels& kernels)
+{
+    if (src.format == dst.format)
+    {
+        resizeImage(src, dst, interpolation, kernels);
+        return 0;
+    }
+    if (isYuv420(src.format) && !isYuv420(dst.format))
+    {
+        resizeYuvToPacked(src, dst, interpolation, kernels);
+        return 0;
+    }
+
+    // format change as well (RGA does both in one imresize): convert at source size first
+    const int tempWidthStride = (src.width + 1) & ~1;
+    const int tempHeightStride = (src.height + 1) & ~1;
+    std::vector<uint8_t> temp(static_cast<size_t>(tempWidthStride) * tempHeightStride * 4);
+    CpuImage tempImage;
+    if (!makeCpuImage(temp.data(), dst.format, src.width, src.height, tempWidthStride, tempHeightStride,
+                      temp.size(), tempImage) ||
+        (cvtColorImage(src, tempImage, kernels) != 0))
+    {
+        return -1;
+    }
+    resizeImage(tempImage, dst, interpolation, kernels);
+    return 0;
+}
+
+/**
+ * @brief Run the jobs of a batch. With at least one job per thread the jobs themselves are
+ * spread over the pool (their row loops then run inline), otherwise each job gets the pool.
+ */
+int runResizeJobs(const std::vector<CpuImage>& srcs, const std::vector<CpuImage>& dsts, const Cpu2dKernels& kernels)
+{
+    auto& pool = BspParallel::getInstance();
+    const int count = static_cast<int>(srcs.size());
+    std::atomic<int> failures{0};
+    auto runJobs = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            if (resizeConvertImage(srcs[i], dsts[i], IGraphics2D::Interpolation::Bilinear, kernels) != 0)
+            {
+                failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    if (count >= pool.concurrency())
+    {
+        pool.parallelFor(count, 1, 1, runJobs);
+    }
+    else
+    {
+        runJobs(0, count);
+    }
+    return (failures.load() == 0) ? 0 : -1;
+}
+
+} // namespace
+
+Cpu2dGraphics2D::Cpu2dGraphics2D():
+    m_kernels(impl::getCpu2dKernels())
+{
+}
+
+// ========== New Interface Implementation ==========
+
+std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> Cpu2dGraphics2D::createBuffer(
+    BufferType type,
+    const bsp_perf::bsp_image::ImageView& image)
+{
+    auto imageBuffer = std::make_shared<bsp_perf::bsp_image::ImageBuffer>();
+    imageBuffer->view = image;
+    auto g2dBuffer = std::make_shared<impl::G2DBufferInternal>();
+    g2dBuffer->g2dPlatform = "cpu";
+    g2dBuffer->bufferType = type;
+    imageBuffer->nativeHandle = g2dBuffer;
+
+    const auto& desc = image.desc;
+    const auto& plane = image.planes[0];
+    size_t bufferSize = desc.dataSize;
+    if (bufferSize == 0)
+    {
+        try
+        {
+            bufferSize = bsp_perf::bsp_image::imageDataSize(desc);
+        }
+        catch (const std::out_of_range&)
+        {
+            std::cerr << LOG_TAG << "unknown format: " << desc.format << std::endl;
+            return nullptr;
+        }
+    }
+    g2dBuffer->bufferSize = bufferSize;
+
+    if (plane.data != nullptr)
+    {
+        g2dBuffer->hostPtr = plane.data;
+    }
+    else if ((type == BufferType::Hardware) && (plane.fd >= 0))
+    {
+        const size_t mapSize = bufferSize + plane.offset;
+        void* addr = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, plane.fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            std::cerr << LOG_TAG << "mmap of fd " << plane.fd << " failed: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+        g2dBuffer->hostPtr = static_cast<uint8_t*>(addr) + plane.offset;
+        g2dBuffer->g2dBufferHandle = plane.fd;
+        imageBuffer->release = [addr, mapSize]() {
+            ::munmap(addr, mapSize);
+        };
+    }
+    else
+    {
+        std::cerr << LOG_TAG << "buffer requires host_ptr or (Hardware) fd" << std::endl;
+        return nullptr;
+    }
+
+    return imageBuffer;
+}
+
+void Cpu2dGraphics2D::releaseBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer)
+{
+    // dma-buf mappings are undone by ImageBuffer::release once the last reference goes away
+    buffer.reset();
+}
+
+int Cpu2dGraphics2D::syncBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer, SyncDirection direction)
+{
+    auto g2dBuffer = impl::getG2DBufferInternal(buffer);
+    if (!g2dBuffer)
+    {
+        return -1;
+    }
+
+    // only mmapped dma-bufs need cache maintenance, plain host memory is already coherent
+    const int* fd = std::any_cast<int>(&g2dBuffer->g2dBufferHandle);
+    if (fd == nullptr)
+    {
+        return 0;
+    }
+
+    struct dma_buf_sync sync{};
+    if ((direction == SyncDirection::CpuToDevice) || (direction == SyncDirection::Bidirectional))
+    {
+        sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW;
+        if (::ioctl(*fd, DMA_BUF_IOCTL_SYNC, &sync) < 0)
+        {
+            std::cerr << LOG_TAG << "DMA_BUF_SYNC_END failed: " << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+    if ((direction == SyncDirection::DeviceToCpu) || (direction == SyncDirection::Bidirectional))
+    {
+        sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW;
+        if (::ioctl(*fd, DMA_BUF_IOCTL_SYNC, &sync) < 0)
+        {
+            std::cerr << LOG_TAG << "DMA_BUF_SYNC_START failed: " << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void* Cpu2dGraphics2D::mapBuffer(
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer,
+    const std::string& access_mode)
+{
+    (void)access_mode;
+    auto g2dBuffer = impl::getG2DBufferInternal(buffer);
+    if (!g2dBuffer)
+    {
+        return nullptr;
+    }
+    return g2dBuffer->hostPtr;
+}
+
+void Cpu2dGraphics2D::unmapBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer)
+{
+    // No-op, buffers stay mapped for their whole lifetime
+    (void)buffer;
+}
+
+bool Cpu2dGraphics2D::queryCapability(const std::string& capability) const
+{
+    if (capability == "hardware_draw") return false;
+    if (capability == "zero_copy_cpu_access") return true;
+    if (capability == "requires_explicit_sync") return false;
+    return false;
+}
+
+std::string Cpu2dGraphics2D::getPlatformName() const
+{
+    return "cpu";
+}
+
+// ========== Image Operations ==========
+
+int Cpu2dGraphics2D::imageResize(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst)
+{
+    return imageResize(src, dst, Interpolation::Bilinear);
+}
+
+int Cpu2dGraphics2D::imageResize(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                                 Interpolation interpolation)
+{
+    CpuImage srcImage;
+    CpuImage dstImage;
+    if (!getCpuImage(src, src ? src->view.desc.format : "", srcImage) ||
+        !getCpuImage(dst, dst ? dst->view.desc.format : "", dstImage))
+    {
+        return -1;
+    }
+    return resizeConvertImage(srcImage, dstImage, interpolation, m_kernels);
+}
+
+int Cpu2dGraphics2D::imageCopy(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst)
+{
+    CpuImage srcImage;
+    CpuImage dstImage;
+    if (!getCpuImage(src, src ? src->view.desc.format : "", srcImage) ||
+        !getCpuImage(dst, dst ? dst->view.desc.format : "", dstImage))
+    {
+        return -1;
+    }
+    if ((srcImage.format != dstImage.format) || (srcImage.width != dstImage.width) || (srcImage.height != dstImage.height))
+    {
+        std::cerr << LOG_TAG << "imageCopy needs equal size and format" << std::endl;
+        return -1;
+    }
+    copyImage(srcImage, dstImage);
+    return 0;
+}
+
+int Cpu2dGraphics2D::imageDrawRectangle(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst, ImageRect& rect, uint32_t color, int thickness)
+{
+    CpuImage image;
+    if (!getCpuImage(dst, dst ? dst->view.desc.format : "", image))
+    {
+        return -1;
+    }
+    return drawRectangle(image, rect, color, thickness);
+}
+
+int Cpu2dGraphics2D::imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                                   const std::string& src_format, const std::string& dst_format)
+{
+    CpuImage srcImage;
+    CpuImage dstImage;
+    if (!getCpuImage(src, src_format, srcImage) || !getCpuImage(dst, dst_format, dstImage))
+    {
+        return -1;
+    }
+    return cvtColorImage(srcImage, dstImage, m_kernels);
+}
+
+int Cpu2dGraphics2D::imagePreprocess(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, void* dst, size_t dst_size,
+                                     uint32_t dst_width, uint32_t dst_height, const PreprocessParams& params, PreprocessResult& result)
+{
+    CpuImage srcImage;
+    if (!getCpuImage(src, src ? src->view.desc.format : "", srcImage))
+    {
+        return -1;
+    }
+
+    impl::LetterboxGeometry geometry;
+    impl::TensorWriter writer;
+    if ((impl::computeLetterbox(srcImage.width, srcImage.height, dst_width, dst_height, params.keep_aspect, geometry) != 0) ||
+        (writer.init(dst, dst_size, dst_width, dst_height, params) != 0))
+    {
+        return -1;
+    }
+
+    preprocessImage(srcImage, writer, geometry, params.interpolation, m_kernels, static_cast<int>(dst_height));
+    result = geometry.result;
+    return 0;
+}
+
+int Cpu2dGraphics2D::imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+                                      const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+                                      const std::vector<ImageRect>& dst_rects)
+{
+    if ((srcs.size() != dsts.size()) || (!dst_rects.empty() && (dst_rects.size() != dsts.size())))
+    {
+        std::cerr << LOG_TAG << "imageResizeBatch needs one dst (and dst rect) per src" << std::endl;
+        return -1;
+    }
+
+    std::vector<CpuImage> srcImages(srcs.size());
+    std::vector<CpuImage> dstImages(dsts.size());
+    for (size_t i = 0; i < srcs.size(); ++i)
+    {
+        CpuImage dstImage;
+        if (!getCpuImage(srcs[i], srcs[i] ? srcs[i]->view.desc.format : "", srcImages[i]) ||
+            !getCpuImage(dsts[i], dsts[i] ? dsts[i]->view.desc.format : "", dstImage))
+        {
+            return -1;
+        }
+        if (dst_rects.empty())
+        {
+            dstImages[i] = dstImage;
+        }
+        else if (!cropCpuImage(dstImage, dst_rects[i], dstImages[i]))
+        {
+            return -1;
+        }
+    }
+    return runResizeJobs(srcImages, dstImages, m_kernels);
+}
+
+int Cpu2dGraphics2D::imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+                                          const std::vector<ImageRect>& rois,
+                                          const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts)
+{
+    CpuImage srcImage;
+    if ((rois.size() != dsts.size()) || !getCpuImage(src, src ? src->view.desc.format : "", srcImage))
+    {
+        return -1;
+    }
+
+    std::vector<CpuImage> srcImages(rois.size());
+    std::vector<CpuImage> dstImages(dsts.size());
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        if (!cropCpuImage(srcImage, rois[i], srcImages[i]) ||
+            !getCpuImage(dsts[i], dsts[i] ? dsts[i]->view.desc.format : "", dstImages[i]))
+        {
+            return -1;
+        }
+    }
+    return runResizeJobs(srcImages, dstImages, m_kernels);
+}
+
+int Cpu2dGraphics2D::imageDrawRectangles(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                                         const std::vector<ImageRect>& rects, uint32_t color, int thickness)
+{
+    CpuImage image;
+    if (!getCpuImage(dst, dst ? dst->view.desc.format : "", image))
+    {
+        return -1;
+    }
+
+    int ret = 0;
+    for (const auto& rect : rects)
+    {
+        if (drawRectangle(image, rect, color, thickness) != 0)
+        {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+} // namespace bsp_g2d
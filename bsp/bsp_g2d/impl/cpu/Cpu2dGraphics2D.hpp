@@ -0,0 +1,102 @@
+#ifndef __CPU2D_GRAPHICS2D_HPP__
+#define __CPU2D_GRAPHICS2D_HPP__
+
+#include <bsp_g2d/IGraphics2D.hpp>
+#include <bsp_g2d/impl/G2DBufferInternal.hpp>
+#include "Cpu2dKernels.hpp"
+#include <string>
+#include <vector>
+
+namespace bsp_g2d
+{
+
+/**
+ * @brief Portable CPU implementation of IGraphics2D ("cpu").
+ *
+ * Runs anywhere (x86 dev hosts, CI) and serves as a fallback when the 2D engine is busy.
+ * Hot row kernels are hand vectorized (SSSE3 / AVX2 / NEON, picked at runtime, see
+ * Cpu2dKernels.hpp) and every operation is split over row bands on the shared BspParallel pool.
+ *
+ * Supported formats:
+ * - RGB888, BGR888, RGBA8888, BGRA8888
+ * - YUV420SP / YCbCr_420_SP (NV12), YCrCb_420_SP (NV21), YUV420P / YCbCr_420_P (I420)
+ *
+ * Buffers are plain host memory: Mapped wraps the view data, Hardware mmaps the dma-buf fd
+ * when the view carries no host pointer. Colors are 0xAARRGGBB.
+ */
+class Cpu2dGraphics2D : public IGraphics2D
+{
+public:
+    static constexpr char LOG_TAG[] {"Cpu2dGraphics2D: "};
+
+    Cpu2dGraphics2D();
+    Cpu2dGraphics2D(const Cpu2dGraphics2D&) = delete;
+    Cpu2dGraphics2D& operator=(const Cpu2dGraphics2D&) = delete;
+    Cpu2dGraphics2D(Cpu2dGraphics2D&&) = delete;
+    Cpu2dGraphics2D& operator=(Cpu2dGraphics2D&&) = delete;
+    ~Cpu2dGraphics2D() = default;
+
+    // ========== New Interface ==========
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> createBuffer(
+        BufferType type,
+        const bsp_perf::bsp_image::ImageView& image) override;
+
+    void releaseBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer) override;
+
+    int syncBuffer(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer,
+        SyncDirection direction) override;
+
+    void* mapBuffer(
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer,
+        const std::string& access_mode = "readwrite") override;
+
+    void unmapBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buffer) override;
+
+    bool queryCapability(const std::string& capability) const override;
+
+    std::string getPlatformName() const override;
+
+    // ========== Image Operations ==========
+
+    int imageResize(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst) override;
+
+    int imageResize(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                    Interpolation interpolation) override;
+
+    int imageCopy(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst) override;
+
+    int imageDrawRectangle(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst, ImageRect& rect, uint32_t color, int thickness) override;
+
+    int imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
+                    const std::string& src_format, const std::string& dst_format) override;
+
+    int imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+                         const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+                         const std::vector<ImageRect>& dst_rects = {}) override;
+
+    int imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, const std::vector<ImageRect>& rois,
+                             const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts) override;
+
+    int imageDrawRectangles(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst, const std::vector<ImageRect>& rects,
+                            uint32_t color, int thickness) override;
+
+    /**
+     * @brief Fused resize + cvtColor + letterbox + normalize, a single pass over the tensor.
+     */
+    int imagePreprocess(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, void* dst, size_t dst_size,
+                        uint32_t dst_width, uint32_t dst_height, const PreprocessParams& params,
+                        PreprocessResult& result) override;
+
+    /**
+     * @brief ISA of the row kernels in use: "avx2", "sse", "neon" or "scalar".
+     */
+    const char* getKernelIsa() const { return m_kernels.isa; }
+
+private:
+    const impl::Cpu2dKernels& m_kernels;
+};
+
+} // namespace bsp_g2d
+
+#endif // __CPU2D_GRAPHICS2D_HPP__
@@ -0,0 +1,84 @@
+#include "Cpu2dKernels.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+namespace
+{
+
+constexpr Cpu2dKernels SCALAR_KERNELS{"scalar", scalar::yuv420ToRgbRow, scalar::lerpRows, scalar::blendRow};
+
+#if defined(__x86_64__) || defined(__i386__)
+constexpr Cpu2dKernels SSE_KERNELS{"sse", sse::yuv420ToRgbRow, sse::lerpRows, sse::blendRow};
+constexpr Cpu2dKernels AVX2_KERNELS{"avx2", avx2::yuv420ToRgbRow, avx2::lerpRows, avx2::blendRow};
+#endif
+
+#if defined(__aarch64__)
+constexpr Cpu2dKernels NEON_KERNELS{"neon", neon::yuv420ToRgbRow, neon::lerpRows, neon::blendRow};
+#endif
+
+const Cpu2dKernels* selectKernels()
+{
+    const char* forced = std::getenv("BSP_CPU2D_ISA");
+    if (forced != nullptr)
+    {
+        const Cpu2dKernels* kernels = getCpu2dKernels(forced);
+        if (kernels != nullptr)
+        {
+            return kernels;
+        }
+        std::cerr << "Cpu2d: BSP_CPU2D_ISA=" << forced << " not available, auto detecting" << std::endl;
+    }
+
+    for (const char* isa : {"avx2", "sse", "neon"})
+    {
+        const Cpu2dKernels* kernels = getCpu2dKernels(isa);
+        if (kernels != nullptr)
+        {
+            return kernels;
+        }
+    }
+    return &SCALAR_KERNELS;
+}
+
+} // namespace
+
+const Cpu2dKernels* getCpu2dKernels(const char* isa)
+{
+    if (std::strcmp(isa, "scalar") == 0)
+    {
+        return &SCALAR_KERNELS;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if ((std::strcmp(isa, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+    {
+        return &AVX2_KERNELS;
+    }
+    if ((std::strcmp(isa, "sse") == 0) && __builtin_cpu_supports("ssse3"))
+    {
+        return &SSE_KERNELS;
+    }
+#endif
+#if defined(__aarch64__)
+    if (std::strcmp(isa, "neon") == 0)
+    {
+        return &NEON_KERNELS;
+    }
+#endif
+    return nullptr;
+}
+
+const Cpu2dKernels& getCpu2dKernels()
+{
+    static const Cpu2dKernels* kernels = selectKernels();
+    return *kernels;
+}
+
+} // namespace impl
+} // namespace bsp_g2d
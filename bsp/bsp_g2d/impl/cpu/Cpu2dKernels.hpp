@@ -0,0 +1,124 @@
+#ifndef __CPU2D_KERNELS_HPP__
+#define __CPU2D_KERNELS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+
+/**
+ * @brief Chroma layout of a 4:2:0 source row.
+ * NV12: interleaved UVUV..., NV21: interleaved VUVU..., I420: separate U and V planes.
+ */
+enum class Cpu2dChroma
+{
+    NV12,
+    NV21,
+    I420
+};
+
+/**
+ * @brief Fixed point constants shared by every ISA so all kernels produce bit-identical output.
+ *
+ * YUV -> RGB is BT.601 limited range (same as RGA / OpenCV COLOR_YUV2RGB_NV12) with 6 fractional bits.
+ * Bilinear resize keeps the horizontal pass in uint16 (pixel * 256) and blends rows with
+ * weights in [0, CPU2D_LERP_ONE].
+ */
+constexpr int CPU2D_YUV_SHIFT{6};
+constexpr int CPU2D_YUV_Y{74};      // 1.164
+constexpr int CPU2D_YUV_RV{102};    // 1.596
+constexpr int CPU2D_YUV_GU{25};     // 0.391
+constexpr int CPU2D_YUV_GV{52};     // 0.813
+constexpr int CPU2D_YUV_BU{129};    // 2.018
+constexpr int CPU2D_LERP_BITS{8};
+constexpr int CPU2D_LERP_ONE{1 << CPU2D_LERP_BITS};
+constexpr int CPU2D_ALPHA_BITS{8};
+constexpr int CPU2D_ALPHA_ONE{1 << CPU2D_ALPHA_BITS};
+
+/**
+ * @brief Row kernels of one instruction set, picked once at runtime by getCpu2dKernels().
+ */
+struct Cpu2dKernels
+{
+    const char* isa;
+
+    /**
+     * @brief Convert one row of 4:2:0 YUV to packed RGB888/BGR888 (dst_channels 3) or
+     * RGBA8888/BGRA8888 (dst_channels 4, alpha 0xff).
+     * @param u NV12/NV21: the interleaved chroma row, I420: the U row
+     * @param v I420 only: the V row
+     * @param swap_rb write B first (BGR / BGRA)
+     */
+    void (*yuv420ToRgbRow)(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                           uint8_t* dst, int width, int dst_channels, bool swap_rb);
+
+    /**
+     * @brief Vertical bilinear pass over rows of horizontally interpolated pixels (scaled by
+     * CPU2D_LERP_ONE), wy in [0, CPU2D_LERP_ONE]. Written in the form of an unsigned mulhi so
+     * every ISA rounds the same way:
+     * dst[i] = (((row0[i] * 2 * (ONE - wy)) >> 16) + ((row1[i] * 2 * wy) >> 16) + 1) >> 1
+     */
+    void (*lerpRows)(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy);
+
+    /**
+     * @brief Alpha blend src over dst in place, alpha in [1, CPU2D_ALPHA_ONE - 1]
+     * (0 and CPU2D_ALPHA_ONE are a no-op and a memcpy, callers handle them):
+     * dst[i] = (dst[i] * (ONE - alpha) + src[i] * alpha + ONE / 2) >> CPU2D_ALPHA_BITS
+     */
+    void (*blendRow)(uint8_t* dst, const uint8_t* src, int len, int alpha);
+};
+
+/**
+ * @brief Best kernels for the running CPU: AVX2 > SSSE3 on x86, NEON on aarch64, scalar otherwise.
+ * BSP_CPU2D_ISA=scalar|sse|avx2|neon in the environment forces one (if the CPU supports it).
+ */
+const Cpu2dKernels& getCpu2dKernels();
+
+/**
+ * @brief Kernels of one ISA, nullptr if not built in or not supported by the running CPU.
+ */
+const Cpu2dKernels* getCpu2dKernels(const char* isa);
+
+namespace scalar
+{
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb);
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy);
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha);
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace sse
+{
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb);
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy);
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha);
+} // namespace sse
+
+namespace avx2
+{
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb);
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy);
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha);
+} // namespace avx2
+#endif
+
+#if defined(__aarch64__)
+namespace neon
+{
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb);
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy);
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha);
+} // namespace neon
+#endif
+
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __CPU2D_KERNELS_HPP__
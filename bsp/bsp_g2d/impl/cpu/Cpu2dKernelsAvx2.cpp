@@ -0,0 +1,169 @@
+// Built with -mavx2, only reached through getCpu2dKernels() after a cpuid check.
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "Cpu2dKernelsX86.hpp"
+#include <immintrin.h>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+namespace avx2
+{
+
+namespace
+{
+
+struct YuvCoeffs
+{
+    __m256i y_off{_mm256_set1_epi16(16)};
+    __m256i uv_off{_mm256_set1_epi16(128)};
+    __m256i round{_mm256_set1_epi16(1 << (CPU2D_YUV_SHIFT - 1))};
+    __m256i y{_mm256_set1_epi16(CPU2D_YUV_Y)};
+    __m256i rv{_mm256_set1_epi16(CPU2D_YUV_RV)};
+    __m256i gu{_mm256_set1_epi16(CPU2D_YUV_GU)};
+    __m256i gv{_mm256_set1_epi16(CPU2D_YUV_GV)};
+    __m256i bu{_mm256_set1_epi16(CPU2D_YUV_BU)};
+};
+
+// 16 pixels in int16 lanes, chroma already centered and duplicated per pixel
+inline void yuvToRgb16(const YuvCoeffs& k, __m256i y, __m256i u, __m256i v, __m256i& r, __m256i& g, __m256i& b)
+{
+    const __m256i yy = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(y, k.y_off), k.y), k.round);
+    r = _mm256_srai_epi16(_mm256_adds_epi16(yy, _mm256_mullo_epi16(v, k.rv)), CPU2D_YUV_SHIFT);
+    g = _mm256_srai_epi16(_mm256_subs_epi16(_mm256_subs_epi16(yy, _mm256_mullo_epi16(v, k.gv)),
+                                            _mm256_mullo_epi16(u, k.gu)), CPU2D_YUV_SHIFT);
+    b = _mm256_srai_epi16(_mm256_adds_epi16(yy, _mm256_mullo_epi16(u, k.bu)), CPU2D_YUV_SHIFT);
+}
+
+// u8 pack of two int16 vectors, in pixel order (packus works per 128-bit lane)
+inline __m256i packPixels(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+}
+
+// duplicate 16 chroma samples to 32 pixels: [c0 c0 .. c7 c7] and [c8 c8 .. c15 c15]
+inline void dupChroma(__m256i c, __m256i& lo, __m256i& hi)
+{
+    const __m256i t_lo = _mm256_unpacklo_epi16(c, c);
+    const __m256i t_hi = _mm256_unpackhi_epi16(c, c);
+    lo = _mm256_permute2x128_si256(t_lo, t_hi, 0x20);
+    hi = _mm256_permute2x128_si256(t_lo, t_hi, 0x31);
+}
+
+} // namespace
+
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb)
+{
+    const YuvCoeffs k{};
+    const __m256i low_byte = _mm256_set1_epi16(0x00ff);
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32)
+    {
+        const __m256i y_lo = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+        const __m256i y_hi = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x + 16)));
+
+        __m256i u16;
+        __m256i v16;
+        if (chroma == Cpu2dChroma::I420)
+        {
+            u16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x / 2)));
+            v16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + x / 2)));
+        }
+        else
+        {
+            const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + x));
+            const __m256i even = _mm256_and_si256(c, low_byte);
+            const __m256i odd = _mm256_srli_epi16(c, 8);
+            u16 = (chroma == Cpu2dChroma::NV12) ? even : odd;
+            v16 = (chroma == Cpu2dChroma::NV12) ? odd : even;
+        }
+        u16 = _mm256_sub_epi16(u16, k.uv_off);
+        v16 = _mm256_sub_epi16(v16, k.uv_off);
+
+        __m256i u_lo, u_hi, v_lo, v_hi;
+        dupChroma(u16, u_lo, u_hi);
+        dupChroma(v16, v_lo, v_hi);
+
+        __m256i r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+        yuvToRgb16(k, y_lo, u_lo, v_lo, r_lo, g_lo, b_lo);
+        yuvToRgb16(k, y_hi, u_hi, v_hi, r_hi, g_hi, b_hi);
+
+        const __m256i r = packPixels(r_lo, r_hi);
+        const __m256i g = packPixels(g_lo, g_hi);
+        const __m256i b = packPixels(b_lo, b_hi);
+        uint8_t* out = dst + x * dst_channels;
+        storePackedRgb(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b),
+                       out, dst_channels, swap_rb);
+        storePackedRgb(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1),
+                       out + 16 * dst_channels, dst_channels, swap_rb);
+    }
+
+    if (x < width)
+    {
+        const uint8_t* u_tail = (chroma == Cpu2dChroma::I420) ? u + x / 2 : u + x;
+        const uint8_t* v_tail = (chroma == Cpu2dChroma::I420) ? v + x / 2 : v;
+        scalar::yuv420ToRgbRow(y + x, u_tail, v_tail, chroma, dst + x * dst_channels, width - x, dst_channels, swap_rb);
+    }
+}
+
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy)
+{
+    const __m256i w0 = _mm256_set1_epi16(static_cast<short>((CPU2D_LERP_ONE - wy) << 1));
+    const __m256i w1 = _mm256_set1_epi16(static_cast<short>(wy << 1));
+    const __m256i one = _mm256_set1_epi16(1);
+    int i = 0;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i res[2];
+        for (int half = 0; half < 2; ++half)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + i + half * 16));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + i + half * 16));
+            const __m256i sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(a, w0), _mm256_mulhi_epu16(b, w1)), one);
+            res[half] = _mm256_srli_epi16(sum, 1);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packPixels(res[0], res[1]));
+    }
+
+    if (i < len)
+    {
+        scalar::lerpRows(row0 + i, row1 + i, dst + i, len - i, wy);
+    }
+}
+
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha)
+{
+    // unpack and pack both work per 128 bit lane, so the byte order survives without a permute
+    const __m256i wd = _mm256_set1_epi16(static_cast<short>(CPU2D_ALPHA_ONE - alpha));
+    const __m256i ws = _mm256_set1_epi16(static_cast<short>(alpha));
+    const __m256i half = _mm256_set1_epi16(CPU2D_ALPHA_ONE >> 1);
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), wd),
+                                                             _mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), ws)), half);
+        const __m256i hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), wd),
+                                                             _mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), ws)), half);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_packus_epi16(_mm256_srli_epi16(lo, CPU2D_ALPHA_BITS), _mm256_srli_epi16(hi, CPU2D_ALPHA_BITS)));
+    }
+
+    if (i < len)
+    {
+        scalar::blendRow(dst + i, src + i, len - i, alpha);
+    }
+}
+
+} // namespace avx2
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __x86_64__ || __i386__
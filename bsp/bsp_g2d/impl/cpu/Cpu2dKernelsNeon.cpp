@@ -0,0 +1,154 @@
+// NEON is mandatory on aarch64, no runtime check needed.
+#if defined(__aarch64__)
+
+#include "Cpu2dKernels.hpp"
+#include <arm_neon.h>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+namespace neon
+{
+
+namespace
+{
+
+struct YuvCoeffs
+{
+    int16x8_t y_off{vdupq_n_s16(16)};
+    int16x8_t uv_off{vdupq_n_s16(128)};
+    int16x8_t round{vdupq_n_s16(1 << (CPU2D_YUV_SHIFT - 1))};
+    int16x8_t y{vdupq_n_s16(CPU2D_YUV_Y)};
+    int16x8_t rv{vdupq_n_s16(CPU2D_YUV_RV)};
+    int16x8_t gu{vdupq_n_s16(CPU2D_YUV_GU)};
+    int16x8_t gv{vdupq_n_s16(CPU2D_YUV_GV)};
+    int16x8_t bu{vdupq_n_s16(CPU2D_YUV_BU)};
+};
+
+// 8 pixels, chroma already centered and duplicated per pixel
+inline void yuvToRgb8(const YuvCoeffs& k, int16x8_t y, int16x8_t u, int16x8_t v,
+                      int16x8_t& r, int16x8_t& g, int16x8_t& b)
+{
+    const int16x8_t yy = vaddq_s16(vmulq_s16(vsubq_s16(y, k.y_off), k.y), k.round);
+    r = vqaddq_s16(yy, vmulq_s16(v, k.rv));
+    g = vqsubq_s16(vqsubq_s16(yy, vmulq_s16(v, k.gv)), vmulq_s16(u, k.gu));
+    b = vqaddq_s16(yy, vmulq_s16(u, k.bu));
+}
+
+inline uint8x16_t narrowPixels(int16x8_t lo, int16x8_t hi)
+{
+    return vcombine_u8(vqshrun_n_s16(lo, CPU2D_YUV_SHIFT), vqshrun_n_s16(hi, CPU2D_YUV_SHIFT));
+}
+
+} // namespace
+
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb)
+{
+    const YuvCoeffs k{};
+    int x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8x16_t y8 = vld1q_u8(y + x);
+        const int16x8_t y_lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8)));
+        const int16x8_t y_hi = vreinterpretq_s16_u16(vmovl_high_u8(y8));
+
+        int16x8_t u16;
+        int16x8_t v16;
+        if (chroma == Cpu2dChroma::I420)
+        {
+            u16 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x / 2)));
+            v16 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x / 2)));
+        }
+        else
+        {
+            const uint8x8x2_t c = vld2_u8(u + x);
+            const int16x8_t even = vreinterpretq_s16_u16(vmovl_u8(c.val[0]));
+            const int16x8_t odd = vreinterpretq_s16_u16(vmovl_u8(c.val[1]));
+            u16 = (chroma == Cpu2dChroma::NV12) ? even : odd;
+            v16 = (chroma == Cpu2dChroma::NV12) ? odd : even;
+        }
+        const int16x8x2_t u_dup = vzipq_s16(vsubq_s16(u16, k.uv_off), vsubq_s16(u16, k.uv_off));
+        const int16x8x2_t v_dup = vzipq_s16(vsubq_s16(v16, k.uv_off), vsubq_s16(v16, k.uv_off));
+
+        int16x8_t r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+        yuvToRgb8(k, y_lo, u_dup.val[0], v_dup.val[0], r_lo, g_lo, b_lo);
+        yuvToRgb8(k, y_hi, u_dup.val[1], v_dup.val[1], r_hi, g_hi, b_hi);
+
+        const uint8x16_t r = narrowPixels(r_lo, r_hi);
+        const uint8x16_t g = narrowPixels(g_lo, g_hi);
+        const uint8x16_t b = narrowPixels(b_lo, b_hi);
+        uint8_t* out = dst + x * dst_channels;
+        if (dst_channels == 4)
+        {
+            uint8x16x4_t px{{swap_rb ? b : r, g, swap_rb ? r : b, vdupq_n_u8(0xff)}};
+            vst4q_u8(out, px);
+        }
+        else
+        {
+            uint8x16x3_t px{{swap_rb ? b : r, g, swap_rb ? r : b}};
+            vst3q_u8(out, px);
+        }
+    }
+
+    if (x < width)
+    {
+        const uint8_t* u_tail = (chroma == Cpu2dChroma::I420) ? u + x / 2 : u + x;
+        const uint8_t* v_tail = (chroma == Cpu2dChroma::I420) ? v + x / 2 : v;
+        scalar::yuv420ToRgbRow(y + x, u_tail, v_tail, chroma, dst + x * dst_channels, width - x, dst_channels, swap_rb);
+    }
+}
+
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy)
+{
+    const uint16x8_t w0 = vdupq_n_u16(static_cast<uint16_t>((CPU2D_LERP_ONE - wy) << 1));
+    const uint16x8_t w1 = vdupq_n_u16(static_cast<uint16_t>(wy << 1));
+    const uint16x8_t one = vdupq_n_u16(1);
+    int i = 0;
+
+    for (; i + 8 <= len; i += 8)
+    {
+        const uint16x8_t a = vld1q_u16(row0 + i);
+        const uint16x8_t b = vld1q_u16(row1 + i);
+        const uint16x8_t ta = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(w0)), 16),
+                                           vshrn_n_u32(vmull_high_u16(a, w0), 16));
+        const uint16x8_t tb = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(b), vget_low_u16(w1)), 16),
+                                           vshrn_n_u32(vmull_high_u16(b, w1), 16));
+        vst1_u8(dst + i, vmovn_u16(vshrq_n_u16(vaddq_u16(vaddq_u16(ta, tb), one), 1)));
+    }
+
+    if (i < len)
+    {
+        scalar::lerpRows(row0 + i, row1 + i, dst + i, len - i, wy);
+    }
+}
+
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha)
+{
+    const uint8x16_t wd = vdupq_n_u8(static_cast<uint8_t>(CPU2D_ALPHA_ONE - alpha));
+    const uint8x16_t ws = vdupq_n_u8(static_cast<uint8_t>(alpha));
+    int i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        const uint8x16_t d = vld1q_u8(dst + i);
+        const uint8x16_t s = vld1q_u8(src + i);
+        const uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(d), vget_low_u8(wd)), vget_low_u8(s), vget_low_u8(ws));
+        const uint16x8_t hi = vmlal_high_u8(vmull_high_u8(d, wd), s, ws);
+        // vrshrn adds ONE / 2 before the shift, same rounding as the other ISAs
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, CPU2D_ALPHA_BITS), vrshrn_n_u16(hi, CPU2D_ALPHA_BITS)));
+    }
+
+    if (i < len)
+    {
+        scalar::blendRow(dst + i, src + i, len - i, alpha);
+    }
+}
+
+} // namespace neon
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __aarch64__
@@ -0,0 +1,78 @@
+#include "Cpu2dKernels.hpp"
+#include <algorithm>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+namespace scalar
+{
+
+static inline uint8_t clampPixel(int val)
+{
+    return static_cast<uint8_t>(std::min(std::max(val >> CPU2D_YUV_SHIFT, 0), 255));
+}
+
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb)
+{
+    const int r_idx = swap_rb ? 2 : 0;
+    const int b_idx = swap_rb ? 0 : 2;
+
+    for (int x = 0; x < width; ++x)
+    {
+        int cu = 0;
+        int cv = 0;
+        switch (chroma)
+        {
+        case Cpu2dChroma::NV12:
+            cu = u[(x & ~1)];
+            cv = u[(x & ~1) + 1];
+            break;
+        case Cpu2dChroma::NV21:
+            cv = u[(x & ~1)];
+            cu = u[(x & ~1) + 1];
+            break;
+        default:
+            cu = u[x >> 1];
+            cv = v[x >> 1];
+            break;
+        }
+        cu -= 128;
+        cv -= 128;
+
+        const int yy = (static_cast<int>(y[x]) - 16) * CPU2D_YUV_Y + (1 << (CPU2D_YUV_SHIFT - 1));
+        uint8_t* px = dst + x * dst_channels;
+        px[r_idx] = clampPixel(yy + CPU2D_YUV_RV * cv);
+        px[1] = clampPixel(yy - CPU2D_YUV_GV * cv - CPU2D_YUV_GU * cu);
+        px[b_idx] = clampPixel(yy + CPU2D_YUV_BU * cu);
+        if (dst_channels == 4)
+        {
+            px[3] = 0xff;
+        }
+    }
+}
+
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy)
+{
+    const uint32_t w0 = static_cast<uint32_t>(CPU2D_LERP_ONE - wy) << 1;
+    const uint32_t w1 = static_cast<uint32_t>(wy) << 1;
+    for (int i = 0; i < len; ++i)
+    {
+        dst[i] = static_cast<uint8_t>((((row0[i] * w0) >> 16) + ((row1[i] * w1) >> 16) + 1) >> 1);
+    }
+}
+
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha)
+{
+    const uint32_t ws = static_cast<uint32_t>(alpha);
+    const uint32_t wd = static_cast<uint32_t>(CPU2D_ALPHA_ONE - alpha);
+    for (int i = 0; i < len; ++i)
+    {
+        dst[i] = static_cast<uint8_t>((dst[i] * wd + src[i] * ws + (CPU2D_ALPHA_ONE >> 1)) >> CPU2D_ALPHA_BITS);
+    }
+}
+
+} // namespace scalar
+} // namespace impl
+} // namespace bsp_g2d
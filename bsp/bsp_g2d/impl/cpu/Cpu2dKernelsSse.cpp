@@ -0,0 +1,144 @@
+// Built with -mssse3, only reached through getCpu2dKernels() after a cpuid check.
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "Cpu2dKernelsX86.hpp"
+
+namespace bsp_g2d
+{
+namespace impl
+{
+namespace sse
+{
+
+namespace
+{
+
+struct YuvCoeffs
+{
+    __m128i y_off{_mm_set1_epi16(16)};
+    __m128i uv_off{_mm_set1_epi16(128)};
+    __m128i round{_mm_set1_epi16(1 << (CPU2D_YUV_SHIFT - 1))};
+    __m128i y{_mm_set1_epi16(CPU2D_YUV_Y)};
+    __m128i rv{_mm_set1_epi16(CPU2D_YUV_RV)};
+    __m128i gu{_mm_set1_epi16(CPU2D_YUV_GU)};
+    __m128i gv{_mm_set1_epi16(CPU2D_YUV_GV)};
+    __m128i bu{_mm_set1_epi16(CPU2D_YUV_BU)};
+};
+
+// 8 pixels in int16 lanes, chroma already centered and duplicated per pixel
+inline void yuvToRgb8(const YuvCoeffs& k, __m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
+    const __m128i yy = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, k.y_off), k.y), k.round);
+    r = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(v, k.rv)), CPU2D_YUV_SHIFT);
+    g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(yy, _mm_mullo_epi16(v, k.gv)), _mm_mullo_epi16(u, k.gu)), CPU2D_YUV_SHIFT);
+    b = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(u, k.bu)), CPU2D_YUV_SHIFT);
+}
+
+} // namespace
+
+void yuv420ToRgbRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, Cpu2dChroma chroma,
+                    uint8_t* dst, int width, int dst_channels, bool swap_rb)
+{
+    const YuvCoeffs k{};
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_byte = _mm_set1_epi16(0x00ff);
+    int x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i y_lo = _mm_unpacklo_epi8(y8, zero);
+        const __m128i y_hi = _mm_unpackhi_epi8(y8, zero);
+
+        __m128i u16;
+        __m128i v16;
+        if (chroma == Cpu2dChroma::I420)
+        {
+            u16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)), zero);
+            v16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)), zero);
+        }
+        else
+        {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x));
+            const __m128i even = _mm_and_si128(c, low_byte);
+            const __m128i odd = _mm_srli_epi16(c, 8);
+            u16 = (chroma == Cpu2dChroma::NV12) ? even : odd;
+            v16 = (chroma == Cpu2dChroma::NV12) ? odd : even;
+        }
+        u16 = _mm_sub_epi16(u16, k.uv_off);
+        v16 = _mm_sub_epi16(v16, k.uv_off);
+
+        __m128i r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+        yuvToRgb8(k, y_lo, _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), r_lo, g_lo, b_lo);
+        yuvToRgb8(k, y_hi, _mm_unpackhi_epi16(u16, u16), _mm_unpackhi_epi16(v16, v16), r_hi, g_hi, b_hi);
+
+        storePackedRgb(_mm_packus_epi16(r_lo, r_hi), _mm_packus_epi16(g_lo, g_hi), _mm_packus_epi16(b_lo, b_hi),
+                       dst + x * dst_channels, dst_channels, swap_rb);
+    }
+
+    if (x < width)
+    {
+        const uint8_t* u_tail = (chroma == Cpu2dChroma::I420) ? u + x / 2 : u + x;
+        const uint8_t* v_tail = (chroma == Cpu2dChroma::I420) ? v + x / 2 : v;
+        scalar::yuv420ToRgbRow(y + x, u_tail, v_tail, chroma, dst + x * dst_channels, width - x, dst_channels, swap_rb);
+    }
+}
+
+void lerpRows(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int len, int wy)
+{
+    const __m128i w0 = _mm_set1_epi16(static_cast<short>((CPU2D_LERP_ONE - wy) << 1));
+    const __m128i w1 = _mm_set1_epi16(static_cast<short>(wy << 1));
+    const __m128i one = _mm_set1_epi16(1);
+    int i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i res[2];
+        for (int half = 0; half < 2; ++half)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i + half * 8));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i + half * 8));
+            const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mulhi_epu16(a, w0), _mm_mulhi_epu16(b, w1)), one);
+            res[half] = _mm_srli_epi16(sum, 1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(res[0], res[1]));
+    }
+
+    if (i < len)
+    {
+        scalar::lerpRows(row0 + i, row1 + i, dst + i, len - i, wy);
+    }
+}
+
+void blendRow(uint8_t* dst, const uint8_t* src, int len, int alpha)
+{
+    // 255 * 256 + 128 still fits an unsigned 16 bit lane
+    const __m128i wd = _mm_set1_epi16(static_cast<short>(CPU2D_ALPHA_ONE - alpha));
+    const __m128i ws = _mm_set1_epi16(static_cast<short>(alpha));
+    const __m128i half = _mm_set1_epi16(CPU2D_ALPHA_ONE >> 1);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), wd),
+                                                       _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), ws)), half);
+        const __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), wd),
+                                                       _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), ws)), half);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(_mm_srli_epi16(lo, CPU2D_ALPHA_BITS), _mm_srli_epi16(hi, CPU2D_ALPHA_BITS)));
+    }
+
+    if (i < len)
+    {
+        scalar::blendRow(dst + i, src + i, len - i, alpha);
+    }
+}
+
+} // namespace sse
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __x86_64__ || __i386__
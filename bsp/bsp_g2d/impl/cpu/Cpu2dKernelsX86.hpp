@@ -0,0 +1,92 @@
+#ifndef __CPU2D_KERNELS_X86_HPP__
+#define __CPU2D_KERNELS_X86_HPP__
+
+// Helpers shared by the SSSE3 and AVX2 translation units. Everything here has internal linkage
+// on purpose: each TU is built with its own -m flags and the linker must never merge an AVX2
+// compiled copy into the SSSE3 path.
+
+#include "Cpu2dKernels.hpp"
+#include <tmmintrin.h>
+
+namespace bsp_g2d
+{
+namespace impl
+{
+namespace
+{
+
+struct RgbShuffleMasks
+{
+    alignas(16) int8_t m[3][3][16];     // [output vector][source channel][byte]
+};
+
+constexpr RgbShuffleMasks makeRgbShuffleMasks()
+{
+    RgbShuffleMasks masks{};
+    for (int k = 0; k < 48; ++k)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            masks.m[k / 16][c][k % 16] = (k % 3 == c) ? static_cast<int8_t>(k / 3) : static_cast<int8_t>(-128);
+        }
+    }
+    return masks;
+}
+
+constexpr RgbShuffleMasks RGB_SHUFFLE_MASKS = makeRgbShuffleMasks();
+
+inline __m128i rgbShuffleMask(int vec, int channel)
+{
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(RGB_SHUFFLE_MASKS.m[vec][channel]));
+}
+
+/**
+ * @brief Interleave 16 pixels of three planar channels into 48 bytes of packed RGB.
+ */
+inline void storePacked3(__m128i c0, __m128i c1, __m128i c2, uint8_t* dst)
+{
+    for (int vec = 0; vec < 3; ++vec)
+    {
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, rgbShuffleMask(vec, 0)),
+                                                _mm_shuffle_epi8(c1, rgbShuffleMask(vec, 1))),
+                                   _mm_shuffle_epi8(c2, rgbShuffleMask(vec, 2)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + vec * 16), out);
+    }
+}
+
+/**
+ * @brief Interleave 16 pixels of three planar channels plus opaque alpha into 64 bytes.
+ */
+inline void storePacked4(__m128i c0, __m128i c1, __m128i c2, uint8_t* dst)
+{
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+    const __m128i c01_lo = _mm_unpacklo_epi8(c0, c1);
+    const __m128i c01_hi = _mm_unpackhi_epi8(c0, c1);
+    const __m128i c2a_lo = _mm_unpacklo_epi8(c2, alpha);
+    const __m128i c2a_hi = _mm_unpackhi_epi8(c2, alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(c01_lo, c2a_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(c01_lo, c2a_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(c01_hi, c2a_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(c01_hi, c2a_hi));
+}
+
+inline void storePackedRgb(__m128i r, __m128i g, __m128i b, uint8_t* dst, int dst_channels, bool swap_rb)
+{
+    // no std::swap: a template instance could be shared across the differently built TUs
+    const __m128i c0 = swap_rb ? b : r;
+    const __m128i c2 = swap_rb ? r : b;
+    if (dst_channels == 4)
+    {
+        storePacked4(c0, g, c2, dst);
+    }
+    else
+    {
+        storePacked3(c0, g, c2, dst);
+    }
+}
+
+} // namespace
+} // namespace impl
+} // namespace bsp_g2d
+
+#endif // __CPU2D_KERNELS_X86_HPP__
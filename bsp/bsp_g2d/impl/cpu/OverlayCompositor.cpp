@@ -0,0 +1,469 @@
+#include <bsp_g2d/OverlayCompositor.hpp>
+#include "Cpu2dKernels.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace bsp_g2d
+{
+
+constexpr char OverlayCompositor::LOG_TAG[];
+
+namespace
+{
+
+// 5x7 font for ASCII 0x20..0x7e, one byte per column, bit 0 is the top row
+constexpr uint8_t FONT_5X7[][OverlayCompositor::GLYPH_WIDTH] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5f, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7f, 0x14, 0x7f, 0x14}, {0x24, 0x2a, 0x7f, 0x2a, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1c, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1c, 0x00}, {0x14, 0x08, 0x3e, 0x08, 0x14}, {0x08, 0x08, 0x3e, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3e, 0x51, 0x49, 0x45, 0x3e}, {0x00, 0x42, 0x7f, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4b, 0x31}, {0x18, 0x14, 0x12, 0x7f, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3c, 0x4a, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1e}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3e}, // > ? @
+    {0x7e, 0x11, 0x11, 0x11, 0x7e}, {0x7f, 0x49, 0x49, 0x49, 0x36}, {0x3e, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7f, 0x41, 0x41, 0x22, 0x1c}, {0x7f, 0x49, 0x49, 0x49, 0x41}, {0x7f, 0x09, 0x09, 0x09, 0x01}, // D E F
+    {0x3e, 0x41, 0x49, 0x49, 0x7a}, {0x7f, 0x08, 0x08, 0x08, 0x7f}, {0x00, 0x41, 0x7f, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3f, 0x01}, {0x7f, 0x08, 0x14, 0x22, 0x41}, {0x7f, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7f, 0x02, 0x0c, 0x02, 0x7f}, {0x7f, 0x04, 0x08, 0x10, 0x7f}, {0x3e, 0x41, 0x41, 0x41, 0x3e}, // M N O
+    {0x7f, 0x09, 0x09, 0x09, 0x06}, {0x3e, 0x41, 0x51, 0x21, 0x5e}, {0x7f, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7f, 0x01, 0x01}, {0x3f, 0x40, 0x40, 0x40, 0x3f}, // S T U
+    {0x1f, 0x20, 0x40, 0x20, 0x1f}, {0x3f, 0x40, 0x38, 0x40, 0x3f}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7f, 0x41, 0x41, 0x00}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7f, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7f, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7f}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7e, 0x09, 0x01, 0x02}, {0x0c, 0x52, 0x52, 0x52, 0x3e}, // e f g
+    {0x7f, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7d, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3d, 0x00}, // h i j
+    {0x7f, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7f, 0x40, 0x00}, {0x7c, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7c, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7c, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7c}, {0x7c, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3f, 0x44, 0x40, 0x20}, {0x3c, 0x40, 0x40, 0x20, 0x7c}, {0x1c, 0x20, 0x40, 0x20, 0x1c}, // t u v
+    {0x3c, 0x40, 0x30, 0x40, 0x3c}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0c, 0x50, 0x50, 0x50, 0x3c}, // w x y
+    {0x44, 0x64, 0x54, 0x4c, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7f, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08},                                 // } ~
+};
+
+static_assert(sizeof(FONT_5X7) / sizeof(FONT_5X7[0]) == 0x7f - 0x20, "font covers printable ASCII");
+
+const uint8_t* glyph(char c)
+{
+    const unsigned char code = static_cast<unsigned char>(c);
+    return FONT_5X7[((code >= 0x20) && (code < 0x7f)) ? code - 0x20 : '?' - 0x20];
+}
+
+enum class PlaneKind
+{
+    Y,
+    U,
+    V,
+    UV,
+    VU,
+    RGB,
+    BGR,
+    RGBA,
+    BGRA
+};
+
+int floorDiv(int value, int div)
+{
+    return (value >= 0) ? value / div : -((-value + div - 1) / div);
+}
+
+int ceilDiv(int value, int div)
+{
+    return -floorDiv(-value, div);
+}
+
+// ARGB8888 alpha to blend weight, 0xff maps to CPU2D_ALPHA_ONE (plain copy)
+int blendAlpha(uint32_t color)
+{
+    const int alpha = static_cast<int>(color >> 24);
+    return alpha + (alpha >> 7);
+}
+
+/**
+ * @brief Bytes of one sample of the color in a plane, BT.601 limited range like the cpu backend.
+ */
+int planePattern(PlaneKind kind, uint32_t color, uint8_t pattern[4])
+{
+    const int r = static_cast<int>((color >> 16) & 0xff);
+    const int g = static_cast<int>((color >> 8) & 0xff);
+    const int b = static_cast<int>(color & 0xff);
+    const auto y = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    const auto u = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    const auto v = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+
+    switch (kind)
+    {
+    case PlaneKind::Y:
+        pattern[0] = y;
+        return 1;
+    case PlaneKind::U:
+        pattern[0] = u;
+        return 1;
+    case PlaneKind::V:
+        pattern[0] = v;
+        return 1;
+    case PlaneKind::UV:
+        pattern[0] = u;
+        pattern[1] = v;
+        return 2;
+    case PlaneKind::VU:
+        pattern[0] = v;
+        pattern[1] = u;
+        return 2;
+    case PlaneKind::RGB:
+    case PlaneKind::RGBA:
+        pattern[0] = static_cast<uint8_t>(r);
+        pattern[1] = static_cast<uint8_t>(g);
+        pattern[2] = static_cast<uint8_t>(b);
+        pattern[3] = 0xff;
+        return (kind == PlaneKind::RGBA) ? 4 : 3;
+    case PlaneKind::BGR:
+    case PlaneKind::BGRA:
+        pattern[0] = static_cast<uint8_t>(b);
+        pattern[1] = static_cast<uint8_t>(g);
+        pattern[2] = static_cast<uint8_t>(r);
+        pattern[3] = 0xff;
+        return (kind == PlaneKind::BGRA) ? 4 : 3;
+    }
+    return 0;
+}
+
+} // namespace
+
+struct OverlayCompositor::Plane
+{
+    uint8_t* data{nullptr};
+    size_t rowStride{0};
+    int width{0};           // samples
+    int height{0};
+    int hsub{1};
+    int vsub{1};
+    PlaneKind kind{PlaneKind::Y};
+    const impl::Cpu2dKernels* kernels{nullptr};
+    std::vector<uint8_t>* colorRow{nullptr};
+    uint32_t rowColor{0};   // color currently in colorRow
+    bool rowValid{false};
+};
+
+struct OverlayCompositor::Target
+{
+    std::array<Plane, 3> planes{};
+    int planeCount{0};
+};
+
+void OverlayCompositor::addRectangle(const IGraphics2D::ImageRect& rect, uint32_t color, int thickness)
+{
+    Item item{};
+    item.type = ItemType::Rectangle;
+    item.rect = rect;
+    item.color = color;
+    item.thickness = thickness;
+    m_items.push_back(std::move(item));
+}
+
+void OverlayCompositor::addText(int x, int y, const std::string& text, uint32_t color, int scale, uint32_t background)
+{
+    if (text.empty())
+    {
+        return;
+    }
+    scale = std::max(scale, 1);
+    if ((background >> 24) != 0)
+    {
+        addRectangle({x - scale, y - scale, textWidth(text, scale) + 2 * scale, textHeight(scale) + 2 * scale}, background, 0);
+    }
+
+    Item item{};
+    item.type = ItemType::Text;
+    item.rect = {x, y, textWidth(text, scale), textHeight(scale)};
+    item.color = color;
+    item.scale = scale;
+    item.text = text;
+    m_items.push_back(std::move(item));
+}
+
+void OverlayCompositor::addLabeledBox(const IGraphics2D::ImageRect& rect, const std::string& label, uint32_t color,
+                                      uint32_t textColor, int thickness, int scale)
+{
+    addRectangle(rect, color, thickness);
+    if (label.empty())
+    {
+        return;
+    }
+    scale = std::max(scale, 1);
+    const int tabHeight = textHeight(scale) + 2 * scale;
+    const int tabTop = (rect.y >= tabHeight) ? rect.y - tabHeight : rect.y;
+    addText(rect.x + scale, tabTop + scale, label, textColor, scale, color | 0xff000000U);
+}
+
+void OverlayCompositor::clear()
+{
+    m_items.clear();
+}
+
+int OverlayCompositor::textWidth(const std::string& text, int scale)
+{
+    if (text.empty())
+    {
+        return 0;
+    }
+    return (static_cast<int>(text.size()) * GLYPH_ADVANCE - 1) * std::max(scale, 1);
+}
+
+int OverlayCompositor::textHeight(int scale)
+{
+    return GLYPH_HEIGHT * std::max(scale, 1);
+}
+
+int OverlayCompositor::render(const bsp_perf::bsp_image::ImageView& image)
+{
+    using bsp_perf::bsp_image::PixelFormat;
+
+    if (image.empty() || (image.memoryType != bsp_perf::bsp_image::ImageMemoryType::Host))
+    {
+        std::cerr << LOG_TAG << "render needs a host image" << std::endl;
+        return -1;
+    }
+
+    const PixelFormat format = bsp_perf::bsp_image::pixelFormatFromString(image.desc.format);
+    Target target{};
+    int sub = 1;
+    switch (format)
+    {
+    case PixelFormat::YUV420SP:
+    case PixelFormat::YCbCr_420_SP:
+        target.planes[0].kind = PlaneKind::Y;
+        target.planes[1].kind = PlaneKind::UV;
+        target.planeCount = 2;
+        sub = 2;
+        break;
+    case PixelFormat::YCrCb_420_SP:
+        target.planes[0].kind = PlaneKind::Y;
+        target.planes[1].kind = PlaneKind::VU;
+        target.planeCount = 2;
+        sub = 2;
+        break;
+    case PixelFormat::YUV420P:
+    case PixelFormat::YCbCr_420_P:
+        target.planes[0].kind = PlaneKind::Y;
+        target.planes[1].kind = PlaneKind::U;
+        target.planes[2].kind = PlaneKind::V;
+        target.planeCount = 3;
+        sub = 2;
+        break;
+    case PixelFormat::RGB888:
+        target.planes[0].kind = PlaneKind::RGB;
+        target.planeCount = 1;
+        break;
+    case PixelFormat::BGR888:
+        target.planes[0].kind = PlaneKind::BGR;
+        target.planeCount = 1;
+        break;
+    case PixelFormat::RGBA8888:
+        target.planes[0].kind = PlaneKind::RGBA;
+        target.planeCount = 1;
+        break;
+    case PixelFormat::BGRA8888:
+        target.planes[0].kind = PlaneKind::BGRA;
+        target.planeCount = 1;
+        break;
+    default:
+        std::cerr << LOG_TAG << "unsupported format " << image.desc.format << std::endl;
+        return -1;
+    }
+
+    const uint32_t widthStride = image.desc.widthStride > 0 ? image.desc.widthStride : image.desc.width;
+    const uint32_t heightStride = image.desc.heightStride > 0 ? image.desc.heightStride : image.desc.height;
+    const auto layout = bsp_perf::bsp_image::planeLayout(format, widthStride, heightStride);
+    const auto& kernels = impl::getCpu2dKernels();
+    for (int i = 0; i < target.planeCount; ++i)
+    {
+        auto& plane = target.planes[i];
+        const auto& viewPlane = image.planes[i];
+        const bool described = (static_cast<uint32_t>(i) < image.planeCount) && (viewPlane.data != nullptr);
+        plane.data = described ? viewPlane.data : image.planes[0].data + layout.offset[i];
+        plane.rowStride = (described && (viewPlane.rowStride > 0)) ? viewPlane.rowStride : layout.rowStride[i];
+        plane.hsub = (i == 0) ? 1 : sub;
+        plane.vsub = plane.hsub;
+        plane.width = ceilDiv(static_cast<int>(image.desc.width), plane.hsub);
+        plane.height = ceilDiv(static_cast<int>(image.desc.height), plane.vsub);
+        plane.kernels = &kernels;
+        plane.colorRow = &m_colorRows[i];
+    }
+
+    for (const auto& item : m_items)
+    {
+        if (item.type == ItemType::Rectangle)
+        {
+            renderRectangle(target, item);
+        }
+        else
+        {
+            renderText(target, item);
+        }
+    }
+    return 0;
+}
+
+void OverlayCompositor::blendSpan(Plane& plane, uint32_t color, int row, int x0, int x1)
+{
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, plane.width);
+    const int alpha = blendAlpha(color);
+    if ((row < 0) || (row >= plane.height) || (x0 >= x1) || (alpha == 0))
+    {
+        return;
+    }
+
+    uint8_t pattern[4]{};
+    const int sampleBytes = planePattern(plane.kind, color, pattern);
+    if (!plane.rowValid || (plane.rowColor != color))
+    {
+        const size_t rowBytes = static_cast<size_t>(plane.width) * sampleBytes;
+        if (plane.colorRow->size() < rowBytes)
+        {
+            plane.colorRow->resize(rowBytes);
+        }
+        uint8_t* dst = plane.colorRow->data();
+        for (int x = 0; x < plane.width; ++x, dst += sampleBytes)
+        {
+            std::memcpy(dst, pattern, sampleBytes);
+        }
+        plane.rowColor = color;
+        plane.rowValid = true;
+    }
+
+    uint8_t* dst = plane.data + plane.rowStride * row + static_cast<size_t>(x0) * sampleBytes;
+    const int len = (x1 - x0) * sampleBytes;
+    if (alpha >= impl::CPU2D_ALPHA_ONE)
+    {
+        std::memcpy(dst, plane.colorRow->data(), len);
+    }
+    else
+    {
+        plane.kernels->blendRow(dst, plane.colorRow->data(), len, alpha);
+    }
+}
+
+void OverlayCompositor::renderRectangle(Target& target, const Item& item)
+{
+    const auto& rect = item.rect;
+    if ((rect.width <= 0) || (rect.height <= 0))
+    {
+        return;
+    }
+
+    for (int i = 0; i < target.planeCount; ++i)
+    {
+        auto& plane = target.planes[i];
+        // plane coordinates, rounded outward so subsampled chroma covers every luma pixel
+        const int x0 = floorDiv(rect.x, plane.hsub);
+        const int x1 = ceilDiv(rect.x + rect.width, plane.hsub);
+        const int y0 = floorDiv(rect.y, plane.vsub);
+        const int y1 = ceilDiv(rect.y + rect.height, plane.vsub);
+        const int tx = ceilDiv(item.thickness, plane.hsub);
+        const int ty = ceilDiv(item.thickness, plane.vsub);
+        const bool filled = (item.thickness <= 0) || (2 * tx >= x1 - x0) || (2 * ty >= y1 - y0);
+
+        // every pixel is blended once, edges never overlap
+        for (int row = std::max(y0, 0); row < std::min(y1, plane.height); ++row)
+        {
+            if (filled || (row < y0 + ty) || (row >= y1 - ty))
+            {
+                blendSpan(plane, item.color, row, x0, x1);
+            }
+            else
+            {
+                blendSpan(plane, item.color, row, x0, x0 + tx);
+                blendSpan(plane, item.color, row, x1 - tx, x1);
+            }
+        }
+    }
+}
+
+void OverlayCompositor::renderText(Target& target, const Item& item)
+{
+    const int scale = item.scale;
+    const int maskWidth = item.rect.width;
+    const int maskHeight = item.rect.height;
+    if ((maskWidth <= 0) || (maskHeight <= 0))
+    {
+        return;
+    }
+
+    // luma resolution coverage of the whole string
+    m_mask.assign(static_cast<size_t>(maskWidth) * maskHeight, 0);
+    for (size_t n = 0; n < item.text.size(); ++n)
+    {
+        const uint8_t* columns = glyph(item.text[n]);
+        for (int col = 0; col < GLYPH_WIDTH; ++col)
+        {
+            for (int bit = 0; bit < GLYPH_HEIGHT; ++bit)
+            {
+                if ((columns[col] & (1U << bit)) == 0)
+                {
+                    continue;
+                }
+                const int x = (static_cast<int>(n) * GLYPH_ADVANCE + col) * scale;
+                for (int y = bit * scale; y < (bit + 1) * scale; ++y)
+                {
+                    std::memset(&m_mask[static_cast<size_t>(y) * maskWidth + x], 1, scale);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < target.planeCount; ++i)
+    {
+        auto& plane = target.planes[i];
+        const int x0 = floorDiv(item.rect.x, plane.hsub);
+        const int x1 = ceilDiv(item.rect.x + maskWidth, plane.hsub);
+        const int y0 = floorDiv(item.rect.y, plane.vsub);
+        const int y1 = ceilDiv(item.rect.y + maskHeight, plane.vsub);
+        m_maskRow.resize(static_cast<size_t>(x1 - x0));
+
+        for (int row = std::max(y0, 0); row < std::min(y1, plane.height); ++row)
+        {
+            // a sample is drawn when any luma pixel it covers is set
+            std::fill(m_maskRow.begin(), m_maskRow.end(), 0);
+            for (int sy = 0; sy < plane.vsub; ++sy)
+            {
+                const int my = row * plane.vsub + sy - item.rect.y;
+                if ((my < 0) || (my >= maskHeight))
+                {
+                    continue;
+                }
+                const uint8_t* maskLine = &m_mask[static_cast<size_t>(my) * maskWidth];
+                for (int mx = 0; mx < maskWidth; ++mx)
+                {
+                    m_maskRow[floorDiv(item.rect.x + mx, plane.hsub) - x0] |= maskLine[mx];
+                }
+            }
+
+            for (int start = 0; start < x1 - x0;)
+            {
+                if (m_maskRow[start] == 0)
+                {
+                    ++start;
+                    continue;
+                }
+                int end = start;
+                while ((end < x1 - x0) && (m_maskRow[end] != 0))
+                {
+                    ++end;
+                }
+                blendSpan(plane, item.color, row, x0 + start, x0 + end);
+                start = end;
+            }
+        }
+    }
+}
+
+} // namespace bsp_g2d
@@ -1,4 +1,5 @@
 #include "NvVicGraphics2D.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <stdexcept>
@@ -593,4 +594,130 @@ int NvVicGraphics2D::imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuf
     return performTransform(src_surf, dst_surf, transform_params);
 }
 
+// ========== Batch Operations ==========
+
+int NvVicGraphics2D::performTransformBatch(std::vector<BatchTransform>& transforms)
+{
+    std::vector<NvBufSurfTransformSyncObj_t> syncObjs;
+    syncObjs.reserve(transforms.size());
+
+    int result = 0;
+    for (auto& transform : transforms)
+    {
+        NvBufSurfTransformParams transform_params = {0};
+        transform_params.transform_flag = NVBUFSURF_TRANSFORM_FILTER | NVBUFSURF_TRANSFORM_CROP_SRC | NVBUFSURF_TRANSFORM_CROP_DST;
+        transform_params.transform_filter = NvBufSurfTransformInter_Algo4;
+        transform_params.src_rect = &transform.src_rect;
+        transform_params.dst_rect = &transform.dst_rect;
+
+        NvBufSurfTransformSyncObj_t syncObj = nullptr;
+        int ret = NvBufSurfTransformAsync(transform.src, transform.dst, &transform_params, &syncObj);
+        if (ret != 0)
+        {
+            std::cerr << "NvVicGraphics2D: Async transform failed with error: " << ret << std::endl;
+            result = -1;
+            break;
+        }
+        syncObjs.push_back(syncObj);
+    }
+
+    // always drain what was queued, the rects must outlive the hardware jobs
+    for (auto& syncObj : syncObjs)
+    {
+        if (NvBufSurfTransformSyncObjWait(syncObj, -1) != 0)
+        {
+            std::cerr << "NvVicGraphics2D: Waiting for async transform failed" << std::endl;
+            result = -1;
+        }
+        NvBufSurfTransformSyncObjDestroy(&syncObj);
+    }
+    return result;
+}
+
+int NvVicGraphics2D::imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+    const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+    const std::vector<ImageRect>& dst_rects)
+{
+    if ((srcs.size() != dsts.size()) || (!dst_rects.empty() && (dst_rects.size() != dsts.size())))
+    {
+        std::cerr << "NvVicGraphics2D: imageResizeBatch needs one dst (and dst rect) per src" << std::endl;
+        return -1;
+    }
+
+    std::vector<BatchTransform> transforms;
+    transforms.reserve(srcs.size());
+    for (size_t i = 0; i < srcs.size(); ++i)
+    {
+        NvBufSurface* src_surf = getNvBufSurface(srcs[i]);
+        NvBufSurface* dst_surf = getNvBufSurface(dsts[i]);
+        if (!src_surf || !dst_surf)
+        {
+            std::cerr << "NvVicGraphics2D: Failed to get NvBufSurface for batch resize" << std::endl;
+            return -1;
+        }
+
+        BatchTransform transform{};
+        transform.src = src_surf;
+        transform.dst = dst_surf;
+        transform.src_rect = {0, 0, src_surf->surfaceList[0].width, src_surf->surfaceList[0].height};
+        if (dst_rects.empty())
+        {
+            transform.dst_rect = {0, 0, dst_surf->surfaceList[0].width, dst_surf->surfaceList[0].height};
+        }
+        else
+        {
+            const ImageRect& rect = dst_rects[i];
+            transform.dst_rect = {static_cast<uint32_t>(rect.y), static_cast<uint32_t>(rect.x),
+                                  static_cast<uint32_t>(rect.width), static_cast<uint32_t>(rect.height)};
+        }
+        transforms.push_back(transform);
+    }
+    return performTransformBatch(transforms);
+}
+
+int NvVicGraphics2D::imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
+    const std::vector<ImageRect>& rois,
+    const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts)
+{
+    NvBufSurface* src_surf = getNvBufSurface(src);
+    if (!src_surf || (rois.size() != dsts.size()))
+    {
+        std::cerr << "NvVicGraphics2D: imageCropResizeBatch needs a source and one dst per roi" << std::endl;
+        return -1;
+    }
+    const int src_width = static_cast<int>(src_surf->surfaceList[0].width);
+    const int src_height = static_cast<int>(src_surf->surfaceList[0].height);
+
+    std::vector<BatchTransform> transforms;
+    transforms.reserve(rois.size());
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        NvBufSurface* dst_surf = getNvBufSurface(dsts[i]);
+        if (!dst_surf)
+        {
+            std::cerr << "NvVicGraphics2D: Failed to get NvBufSurface for batch crop" << std::endl;
+            return -1;
+        }
+
+        const int x0 = std::clamp(rois[i].x, 0, src_width);
+        const int y0 = std::clamp(rois[i].y, 0, src_height);
+        const int x1 = std::clamp(rois[i].x + rois[i].width, 0, src_width);
+        const int y1 = std::clamp(rois[i].y + rois[i].height, 0, src_height);
+        if ((x0 >= x1) || (y0 >= y1))
+        {
+            std::cerr << "NvVicGraphics2D: imageCropResizeBatch roi " << i << " outside of the image" << std::endl;
+            return -1;
+        }
+
+        BatchTransform transform{};
+        transform.src = src_surf;
+        transform.dst = dst_surf;
+        transform.src_rect = {static_cast<uint32_t>(y0), static_cast<uint32_t>(x0),
+                              static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)};
+        transform.dst_rect = {0, 0, dst_surf->surfaceList[0].width, dst_surf->surfaceList[0].height};
+        transforms.push_back(transform);
+    }
+    return performTransformBatch(transforms);
+}
+
 } // namespace bsp_g2d
@@ -7,6 +7,7 @@
 #include "nvbufsurftransform.h"
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace bsp_g2d
 {
@@ -72,7 +73,29 @@ public:
     int imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
             const std::string& src_format, const std::string& dst_format) override;
 
+    // ========== Batch Operations ==========
+
+    int imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+            const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+            const std::vector<ImageRect>& dst_rects = {}) override;
+
+    int imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, const std::vector<ImageRect>& rois,
+            const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts) override;
+
 private:
+    struct BatchTransform
+    {
+        NvBufSurface* src;
+        NvBufSurface* dst;
+        NvBufSurfTransformRect src_rect;
+        NvBufSurfTransformRect dst_rect;
+    };
+
+    /**
+     * @brief Queues every transform with NvBufSurfTransformAsync, then waits on all sync objects.
+     */
+    int performTransformBatch(std::vector<BatchTransform>& transforms);
+
     /**
      * @brief Maps format string to NvBufSurfaceColorFormat.
      */
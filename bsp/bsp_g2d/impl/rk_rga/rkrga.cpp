@@ -1,5 +1,7 @@
 #include "rkrga.hpp"
 #include <rga/im2d_common.h>
+#include <rga/im2d_task.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <any>
@@ -28,17 +30,14 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> rkrga::createBuffer(
     const uint32_t widthStride = desc.widthStride > 0 ? desc.widthStride : desc.width;
     const uint32_t heightStride = desc.heightStride > 0 ? desc.heightStride : desc.height;
 
+    const size_t bufferSize = desc.dataSize > 0 ? desc.dataSize : bsp_perf::bsp_image::imageDataSize(desc);
+    rga_buffer_handle_t handle = 0;
+
     if (type == BufferType::Hardware)
     {
         // Hardware buffer: use fd or handle
         if (plane.fd >= 0) {
-            g2dBuffer->g2dBufferHandle = wrapbuffer_fd_t(
-                plane.fd,
-                desc.width,
-                desc.height,
-                widthStride,
-                heightStride,
-                rga_format);
+            handle = importbuffer_fd(plane.fd, static_cast<int>(bufferSize));
         } else {
             std::cerr << "rkrga: Hardware buffer requires fd" << std::endl;
             return nullptr;
@@ -54,15 +53,24 @@ std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> rkrga::createBuffer(
 
         g2dBuffer->hostPtr = plane.data;
         g2dBuffer->bufferSize = desc.dataSize;
-        g2dBuffer->g2dBufferHandle = wrapbuffer_virtualaddr_t(
-            plane.data, desc.width, desc.height,
-            widthStride, heightStride, rga_format);
+        handle = importbuffer_virtualaddr(plane.data, static_cast<int>(bufferSize));
     }
     else
     {
         return nullptr;
     }
 
+    if (handle == 0)
+    {
+        std::cerr << "rkrga: importbuffer failed" << std::endl;
+        return nullptr;
+    }
+    // imported once per buffer so the driver does not map the memory again on every job,
+    // the handle lives as long as the ImageBuffer (IGraphics2D may cache it across calls)
+    g2dBuffer->g2dBufferHandle = wrapbuffer_handle_t(handle, desc.width, desc.height,
+                                                     widthStride, heightStride, rga_format);
+    imageBuffer->release = [handle]() { releasebuffer_handle(handle); };
+
     return imageBuffer;
 }
 
@@ -72,7 +80,7 @@ void rkrga::releaseBuffer(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> buff
     {
         return;
     }
-    // RGA buffers don't need explicit cleanup for wrapped buffers
+    // The imported handle is released by ImageBuffer::release once the last reference goes away
     // The user is responsible for managing the underlying memory
     buffer.reset();
 }
@@ -256,4 +264,173 @@ int rkrga::imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src,
     }
 }
 
+// ========== Batch Operations ==========
+
+namespace
+{
+
+im_rect toImRect(const IGraphics2D::ImageRect& rect)
+{
+    im_rect im{};
+    im.x = rect.x;
+    im.y = rect.y;
+    im.width = rect.width;
+    im.height = rect.height;
+    return im;
+}
+
+} // namespace
+
+int rkrga::submitBatch(const std::vector<BatchTask>& tasks)
+{
+    if (tasks.empty())
+    {
+        return 0;
+    }
+    // WAR: Set rga core affinity for each thread to avoid RGA2 core3 being scheduled
+    static thread_local bool rga_core_affinity_set = false;
+    if (!rga_core_affinity_set)
+    {
+        imconfig(IM_CONFIG_SCHEDULER_CORE, IM_SCHEDULER_CORE::IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_CORE::IM_SCHEDULER_RGA3_CORE1);
+        rga_core_affinity_set = true;
+    }
+
+    for (const auto& task : tasks)
+    {
+        int ret = imcheck(task.src, task.dst, task.src_rect, task.dst_rect);
+        if (ret != IM_STATUS_NOERROR)
+        {
+            std::cerr << "rkrga: batch imcheck failed ret: " << ret << std::endl;
+            return -1;
+        }
+    }
+
+    im_job_handle_t job = imbeginJob();
+    if (job == 0)
+    {
+        std::cerr << "rkrga: imbeginJob failed" << std::endl;
+        return -1;
+    }
+
+    rga_buffer_t pat{};
+    for (const auto& task : tasks)
+    {
+        int ret = improcessTask(job, task.src, task.dst, pat, task.src_rect, task.dst_rect, {}, nullptr, 0);
+        if (ret != IM_STATUS_SUCCESS)
+        {
+            std::cerr << "rkrga: improcessTask failed ret: " << ret << std::endl;
+            imcancelJob(job);
+            return -1;
+        }
+    }
+
+    int ret = imendJob(job);
+    if (ret != IM_STATUS_SUCCESS)
+    {
+        std::cerr << "rkrga: imendJob failed ret: " << ret << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int rkrga::imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+                            const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+                            const std::vector<ImageRect>& dst_rects)
+{
+    if ((srcs.size() != dsts.size()) || (!dst_rects.empty() && (dst_rects.size() != dsts.size())))
+    {
+        std::cerr << "rkrga: imageResizeBatch needs one dst (and dst rect) per src" << std::endl;
+        return -1;
+    }
+
+    std::vector<BatchTask> tasks;
+    tasks.reserve(srcs.size());
+    for (size_t i = 0; i < srcs.size(); ++i)
+    {
+        auto srcBuffer = impl::getG2DBufferInternal(srcs[i]);
+        auto dstBuffer = impl::getG2DBufferInternal(dsts[i]);
+        if (!srcBuffer || !dstBuffer)
+        {
+            return -1;
+        }
+        BatchTask task{};
+        task.src = std::any_cast<rga_buffer_t>(srcBuffer->g2dBufferHandle);
+        task.dst = std::any_cast<rga_buffer_t>(dstBuffer->g2dBufferHandle);
+        task.src_rect = {0, 0, task.src.width, task.src.height};
+        task.dst_rect = dst_rects.empty() ? im_rect{0, 0, task.dst.width, task.dst.height} : toImRect(dst_rects[i]);
+        tasks.push_back(task);
+    }
+    return submitBatch(tasks);
+}
+
+int rkrga::imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, const std::vector<ImageRect>& rois,
+                                const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts)
+{
+    auto srcBuffer = impl::getG2DBufferInternal(src);
+    if (!srcBuffer || (rois.size() != dsts.size()))
+    {
+        return -1;
+    }
+    const rga_buffer_t srcHandle = std::any_cast<rga_buffer_t>(srcBuffer->g2dBufferHandle);
+
+    std::vector<BatchTask> tasks;
+    tasks.reserve(rois.size());
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        auto dstBuffer = impl::getG2DBufferInternal(dsts[i]);
+        if (!dstBuffer)
+        {
+            return -1;
+        }
+        // clip to the source, RGA rejects rects outside of the image
+        const int x0 = std::clamp(rois[i].x, 0, srcHandle.width);
+        const int y0 = std::clamp(rois[i].y, 0, srcHandle.height);
+        const int x1 = std::clamp(rois[i].x + rois[i].width, 0, srcHandle.width);
+        const int y1 = std::clamp(rois[i].y + rois[i].height, 0, srcHandle.height);
+        if ((x0 >= x1) || (y0 >= y1))
+        {
+            std::cerr << "rkrga: imageCropResizeBatch roi " << i << " outside of the image" << std::endl;
+            return -1;
+        }
+
+        BatchTask task{};
+        task.src = srcHandle;
+        task.dst = std::any_cast<rga_buffer_t>(dstBuffer->g2dBufferHandle);
+        task.src_rect = {x0, y0, x1 - x0, y1 - y0};
+        task.dst_rect = {0, 0, task.dst.width, task.dst.height};
+        tasks.push_back(task);
+    }
+    return submitBatch(tasks);
+}
+
+int rkrga::imageDrawRectangles(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst, const std::vector<ImageRect>& rects,
+                               uint32_t color, int thickness)
+{
+    auto dstBuffer = impl::getG2DBufferInternal(dst);
+    if (!dstBuffer)
+    {
+        return -1;
+    }
+    if (rects.empty())
+    {
+        return 0;
+    }
+
+    std::vector<im_rect> imRects;
+    imRects.reserve(rects.size());
+    for (const auto& rect : rects)
+    {
+        imRects.push_back(toImRect(rect));
+    }
+
+    int ret = imrectangleArray(std::any_cast<rga_buffer_t>(dstBuffer->g2dBufferHandle), imRects.data(),
+                               static_cast<int>(imRects.size()), color, thickness);
+    if (ret != IM_STATUS_SUCCESS)
+    {
+        std::cerr << "imageDrawRectangles imrectangleArray failed ret: " << ret << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 } // namespace bsp_g2d
@@ -134,6 +134,32 @@ public:
 
     int imageCvtColor(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst,
                     const std::string& src_format, const std::string& dst_format) override;
+
+    // ========== Batch Operations ==========
+
+    int imageResizeBatch(const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& srcs,
+                         const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts,
+                         const std::vector<ImageRect>& dst_rects = {}) override;
+
+    int imageCropResizeBatch(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> src, const std::vector<ImageRect>& rois,
+                             const std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>>& dsts) override;
+
+    int imageDrawRectangles(std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> dst, const std::vector<ImageRect>& rects,
+                            uint32_t color, int thickness) override;
+
+private:
+    struct BatchTask
+    {
+        rga_buffer_t src;
+        rga_buffer_t dst;
+        im_rect src_rect;
+        im_rect dst_rect;
+    };
+
+    /**
+     * @brief Submit the tasks as one RGA job (imbeginJob / improcessTask / imendJob).
+     */
+    int submitBatch(const std::vector<BatchTask>& tasks);
 };
 
 } // namespace bsp_g2d
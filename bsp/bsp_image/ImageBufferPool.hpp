@@ -0,0 +1,273 @@
+#ifndef __BSP_IMAGE_BUFFER_POOL_HPP__
+#define __BSP_IMAGE_BUFFER_POOL_HPP__
+
+#include "ImageBuffer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace bsp_perf
+{
+namespace bsp_image
+{
+
+/**
+ * @brief Recycling allocator for host ImageBuffers.
+ *
+ * acquire() hands out aligned blocks sized by the ImageDesc; when the last reference to the
+ * buffer memory (ImageBuffer::owner) goes away the block goes back to the pool instead of
+ * being freed, so per-frame decode / conversion paths stop allocating and zeroing. Free
+ * blocks are bucketed by byte size, any desc with the same footprint reuses them.
+ * Buffers may outlive the pool, they are then freed normally.
+ */
+class ImageBufferPool
+{
+public:
+    struct Options
+    {
+        size_t alignment{64};           // power of two, rounded up to the page size with hugePages
+        bool hugePages{false};          // MAP_HUGETLB, falls back to transparent hugepages
+        size_t maxFreePerSize{8};       // free blocks kept per size, extra ones are freed
+        // called with the block address right before the pool frees a block it kept,
+        // e.g. to drop a hardware import of that memory; not called from ~ImageBufferPool
+        std::function<void(uint8_t*)> onFree{};
+    };
+
+    struct Stats
+    {
+        uint64_t allocations{0};    // blocks taken from the system
+        uint64_t reuses{0};         // acquire() served from a free block
+        uint64_t frees{0};          // blocks given back to the system
+        size_t freeBlocks{0};
+        size_t freeBytes{0};
+    };
+
+    ImageBufferPool(): ImageBufferPool(Options{}) {}
+
+    explicit ImageBufferPool(const Options& options)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->options = options;
+        if (m_state->options.alignment < sizeof(void*)) {
+            m_state->options.alignment = sizeof(void*);
+        }
+        if (m_state->options.hugePages) {
+            m_state->options.alignment = std::max(m_state->options.alignment, pageSize());
+        }
+    }
+
+    ~ImageBufferPool()
+    {
+        std::vector<Block*> blocks;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            m_state->alive = false;
+            for (auto& bucket : m_state->freeBlocks) {
+                blocks.insert(blocks.end(), bucket.second.begin(), bucket.second.end());
+            }
+            m_state->freeBlocks.clear();
+        }
+        for (auto* block : blocks) {
+            delete block;
+        }
+    }
+
+    ImageBufferPool(const ImageBufferPool&) = delete;
+    ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+    /**
+     * @brief Host buffer for desc, contents are undefined unless zero is set.
+     * @return nullptr when the desc is empty or the allocation failed
+     */
+    std::shared_ptr<ImageBuffer> acquire(const ImageDesc& desc, bool zero = false)
+    {
+        ImageDesc bufferDesc = desc;
+        if (bufferDesc.dataSize == 0) {
+            bufferDesc.dataSize = imageDataSize(desc);
+        }
+        if (bufferDesc.empty() || bufferDesc.dataSize == 0) {
+            return nullptr;
+        }
+
+        const size_t size = roundUp(bufferDesc.dataSize, m_state->options.alignment);
+        Block* block = takeFreeBlock(size);
+        if (block == nullptr) {
+            block = Block::allocate(size, m_state->options);
+            if (block == nullptr) {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            ++m_state->stats.allocations;
+        }
+        if (zero) {
+            std::memset(block->data, 0, bufferDesc.dataSize);
+        }
+
+        std::weak_ptr<State> weakState = m_state;
+        auto buffer = std::make_shared<ImageBuffer>();
+        buffer->owner = std::shared_ptr<uint8_t>(block->data, [weakState, block](uint8_t*) {
+            recycle(weakState, block);
+        });
+        buffer->view = makeHostImageView(block->data, bufferDesc);
+        return buffer;
+    }
+
+    /**
+     * @brief Free every block kept for reuse.
+     */
+    void trim()
+    {
+        std::vector<Block*> blocks;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            for (auto& bucket : m_state->freeBlocks) {
+                blocks.insert(blocks.end(), bucket.second.begin(), bucket.second.end());
+            }
+            m_state->freeBlocks.clear();
+            m_state->stats.frees += blocks.size();
+            m_state->stats.freeBlocks = 0;
+            m_state->stats.freeBytes = 0;
+        }
+        for (auto* block : blocks) {
+            freeBlock(*m_state, block);
+        }
+    }
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->stats;
+    }
+
+private:
+    struct Block
+    {
+        uint8_t* data{nullptr};
+        size_t size{0};
+        bool mapped{false};
+
+        static Block* allocate(size_t size, const Options& options)
+        {
+            auto* block = new Block();
+            block->size = size;
+            if (options.hugePages) {
+                void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (mem == MAP_FAILED) {
+                    // no reserved hugetlb pages, ask for transparent hugepages instead
+                    mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (mem != MAP_FAILED) {
+                        ::madvise(mem, size, MADV_HUGEPAGE);
+                    }
+                }
+                if (mem != MAP_FAILED) {
+                    block->data = static_cast<uint8_t*>(mem);
+                    block->mapped = true;
+                    return block;
+                }
+            }
+
+            void* mem = nullptr;
+            if (::posix_memalign(&mem, options.alignment, size) != 0) {
+                delete block;
+                return nullptr;
+            }
+            block->data = static_cast<uint8_t*>(mem);
+            return block;
+        }
+
+        ~Block()
+        {
+            if (mapped) {
+                ::munmap(data, size);
+            } else {
+                std::free(data);
+            }
+        }
+    };
+
+    struct State
+    {
+        std::mutex mutex;
+        bool alive{true};
+        Options options;
+        std::unordered_map<size_t, std::vector<Block*>> freeBlocks;
+        Stats stats;
+    };
+
+    static size_t pageSize()
+    {
+        const long size = ::sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t>(size) : 4096;
+    }
+
+    static size_t roundUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static void freeBlock(State& state, Block* block)
+    {
+        if (state.options.onFree) {
+            state.options.onFree(block->data);
+        }
+        delete block;
+    }
+
+    static void recycle(const std::weak_ptr<State>& weakState, Block* block)
+    {
+        auto state = weakState.lock();
+        if (!state) {
+            delete block;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->alive) {
+                delete block;
+                return;
+            }
+            auto& bucket = state->freeBlocks[block->size];
+            if (bucket.size() < state->options.maxFreePerSize) {
+                bucket.push_back(block);
+                ++state->stats.freeBlocks;
+                state->stats.freeBytes += block->size;
+                return;
+            }
+            ++state->stats.frees;
+        }
+        freeBlock(*state, block);
+    }
+
+    Block* takeFreeBlock(size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        auto it = m_state->freeBlocks.find(size);
+        if (it == m_state->freeBlocks.end() || it->second.empty()) {
+            return nullptr;
+        }
+        Block* block = it->second.back();
+        it->second.pop_back();
+        ++m_state->stats.reuses;
+        --m_state->stats.freeBlocks;
+        m_state->stats.freeBytes -= block->size;
+        return block;
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace bsp_image
+} // namespace bsp_perf
+
+#endif // __BSP_IMAGE_BUFFER_POOL_HPP__
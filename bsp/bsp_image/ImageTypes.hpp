@@ -1,6 +1,7 @@
 #ifndef __BSP_IMAGE_TYPES_HPP__
 #define __BSP_IMAGE_TYPES_HPP__
 
+#include "PixelFormat.hpp"
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -73,8 +74,12 @@ struct ImageView
     }
 };
 
+/**
+ * @brief Host view with explicit plane offsets (from data) and row strides in bytes,
+ * e.g. a decoder frame whose chroma plane does not follow the luma rows directly.
+ */
 inline ImageView makeHostImageView(uint8_t* data, const ImageDesc& desc,
-                                   uint32_t rowStride = 0,
+                                   const PlaneLayout& layout,
                                    ImageAccess access = ImageAccess::ReadWrite)
 {
     ImageView view{};
@@ -87,14 +92,40 @@ inline ImageView makeHostImageView(uint8_t* data, const ImageDesc& desc,
     }
     view.memoryType = ImageMemoryType::Host;
     view.access = access;
-    view.planeCount = 1;
-    view.planes[0].data = data;
-    view.planes[0].size = view.desc.dataSize;
-    view.planes[0].rowStride = rowStride > 0 ? rowStride : view.desc.widthStride;
-    view.planes[0].fd = -1;
+    view.planeCount = layout.planeCount;
+    for (uint32_t plane = 0; plane < layout.planeCount && plane < view.planes.size(); ++plane) {
+        view.planes[plane].data = data != nullptr ? data + layout.offset[plane] : nullptr;
+        view.planes[plane].size = layout.size[plane];
+        view.planes[plane].offset = layout.offset[plane];
+        view.planes[plane].rowStride = layout.rowStride[plane];
+        view.planes[plane].fd = -1;
+    }
     return view;
 }
 
+/**
+ * @brief Host view of a packed buffer, one plane per format plane (NV12: Y + UV, I420: Y + U + V).
+ * @param rowStride luma / packed row stride in bytes, 0 derives it from desc.widthStride
+ */
+inline ImageView makeHostImageView(uint8_t* data, const ImageDesc& desc,
+                                   uint32_t rowStride = 0,
+                                   ImageAccess access = ImageAccess::ReadWrite)
+{
+    const uint32_t widthStride = desc.widthStride > 0 ? desc.widthStride : desc.width;
+    const uint32_t heightStride = desc.heightStride > 0 ? desc.heightStride : desc.height;
+    PlaneLayout layout = planeLayout(pixelFormatFromString(desc.format), widthStride, heightStride);
+    if (layout.planeCount == 0) {
+        // format outside the table, expose the whole buffer as one plane
+        layout.planeCount = 1;
+        layout.rowStride[0] = widthStride;
+        layout.size[0] = desc.dataSize;
+    }
+    if (rowStride > 0) {
+        layout.rowStride[0] = rowStride;
+    }
+    return makeHostImageView(data, desc, layout, access);
+}
+
 } // namespace bsp_image
 } // namespace bsp_perf
 
@@ -3,6 +3,7 @@
 
 #include "ImageBuffer.hpp"
 #include <cstring>
+#include <memory>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <string>
@@ -30,6 +31,10 @@ public:
         return -1;
     }
 
+    /**
+     * @brief Header only cv::Mat over a host view. DmaBuf / hardware buffers have to be mapped
+     * first, see bsp_g2d::MappedImageView.
+     */
     static bool toMat(const ImageView& view, cv::Mat& mat)
     {
         const int cvType = cvTypeForFormat(view.desc.format);
@@ -67,7 +72,44 @@ public:
         return !rgb.empty();
     }
 
+    /**
+     * @brief Wrap mat without copying, the ImageBuffer owner holds a cv::Mat reference so the
+     * pixels live as long as the buffer. Writes to mat stay visible through the buffer, use
+     * copyFromMat() when mat is reused for the next frame. Mats that do not own their pixels
+     * (e.g. from toMat()) or whose strided rows overrun the allocation are copied instead.
+     */
     static bool fromMat(const cv::Mat& mat, const std::string& format, ImageBuffer& buffer)
+    {
+        if (mat.empty() || mat.dims != 2) {
+            return false;
+        }
+
+        const size_t elemSize = mat.elemSize();
+        const size_t step = mat.step[0];
+        const bool shareable = (mat.u != nullptr) && (step % elemSize == 0) &&
+                               (mat.data + step * static_cast<size_t>(mat.rows) <= mat.datalimit);
+        if (!shareable) {
+            return copyFromMat(mat, format, buffer);
+        }
+
+        ImageDesc desc{};
+        desc.width = static_cast<uint32_t>(mat.cols);
+        desc.height = static_cast<uint32_t>(mat.rows);
+        desc.widthStride = static_cast<uint32_t>(step / elemSize);
+        desc.heightStride = static_cast<uint32_t>(mat.rows);
+        desc.format = format;
+        desc.dataSize = step * static_cast<size_t>(mat.rows);
+
+        auto owner = std::make_shared<cv::Mat>(mat);
+        buffer.view = makeHostImageView(owner->data, desc, static_cast<uint32_t>(step));
+        buffer.owner = std::move(owner);
+        return true;
+    }
+
+    /**
+     * @brief Deep copy of mat into a packed host buffer.
+     */
+    static bool copyFromMat(const cv::Mat& mat, const std::string& format, ImageBuffer& buffer)
     {
         if (mat.empty()) {
             return false;
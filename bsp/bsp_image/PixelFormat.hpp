@@ -0,0 +1,228 @@
+#ifndef __BSP_IMAGE_PIXEL_FORMAT_HPP__
+#define __BSP_IMAGE_PIXEL_FORMAT_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace bsp_perf
+{
+namespace bsp_image
+{
+
+enum class PixelFormat : uint8_t
+{
+    Unknown,
+    YUV420SP,
+    YUV420P,
+    YUV422SP,
+    YUV422P,
+    YUV444SP,
+    YUV444P,
+    YUV420SP_10BIT,
+    YUV420P_10BIT,
+    YUV422SP_10BIT,
+    YUV422P_10BIT,
+    YUV444SP_10BIT,
+    YUV444P_10BIT,
+    YCbCr_420_SP,
+    YCrCb_420_SP,
+    YCbCr_420_P,
+    YCbCr_444_SP,
+    YCrCb_444_SP,
+    RGB888,
+    BGR888,
+    RGB565,
+    RGB555,
+    RGB444,
+    ARGB8888,
+    XRGB8888,
+    ABGR8888,
+    XBGR8888,
+    BGRA8888,
+    RGBA8888,
+    ARGB1555,
+    ARGB4444,
+    ABGR5551,
+    ABGR4444,
+    RGBA2BPP,
+    A8,
+    Y8,
+    GRAY8,
+    Count
+};
+
+/**
+ * @brief One plane of a format: samples are taken every hsub x vsub pixels and each
+ * sample position stores bitsPerElement bits (all interleaved components, e.g. 16 for NV12 UV).
+ */
+struct PlaneFormat
+{
+    uint8_t hsub{1};
+    uint8_t vsub{1};
+    uint8_t bitsPerElement{0};
+};
+
+struct PixelFormatInfo
+{
+    PixelFormat format{PixelFormat::Unknown};
+    std::string_view name{};
+    uint8_t planeCount{0};
+    uint8_t bitsPerComponent{0};    // widest component
+    bool yuv{false};
+    std::array<PlaneFormat, 3> planes{};
+};
+
+namespace detail
+{
+
+constexpr PlaneFormat FULL8{1, 1, 8};
+
+constexpr std::array<PixelFormatInfo, static_cast<size_t>(PixelFormat::Count)> PIXEL_FORMAT_TABLE{{
+    {PixelFormat::Unknown, "UNKNOWN", 0, 0, false, {}},
+    {PixelFormat::YUV420SP, "YUV420SP", 2, 8, true, {{FULL8, {2, 2, 16}}}},
+    {PixelFormat::YUV420P, "YUV420P", 3, 8, true, {{FULL8, {2, 2, 8}, {2, 2, 8}}}},
+    {PixelFormat::YUV422SP, "YUV422SP", 2, 8, true, {{FULL8, {2, 1, 16}}}},
+    {PixelFormat::YUV422P, "YUV422P", 3, 8, true, {{FULL8, {2, 1, 8}, {2, 1, 8}}}},
+    {PixelFormat::YUV444SP, "YUV444SP", 2, 8, true, {{FULL8, {1, 1, 16}}}},
+    {PixelFormat::YUV444P, "YUV444P", 3, 8, true, {{FULL8, FULL8, FULL8}}},
+    // 10 bit formats are stored packed (MPP / RGA layout), 4 luma samples in 5 bytes
+    {PixelFormat::YUV420SP_10BIT, "YUV420SP_10BIT", 2, 10, true, {{{1, 1, 10}, {2, 2, 20}}}},
+    {PixelFormat::YUV420P_10BIT, "YUV420P_10BIT", 3, 10, true, {{{1, 1, 10}, {2, 2, 10}, {2, 2, 10}}}},
+    {PixelFormat::YUV422SP_10BIT, "YUV422SP_10BIT", 2, 10, true, {{{1, 1, 10}, {2, 1, 20}}}},
+    {PixelFormat::YUV422P_10BIT, "YUV422P_10BIT", 3, 10, true, {{{1, 1, 10}, {2, 1, 10}, {2, 1, 10}}}},
+    {PixelFormat::YUV444SP_10BIT, "YUV444SP_10BIT", 2, 10, true, {{{1, 1, 10}, {1, 1, 20}}}},
+    {PixelFormat::YUV444P_10BIT, "YUV444P_10BIT", 3, 10, true, {{{1, 1, 10}, {1, 1, 10}, {1, 1, 10}}}},
+    {PixelFormat::YCbCr_420_SP, "YCbCr_420_SP", 2, 8, true, {{FULL8, {2, 2, 16}}}},
+    {PixelFormat::YCrCb_420_SP, "YCrCb_420_SP", 2, 8, true, {{FULL8, {2, 2, 16}}}},
+    {PixelFormat::YCbCr_420_P, "YCbCr_420_P", 3, 8, true, {{FULL8, {2, 2, 8}, {2, 2, 8}}}},
+    {PixelFormat::YCbCr_444_SP, "YCbCr_444_SP", 2, 8, true, {{FULL8, {1, 1, 16}}}},
+    {PixelFormat::YCrCb_444_SP, "YCrCb_444_SP", 2, 8, true, {{FULL8, {1, 1, 16}}}},
+    {PixelFormat::RGB888, "RGB888", 1, 8, false, {{{1, 1, 24}}}},
+    {PixelFormat::BGR888, "BGR888", 1, 8, false, {{{1, 1, 24}}}},
+    {PixelFormat::RGB565, "RGB565", 1, 6, false, {{{1, 1, 16}}}},
+    {PixelFormat::RGB555, "RGB555", 1, 5, false, {{{1, 1, 16}}}},
+    {PixelFormat::RGB444, "RGB444", 1, 4, false, {{{1, 1, 16}}}},
+    {PixelFormat::ARGB8888, "ARGB8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::XRGB8888, "XRGB8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::ABGR8888, "ABGR8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::XBGR8888, "XBGR8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::BGRA8888, "BGRA8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::RGBA8888, "RGBA8888", 1, 8, false, {{{1, 1, 32}}}},
+    {PixelFormat::ARGB1555, "ARGB1555", 1, 5, false, {{{1, 1, 16}}}},
+    {PixelFormat::ARGB4444, "ARGB4444", 1, 4, false, {{{1, 1, 16}}}},
+    {PixelFormat::ABGR5551, "ABGR5551", 1, 5, false, {{{1, 1, 16}}}},
+    {PixelFormat::ABGR4444, "ABGR4444", 1, 4, false, {{{1, 1, 16}}}},
+    {PixelFormat::RGBA2BPP, "RGBA2BPP", 1, 2, false, {{{1, 1, 2}}}},
+    {PixelFormat::A8, "A8", 1, 8, false, {{FULL8}}},
+    {PixelFormat::Y8, "Y8", 1, 8, true, {{FULL8}}},
+    {PixelFormat::GRAY8, "GRAY8", 1, 8, false, {{FULL8}}},
+}};
+
+constexpr bool tableMatchesEnum()
+{
+    for (size_t i = 0; i < PIXEL_FORMAT_TABLE.size(); ++i) {
+        if (static_cast<size_t>(PIXEL_FORMAT_TABLE[i].format) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(tableMatchesEnum(), "PIXEL_FORMAT_TABLE must follow the PixelFormat order");
+
+} // namespace detail
+
+constexpr const PixelFormatInfo& pixelFormatInfo(PixelFormat format)
+{
+    return static_cast<size_t>(format) < detail::PIXEL_FORMAT_TABLE.size() ?
+        detail::PIXEL_FORMAT_TABLE[static_cast<size_t>(format)] : detail::PIXEL_FORMAT_TABLE[0];
+}
+
+/**
+ * @brief Format for a name such as "YUV420SP", PixelFormat::Unknown when not in the table.
+ * Lock free, a bounded scan of the constexpr table.
+ */
+constexpr PixelFormat pixelFormatFromString(std::string_view name)
+{
+    for (const auto& info : detail::PIXEL_FORMAT_TABLE) {
+        if (info.name == name) {
+            return info.format;
+        }
+    }
+    return PixelFormat::Unknown;
+}
+
+constexpr std::string_view pixelFormatName(PixelFormat format)
+{
+    return pixelFormatInfo(format).name;
+}
+
+/**
+ * @brief Bytes per row of a plane for a width stride in pixels.
+ */
+constexpr uint32_t planeRowBytes(PixelFormat format, uint32_t plane, uint32_t widthStride)
+{
+    const auto& info = pixelFormatInfo(format);
+    if (plane >= info.planeCount) {
+        return 0;
+    }
+    const auto& planeFormat = info.planes[plane];
+    const uint64_t samples = (widthStride + planeFormat.hsub - 1) / planeFormat.hsub;
+    return static_cast<uint32_t>((samples * planeFormat.bitsPerElement + 7) / 8);
+}
+
+/**
+ * @brief Rows of a plane for a height stride in pixels.
+ */
+constexpr uint32_t planeRows(PixelFormat format, uint32_t plane, uint32_t heightStride)
+{
+    const auto& info = pixelFormatInfo(format);
+    if (plane >= info.planeCount) {
+        return 0;
+    }
+    return (heightStride + info.planes[plane].vsub - 1) / info.planes[plane].vsub;
+}
+
+/**
+ * @brief Byte layout of the planes inside one buffer.
+ */
+struct PlaneLayout
+{
+    uint32_t planeCount{0};
+    std::array<size_t, 4> offset{};
+    std::array<uint32_t, 4> rowStride{};    // bytes
+    std::array<size_t, 4> size{};
+    size_t totalSize{0};
+};
+
+/**
+ * @brief Planes packed back to back, each row planeRowBytes() long (the RGA / MPP layout).
+ */
+constexpr PlaneLayout planeLayout(PixelFormat format, uint32_t widthStride, uint32_t heightStride)
+{
+    PlaneLayout layout{};
+    const auto& info = pixelFormatInfo(format);
+    layout.planeCount = info.planeCount;
+    for (uint32_t plane = 0; plane < info.planeCount; ++plane) {
+        layout.offset[plane] = layout.totalSize;
+        layout.rowStride[plane] = planeRowBytes(format, plane, widthStride);
+        layout.size[plane] = static_cast<size_t>(layout.rowStride[plane]) * planeRows(format, plane, heightStride);
+        layout.totalSize += layout.size[plane];
+    }
+    return layout;
+}
+
+constexpr size_t imageDataSize(PixelFormat format, uint32_t widthStride, uint32_t heightStride)
+{
+    return planeLayout(format, widthStride, heightStride).totalSize;
+}
+
+static_assert(imageDataSize(PixelFormat::YUV420SP, 1920, 1080) == 1920 * 1080 * 3 / 2, "NV12 size");
+static_assert(planeRowBytes(PixelFormat::YUV420P, 1, 1920) == 960, "I420 chroma stride");
+
+} // namespace bsp_image
+} // namespace bsp_perf
+
+#endif // __BSP_IMAGE_PIXEL_FORMAT_HPP__
@@ -0,0 +1,244 @@
+#ifndef __BSP_PIPELINE_BOUNDED_QUEUE_HPP__
+#define __BSP_PIPELINE_BOUNDED_QUEUE_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace bsp_pipeline
+{
+
+/**
+ * @brief Bounded multi producer / multi consumer queue (Vyukov ring), the link between two
+ * pipeline stages.
+ *
+ * tryPush() / tryPop() are lock-free: a CAS on the head or tail plus a sequence number per
+ * slot. push() / pop() fall back to sleeping on a condition variable only when the ring is
+ * full / empty, and the other side takes the mutex only while somebody sleeps, so a stage that
+ * keeps up never touches a lock. A full ring blocks the producer, that is the backpressure.
+ *
+ * close() wakes everybody: push() fails from then on, pop() still drains what is queued.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @param capacity rounded up to a power of two, at least 2
+     */
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t ringSize = 2;
+        while (ringSize < capacity)
+        {
+            ringSize <<= 1;
+        }
+        m_ring = std::make_unique<Slot[]>(ringSize);
+        m_ring_mask = ringSize - 1;
+        for (size_t i = 0; i < ringSize; i++)
+        {
+            m_ring[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Enqueue without waiting, item is moved from only on success.
+     */
+    bool tryPush(T& item)
+    {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true)
+        {
+            slot = &m_ring[pos & m_ring_mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(item);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        wake(m_pop_waiters, m_not_empty);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue without waiting.
+     */
+    bool tryPop(T& item)
+    {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true)
+        {
+            slot = &m_ring[pos & m_ring_mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(slot->value);
+        // drop what the moved-from value still references before the slot is reused
+        slot->value = T{};
+        slot->seq.store(pos + m_ring_mask + 1, std::memory_order_release);
+        wake(m_push_waiters, m_not_full);
+        return true;
+    }
+
+    /**
+     * @brief Enqueue, waits while the queue is full.
+     * @return false once the queue is closed, item is dropped then
+     */
+    bool push(T item)
+    {
+        while (!m_closed.load(std::memory_order_acquire))
+        {
+            if (tryPush(item))
+            {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(m_wait_mutex);
+            m_push_waiters.fetch_add(1, std::memory_order_seq_cst);
+            // re-check after announcing the waiter, a pop in between did not see it
+            if (full() && !m_closed.load(std::memory_order_acquire))
+            {
+                m_not_full.wait(lock);
+            }
+            m_push_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Dequeue, waits while the queue is empty.
+     * @return false when the queue is closed and drained
+     */
+    bool pop(T& item)
+    {
+        while (true)
+        {
+            if (tryPop(item))
+            {
+                return true;
+            }
+            if (m_closed.load(std::memory_order_acquire))
+            {
+                // a push may have landed right before close()
+                return tryPop(item);
+            }
+            std::unique_lock<std::mutex> lock(m_wait_mutex);
+            m_pop_waiters.fetch_add(1, std::memory_order_seq_cst);
+            if (empty() && !m_closed.load(std::memory_order_acquire))
+            {
+                m_not_empty.wait(lock);
+            }
+            m_pop_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wait_mutex);
+            m_closed.store(true, std::memory_order_release);
+        }
+        m_not_empty.notify_all();
+        m_not_full.notify_all();
+    }
+
+    bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Items queued right now, approximate while other threads push or pop.
+     */
+    size_t size() const
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_relaxed);
+        return (head > tail) ? (head - tail) : 0;
+    }
+
+    size_t capacity() const { return m_ring_mask + 1; }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> seq{0};
+        T value{};
+    };
+
+    bool full() const
+    {
+        size_t pos = m_head.load(std::memory_order_seq_cst);
+        return m_ring[pos & m_ring_mask].seq.load(std::memory_order_seq_cst) != pos;
+    }
+
+    bool empty() const
+    {
+        size_t pos = m_tail.load(std::memory_order_seq_cst);
+        return m_ring[pos & m_ring_mask].seq.load(std::memory_order_seq_cst) != pos + 1;
+    }
+
+    void wake(std::atomic<int>& waiters, std::condition_variable& cv)
+    {
+        // pairs with the seq_cst increment of a waiter that is about to re-check the ring
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_wait_mutex);
+            }
+            cv.notify_all();
+        }
+    }
+
+private:
+    std::unique_ptr<Slot[]> m_ring;
+    size_t m_ring_mask{0};
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+
+    alignas(64) std::atomic<int> m_push_waiters{0};
+    std::atomic<int> m_pop_waiters{0};
+    std::atomic<bool> m_closed{false};
+    std::mutex m_wait_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+};
+
+} // namespace bsp_pipeline
+
+#endif // __BSP_PIPELINE_BOUNDED_QUEUE_HPP__
@@ -0,0 +1,125 @@
+#ifndef __BSP_PIPELINE_FRAME_POOL_HPP__
+#define __BSP_PIPELINE_FRAME_POOL_HPP__
+
+#include <bsp_image/ImageBufferPool.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace bsp_pipeline
+{
+
+/**
+ * @brief Fixed budget of host frames flowing through a pipeline.
+ *
+ * acquire() waits while frames() buffers are alive, a frame comes back when its last
+ * ImageBuffer reference is dropped, typically by the last stage. The memory is recycled by an
+ * ImageBufferPool, so a stage that copies frames out of decoder or camera memory neither
+ * allocates nor grows without bound when a later stage falls behind.
+ */
+class FramePool
+{
+public:
+    static constexpr size_t DEFAULT_FRAMES{8};
+
+    explicit FramePool(size_t frames = DEFAULT_FRAMES,
+                       const bsp_perf::bsp_image::ImageBufferPool::Options& options = {}):
+        m_pool(options),
+        m_slots(std::make_shared<SlotState>())
+    {
+        m_slots->capacity = (frames > 0) ? frames : 1;
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Frame for desc, contents are undefined.
+     * @param timeout_ms -1 waits forever
+     * @return nullptr on timeout, after cancel() or when the allocation failed
+     */
+    std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> acquire(const bsp_perf::bsp_image::ImageDesc& desc,
+                                                               int timeout_ms = -1)
+    {
+        auto slots = m_slots;
+        {
+            std::unique_lock<std::mutex> lock(slots->mutex);
+            auto ready = [&slots]() { return slots->cancelled || (slots->in_use < slots->capacity); };
+            if (timeout_ms < 0)
+            {
+                slots->cv.wait(lock, ready);
+            }
+            else if (!slots->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready))
+            {
+                return nullptr;
+            }
+            if (slots->cancelled)
+            {
+                return nullptr;
+            }
+            ++slots->in_use;
+        }
+
+        auto buffer = m_pool.acquire(desc);
+        if (buffer == nullptr)
+        {
+            slots->release();
+            return nullptr;
+        }
+        buffer->release = [slots]() { slots->release(); };
+        return buffer;
+    }
+
+    /**
+     * @brief Wake every waiting acquire(), it returns nullptr from now on (pipeline abort).
+     */
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_slots->mutex);
+            m_slots->cancelled = true;
+        }
+        m_slots->cv.notify_all();
+    }
+
+    size_t frames() const { return m_slots->capacity; }
+
+    /**
+     * @brief Frames alive right now.
+     */
+    size_t inFlight() const
+    {
+        std::lock_guard<std::mutex> lock(m_slots->mutex);
+        return m_slots->in_use;
+    }
+
+    bsp_perf::bsp_image::ImageBufferPool& pool() { return m_pool; }
+
+private:
+    struct SlotState
+    {
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        size_t capacity{DEFAULT_FRAMES};
+        size_t in_use{0};
+        bool cancelled{false};
+
+        void release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --in_use;
+            }
+            cv.notify_one();
+        }
+    };
+
+private:
+    bsp_perf::bsp_image::ImageBufferPool m_pool;
+    std::shared_ptr<SlotState> m_slots;
+};
+
+} // namespace bsp_pipeline
+
+#endif // __BSP_PIPELINE_FRAME_POOL_HPP__
@@ -0,0 +1,633 @@
+#ifndef __BSP_PIPELINE_HPP__
+#define __BSP_PIPELINE_HPP__
+
+#include <bsp_pipeline/BoundedQueue.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bsp_perf {
+namespace common {
+class StatsCounter;
+class StatsGauge;
+class StatsHistogram;
+} // namespace common
+} // namespace bsp_perf
+
+namespace bsp_pipeline
+{
+
+/**
+ * @brief What travels through a queue: one item, or the end of stream marker.
+ */
+template <typename T>
+struct Envelope
+{
+    T value{};
+    uint64_t seq{0};
+    bool eos{false};
+};
+
+template <typename T>
+using StageQueue = BoundedQueue<Envelope<T>>;
+
+struct StageOptions
+{
+    // threads running the stage function, items may then finish out of order
+    int workers{1};
+    // with more than one worker, hand the outputs downstream in input order
+    bool ordered{true};
+    // items buffered between this stage and the next one, 0 takes the pipeline default
+    size_t queue_capacity{0};
+    // BspThreadConfig role of the stage threads, the stage name when empty
+    std::string thread_role{};
+};
+
+/**
+ * @brief Counters of one stage since start(). busy + idle + blocked is the thread time, a
+ * stage that is never idle is the bottleneck, one that is mostly blocked waits on the next.
+ */
+struct StageStats
+{
+    std::string name{};
+    int workers{0};
+    uint64_t items{0};          // inputs consumed
+    uint64_t outputs{0};        // items pushed downstream
+    uint64_t errors{0};
+    uint64_t busy_us{0};        // inside the stage function
+    uint64_t idle_us{0};        // waiting for input
+    uint64_t blocked_us{0};     // waiting for room downstream
+    size_t queue_depth{0};      // input queue right now
+    size_t queue_capacity{0};
+    double latency_p50_us{0.0};
+    double latency_p99_us{0.0};
+};
+
+/**
+ * @brief Typed output of a stage, the input of exactly one following stage.
+ */
+template <typename T>
+struct Port
+{
+    std::shared_ptr<StageQueue<T>> queue{};
+    size_t id{0};
+};
+
+class Pipeline;
+class FramePool;
+
+/**
+ * @brief Non template part of a stage: threads, EOS bookkeeping and metrics.
+ */
+class StageBase
+{
+public:
+    StageBase(Pipeline& pipeline, const std::string& name, const StageOptions& options);
+    virtual ~StageBase();
+
+    StageBase(const StageBase&) = delete;
+    StageBase& operator=(const StageBase&) = delete;
+
+    const std::string& name() const { return m_name; }
+
+    const StageOptions& options() const { return m_options; }
+
+    StageStats stats() const;
+
+    bool aborted() const;
+
+    /**
+     * @brief Count time spent waiting on a full output queue.
+     */
+    void addBlocked(uint64_t ns);
+
+    void addOutput() { m_outputs.fetch_add(1, std::memory_order_relaxed); }
+
+    static uint64_t nowNs();
+
+    /**
+     * @brief Blocked time of the calling thread so far, keeps backpressure out of the latency.
+     */
+    static uint64_t threadBlockedNs();
+
+protected:
+    friend class Pipeline;
+
+    /**
+     * @brief Body of every stage thread.
+     */
+    virtual void run() = 0;
+
+    /**
+     * @brief Close the queues the stage reads and writes and drop what its input still holds,
+     * wakes its threads on abort.
+     */
+    virtual void closeQueues() = 0;
+
+    virtual size_t inputDepth() const { return 0; }
+
+    virtual size_t inputCapacity() const { return 0; }
+
+    /**
+     * @brief Account one worker leaving on EOS.
+     * @return true for the last one, which flushes and forwards the EOS
+     */
+    bool leaveOnEos() { return m_active.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    void addIdle(uint64_t ns);
+
+    /**
+     * @brief One input done in ns, blocked time excluded.
+     */
+    void addItem(uint64_t ns, bool failed);
+
+    /**
+     * @brief Time of a source function, it has no inputs.
+     */
+    void addRun(uint64_t ns, bool failed);
+
+    /**
+     * @brief Count a failed flush.
+     */
+    void addError();
+
+    void setQueueDepth(size_t depth);
+
+protected:
+    Pipeline& m_pipeline;
+    std::string m_name;
+    StageOptions m_options;
+    std::atomic<int> m_active{0};
+
+private:
+    std::atomic<uint64_t> m_items{0};
+    std::atomic<uint64_t> m_outputs{0};
+    std::atomic<uint64_t> m_errors{0};
+    std::atomic<uint64_t> m_busy_ns{0};
+    std::atomic<uint64_t> m_idle_ns{0};
+    std::atomic<uint64_t> m_blocked_ns{0};
+
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_items;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_errors;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_idle;
+    std::shared_ptr<bsp_perf::common::StatsCounter> m_stat_blocked;
+    std::shared_ptr<bsp_perf::common::StatsGauge> m_stat_queue_depth;
+    std::shared_ptr<bsp_perf::common::StatsHistogram> m_stat_latency;
+};
+
+/**
+ * @brief Output side handed to stage functions, push() is thread safe.
+ */
+template <typename T>
+class Emitter
+{
+public:
+    Emitter(StageBase& stage, std::shared_ptr<StageQueue<T>> queue):
+        m_stage(stage),
+        m_queue(std::move(queue))
+    {
+    }
+
+    /**
+     * @brief Emitter collecting into outputs instead of a queue (ordered multi worker stages).
+     */
+    Emitter(StageBase& stage, std::vector<T>& outputs):
+        m_stage(stage),
+        m_outputs(&outputs)
+    {
+    }
+
+    Emitter(const Emitter&) = delete;
+    Emitter& operator=(const Emitter&) = delete;
+
+    /**
+     * @brief Send one item downstream, waits while the next stage is behind.
+     * @return false when the pipeline is aborted, the item is dropped
+     */
+    bool push(T value)
+    {
+        if (m_stage.aborted())
+        {
+            // tryPush() would still fill a closed queue that nobody drains any more
+            return false;
+        }
+        if (m_outputs != nullptr)
+        {
+            m_outputs->push_back(std::move(value));
+            return !m_stage.aborted();
+        }
+
+        Envelope<T> env;
+        env.value = std::move(value);
+        env.seq = m_seq.fetch_add(1, std::memory_order_relaxed);
+        if (m_queue->tryPush(env))
+        {
+            m_stage.addOutput();
+            return true;
+        }
+        uint64_t start = StageBase::nowNs();
+        bool ret = m_queue->push(std::move(env));
+        m_stage.addBlocked(StageBase::nowNs() - start);
+        if (ret)
+        {
+            m_stage.addOutput();
+        }
+        return ret;
+    }
+
+    /**
+     * @brief True once the pipeline is aborted, long running sources should return then.
+     */
+    bool stopped() const { return m_stage.aborted(); }
+
+    /**
+     * @brief End of stream marker, sent by the stage after its flush.
+     */
+    bool pushEos()
+    {
+        Envelope<T> env;
+        env.seq = m_seq.load(std::memory_order_relaxed);
+        env.eos = true;
+        return m_queue->push(std::move(env));
+    }
+
+private:
+    StageBase& m_stage;
+    std::shared_ptr<StageQueue<T>> m_queue{};
+    std::vector<T>* m_outputs{nullptr};
+    std::atomic<uint64_t> m_seq{0};
+};
+
+/**
+ * @brief Stage without input, fn runs once on the stage thread (or hands an Emitter to decoder
+ * callbacks) and pushes every item. The EOS follows when fn returns.
+ */
+template <typename Out>
+class SourceStage : public StageBase
+{
+public:
+    using sourceFunc = std::function<int(Emitter<Out>& out)>;
+
+    SourceStage(Pipeline& pipeline, const std::string& name, sourceFunc fn, const StageOptions& options,
+                std::shared_ptr<StageQueue<Out>> output):
+        StageBase(pipeline, name, options),
+        m_fn(std::move(fn)),
+        m_output(output),
+        m_emitter(*this, std::move(output))
+    {
+        m_options.workers = 1;
+    }
+
+protected:
+    void run() override
+    {
+        uint64_t start = nowNs();
+        uint64_t blocked = threadBlockedNs();
+        int ret = m_fn(m_emitter);
+        addRun(nowNs() - start - (threadBlockedNs() - blocked), ret < 0);
+        m_emitter.pushEos();
+    }
+
+    void closeQueues() override { m_output->close(); }
+
+private:
+    sourceFunc m_fn;
+    std::shared_ptr<StageQueue<Out>> m_output;
+    Emitter<Out> m_emitter;
+};
+
+/**
+ * @brief Stage reading one queue with options().workers threads. The worker that takes the
+ * EOS passes it on to its siblings and leaves, the last one to leave calls finish(), so
+ * finish() runs after every item of the stream went through consume().
+ */
+template <typename In>
+class ConsumerStage : public StageBase
+{
+public:
+    ConsumerStage(Pipeline& pipeline, const std::string& name, const StageOptions& options,
+                  std::shared_ptr<StageQueue<In>> input):
+        StageBase(pipeline, name, options),
+        m_input(std::move(input))
+    {
+    }
+
+protected:
+    virtual int consume(Envelope<In>& env) = 0;
+
+    virtual void finish() = 0;
+
+    void run() override
+    {
+        Envelope<In> env;
+        while (true)
+        {
+            uint64_t start = nowNs();
+            if (!m_input->pop(env))
+            {
+                // closed by abort
+                return;
+            }
+            uint64_t popped = nowNs();
+            addIdle(popped - start);
+            setQueueDepth(m_input->size());
+
+            if (env.eos)
+            {
+                if (leaveOnEos())
+                {
+                    finish();
+                }
+                else
+                {
+                    m_input->push(std::move(env));
+                }
+                return;
+            }
+            if (aborted())
+            {
+                continue;
+            }
+            uint64_t blocked = threadBlockedNs();
+            int ret = consume(env);
+            addItem(nowNs() - popped - (threadBlockedNs() - blocked), ret < 0);
+        }
+    }
+
+    size_t inputDepth() const override { return m_input->size(); }
+
+    size_t inputCapacity() const override { return m_input->capacity(); }
+
+    /**
+     * @brief Close the input and drop the queued items, the frames they hold go back to their
+     * pool even when the stage threads have already left.
+     */
+    void closeInput()
+    {
+        m_input->close();
+        Envelope<In> env;
+        while (m_input->tryPop(env))
+        {
+            env = Envelope<In>{};
+        }
+    }
+
+protected:
+    std::shared_ptr<StageQueue<In>> m_input;
+};
+
+/**
+ * @brief Stage turning every In into zero or more Out, flush runs once after the last input
+ * (drain a decoder or encoder).
+ */
+template <typename In, typename Out>
+class ProcessStage : public ConsumerStage<In>
+{
+public:
+    using processFunc = std::function<int(In& in, Emitter<Out>& out)>;
+    using flushFunc = std::function<int(Emitter<Out>& out)>;
+
+    ProcessStage(Pipeline& pipeline, const std::string& name, processFunc fn, flushFunc flush,
+                 const StageOptions& options, std::shared_ptr<StageQueue<In>> input,
+                 std::shared_ptr<StageQueue<Out>> output):
+        ConsumerStage<In>(pipeline, name, options, std::move(input)),
+        m_fn(std::move(fn)),
+        m_flush(std::move(flush)),
+        m_output(output),
+        m_emitter(*this, std::move(output))
+    {
+    }
+
+protected:
+    int consume(Envelope<In>& env) override
+    {
+        if ((this->m_options.workers <= 1) || !this->m_options.ordered)
+        {
+            return m_fn(env.value, m_emitter);
+        }
+
+        // the outputs of one input are held back until every earlier input was released
+        std::vector<Out> outputs;
+        Emitter<Out> collector(*this, outputs);
+        int ret = m_fn(env.value, collector);
+
+        std::lock_guard<std::mutex> lock(m_reorder_mutex);
+        m_reorder.emplace(env.seq, std::move(outputs));
+        while (!m_reorder.empty() && (m_reorder.begin()->first == m_next_seq))
+        {
+            for (auto& out : m_reorder.begin()->second)
+            {
+                m_emitter.push(std::move(out));
+            }
+            m_reorder.erase(m_reorder.begin());
+            ++m_next_seq;
+        }
+        return ret;
+    }
+
+    void finish() override
+    {
+        if ((m_flush != nullptr) && (m_flush(m_emitter) < 0))
+        {
+            this->addError();
+        }
+        m_emitter.pushEos();
+    }
+
+    void closeQueues() override
+    {
+        m_output->close();
+        this->closeInput();
+    }
+
+private:
+    processFunc m_fn;
+    flushFunc m_flush;
+    std::shared_ptr<StageQueue<Out>> m_output;
+    Emitter<Out> m_emitter;
+
+    std::mutex m_reorder_mutex;
+    std::map<uint64_t, std::vector<Out>> m_reorder{};
+    uint64_t m_next_seq{0};
+};
+
+/**
+ * @brief Last stage of a branch, flush runs once after the last input.
+ */
+template <typename In>
+class SinkStage : public ConsumerStage<In>
+{
+public:
+    using sinkFunc = std::function<int(In& in)>;
+    using flushFunc = std::function<int()>;
+
+    SinkStage(Pipeline& pipeline, const std::string& name, sinkFunc fn, flushFunc flush,
+              const StageOptions& options, std::shared_ptr<StageQueue<In>> input):
+        ConsumerStage<In>(pipeline, name, options, std::move(input)),
+        m_fn(std::move(fn)),
+        m_flush(std::move(flush))
+    {
+    }
+
+protected:
+    int consume(Envelope<In>& env) override { return m_fn(env.value); }
+
+    void finish() override
+    {
+        if ((m_flush != nullptr) && (m_flush() < 0))
+        {
+            this->addError();
+        }
+    }
+
+    void closeQueues() override { this->closeInput(); }
+
+private:
+    sinkFunc m_fn;
+    flushFunc m_flush;
+};
+
+/**
+ * @brief Stages connected by bounded queues, every stage on its own thread(s).
+ *
+ * Items of any movable type (shared_ptr<ImageBuffer>, StreamPacket ...) flow from a source
+ * through process stages into sinks. A full queue blocks the stage feeding it, so the slowest
+ * stage paces the others and memory stays bounded; with a FramePool handing out the frames the
+ * number of frames alive is bounded as well. When a source returns its EOS travels behind the
+ * last item, each stage drains its input, runs its flush and passes the EOS on, wait() returns
+ * once every sink flushed.
+ *
+ *     Pipeline pipeline("transcode");
+ *     auto packets = pipeline.addSource<StreamPacket>("demux", [&](Emitter<StreamPacket>& out) {...});
+ *     auto frames = pipeline.addStage<FramePtr>("decode", packets, decodeFn, drainFn);
+ *     auto drawn = pipeline.addStage<FramePtr>("detect", frames, detectFn, nullptr, {.workers = 2});
+ *     pipeline.addSink("encode", drawn, encodeFn, flushFn);
+ *     pipeline.run();
+ *     std::cout << pipeline.statsReport();
+ *
+ * Per stage items, busy / idle / blocked time, input queue depth and latency are exported to
+ * StatsRegistry as pipeline_stage_* labelled {pipeline, stage}.
+ */
+class Pipeline
+{
+public:
+    static constexpr char LOG_TAG[] {"[Pipeline]: "};
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY{4};
+
+    explicit Pipeline(const std::string& name, size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+
+    /**
+     * @brief Aborts a running pipeline and joins its threads.
+     */
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    template <typename Out>
+    Port<Out> addSource(const std::string& name, typename SourceStage<Out>::sourceFunc fn,
+                        const StageOptions& options = {})
+    {
+        Port<Out> output = newPort<Out>(options);
+        m_stages.push_back(std::make_unique<SourceStage<Out>>(*this, name, std::move(fn), options, output.queue));
+        return output;
+    }
+
+    template <typename Out, typename In>
+    Port<Out> addStage(const std::string& name, const Port<In>& input,
+                       typename ProcessStage<In, Out>::processFunc fn,
+                       typename ProcessStage<In, Out>::flushFunc flush = nullptr,
+                       const StageOptions& options = {})
+    {
+        consumePort(input.id, name);
+        Port<Out> output = newPort<Out>(options);
+        m_stages.push_back(std::make_unique<ProcessStage<In, Out>>(*this, name, std::move(fn), std::move(flush),
+                                                                   options, input.queue, output.queue));
+        return output;
+    }
+
+    template <typename In>
+    void addSink(const std::string& name, const Port<In>& input, typename SinkStage<In>::sinkFunc fn,
+                 typename SinkStage<In>::flushFunc flush = nullptr, const StageOptions& options = {})
+    {
+        consumePort(input.id, name);
+        m_stages.push_back(std::make_unique<SinkStage<In>>(*this, name, std::move(fn), std::move(flush),
+                                                           options, input.queue));
+    }
+
+    /**
+     * @brief Start every stage thread.
+     * @return 0 success, -1 when already started or a port is not read by exactly one stage
+     */
+    int start();
+
+    /**
+     * @brief Wait until the EOS went through every stage and join the threads.
+     * @return 0 success, -1 when a stage function failed or the pipeline was aborted
+     */
+    int wait();
+
+    int run()
+    {
+        int ret = start();
+        return (ret == 0) ? wait() : ret;
+    }
+
+    /**
+     * @brief Frames of pool are held by the stages, abort() cancels it so that a stage waiting
+     * in FramePool::acquire() returns. pool has to outlive the pipeline.
+     */
+    void addFramePool(FramePool& pool);
+
+    /**
+     * @brief Stop without draining: queues are closed, queued items dropped, the frame pools
+     * cancelled, blocked stages return. Sources see Emitter::push() fail.
+     */
+    void abort();
+
+    bool aborted() const { return m_aborted.load(std::memory_order_acquire); }
+
+    const std::string& name() const { return m_name; }
+
+    std::vector<StageStats> stats() const;
+
+    /**
+     * @brief One line per stage: items, busy / idle / blocked share, queue, latency.
+     */
+    std::string statsReport() const;
+
+private:
+    template <typename T>
+    Port<T> newPort(const StageOptions& options)
+    {
+        Port<T> port;
+        size_t capacity = (options.queue_capacity > 0) ? options.queue_capacity : m_queue_capacity;
+        port.queue = std::make_shared<StageQueue<T>>(capacity);
+        port.id = m_port_readers.size();
+        m_port_readers.push_back(0);
+        return port;
+    }
+
+    void consumePort(size_t id, const std::string& stage);
+
+private:
+    std::string m_name;
+    size_t m_queue_capacity{DEFAULT_QUEUE_CAPACITY};
+    std::vector<std::unique_ptr<StageBase>> m_stages{};
+    std::vector<int> m_port_readers{};
+    bool m_setup_error{false};
+    std::vector<std::thread> m_threads{};
+    std::vector<FramePool*> m_frame_pools{};
+    std::atomic<bool> m_aborted{false};
+};
+
+} // namespace bsp_pipeline
+
+#endif // __BSP_PIPELINE_HPP__
@@ -0,0 +1,269 @@
+#include <bsp_pipeline/Pipeline.hpp>
+#include <bsp_pipeline/FramePool.hpp>
+#include <profiler/StatsRegistry.hpp>
+#include <shared/BspThreadConfig.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace bsp_pipeline
+{
+
+using bsp_perf::common::StatsRegistry;
+
+constexpr char Pipeline::LOG_TAG[];
+
+namespace
+{
+thread_local uint64_t t_blocked_ns{0};
+} // namespace
+
+StageBase::StageBase(Pipeline& pipeline, const std::string& name, const StageOptions& options):
+    m_pipeline(pipeline),
+    m_name(name),
+    m_options(options)
+{
+    if (m_options.workers < 1)
+    {
+        m_options.workers = 1;
+    }
+    if (m_options.thread_role.empty())
+    {
+        m_options.thread_role = name;
+    }
+
+    auto& stats = StatsRegistry::getInstance();
+    StatsRegistry::Labels labels{{"pipeline", pipeline.name()}, {"stage", name}};
+    m_stat_items = stats.counter("pipeline_stage_items_total", "Inputs processed by the pipeline stage", labels);
+    m_stat_errors = stats.counter("pipeline_stage_errors_total", "Pipeline stage calls that returned an error", labels);
+    m_stat_idle = stats.counter("pipeline_stage_idle_us_total", "Microseconds the stage waited for input", labels);
+    m_stat_blocked = stats.counter("pipeline_stage_blocked_us_total", "Microseconds the stage waited for room downstream", labels);
+    m_stat_queue_depth = stats.gauge("pipeline_stage_queue_depth", "Items waiting in the input queue of the stage", labels);
+    m_stat_latency = stats.histogram("pipeline_stage_latency_us", "Pipeline stage time per input in microseconds", labels);
+}
+
+StageBase::~StageBase() = default;
+
+StageStats StageBase::stats() const
+{
+    StageStats stats;
+    stats.name = m_name;
+    stats.workers = m_options.workers;
+    stats.items = m_items.load(std::memory_order_relaxed);
+    stats.outputs = m_outputs.load(std::memory_order_relaxed);
+    stats.errors = m_errors.load(std::memory_order_relaxed);
+    stats.busy_us = m_busy_ns.load(std::memory_order_relaxed) / 1000;
+    stats.idle_us = m_idle_ns.load(std::memory_order_relaxed) / 1000;
+    stats.blocked_us = m_blocked_ns.load(std::memory_order_relaxed) / 1000;
+    stats.queue_depth = inputDepth();
+    stats.queue_capacity = inputCapacity();
+    if (m_stat_latency->getCount() > 0)
+    {
+        stats.latency_p50_us = m_stat_latency->percentile(0.5);
+        stats.latency_p99_us = m_stat_latency->percentile(0.99);
+    }
+    return stats;
+}
+
+bool StageBase::aborted() const
+{
+    return m_pipeline.aborted();
+}
+
+void StageBase::addBlocked(uint64_t ns)
+{
+    t_blocked_ns += ns;
+    m_blocked_ns.fetch_add(ns, std::memory_order_relaxed);
+    m_stat_blocked->inc(ns / 1000);
+}
+
+uint64_t StageBase::nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t StageBase::threadBlockedNs()
+{
+    return t_blocked_ns;
+}
+
+void StageBase::addIdle(uint64_t ns)
+{
+    m_idle_ns.fetch_add(ns, std::memory_order_relaxed);
+    m_stat_idle->inc(ns / 1000);
+}
+
+void StageBase::addItem(uint64_t ns, bool failed)
+{
+    m_items.fetch_add(1, std::memory_order_relaxed);
+    m_busy_ns.fetch_add(ns, std::memory_order_relaxed);
+    m_stat_items->inc();
+    m_stat_latency->observe(static_cast<double>(ns) / 1000.0);
+    if (failed)
+    {
+        addError();
+    }
+}
+
+void StageBase::addRun(uint64_t ns, bool failed)
+{
+    m_busy_ns.fetch_add(ns, std::memory_order_relaxed);
+    if (failed)
+    {
+        addError();
+    }
+}
+
+void StageBase::addError()
+{
+    m_errors.fetch_add(1, std::memory_order_relaxed);
+    m_stat_errors->inc();
+}
+
+void StageBase::setQueueDepth(size_t depth)
+{
+    m_stat_queue_depth->set(static_cast<double>(depth));
+}
+
+Pipeline::Pipeline(const std::string& name, size_t queue_capacity):
+    m_name(name),
+    m_queue_capacity((queue_capacity > 0) ? queue_capacity : DEFAULT_QUEUE_CAPACITY)
+{
+}
+
+Pipeline::~Pipeline()
+{
+    if (!m_threads.empty())
+    {
+        abort();
+        wait();
+    }
+}
+
+void Pipeline::consumePort(size_t id, const std::string& stage)
+{
+    if ((id >= m_port_readers.size()) || (++m_port_readers[id] > 1))
+    {
+        std::cerr << LOG_TAG << m_name << ": stage " << stage << " reads a port that is already read" << std::endl;
+        m_setup_error = true;
+    }
+}
+
+int Pipeline::start()
+{
+    if (!m_threads.empty() || m_stages.empty())
+    {
+        std::cerr << LOG_TAG << m_name << ": start() called twice or without stages" << std::endl;
+        return -1;
+    }
+    for (size_t id = 0; id < m_port_readers.size(); id++)
+    {
+        if (m_port_readers[id] != 1)
+        {
+            // nobody would drain it, the producer would block forever
+            std::cerr << LOG_TAG << m_name << ": output " << id << " is not read by any stage" << std::endl;
+            m_setup_error = true;
+        }
+    }
+    if (m_setup_error)
+    {
+        return -1;
+    }
+
+    for (auto& stage : m_stages)
+    {
+        stage->m_active.store(stage->m_options.workers, std::memory_order_relaxed);
+    }
+    for (auto& stage : m_stages)
+    {
+        for (int i = 0; i < stage->m_options.workers; i++)
+        {
+            StageBase* worker = stage.get();
+            m_threads.emplace_back([worker]()
+            {
+                bsp_perf::shared::BspThreadConfig::getInstance().applyToCurrentThread(worker->m_options.thread_role);
+                worker->run();
+            });
+        }
+    }
+    return 0;
+}
+
+int Pipeline::wait()
+{
+    for (auto& thread : m_threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    m_threads.clear();
+
+    if (aborted())
+    {
+        return -1;
+    }
+    for (auto& stage : m_stages)
+    {
+        if (stage->stats().errors > 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void Pipeline::addFramePool(FramePool& pool)
+{
+    m_frame_pools.push_back(&pool);
+}
+
+void Pipeline::abort()
+{
+    m_aborted.store(true, std::memory_order_release);
+    // frames held by queued items come back here, a stage blocked in acquire() is woken below
+    for (auto& stage : m_stages)
+    {
+        stage->closeQueues();
+    }
+    for (auto* pool : m_frame_pools)
+    {
+        pool->cancel();
+    }
+}
+
+std::vector<StageStats> Pipeline::stats() const
+{
+    std::vector<StageStats> result;
+    result.reserve(m_stages.size());
+    for (auto& stage : m_stages)
+    {
+        result.push_back(stage->stats());
+    }
+    return result;
+}
+
+std::string Pipeline::statsReport() const
+{
+    std::string report;
+    char line[256];
+    for (const auto& stats : this->stats())
+    {
+        double total = static_cast<double>(stats.busy_us + stats.idle_us + stats.blocked_us);
+        auto share = [total](uint64_t us) { return (total > 0.0) ? (100.0 * static_cast<double>(us) / total) : 0.0; };
+        std::snprintf(line, sizeof(line),
+            "%s/%s x%d: in %llu out %llu err %llu, busy %.1f%% idle %.1f%% blocked %.1f%%, "
+            "queue %zu/%zu, p50 %.0fus p99 %.0fus\n",
+            m_name.c_str(), stats.name.c_str(), stats.workers,
+            static_cast<unsigned long long>(stats.items), static_cast<unsigned long long>(stats.outputs),
+            static_cast<unsigned long long>(stats.errors),
+            share(stats.busy_us), share(stats.idle_us), share(stats.blocked_us),
+            stats.queue_depth, stats.queue_capacity, stats.latency_p50_us, stats.latency_p99_us);
+        report += line;
+    }
+    return report;
+}
+
+} // namespace bsp_pipeline
@@ -58,7 +58,7 @@ int OutputBufferQueue::writeFd(int fd)
 {
     if (getBuffersCount() == 0)
     {
-        m_logger->printStdoutLog(BspLogger::LogLevel::Debug, "OutputBufferQueue is empty");
+        BSP_LOG(m_logger, printStdoutLog, Debug, "OutputBufferQueue is empty");
         return 0;
     }
 
@@ -6,6 +6,7 @@
 #include "EventLoopPoll.hpp"
 #include "EventLoopLibevent.hpp"
 #include <bsp_sockets/TcpServer.hpp>
+#include <shared/BspThreadConfig.hpp>
 
 #include <memory>
 #include <thread>
@@ -60,6 +61,7 @@ static void onMsgComing(std::shared_ptr<IEventLoop> loop, int fd, std::any args)
 
 static std::any threadDomain(std::shared_ptr<ThreadQueue<queueMsg>> t_queue, std::weak_ptr<TcpServer> server)
 {
+    BspThreadConfig::getInstance().applyToCurrentThread("socket_worker");
     auto loop = bsp_sockets::IEventLoop::create(server.lock()->getPollType());
 
     t_queue->setLoop(loop, onMsgComing, std::make_pair(t_queue, server));
@@ -1,22 +1,78 @@
 #include "BspTrace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <fstream>
+#include <iostream>
+#include <vector>
 
 #include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 
 PERFETTO_TRACK_EVENT_STATIC_STORAGE();
 namespace bsp_perf {
 namespace common {
 
+constexpr char BspTrace::LOG_TAG[];
+
+std::atomic<uint32_t> BspTrace::s_category_mask{~0u};
+std::atomic<int> BspTrace::s_trigger_fd{-1};
+
+namespace {
+
+constexpr uint8_t SNAPSHOT_THREAD_EXIT{0xff};
+
+struct CategoryName
+{
+    BspTrace::Category category;
+    const char* perfetto_name;
+    const char* short_name;
+};
+
+constexpr CategoryName CATEGORY_NAMES[] = {
+    {BspTrace::Category::Default, BSP_TRACE_CATEGORY_Default, "Default"},
+    {BspTrace::Category::Codec, BSP_TRACE_CATEGORY_Codec, "Codec"},
+    {BspTrace::Category::G2d, BSP_TRACE_CATEGORY_G2d, "G2d"},
+    {BspTrace::Category::Dnn, BSP_TRACE_CATEGORY_Dnn, "Dnn"},
+    {BspTrace::Category::Pipeline, BSP_TRACE_CATEGORY_Pipeline, "Pipeline"},
+    {BspTrace::Category::Io, BSP_TRACE_CATEGORY_Io, "Io"},
+};
+
+const char* reasonName(BspTrace::SnapshotReason reason)
+{
+    switch (reason)
+    {
+    case BspTrace::SnapshotReason::Signal:
+        return "signal";
+    case BspTrace::SnapshotReason::Slo:
+        return "slo";
+    default:
+        return "api";
+    }
+}
+
+} // namespace
+
+void BspTrace::initPerfetto()
+{
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        perfetto::TracingInitArgs args;
+        args.backends |= perfetto::kInProcessBackend;
+        perfetto::Tracing::Initialize(args);
+        perfetto::TrackEvent::Register();
+    });
+}
+
 BspTrace::BspTrace(const std::string& trace_file_path, const std::string& category_name):
     m_category_name(category_name),
     m_trace_file_path(trace_file_path),
     m_tracingSession(nullptr)
 {
-    perfetto::TracingInitArgs args;
-    args.backends |= perfetto::kInProcessBackend;
-    perfetto::Tracing::Initialize(args);
-    perfetto::TrackEvent::Register();
+    initPerfetto();
 
     perfetto::TraceConfig cfg;
     cfg.add_buffers()->set_size_kb(10240);
@@ -29,12 +85,246 @@ BspTrace::BspTrace(const std::string& trace_file_path, const std::string& catego
 
 }
 
+BspTrace::BspTrace(const FlightRecorderConfig& config):
+    m_category_name(BSP_CATEGORY_NAME),
+    m_tracingSession(nullptr),
+    m_flight_recorder(true),
+    m_config(config)
+{
+    initPerfetto();
+
+    if (startSession() < 0)
+    {
+        return;
+    }
+
+    if (::pipe2(m_trigger_pipe, O_CLOEXEC | O_NONBLOCK) < 0)
+    {
+        std::cerr << LOG_TAG << "pipe2 failed: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    int expected = -1;
+    if (!s_trigger_fd.compare_exchange_strong(expected, m_trigger_pipe[1]))
+    {
+        std::cerr << LOG_TAG << "another flight recorder is already active, triggers go to it" << std::endl;
+    }
+
+    if ((m_config.snapshot_signal > 0) && (s_trigger_fd.load() == m_trigger_pipe[1]))
+    {
+        struct sigaction sa{};
+        sa.sa_handler = &BspTrace::onSnapshotSignal;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        if (::sigaction(m_config.snapshot_signal, &sa, &m_old_sigaction) < 0)
+        {
+            std::cerr << LOG_TAG << "sigaction failed: " << strerror(errno) << std::endl;
+            m_config.snapshot_signal = 0;
+        }
+    }
+
+    m_snapshot_thread = std::make_unique<std::thread>([this]() {snapshotLoop();});
+}
+
 BspTrace::~BspTrace()
 {
+    if (m_flight_recorder)
+    {
+        int own_fd = m_trigger_pipe[1];
+        if ((own_fd >= 0) && s_trigger_fd.compare_exchange_strong(own_fd, -1) && (m_config.snapshot_signal > 0))
+        {
+            ::sigaction(m_config.snapshot_signal, &m_old_sigaction, nullptr);
+        }
+
+        if (m_snapshot_thread != nullptr)
+        {
+            uint8_t code = SNAPSHOT_THREAD_EXIT;
+            ssize_t ret = ::write(m_trigger_pipe[1], &code, 1);
+            (void)ret;
+            m_snapshot_thread->join();
+            m_snapshot_thread.reset();
+        }
+
+        for (int& fd : m_trigger_pipe)
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        if (m_tracingSession != nullptr)
+        {
+            m_tracingSession->StopBlocking();
+            m_tracingSession.reset();
+        }
+        return;
+    }
+
     m_tracingSession->StopBlocking();
     close(m_trace_file_fd);
     m_tracingSession.reset();
 }
 
+int BspTrace::startSession()
+{
+    perfetto::TraceConfig cfg;
+    auto* buffer = cfg.add_buffers();
+    buffer->set_size_kb(m_config.buffer_kb);
+    // oldest events are overwritten, the buffer always holds the most recent window
+    buffer->set_fill_policy(perfetto::TraceConfig::BufferConfig::RING_BUFFER);
+
+    perfetto::protos::gen::TrackEventConfig track_event_cfg;
+    track_event_cfg.add_enabled_categories("*");
+    auto* ds_cfg = cfg.add_data_sources()->mutable_config();
+    ds_cfg->set_name("track_event");
+    ds_cfg->set_track_event_config_raw(track_event_cfg.SerializeAsString());
+
+    m_tracingSession = perfetto::Tracing::NewTrace();
+    if (m_tracingSession == nullptr)
+    {
+        std::cerr << LOG_TAG << "failed to create tracing session" << std::endl;
+        return -1;
+    }
+    // no fd: the trace stays in memory until it is read back by snapshot()
+    m_tracingSession->Setup(cfg);
+    m_tracingSession->StartBlocking();
+    return 0;
+}
+
+void BspTrace::onSnapshotSignal(int signo)
+{
+    (void)signo;
+    int fd = s_trigger_fd.load(std::memory_order_relaxed);
+    if (fd >= 0)
+    {
+        uint8_t code = static_cast<uint8_t>(SnapshotReason::Signal);
+        ssize_t ret = ::write(fd, &code, 1);
+        (void)ret;
+    }
+}
+
+void BspTrace::requestSnapshot(SnapshotReason reason)
+{
+    int fd = s_trigger_fd.load(std::memory_order_relaxed);
+    if (fd >= 0)
+    {
+        // non-blocking pipe: when it is full a snapshot is already pending anyway
+        uint8_t code = static_cast<uint8_t>(reason);
+        ssize_t ret = ::write(fd, &code, 1);
+        (void)ret;
+    }
+}
+
+void BspTrace::snapshotLoop()
+{
+    while (true)
+    {
+        struct pollfd pfd{m_trigger_pipe[0], POLLIN, 0};
+        if (::poll(&pfd, 1, -1) <= 0)
+        {
+            continue;
+        }
+
+        uint8_t codes[64];
+        ssize_t n = ::read(m_trigger_pipe[0], codes, sizeof(codes));
+        if (n <= 0)
+        {
+            continue;
+        }
+
+        // coalesce a burst of triggers into one snapshot
+        if (std::find(codes, codes + n, SNAPSHOT_THREAD_EXIT) != codes + n)
+        {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if ((m_last_snapshot.time_since_epoch().count() != 0) &&
+            (now - m_last_snapshot < m_config.min_snapshot_interval))
+        {
+            continue;
+        }
+        m_last_snapshot = now;
+        snapshot(reasonName(static_cast<SnapshotReason>(codes[n - 1])));
+    }
+}
+
+std::string BspTrace::snapshot(const std::string& reason)
+{
+    if (!m_flight_recorder)
+    {
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(m_session_mutex);
+    if (m_tracingSession == nullptr)
+    {
+        return "";
+    }
+
+    // The SDK can only read a session back once it is stopped, so the ring is swapped for a
+    // fresh one right away. Events emitted during the swap (a few ms) are lost.
+    perfetto::TrackEvent::Flush();
+    m_tracingSession->StopBlocking();
+    std::vector<char> trace_data(m_tracingSession->ReadTraceBlocking());
+    m_tracingSession.reset();
+    startSession();
+
+    ::mkdir(m_config.snapshot_dir.c_str(), 0755);
+
+    char time_str[32];
+    std::time_t now = std::time(nullptr);
+    struct tm tm_now{};
+    localtime_r(&now, &tm_now);
+    std::strftime(time_str, sizeof(time_str), "%Y%m%d_%H%M%S", &tm_now);
+    std::string path = m_config.snapshot_dir + "/" + m_config.snapshot_prefix + "_" + time_str + "_" + reason + ".perfetto-trace";
+
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    out.write(trace_data.data(), trace_data.size());
+    if (!out.good())
+    {
+        std::cerr << LOG_TAG << "write snapshot " << path << " failed" << std::endl;
+        return "";
+    }
+    std::cout << LOG_TAG << "snapshot (" << reason << ") written to " << path << ", " << trace_data.size() << " bytes" << std::endl;
+    return path;
+}
+
+void BspTrace::setCategoryEnabled(Category category, bool enabled)
+{
+    uint32_t bit = 1u << static_cast<uint32_t>(category);
+    if (enabled)
+    {
+        s_category_mask.fetch_or(bit, std::memory_order_relaxed);
+    }
+    else
+    {
+        s_category_mask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+int BspTrace::setCategoryEnabled(const std::string& name, bool enabled)
+{
+    if (name == "*")
+    {
+        s_category_mask.store(enabled ? ~0u : 0u, std::memory_order_relaxed);
+        return 0;
+    }
+
+    for (const auto& entry : CATEGORY_NAMES)
+    {
+        if ((name == entry.perfetto_name) || (name == entry.short_name))
+        {
+            setCategoryEnabled(entry.category, enabled);
+            return 0;
+        }
+    }
+    std::cerr << LOG_TAG << "unknown trace category: " << name << std::endl;
+    return -1;
+}
+
 } // namespace common
 } // namespace bsp_perf
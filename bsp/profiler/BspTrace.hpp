@@ -2,27 +2,150 @@
 #define __BSP_TRACE_HPP__
 
 #include <perfetto.h>
-#include <string>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #define BSP_CATEGORY_NAME "BspTrace"
 
+// Per module categories, each one can be switched on/off at runtime with BspTrace::setCategoryEnabled()
+#define BSP_TRACE_CATEGORY_Default  BSP_CATEGORY_NAME
+#define BSP_TRACE_CATEGORY_Codec    "bsp.codec"
+#define BSP_TRACE_CATEGORY_G2d      "bsp.g2d"
+#define BSP_TRACE_CATEGORY_Dnn      "bsp.dnn"
+#define BSP_TRACE_CATEGORY_Pipeline "bsp.pipeline"
+#define BSP_TRACE_CATEGORY_Io       "bsp.io"
+
 PERFETTO_DEFINE_CATEGORIES(
-    perfetto::Category(BSP_CATEGORY_NAME).SetDescription("BSP Trace"));
+    perfetto::Category(BSP_CATEGORY_NAME).SetDescription("BSP Trace"),
+    perfetto::Category(BSP_TRACE_CATEGORY_Codec).SetDescription("Video decode / encode"),
+    perfetto::Category(BSP_TRACE_CATEGORY_G2d).SetDescription("2D graphics operations"),
+    perfetto::Category(BSP_TRACE_CATEGORY_Dnn).SetDescription("DNN pre/post processing and inference"),
+    perfetto::Category(BSP_TRACE_CATEGORY_Pipeline).SetDescription("Pipeline stages and queues"),
+    perfetto::Category(BSP_TRACE_CATEGORY_Io).SetDescription("IPC, sockets and file I/O"));
 
 #define BSP_TRACE_EVENT_BEGIN(tag_name) \
-    TRACE_EVENT_BEGIN(BSP_CATEGORY_NAME, tag_name)
+    BSP_TRACE_BEGIN(Default, tag_name)
 
 #define BSP_TRACE_EVENT_END() \
-    TRACE_EVENT_END(BSP_CATEGORY_NAME)
+    BSP_TRACE_END(Default)
+
+/**
+ * @brief Category scoped trace macros, cat is one of Default / Codec / G2d / Dnn / Pipeline / Io.
+ * A category disabled at runtime costs one relaxed atomic load per call site.
+ */
+#define BSP_TRACE_BEGIN(cat, tag_name)                                                           \
+    do {                                                                                         \
+        if (bsp_perf::common::BspTrace::isCategoryEnabled(bsp_perf::common::BspTrace::Category::cat)) \
+        {                                                                                        \
+            TRACE_EVENT_BEGIN(BSP_TRACE_CATEGORY_##cat, tag_name);                               \
+        }                                                                                        \
+    } while (0)
+
+#define BSP_TRACE_END(cat)                                                                       \
+    do {                                                                                         \
+        if (bsp_perf::common::BspTrace::isCategoryEnabled(bsp_perf::common::BspTrace::Category::cat)) \
+        {                                                                                        \
+            TRACE_EVENT_END(BSP_TRACE_CATEGORY_##cat);                                           \
+        }                                                                                        \
+    } while (0)
+
+#define BSP_TRACE_COUNTER(cat, counter_name, value)                                              \
+    do {                                                                                         \
+        if (bsp_perf::common::BspTrace::isCategoryEnabled(bsp_perf::common::BspTrace::Category::cat)) \
+        {                                                                                        \
+            TRACE_COUNTER(BSP_TRACE_CATEGORY_##cat, counter_name, value);                        \
+        }                                                                                        \
+    } while (0)
+
+#define BSP_TRACE_CONCAT_INNER(a, b) a##b
+#define BSP_TRACE_CONCAT(a, b) BSP_TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Slice covering the rest of the enclosing scope.
+ */
+#define BSP_TRACE_SCOPE(cat, tag_name)                                                           \
+    bsp_perf::common::BspTraceScope BSP_TRACE_CONCAT(bsp_trace_scope_, __LINE__)(               \
+        bsp_perf::common::BspTrace::isCategoryEnabled(bsp_perf::common::BspTrace::Category::cat) \
+            ? ([&]() { TRACE_EVENT_BEGIN(BSP_TRACE_CATEGORY_##cat, tag_name); return true; }())  \
+            : false,                                                                             \
+        []() { TRACE_EVENT_END(BSP_TRACE_CATEGORY_##cat); })
 
 namespace bsp_perf {
 namespace common {
 
+class BspTraceScope
+{
+public:
+    BspTraceScope(bool active, void (*end_fn)()): m_active{active}, m_end_fn{end_fn} {}
+
+    ~BspTraceScope()
+    {
+        if (m_active)
+        {
+            m_end_fn();
+        }
+    }
+
+    BspTraceScope(const BspTraceScope&) = delete;
+    BspTraceScope& operator=(const BspTraceScope&) = delete;
+
+private:
+    bool m_active;
+    void (*m_end_fn)();
+};
+
 class BspTrace {
 
 public:
+    static constexpr char LOG_TAG[] {"[BspTrace]: "};
+
+    enum class Category : uint32_t
+    {
+        Default,
+        Codec,
+        G2d,
+        Dnn,
+        Pipeline,
+        Io,
+        Count
+    };
+
+    enum class SnapshotReason : uint8_t
+    {
+        Api,
+        Signal,
+        Slo
+    };
+
+    /**
+     * @brief Always-on flight recorder settings. The trace lives in an in-memory ring buffer
+     * and is only written out when a snapshot is triggered.
+     */
+    struct FlightRecorderConfig
+    {
+        uint32_t buffer_kb{16384};
+        std::string snapshot_dir{"logs"};
+        std::string snapshot_prefix{"bsp_flight"};
+        int snapshot_signal{SIGUSR2};   // 0 to not install a signal handler
+        std::chrono::milliseconds min_snapshot_interval{std::chrono::seconds(5)};
+    };
+
+    /**
+     * @brief File mode, everything between construction and destruction goes to trace_file_path.
+     */
     BspTrace(const std::string& trace_file_path, const std::string& category_name = BSP_CATEGORY_NAME);
+
+    /**
+     * @brief Flight recorder mode, see FlightRecorderConfig.
+     */
+    explicit BspTrace(const FlightRecorderConfig& config);
+
     ~BspTrace();
 
     BspTrace(const BspTrace&) = delete;
@@ -31,14 +154,61 @@ public:
     BspTrace(BspTrace&&) = delete;
     BspTrace& operator=(BspTrace&&) = delete;
 
+    /**
+     * @brief Ask the active flight recorder to dump its ring buffer. Safe to call from any thread
+     * and from hot paths: it only wakes the snapshot thread. No-op without a flight recorder.
+     * @param reason tag appended to the snapshot file name.
+     */
+    static void requestSnapshot(SnapshotReason reason = SnapshotReason::Api);
+
+    /**
+     * @brief Dump the ring buffer now and wait for it.
+     * @return path of the written snapshot, empty on failure or in file mode.
+     */
+    std::string snapshot(const std::string& reason = "api");
+
+    static void setCategoryEnabled(Category category, bool enabled);
+
+    /**
+     * @brief Enable/disable by name ("bsp.codec", "Codec", ... or "*" for all).
+     * @return 0 on success, -1 for an unknown category.
+     */
+    static int setCategoryEnabled(const std::string& name, bool enabled);
+
+    static bool isCategoryEnabled(Category category)
+    {
+        return (s_category_mask.load(std::memory_order_relaxed) >> static_cast<uint32_t>(category)) & 1u;
+    }
+
+private:
+    static void initPerfetto();
+
+    int startSession();
+
+    void snapshotLoop();
+
+    static void onSnapshotSignal(int signo);
+
 private:
+    static std::atomic<uint32_t> s_category_mask;
+    static std::atomic<int> s_trigger_fd;
+
     std::string m_category_name;
     std::string m_trace_file_path;
     int m_trace_file_fd{-1};
     std::unique_ptr<perfetto::TracingSession> m_tracingSession;
+
+    // flight recorder
+    bool m_flight_recorder{false};
+    FlightRecorderConfig m_config{};
+    std::mutex m_session_mutex;
+    int m_trigger_pipe[2]{-1, -1};
+    std::unique_ptr<std::thread> m_snapshot_thread{nullptr};
+    std::chrono::steady_clock::time_point m_last_snapshot{};
+    struct sigaction m_old_sigaction{};
 };
 
 } // namespace common
 } // namespace bsp_perf
 
-#endif // __BSP_TRACE_HPP__
\ No newline at end of file
+#endif // __BSP_TRACE_HPP__
@@ -0,0 +1,522 @@
+#include "MetricsLog.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace bsp_perf {
+namespace common {
+
+using namespace bsp_perf::shared;
+
+constexpr char MetricsLog::LOG_TAG[];
+constexpr char MetricsLog::FILE_MAGIC[];
+constexpr uint32_t MetricsLog::FILE_VERSION;
+constexpr size_t MetricsLog::HEADER_BYTES;
+
+namespace {
+
+// 16 4K pages worth of records per mapping window, a multiple of the record size
+constexpr size_t CHUNK_BYTES{4096 * sizeof(MetricsLog::MetricRecord) * 16};
+
+static_assert(sizeof(MetricsLog::MetricsFileHeader) <= MetricsLog::HEADER_BYTES, "header must fit in the header page");
+
+size_t roundUpPow2(size_t val)
+{
+    size_t ret = 1;
+    while (ret < val)
+    {
+        ret <<= 1;
+    }
+    return ret;
+}
+
+std::string jsonEscape(const std::string& str)
+{
+    std::string ret;
+    ret.reserve(str.size());
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        case '\t':
+            ret += "\\t";
+            break;
+        default:
+            ret += c;
+            break;
+        }
+    }
+    return ret;
+}
+
+std::string csvEscape(const std::string& str)
+{
+    if (str.find_first_of(",\"") == std::string::npos)
+    {
+        return str;
+    }
+    std::string ret{"\""};
+    for (char c : str)
+    {
+        if (c == '"')
+        {
+            ret += '"';
+        }
+        ret += c;
+    }
+    ret += '"';
+    return ret;
+}
+
+} // namespace
+
+MetricsLog::MetricsLog(const std::string& file_path, const std::string& case_name,
+                       size_t ring_capacity, std::chrono::milliseconds flush_interval):
+    m_file_path{file_path},
+    m_case_name{case_name},
+    m_flush_interval{flush_interval}
+{
+    size_t capacity = roundUpPow2(std::max<size_t>(ring_capacity, 2));
+    m_ring = std::make_unique<Slot[]>(capacity);
+    m_ring_mask = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        m_ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    auto dir = BspFileUtils::getFilePath(file_path);
+    if (dir != file_path && !dir.empty())
+    {
+        ::mkdir(dir.c_str(), 0755);
+    }
+
+    m_fd = ::open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+    {
+        std::cerr << LOG_TAG << "open " << file_path << " failed: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    std::memcpy(m_header.magic, FILE_MAGIC, sizeof(m_header.magic));
+    std::strncpy(m_header.case_name, case_name.c_str(), sizeof(m_header.case_name) - 1);
+    m_header.clock_base_ns = nowNs();
+    m_header.wall_clock_base_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if ((::ftruncate(m_fd, HEADER_BYTES) != 0) || (mapChunk(0) < 0))
+    {
+        std::cerr << LOG_TAG << "prepare " << file_path << " failed: " << strerror(errno) << std::endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    writeHeader();
+
+    m_meta_fp = std::shared_ptr<FILE>(std::fopen((file_path + ".meta").c_str(), "w"),
+        [](FILE* fp) { if (fp) std::fclose(fp); });
+    if (m_meta_fp)
+    {
+        std::fprintf(m_meta_fp.get(), "# %s\n", case_name.c_str());
+        std::fflush(m_meta_fp.get());
+    }
+
+    m_flusher = std::thread(&MetricsLog::flusherLoop, this);
+}
+
+MetricsLog::~MetricsLog()
+{
+    if (m_flusher.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_flush_mutex);
+            m_stop = true;
+        }
+        m_flush_cv.notify_all();
+        m_flusher.join();
+    }
+
+    if (m_fd < 0)
+    {
+        return;
+    }
+
+    unmapChunk();
+    uint64_t written = m_written.load(std::memory_order_relaxed);
+    if (::ftruncate(m_fd, HEADER_BYTES + written * sizeof(MetricRecord)) != 0)
+    {
+        std::cerr << LOG_TAG << "ftruncate failed: " << strerror(errno) << std::endl;
+    }
+    writeHeader();
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+uint32_t MetricsLog::registerMetric(const std::string& name, const std::string& unit)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_metrics_mutex);
+        auto it = m_metric_ids.find(name);
+        if (it != m_metric_ids.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_metrics_mutex);
+    auto it = m_metric_ids.find(name);
+    if (it != m_metric_ids.end())
+    {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(m_metric_ids.size());
+    m_metric_ids.emplace(name, id);
+    if (m_meta_fp)
+    {
+        std::fprintf(m_meta_fp.get(), "%u\t%s\t%s\n", id, unit.c_str(), name.c_str());
+        std::fflush(m_meta_fp.get());
+    }
+    return id;
+}
+
+bool MetricsLog::record(uint32_t metric_id, double value, uint64_t timestamp_ns) noexcept
+{
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    uint64_t pos = m_head.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    for (;;)
+    {
+        slot = &m_ring[pos & m_ring_mask];
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+
+        if (diff == 0)
+        {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // ring full, the flusher is behind: drop instead of stalling the profiled code
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->rec.timestamp_ns = timestamp_ns;
+    slot->rec.metric_id = metric_id;
+    slot->rec.reserved = 0;
+    slot->rec.value = value;
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void MetricsLog::flush()
+{
+    if (!m_flusher.joinable())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_flush_mutex);
+    uint64_t request = ++m_flush_request;
+    m_flush_cv.notify_all();
+    m_flushed_cv.wait(lock, [this, request] { return m_stop || (m_flush_done >= request); });
+}
+
+void MetricsLog::flusherLoop()
+{
+    for (;;)
+    {
+        uint64_t request = 0;
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(m_flush_mutex);
+            m_flush_cv.wait_for(lock, m_flush_interval,
+                [this] { return m_stop || (m_flush_request > m_flush_done); });
+            request = m_flush_request;
+            stop = m_stop;
+        }
+
+        if (drainRing() > 0)
+        {
+            writeHeader();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_flush_mutex);
+            m_flush_done = request;
+        }
+        m_flushed_cv.notify_all();
+
+        if (stop)
+        {
+            break;
+        }
+    }
+}
+
+size_t MetricsLog::drainRing()
+{
+    size_t drained = 0;
+
+    for (;;)
+    {
+        Slot& slot = m_ring[m_tail & m_ring_mask];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != m_tail + 1)
+        {
+            break;
+        }
+
+        if (m_chunk_used + sizeof(MetricRecord) > CHUNK_BYTES)
+        {
+            unmapChunk();
+            if (mapChunk(m_chunk_index + 1) < 0)
+            {
+                std::cerr << LOG_TAG << "grow " << m_file_path << " failed: " << strerror(errno) << std::endl;
+                break;
+            }
+        }
+
+        std::memcpy(m_chunk + m_chunk_used, &slot.rec, sizeof(MetricRecord));
+        m_chunk_used += sizeof(MetricRecord);
+
+        slot.seq.store(m_tail + m_ring_mask + 1, std::memory_order_release);
+        ++m_tail;
+        ++drained;
+    }
+
+    m_written.fetch_add(drained, std::memory_order_relaxed);
+    return drained;
+}
+
+int MetricsLog::mapChunk(uint64_t chunk_index)
+{
+    off_t offset = static_cast<off_t>(HEADER_BYTES + chunk_index * CHUNK_BYTES);
+
+    if (::ftruncate(m_fd, offset + CHUNK_BYTES) != 0)
+    {
+        return -1;
+    }
+
+    // the mmap offset has to be page aligned, HEADER_BYTES is not on 16K / 64K page kernels
+    static const off_t pageSize = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+    const off_t mapOffset = offset - (offset % pageSize);
+    const size_t mapBytes = CHUNK_BYTES + static_cast<size_t>(offset - mapOffset);
+    void* addr = ::mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, mapOffset);
+    if (addr == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    m_map_addr = addr;
+    m_map_bytes = mapBytes;
+    m_chunk = static_cast<uint8_t*>(addr) + (offset - mapOffset);
+    m_chunk_index = chunk_index;
+    m_chunk_used = 0;
+    return 0;
+}
+
+void MetricsLog::unmapChunk()
+{
+    if (m_chunk != nullptr)
+    {
+        ::munmap(m_map_addr, m_map_bytes);
+        m_map_addr = nullptr;
+        m_map_bytes = 0;
+        m_chunk = nullptr;
+    }
+}
+
+void MetricsLog::writeHeader()
+{
+    m_header.record_count = m_written.load(std::memory_order_relaxed);
+    m_header.dropped_count = m_dropped.load(std::memory_order_relaxed);
+    if (::pwrite(m_fd, &m_header, sizeof(m_header), 0) != static_cast<ssize_t>(sizeof(m_header)))
+    {
+        std::cerr << LOG_TAG << "write header failed: " << strerror(errno) << std::endl;
+    }
+}
+
+MetricsLogReader::~MetricsLogReader()
+{
+    if (m_file != nullptr)
+    {
+        // data is unmapped by its own deleter, only the descriptor is left to close
+        ::close(m_file->fd);
+        m_file.reset();
+    }
+}
+
+int MetricsLogReader::open(const std::string& file_path)
+{
+    m_file = BspFileUtils::LoadFileMmap(file_path);
+    if (m_file == nullptr)
+    {
+        std::cerr << MetricsLog::LOG_TAG << "cannot open " << file_path << std::endl;
+        return -1;
+    }
+
+    if (m_file->size < MetricsLog::HEADER_BYTES)
+    {
+        std::cerr << MetricsLog::LOG_TAG << file_path << " is too short" << std::endl;
+        return -1;
+    }
+
+    std::memcpy(&m_header, m_file->data.get(), sizeof(m_header));
+    if ((std::memcmp(m_header.magic, MetricsLog::FILE_MAGIC, sizeof(m_header.magic)) != 0) ||
+        (m_header.record_size != sizeof(MetricsLog::MetricRecord)))
+    {
+        std::cerr << MetricsLog::LOG_TAG << file_path << " is not a metrics log" << std::endl;
+        return -1;
+    }
+
+    // a log from a process that did not shut down cleanly still has its preallocated tail
+    size_t capacity = (m_file->size - MetricsLog::HEADER_BYTES) / sizeof(MetricsLog::MetricRecord);
+    m_record_count = std::min<size_t>(capacity, m_header.record_count);
+    m_records = reinterpret_cast<const MetricsLog::MetricRecord*>(m_file->data.get() + MetricsLog::HEADER_BYTES);
+
+    std::ifstream meta(file_path + ".meta");
+    std::string line;
+    while (std::getline(meta, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        auto tab1 = line.find('\t');
+        auto tab2 = line.find('\t', tab1 + 1);
+        if ((tab1 == std::string::npos) || (tab2 == std::string::npos))
+        {
+            continue;
+        }
+        uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0, tab1)));
+        m_metrics[id] = MetricsLog::MetricInfo{line.substr(tab2 + 1), line.substr(tab1 + 1, tab2 - tab1 - 1)};
+    }
+
+    return 0;
+}
+
+std::string MetricsLogReader::metricLabel(uint32_t metric_id) const
+{
+    auto it = m_metrics.find(metric_id);
+    if (it == m_metrics.end())
+    {
+        return "metric_" + std::to_string(metric_id);
+    }
+    return it->second.name;
+}
+
+int MetricsLogReader::exportCsv(const std::string& out_path) const
+{
+    std::ofstream out(out_path);
+    if (!out)
+    {
+        return -1;
+    }
+
+    out << "time_us,metric_id,metric,unit,value\n";
+    for (size_t i = 0; i < m_record_count; ++i)
+    {
+        const auto& rec = m_records[i];
+        auto it = m_metrics.find(rec.metric_id);
+        std::string unit = (it != m_metrics.end()) ? it->second.unit : "";
+        out << (rec.timestamp_ns - m_header.clock_base_ns) / 1000 << ','
+            << rec.metric_id << ','
+            << csvEscape(metricLabel(rec.metric_id)) << ','
+            << csvEscape(unit) << ','
+            << rec.value << '\n';
+    }
+    return out.good() ? 0 : -1;
+}
+
+int MetricsLogReader::exportJson(const std::string& out_path) const
+{
+    std::ofstream out(out_path);
+    if (!out)
+    {
+        return -1;
+    }
+
+    out << "{\n  \"case\": \"" << jsonEscape(m_header.case_name) << "\",\n"
+        << "  \"wall_clock_base_ns\": " << m_header.wall_clock_base_ns << ",\n"
+        << "  \"dropped\": " << m_header.dropped_count << ",\n"
+        << "  \"metrics\": {";
+    bool first = true;
+    for (const auto& [id, info] : m_metrics)
+    {
+        out << (first ? "\n" : ",\n") << "    \"" << id << "\": {\"name\": \"" << jsonEscape(info.name)
+            << "\", \"unit\": \"" << jsonEscape(info.unit) << "\"}";
+        first = false;
+    }
+    out << "\n  },\n  \"records\": [";
+    for (size_t i = 0; i < m_record_count; ++i)
+    {
+        const auto& rec = m_records[i];
+        out << (i == 0 ? "\n" : ",\n") << "    [" << (rec.timestamp_ns - m_header.clock_base_ns)
+            << ", " << rec.metric_id << ", " << rec.value << "]";
+    }
+    out << "\n  ]\n}\n";
+    return out.good() ? 0 : -1;
+}
+
+int MetricsLogReader::exportPerfettoCounters(const std::string& out_path) const
+{
+    std::ofstream out(out_path);
+    if (!out)
+    {
+        return -1;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+        << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \""
+        << jsonEscape(m_header.case_name) << "\"}}";
+    for (size_t i = 0; i < m_record_count; ++i)
+    {
+        const auto& rec = m_records[i];
+        auto it = m_metrics.find(rec.metric_id);
+        std::string name = metricLabel(rec.metric_id);
+        if ((it != m_metrics.end()) && !it->second.unit.empty())
+        {
+            name += " (" + it->second.unit + ")";
+        }
+        double ts_us = static_cast<double>(rec.timestamp_ns - m_header.clock_base_ns) / 1000.0;
+        out << ",\n  {\"name\": \"" << jsonEscape(name) << "\", \"ph\": \"C\", \"pid\": 1, \"ts\": "
+            << std::fixed << ts_us << std::defaultfloat << ", \"args\": {\"value\": " << rec.value << "}}";
+    }
+    out << "\n]}\n";
+    return out.good() ? 0 : -1;
+}
+
+} // namespace common
+} // namespace bsp_perf
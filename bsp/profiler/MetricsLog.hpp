@@ -0,0 +1,201 @@
+#ifndef __METRICS_LOG_HPP__
+#define __METRICS_LOG_HPP__
+
+#include <shared/BspFileUtils.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace bsp_perf {
+namespace common {
+
+/**
+ * @brief Append-only binary metrics log.
+ *
+ * Producers push fixed-size records into a bounded lock-free ring (never blocking, a full ring
+ * drops the sample and counts it). A background flusher drains the ring into a memory-mapped
+ * file which grows chunk by chunk. Metric names/units live in a "<file>.meta" sidecar so the
+ * hot path only carries a 32-bit id.
+ *
+ * File layout: one header page (MetricsFileHeader) followed by packed MetricRecord entries.
+ * MetricsLogReader and the metricsConvert tool turn the file into CSV/JSON/Perfetto counters.
+ */
+class MetricsLog
+{
+public:
+    static constexpr char LOG_TAG[] {"[MetricsLog]: "};
+    static constexpr char FILE_MAGIC[8] {'B', 'S', 'P', 'M', 'T', 'R', 'C', '\0'};
+    static constexpr uint32_t FILE_VERSION{1};
+    static constexpr size_t HEADER_BYTES{4096};
+
+    struct MetricRecord
+    {
+        uint64_t timestamp_ns{0};   // steady_clock, see MetricsFileHeader::clock_base_ns
+        uint32_t metric_id{0};
+        uint32_t reserved{0};
+        double value{0.0};
+    };
+    static_assert(sizeof(MetricRecord) == 24, "MetricRecord must stay 24 bytes");
+
+    struct MetricsFileHeader
+    {
+        char magic[8]{};
+        uint32_t version{FILE_VERSION};
+        uint32_t record_size{sizeof(MetricRecord)};
+        uint64_t record_count{0};       // updated after every flush, valid records after the header
+        uint64_t dropped_count{0};
+        uint64_t clock_base_ns{0};      // steady_clock timestamp when the log was opened
+        uint64_t wall_clock_base_ns{0}; // system_clock timestamp matching clock_base_ns
+        char case_name[64]{};
+    };
+
+    struct MetricInfo
+    {
+        std::string name{};
+        std::string unit{};
+    };
+
+    MetricsLog(const std::string& file_path, const std::string& case_name,
+               size_t ring_capacity = 65536,
+               std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100));
+    ~MetricsLog();
+
+    MetricsLog(const MetricsLog&) = delete;
+    MetricsLog& operator=(const MetricsLog&) = delete;
+    MetricsLog(MetricsLog&&) = delete;
+    MetricsLog& operator=(MetricsLog&&) = delete;
+
+    /**
+     * @brief Get or create the id of a metric. Cache the id for per-frame recording.
+     */
+    uint32_t registerMetric(const std::string& name, const std::string& unit);
+
+    /**
+     * @brief Push a sample, wait-free for the caller.
+     * @return false if the ring is full and the sample was dropped.
+     */
+    bool record(uint32_t metric_id, double value) noexcept
+    {
+        return record(metric_id, value, nowNs());
+    }
+
+    bool record(uint32_t metric_id, double value, uint64_t timestamp_ns) noexcept;
+
+    /**
+     * @brief Block until every record pushed before this call is in the file.
+     */
+    void flush();
+
+    uint64_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t getWrittenCount() const { return m_written.load(std::memory_order_relaxed); }
+    bool isOpen() const { return m_fd >= 0; }
+
+    static uint64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        MetricRecord rec{};
+    };
+
+    void flusherLoop();
+    size_t drainRing();
+    int mapChunk(uint64_t chunk_index);
+    void unmapChunk();
+    void writeHeader();
+
+private:
+    std::string m_file_path;
+    std::string m_case_name;
+    int m_fd{-1};
+    MetricsFileHeader m_header{};
+
+    // ring buffer, Vyukov bounded queue with multiple producers and the flusher as single consumer
+    std::unique_ptr<Slot[]> m_ring;
+    size_t m_ring_mask{0};
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    alignas(64) uint64_t m_tail{0};
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_written{0};
+
+    // memory mapped output window
+    uint8_t* m_chunk{nullptr};
+    // the mapping behind m_chunk, it starts at a page boundary at or before the chunk
+    void* m_map_addr{nullptr};
+    size_t m_map_bytes{0};
+    uint64_t m_chunk_index{0};
+    size_t m_chunk_used{0};
+
+    // metric dictionary
+    std::shared_mutex m_metrics_mutex;
+    std::unordered_map<std::string, uint32_t> m_metric_ids{};
+    std::shared_ptr<FILE> m_meta_fp{nullptr};
+
+    // background flusher
+    std::chrono::milliseconds m_flush_interval;
+    std::mutex m_flush_mutex;
+    std::condition_variable m_flush_cv;
+    std::condition_variable m_flushed_cv;
+    uint64_t m_flush_request{0};
+    uint64_t m_flush_done{0};
+    bool m_stop{false};
+    std::thread m_flusher;
+};
+
+/**
+ * @brief Offline reader for files produced by MetricsLog.
+ */
+class MetricsLogReader
+{
+public:
+    MetricsLogReader() = default;
+    ~MetricsLogReader();
+
+    MetricsLogReader(const MetricsLogReader&) = delete;
+    MetricsLogReader& operator=(const MetricsLogReader&) = delete;
+
+    /**
+     * @return 0 on success, -1 if the file is missing or not a metrics log.
+     */
+    int open(const std::string& file_path);
+
+    const MetricsLog::MetricsFileHeader& getHeader() const { return m_header; }
+    const std::map<uint32_t, MetricsLog::MetricInfo>& getMetrics() const { return m_metrics; }
+    size_t getRecordCount() const { return m_record_count; }
+    const MetricsLog::MetricRecord* getRecords() const { return m_records; }
+
+    int exportCsv(const std::string& out_path) const;
+    int exportJson(const std::string& out_path) const;
+    /**
+     * @brief Export as Chrome trace-event counters ("ph": "C"), loadable by ui.perfetto.dev.
+     */
+    int exportPerfettoCounters(const std::string& out_path) const;
+
+private:
+    std::string metricLabel(uint32_t metric_id) const;
+
+private:
+    std::shared_ptr<bsp_perf::shared::BspFileUtils::FileContext> m_file{nullptr};
+    MetricsLog::MetricsFileHeader m_header{};
+    std::map<uint32_t, MetricsLog::MetricInfo> m_metrics{};
+    const MetricsLog::MetricRecord* m_records{nullptr};
+    size_t m_record_count{0};
+};
+
+} // namespace common
+} // namespace bsp_perf
+
+#endif // __METRICS_LOG_HPP__
@@ -1,4 +1,5 @@
 #include "PerfProfiler.hpp"
+#include "BspTrace.hpp"
 
 namespace bsp_perf {
 namespace common {
@@ -6,13 +7,39 @@ namespace common {
 using namespace bsp_perf::shared;
 
 constexpr char PerfProfiler::LOG_TAG[];
+constexpr size_t PerfProfiler::MAX_SLO_METRICS;
 
 PerfProfiler::PerfProfiler(std::string& caseName, const std::string& profile_file_path):
     m_caseName{caseName},
-    m_logger{std::make_unique<BspLogger>("PerfProfiler", "logs/bsp_perf.log"s, profile_file_path)}
+    m_logger{std::make_unique<BspLogger>("PerfProfiler")},
+    m_metrics{std::make_unique<MetricsLog>(profile_file_path, caseName)}
 {
     // Add your code here
     m_logger->setPattern("[%H:%M:%S.%f][thread:%t][%v]"s);
+    for (auto& threshold : m_slo_thresholds)
+    {
+        threshold.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+    }
+}
+
+int PerfProfiler::setSlo(const std::string& metricName, const std::string& unitName, double threshold)
+{
+    uint32_t metricId = m_metrics->registerMetric(metricName, unitName);
+    if (metricId >= MAX_SLO_METRICS)
+    {
+        m_logger->printStdoutLog(BspLogger::LogLevel::Error, "{}no SLO slot left for {}", LOG_TAG, metricName);
+        return -1;
+    }
+    m_slo_thresholds[metricId].store(threshold, std::memory_order_relaxed);
+    return 0;
+}
+
+void PerfProfiler::onSloViolation(uint32_t metricId, double val)
+{
+    m_slo_violations.fetch_add(1, std::memory_order_relaxed);
+    BspTrace::requestSnapshot(BspTrace::SnapshotReason::Slo);
+    BSP_LOG_EVERY_MS(m_logger, printStdoutLog, Warn, 1000, "{}{}: SLO violated by metric {} value {}",
+        LOG_TAG, m_caseName, metricId, val);
 }
 
 }   // namespace common
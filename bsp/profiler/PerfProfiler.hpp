@@ -2,8 +2,13 @@
 #define PERF_PROFILER_HPP
 
 #include <string>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <limits>
+#include <memory>
 #include <shared/BspLogger.hpp>
+#include <profiler/MetricsLog.hpp>
 
 namespace bsp_perf {
 namespace common {
@@ -17,7 +22,8 @@ constexpr int32_t memValueMB(size_t size) { return (size << 20); }
 class PerfProfiler {
 public:
     static constexpr char LOG_TAG[] {"[PerfProfiler]: "};
-    PerfProfiler(std::string& caseName, const std::string& profile_file_path = "logs/perf_case.profile"s);
+    static constexpr size_t MAX_SLO_METRICS{64};
+    PerfProfiler(std::string& caseName, const std::string& profile_file_path = "logs/perf_case.metrics"s);
     ~PerfProfiler() = default;
 
     PerfProfiler(const PerfProfiler&) = delete;
@@ -28,11 +34,55 @@ public:
 
     std::string& getCaseName() { return m_caseName; }
 
+    /**
+     * @brief Get the id of a metric for the hot path overload of asyncRecordPerfData().
+     */
+    uint32_t registerMetric(const std::string& metricName, const std::string& unitName)
+    {
+        return m_metrics->registerMetric(metricName, unitName);
+    }
+
+    /**
+     * @brief Record a sample into the binary metrics log, never blocks the caller.
+     * Convert the profile file offline with bsp_metrics_convert.
+     */
+    template<typename T>
+    void asyncRecordPerfData(uint32_t metricId, T val)
+    {
+        m_metrics->record(metricId, static_cast<double>(val));
+        checkSlo(metricId, static_cast<double>(val));
+    }
+
     template<typename T>
     void asyncRecordPerfData(const std::string& metricName, T val, const std::string& unitName)
     {
-        m_logger->printAsyncFileLog(bsp_perf::shared::BspLogger::LogLevel::Warn,
-            "{}:{}:{}:{}", m_caseName, metricName, val, unitName);
+        asyncRecordPerfData(m_metrics->registerMetric(metricName, unitName), val);
+    }
+
+    /**
+     * @brief Request a BspTrace flight recorder snapshot whenever a recorded sample of the metric
+     * exceeds threshold, so the trace of the seconds before a latency spike is kept.
+     * Only the first MAX_SLO_METRICS registered metrics can carry an SLO.
+     * @return 0 on success, -1 if the metric id is out of range.
+     */
+    int setSlo(const std::string& metricName, const std::string& unitName, double threshold);
+
+    uint64_t getSloViolations() const
+    {
+        return m_slo_violations.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Wait until all recorded samples are written to the profile file.
+     */
+    void flushPerfData()
+    {
+        m_metrics->flush();
+    }
+
+    uint64_t getDroppedPerfData() const
+    {
+        return m_metrics->getDroppedCount();
     }
 
     template<typename T>
@@ -52,9 +102,23 @@ public:
         return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     }
 
+private:
+    void checkSlo(uint32_t metricId, double val)
+    {
+        if ((metricId < MAX_SLO_METRICS) && (val > m_slo_thresholds[metricId].load(std::memory_order_relaxed)))
+        {
+            onSloViolation(metricId, val);
+        }
+    }
+
+    void onSloViolation(uint32_t metricId, double val);
+
 private:
     std::string m_caseName;
     std::unique_ptr<bsp_perf::shared::BspLogger> m_logger;
+    std::unique_ptr<MetricsLog> m_metrics;
+    std::array<std::atomic<double>, MAX_SLO_METRICS> m_slo_thresholds;
+    std::atomic<uint64_t> m_slo_violations{0};
     // Add your member functions and variables here
 };
 
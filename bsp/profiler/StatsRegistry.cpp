@@ -0,0 +1,291 @@
+#include "StatsRegistry.hpp"
+#include "BspTrace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+namespace bsp_perf {
+namespace common {
+
+namespace {
+
+std::string formatValue(double val)
+{
+    if (std::isnan(val))
+    {
+        return "NaN";
+    }
+    if (std::isinf(val))
+    {
+        return (val > 0) ? "+Inf" : "-Inf";
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", val);
+    return buf;
+}
+
+std::string escapeString(const std::string& str)
+{
+    std::string ret;
+    ret.reserve(str.size());
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        default:
+            ret += c;
+            break;
+        }
+    }
+    return ret;
+}
+
+std::string promLabels(const StatsMetric::Labels& labels, const std::string& extra_key = "", const std::string& extra_val = "")
+{
+    if (labels.empty() && extra_key.empty())
+    {
+        return "";
+    }
+
+    std::string ret{"{"};
+    bool first = true;
+    for (const auto& [key, val] : labels)
+    {
+        ret += (first ? "" : ",") + key + "=\"" + escapeString(val) + "\"";
+        first = false;
+    }
+    if (!extra_key.empty())
+    {
+        ret += (first ? "" : ",") + extra_key + "=\"" + extra_val + "\"";
+    }
+    ret += "}";
+    return ret;
+}
+
+// JSON numbers cannot carry NaN / Inf
+std::string jsonValue(double val)
+{
+    return std::isfinite(val) ? formatValue(val) : "null";
+}
+
+} // namespace
+
+void StatsCounter::exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const
+{
+    out += name + promLabels(labels) + " " + std::to_string(get()) + "\n";
+}
+
+void StatsCounter::exportJson(std::string& out) const
+{
+    out += "\"value\": " + std::to_string(get());
+}
+
+void StatsGauge::exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const
+{
+    out += name + promLabels(labels) + " " + formatValue(get()) + "\n";
+}
+
+void StatsGauge::exportJson(std::string& out) const
+{
+    out += "\"value\": " + jsonValue(get());
+}
+
+const std::vector<double>& StatsHistogram::latencyBucketsUs()
+{
+    static const std::vector<double> buckets{
+        100, 250, 500, 1000, 2500, 5000, 10000, 16667, 25000, 33333, 50000, 100000, 250000, 500000, 1000000
+    };
+    return buckets;
+}
+
+StatsHistogram::StatsHistogram(const std::vector<double>& upper_bounds):
+    m_bounds{upper_bounds},
+    m_slo{std::numeric_limits<double>::infinity()}
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+    m_buckets = std::make_unique<std::atomic<uint64_t>[]>(m_bounds.size() + 1);
+    for (size_t i = 0; i <= m_bounds.size(); ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void StatsHistogram::observe(double val)
+{
+    size_t idx = std::lower_bound(m_bounds.begin(), m_bounds.end(), val) - m_bounds.begin();
+    m_buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    double cur = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(cur, cur + val, std::memory_order_relaxed))
+    {
+    }
+
+    if (val > m_slo.load(std::memory_order_relaxed))
+    {
+        m_slo_violations.fetch_add(1, std::memory_order_relaxed);
+        BspTrace::requestSnapshot(BspTrace::SnapshotReason::Slo);
+    }
+}
+
+double StatsHistogram::percentile(double q) const
+{
+    std::vector<uint64_t> counts(m_bounds.size() + 1);
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+    {
+        return 0.0;
+    }
+
+    double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        if ((counts[i] == 0) || (static_cast<double>(cumulative + counts[i]) < rank))
+        {
+            cumulative += counts[i];
+            continue;
+        }
+        if (i == m_bounds.size())
+        {
+            // +Inf bucket, the best we can say is "above the last bound"
+            return m_bounds.empty() ? 0.0 : m_bounds.back();
+        }
+        double lower = (i == 0) ? 0.0 : m_bounds[i - 1];
+        double fraction = (rank - static_cast<double>(cumulative)) / static_cast<double>(counts[i]);
+        return lower + (m_bounds[i] - lower) * fraction;
+    }
+    return m_bounds.empty() ? 0.0 : m_bounds.back();
+}
+
+void StatsHistogram::exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const
+{
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= m_bounds.size(); ++i)
+    {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        std::string le = (i == m_bounds.size()) ? "+Inf" : formatValue(m_bounds[i]);
+        out += name + "_bucket" + promLabels(labels, "le", le) + " " + std::to_string(cumulative) + "\n";
+    }
+    out += name + "_sum" + promLabels(labels) + " " + formatValue(getSum()) + "\n";
+    out += name + "_count" + promLabels(labels) + " " + std::to_string(cumulative) + "\n";
+}
+
+void StatsHistogram::exportJson(std::string& out) const
+{
+    uint64_t count = getCount();
+    out += "\"count\": " + std::to_string(count);
+    out += ", \"mean\": " + jsonValue((count > 0) ? getSum() / static_cast<double>(count) : 0.0);
+    out += ", \"p50\": " + jsonValue(percentile(0.50));
+    out += ", \"p90\": " + jsonValue(percentile(0.90));
+    out += ", \"p99\": " + jsonValue(percentile(0.99));
+    out += ", \"slo_violations\": " + std::to_string(getSloViolations());
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> StatsRegistry::getOrCreate(const std::string& name, const std::string& help, const Labels& labels, Args&&... args)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& family = m_families[name];
+    auto metric = std::make_shared<T>(std::forward<Args>(args)...);
+
+    if (family.type.empty())
+    {
+        family.type = metric->typeName();
+        family.help = help;
+    }
+    else if (family.type != metric->typeName())
+    {
+        // keep the caller running with a detached metric rather than corrupting the family
+        std::cerr << "[StatsRegistry]: " << name << " is already registered as a " << family.type << std::endl;
+        return metric;
+    }
+
+    auto it = family.metrics.find(labels);
+    if (it != family.metrics.end())
+    {
+        return std::static_pointer_cast<T>(it->second);
+    }
+    family.metrics.emplace(labels, metric);
+    return metric;
+}
+
+std::shared_ptr<StatsCounter> StatsRegistry::counter(const std::string& name, const std::string& help, const Labels& labels)
+{
+    return getOrCreate<StatsCounter>(name, help, labels);
+}
+
+std::shared_ptr<StatsGauge> StatsRegistry::gauge(const std::string& name, const std::string& help, const Labels& labels)
+{
+    return getOrCreate<StatsGauge>(name, help, labels);
+}
+
+std::shared_ptr<StatsHistogram> StatsRegistry::histogram(const std::string& name, const std::string& help, const Labels& labels,
+                                                         const std::vector<double>& upper_bounds)
+{
+    return getOrCreate<StatsHistogram>(name, help, labels, upper_bounds);
+}
+
+std::string StatsRegistry::exportPrometheus()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string out;
+
+    for (const auto& [name, family] : m_families)
+    {
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " " + family.type + "\n";
+        for (const auto& [labels, metric] : family.metrics)
+        {
+            metric->exportPrometheus(out, name, labels);
+        }
+    }
+    return out;
+}
+
+std::string StatsRegistry::exportJson()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string out{"{\"metrics\": ["};
+    bool first = true;
+
+    for (const auto& [name, family] : m_families)
+    {
+        for (const auto& [labels, metric] : family.metrics)
+        {
+            out += first ? "\n  {" : ",\n  {";
+            first = false;
+            out += "\"name\": \"" + escapeString(name) + "\", \"type\": \"" + family.type + "\", \"labels\": {";
+            bool first_label = true;
+            for (const auto& [key, val] : labels)
+            {
+                out += (first_label ? "\"" : ", \"") + escapeString(key) + "\": \"" + escapeString(val) + "\"";
+                first_label = false;
+            }
+            out += "}, ";
+            metric->exportJson(out);
+            out += "}";
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+} // namespace common
+} // namespace bsp_perf
@@ -0,0 +1,176 @@
+#ifndef __STATS_REGISTRY_HPP__
+#define __STATS_REGISTRY_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bsp_perf {
+namespace common {
+
+/**
+ * @brief Base of the live metrics kept by StatsRegistry, only the export path is virtual.
+ */
+class StatsMetric
+{
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    virtual ~StatsMetric() = default;
+
+    virtual const char* typeName() const = 0;
+
+    virtual void exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const = 0;
+
+    virtual void exportJson(std::string& out) const = 0;
+};
+
+class StatsCounter : public StatsMetric
+{
+public:
+    void inc(uint64_t val = 1) { m_value.fetch_add(val, std::memory_order_relaxed); }
+
+    uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+    const char* typeName() const override { return "counter"; }
+
+    void exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const override;
+
+    void exportJson(std::string& out) const override;
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+class StatsGauge : public StatsMetric
+{
+public:
+    void set(double val) { m_value.store(val, std::memory_order_relaxed); }
+
+    void add(double val)
+    {
+        double cur = m_value.load(std::memory_order_relaxed);
+        while (!m_value.compare_exchange_weak(cur, cur + val, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    double get() const { return m_value.load(std::memory_order_relaxed); }
+
+    const char* typeName() const override { return "gauge"; }
+
+    void exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const override;
+
+    void exportJson(std::string& out) const override;
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+/**
+ * @brief Fixed-bucket histogram, observe() is a couple of relaxed atomic ops.
+ * Percentiles are interpolated inside the bucket the rank falls in.
+ */
+class StatsHistogram : public StatsMetric
+{
+public:
+    /**
+     * @brief Default latency buckets in microseconds, 100us .. 1s with frame-period marks.
+     */
+    static const std::vector<double>& latencyBucketsUs();
+
+    explicit StatsHistogram(const std::vector<double>& upper_bounds = latencyBucketsUs());
+
+    void observe(double val);
+
+    uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+
+    double getSum() const { return m_sum.load(std::memory_order_relaxed); }
+
+    double percentile(double q) const;
+
+    /**
+     * @brief Latency SLO, every observation above threshold requests a BspTrace flight
+     * recorder snapshot. Disabled (infinite threshold) by default.
+     */
+    void setSlo(double threshold) { m_slo.store(threshold, std::memory_order_relaxed); }
+
+    uint64_t getSloViolations() const { return m_slo_violations.load(std::memory_order_relaxed); }
+
+    const char* typeName() const override { return "histogram"; }
+
+    void exportPrometheus(std::string& out, const std::string& name, const Labels& labels) const override;
+
+    void exportJson(std::string& out) const override;
+
+private:
+    std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;   // m_bounds.size() + 1 (+Inf)
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<double> m_sum{0.0};
+    std::atomic<double> m_slo;
+    std::atomic<uint64_t> m_slo_violations{0};
+};
+
+/**
+ * @brief Process wide registry of live counters / gauges / histograms.
+ *
+ * Components fetch their metrics once (the returned pointers stay valid for the process
+ * lifetime) and update them from the hot path without locking. StatsServer renders the
+ * registry as Prometheus text or JSON on request.
+ */
+class StatsRegistry
+{
+public:
+    using Labels = StatsMetric::Labels;
+
+    static StatsRegistry& getInstance()
+    {
+        static StatsRegistry instance;
+        return instance;
+    }
+
+    std::shared_ptr<StatsCounter> counter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    std::shared_ptr<StatsGauge> gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    std::shared_ptr<StatsHistogram> histogram(const std::string& name, const std::string& help, const Labels& labels = {},
+                                              const std::vector<double>& upper_bounds = StatsHistogram::latencyBucketsUs());
+
+    /**
+     * @brief Prometheus text exposition format 0.0.4.
+     */
+    std::string exportPrometheus();
+
+    std::string exportJson();
+
+private:
+    StatsRegistry() = default;
+    ~StatsRegistry() = default;
+    StatsRegistry(const StatsRegistry&) = delete;
+    StatsRegistry& operator=(const StatsRegistry&) = delete;
+
+    struct Family
+    {
+        std::string help{};
+        std::string type{};
+        std::map<Labels, std::shared_ptr<StatsMetric>> metrics{};
+    };
+
+    template <typename T, typename... Args>
+    std::shared_ptr<T> getOrCreate(const std::string& name, const std::string& help, const Labels& labels, Args&&... args);
+
+private:
+    std::mutex m_mutex;
+    std::map<std::string, Family> m_families{};
+};
+
+} // namespace common
+} // namespace bsp_perf
+
+#endif // __STATS_REGISTRY_HPP__
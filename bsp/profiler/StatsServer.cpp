@@ -0,0 +1,242 @@
+#include "StatsServer.hpp"
+#include "StatsRegistry.hpp"
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace bsp_perf {
+namespace common {
+
+constexpr char StatsServer::LOG_TAG[];
+
+StatsServer::StatsServer(const std::string& listen_addr):
+    m_listen_addr{listen_addr}
+{
+}
+
+StatsServer::~StatsServer()
+{
+    stop();
+}
+
+int StatsServer::openListenSocket()
+{
+    const std::string unix_prefix{"unix:"};
+    const std::string tcp_prefix{"tcp:"};
+
+    if (m_listen_addr.compare(0, unix_prefix.size(), unix_prefix) == 0)
+    {
+        m_unix_path = m_listen_addr.substr(unix_prefix.size());
+        struct sockaddr_un addr{};
+        if (m_unix_path.empty() || m_unix_path.size() >= sizeof(addr.sun_path))
+        {
+            std::cerr << LOG_TAG << "invalid unix socket path: " << m_unix_path << std::endl;
+            return -1;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, m_unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        // a stale socket file from a previous run would make bind() fail
+        ::unlink(m_unix_path.c_str());
+        if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            std::cerr << LOG_TAG << "bind " << m_unix_path << " failed: " << strerror(errno) << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::string host_port = m_listen_addr;
+    if (host_port.compare(0, tcp_prefix.size(), tcp_prefix) == 0)
+    {
+        host_port = host_port.substr(tcp_prefix.size());
+    }
+    auto colon = host_port.rfind(':');
+    std::string host = (colon == std::string::npos) ? "127.0.0.1" : host_port.substr(0, colon);
+    std::string port = (colon == std::string::npos) ? host_port : host_port.substr(colon + 1);
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    try
+    {
+        addr.sin_port = htons(static_cast<uint16_t>(std::stoi(port)));
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << LOG_TAG << "invalid listen address: " << m_listen_addr << std::endl;
+        return -1;
+    }
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+    {
+        std::cerr << LOG_TAG << "invalid listen address: " << m_listen_addr << std::endl;
+        return -1;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << LOG_TAG << "bind " << host_port << " failed: " << strerror(errno) << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int StatsServer::start()
+{
+    if (m_serve_thread != nullptr)
+    {
+        return 0;
+    }
+
+    m_listen_fd = openListenSocket();
+    if (m_listen_fd < 0)
+    {
+        return -1;
+    }
+
+    if (::listen(m_listen_fd, 8) < 0)
+    {
+        std::cerr << LOG_TAG << "listen failed: " << strerror(errno) << std::endl;
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return -1;
+    }
+
+    m_stopSignal.store(false);
+    m_serve_thread = std::make_unique<std::thread>([this]() {serveLoop();});
+    std::cout << LOG_TAG << "serving metrics on " << m_listen_addr << std::endl;
+    return 0;
+}
+
+void StatsServer::stop()
+{
+    if (m_serve_thread != nullptr)
+    {
+        m_stopSignal.store(true);
+        if (m_serve_thread->joinable())
+        {
+            m_serve_thread->join();
+        }
+        m_serve_thread.reset();
+    }
+
+    if (m_listen_fd >= 0)
+    {
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+    }
+
+    if (!m_unix_path.empty())
+    {
+        ::unlink(m_unix_path.c_str());
+        m_unix_path.clear();
+    }
+}
+
+void StatsServer::serveLoop()
+{
+    while (!m_stopSignal.load())
+    {
+        struct pollfd pfd{m_listen_fd, POLLIN, 0};
+        int ret = ::poll(&pfd, 1, 200);
+        if (ret <= 0)
+        {
+            continue;
+        }
+
+        int client_fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            continue;
+        }
+        handleClient(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void StatsServer::handleClient(int client_fd)
+{
+    // never let a slow or idle client stall the scrape loop for long
+    struct timeval tv{1, 0};
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+    {
+        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        request.append(buf, n);
+    }
+
+    std::string path;
+    if (request.compare(0, 4, "GET ") == 0)
+    {
+        auto end = request.find_first_of(" ?\r\n", 4);
+        path = request.substr(4, (end == std::string::npos) ? std::string::npos : end - 4);
+    }
+
+    std::string status{"200 OK"};
+    std::string content_type;
+    std::string body;
+    if (path == "/" || path == "/metrics")
+    {
+        content_type = "text/plain; version=0.0.4";
+        body = StatsRegistry::getInstance().exportPrometheus();
+    }
+    else if (path == "/metrics.json")
+    {
+        content_type = "application/json";
+        body = StatsRegistry::getInstance().exportJson();
+    }
+    else
+    {
+        status = "404 Not Found";
+        content_type = "text/plain";
+        body = "try /metrics or /metrics.json\n";
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+                           "Content-Type: " + content_type + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        ssize_t n = ::send(client_fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            break;
+        }
+        sent += n;
+    }
+}
+
+} // namespace common
+} // namespace bsp_perf
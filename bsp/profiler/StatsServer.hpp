@@ -0,0 +1,67 @@
+#ifndef __STATS_SERVER_HPP__
+#define __STATS_SERVER_HPP__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace bsp_perf {
+namespace common {
+
+/**
+ * @brief Embeddable HTTP/1.0 responder serving StatsRegistry.
+ *
+ * Listen address:
+ *     "unix:/tmp/obj_detector.stats"   Unix domain socket
+ *     "tcp:127.0.0.1:9464"             TCP, loopback by default
+ * Routes:
+ *     GET /metrics        Prometheus text format
+ *     GET /metrics.json   JSON with p50/p90/p99 for histograms
+ *
+ * e.g. curl --unix-socket /tmp/obj_detector.stats http://localhost/metrics.json
+ *
+ * One background thread polls the listening socket, requests are answered one at a time and
+ * the connection closed, which is plenty for a scraper and never touches the pipeline threads.
+ */
+class StatsServer
+{
+public:
+    static constexpr char LOG_TAG[] {"[StatsServer]: "};
+
+    explicit StatsServer(const std::string& listen_addr);
+    ~StatsServer();
+
+    StatsServer(const StatsServer&) = delete;
+    StatsServer& operator=(const StatsServer&) = delete;
+    StatsServer(StatsServer&&) = delete;
+    StatsServer& operator=(StatsServer&&) = delete;
+
+    /**
+     * @return 0 on success, -1 if the address is invalid or cannot be bound.
+     */
+    int start();
+
+    void stop();
+
+    const std::string& getListenAddr() const { return m_listen_addr; }
+
+private:
+    int openListenSocket();
+
+    void serveLoop();
+
+    void handleClient(int client_fd);
+
+private:
+    std::string m_listen_addr;
+    std::string m_unix_path{};
+    int m_listen_fd{-1};
+    std::atomic<bool> m_stopSignal{false};
+    std::unique_ptr<std::thread> m_serve_thread{nullptr};
+};
+
+} // namespace common
+} // namespace bsp_perf
+
+#endif // __STATS_SERVER_HPP__
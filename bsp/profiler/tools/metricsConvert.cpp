@@ -0,0 +1,59 @@
+#include <profiler/MetricsLog.hpp>
+#include <shared/ArgParser.hpp>
+#include <iostream>
+#include <string>
+
+using namespace bsp_perf::common;
+using namespace bsp_perf::shared;
+using namespace std::string_literals;
+
+int main(int argc, char* argv[])
+{
+    ArgParser parser("Convert a binary PerfProfiler metrics log");
+    parser.addOption("--input", "logs/perf_case.metrics"s, "path of the binary metrics log");
+    parser.addOption("--format", "csv"s, "output format: csv | json | perfetto");
+    parser.addOption("--output", ""s, "output file, default is <input>.<format extension>");
+    parser.parseArgs(argc, argv);
+
+    std::string input;
+    std::string format;
+    std::string output;
+    parser.getOptionVal("--input", input);
+    parser.getOptionVal("--format", format);
+    parser.getOptionVal("--output", output);
+
+    MetricsLogReader reader;
+    if (reader.open(input) < 0)
+    {
+        return -1;
+    }
+
+    int ret = -1;
+    if (format == "csv")
+    {
+        ret = reader.exportCsv(output.empty() ? input + ".csv" : output);
+    }
+    else if (format == "json")
+    {
+        ret = reader.exportJson(output.empty() ? input + ".json" : output);
+    }
+    else if (format == "perfetto")
+    {
+        ret = reader.exportPerfettoCounters(output.empty() ? input + ".trace.json" : output);
+    }
+    else
+    {
+        std::cerr << "unknown format: " << format << std::endl;
+        return -1;
+    }
+
+    if (ret < 0)
+    {
+        std::cerr << "convert " << input << " failed" << std::endl;
+        return -1;
+    }
+
+    std::cout << input << ": " << reader.getRecordCount() << " records, "
+              << reader.getHeader().dropped_count << " dropped" << std::endl;
+    return 0;
+}
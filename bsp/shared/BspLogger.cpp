@@ -2,49 +2,76 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/async.h>
-#include <chrono>
+#include <map>
 #include <mutex>
+#include <utility>
 namespace bsp_perf {
 namespace shared {
 
 static std::mutex g_mtxLock;
 
-BspLogger::BspLogger(const std::string& logger_id, const std::string& log_file_path, const std::string& async_log_file_path)
+BspLogger::BspLogger(const std::string& logger_id, const std::string& log_file_path, const std::string& async_log_file_path):
+    m_logger_id{logger_id},
+    m_log_file_path{log_file_path},
+    m_async_log_file_path{async_log_file_path},
+    m_stdout_logger{getSharedLogger(Channel::Stdout)}
 {
-    {
-        std::lock_guard<std::mutex> lock(g_mtxLock);
-        auto ts = std::chrono::system_clock::now().time_since_epoch().count();
-        auto logger_name = logger_id + "_" + std::to_string(ts);
-        m_stdout_logger = spdlog::stdout_color_mt(logger_name);
-        ts = std::chrono::system_clock::now().time_since_epoch().count();
-        logger_name = logger_id + "_" + std::to_string(ts);
-        m_file_logger = spdlog::basic_logger_mt(logger_name, log_file_path);
-        ts = std::chrono::system_clock::now().time_since_epoch().count();
-        logger_name = logger_id + "_" + std::to_string(ts);
-        m_async_file_logger = spdlog::basic_logger_mt<spdlog::async_factory>(logger_name, async_log_file_path);
-    }
-
-    // Initialize the logger here
-    m_stdout_logger->set_level(spdlog::level::debug);
-
-    m_file_logger->set_level(spdlog::level::info);
-    // Set the flush level for the file logger
-    m_file_logger->flush_on(spdlog::level::info);
-
-    m_async_file_logger->set_level(spdlog::level::info);
-    // Set the flush level for the async file logger
-    m_async_file_logger->flush_on(spdlog::level::info);
-
 }
 
 BspLogger::~BspLogger() {
-    // Cleanup the logger here
-    spdlog::flush_every(std::chrono::seconds(3));
-    spdlog::shutdown();
+    // The spdlog loggers are shared with other BspLogger instances, only flush what this one wrote.
+    // spdlog::shutdown() would tear down the loggers and the async thread pool for everyone.
+    if (m_file_logger)
+    {
+        m_file_logger->flush();
+    }
+    if (m_async_file_logger)
+    {
+        m_async_file_logger->flush();
+    }
     m_stdout_logger.reset();
     m_file_logger.reset();
     m_async_file_logger.reset();
 }
 
+std::shared_ptr<spdlog::logger> BspLogger::getSharedLogger(Channel channel, const std::string& file_path)
+{
+    static std::map<std::pair<Channel, std::string>, std::shared_ptr<spdlog::logger>> shared_loggers;
+
+    std::lock_guard<std::mutex> lock(g_mtxLock);
+    auto key = std::make_pair(channel, (channel == Channel::Stdout) ? ""s : file_path);
+    auto it = shared_loggers.find(key);
+    if (it != shared_loggers.end())
+    {
+        return it->second;
+    }
+
+    std::shared_ptr<spdlog::logger> logger{nullptr};
+    switch (channel)
+    {
+    case Channel::Stdout:
+        logger = spdlog::stdout_color_mt("bsp_stdout");
+        logger->set_level(spdlog::level::debug);
+        break;
+    case Channel::File:
+        logger = spdlog::basic_logger_mt("bsp_file:" + file_path, file_path);
+        logger->set_level(spdlog::level::info);
+        // Set the flush level for the file logger
+        logger->flush_on(spdlog::level::info);
+        break;
+    case Channel::AsyncFile:
+        logger = spdlog::basic_logger_mt<spdlog::async_factory>("bsp_async_file:" + file_path, file_path);
+        logger->set_level(spdlog::level::info);
+        // Set the flush level for the async file logger
+        logger->flush_on(spdlog::level::info);
+        break;
+    default:
+        return nullptr;
+    }
+
+    shared_loggers.emplace(key, logger);
+    return logger;
+}
+
 } // namespace shared
-} // namespace bsp_perf
\ No newline at end of file
+} // namespace bsp_perf
@@ -25,19 +25,37 @@ SOFTWARE.
 #ifndef __BSP_LOGGER_HPP__
 #define __BSP_LOGGER_HPP__
 
-// Your code here
-
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <spdlog/spdlog.h>
 
+/**
+ * @brief Compile-time minimum log severity, 0:Debug 1:Info 2:Warn 3:Error 4:Critical.
+ * Call sites going through the BSP_LOG* macros below this level are compiled out,
+ * arguments included. Set it with -DBSP_LOG_ACTIVE_LEVEL=<n> (cmake: BSP_LOG_ACTIVE_LEVEL).
+ */
+#ifndef BSP_LOG_ACTIVE_LEVEL
+#define BSP_LOG_ACTIVE_LEVEL 0
+#endif
+
 namespace bsp_perf {
 namespace shared {
 
 using namespace std::string_literals;
 
+/**
+ * @brief Lightweight logger front end.
+ *
+ * The spdlog loggers behind the stdout / file / async file channels are shared process wide
+ * (one per channel and file path) and created on first use, so constructing a BspLogger per
+ * connection or per queue is cheap. Each instance carries its own runtime level which is
+ * checked with a relaxed atomic load before anything is formatted.
+ */
 class BspLogger {
 public:
     BspLogger(const std::string& logger_id, const std::string& log_file_path = "logs/bsp_perf.log"s, const std::string& async_log_file_path = "logs/bsp_perf_async.log"s);
@@ -55,6 +73,45 @@ public:
     BspLogger& operator=(const BspLogger&) = delete;
     BspLogger& operator=(BspLogger&&) = delete;
 
+    /**
+     * @brief Severity order of a level, Critical is above Error as in spdlog.
+     */
+    static constexpr int severity(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Debug:
+            return 0;
+        case LogLevel::Info:
+            return 1;
+        case LogLevel::Warn:
+            return 2;
+        case LogLevel::Error:
+            return 3;
+        case LogLevel::Critical:
+            return 4;
+        default:
+            return 4;
+        }
+    }
+
+    static constexpr bool isCompiledIn(LogLevel level)
+    {
+        return severity(level) >= BSP_LOG_ACTIVE_LEVEL;
+    }
+
+    void setLevel(LogLevel level)
+    {
+        m_level.store(severity(level), std::memory_order_relaxed);
+    }
+
+    bool shouldLog(LogLevel level) const
+    {
+        return severity(level) >= m_level.load(std::memory_order_relaxed);
+    }
+
+    const std::string& getLoggerId() const { return m_logger_id; }
+
     void setPattern(const std::string& pattern = "[%H:%M:%S.%f][%^%l%$] %v"s)
     {
         // Set the pattern for the loggers
@@ -65,14 +122,21 @@ public:
     void printStdoutLog(LogLevel level, std::string_view sv, const Args &... args)
     {
         // Print the log message to stdout
-        printLogger(m_stdout_logger, level, sv, args...);
+        if (shouldLog(level))
+        {
+            printLogger(m_stdout_logger, level, sv, args...);
+        }
     }
 
     template<typename... Args>
     void printFileLog(LogLevel level, std::string_view sv, const Args &... args)
     {
         // Print the log message to a file
-        printLogger(m_file_logger, level, sv, args...);
+        if (shouldLog(level))
+        {
+            std::call_once(m_file_once, [this] { m_file_logger = getSharedLogger(Channel::File, m_log_file_path); });
+            printLogger(m_file_logger, level, sv, args...);
+        }
     }
 
 
@@ -80,10 +144,48 @@ public:
     void printAsyncFileLog(LogLevel level, std::string_view sv, const Args &... args)
     {
         // Print the log message to a file asynchronously
-        printLogger(m_async_file_logger, level, sv, args...);
+        if (shouldLog(level))
+        {
+            std::call_once(m_async_file_once, [this] { m_async_file_logger = getSharedLogger(Channel::AsyncFile, m_async_log_file_path); });
+            printLogger(m_async_file_logger, level, sv, args...);
+        }
     }
 
+    /**
+     * @brief Rate limiter state for BSP_LOG_EVERY_N / BSP_LOG_EVERY_MS, one per call site.
+     */
+    struct RateLimiter
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<int64_t> last_ms{-1};
+
+        bool everyN(uint64_t n)
+        {
+            return (n <= 1) || (count.fetch_add(1, std::memory_order_relaxed) % n == 0);
+        }
+
+        bool everyMs(int64_t period_ms)
+        {
+            int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t last = last_ms.load(std::memory_order_relaxed);
+            if ((last >= 0) && (now - last < period_ms))
+            {
+                return false;
+            }
+            return last_ms.compare_exchange_strong(last, now, std::memory_order_relaxed);
+        }
+    };
+
 protected:
+    enum class Channel {
+        Stdout,
+        File,
+        AsyncFile
+    };
+
+    static std::shared_ptr<spdlog::logger> getSharedLogger(Channel channel, const std::string& file_path = ""s);
+
     template<typename... Args>
     void printLogger(std::shared_ptr<spdlog::logger> &logger, LogLevel level, std::string_view sv, const Args &... args)
     {
@@ -111,7 +213,12 @@ protected:
     }
 
 private:
-    // Your code here
+    std::string m_logger_id;
+    std::string m_log_file_path;
+    std::string m_async_log_file_path;
+    std::atomic<int> m_level{0};
+    std::once_flag m_file_once;
+    std::once_flag m_async_file_once;
     std::shared_ptr<spdlog::logger> m_stdout_logger{nullptr};
     std::shared_ptr<spdlog::logger> m_file_logger{nullptr};
     std::shared_ptr<spdlog::logger> m_async_file_logger{nullptr};
@@ -121,4 +228,50 @@ private:
 } // namespace shared
 } // namespace bsp_perf
 
+/**
+ * @brief Logging macros, the level is checked (at compile time, then at runtime) before the
+ * arguments are evaluated. method is one of printStdoutLog / printFileLog / printAsyncFileLog.
+ * @code
+ * BSP_LOG(m_logger, printStdoutLog, Info, "frame {} done", frame_id);
+ * BSP_LOG_EVERY_N(m_logger, printStdoutLog, Info, 30, "fps: {}", fps);
+ * BSP_LOG_EVERY_MS(m_logger, printStdoutLog, Warn, 1000, "queue full, dropped {}", dropped);
+ * @endcode
+ */
+#define BSP_LOG(logger, method, level, ...)                                                          \
+    do {                                                                                             \
+        if constexpr (bsp_perf::shared::BspLogger::isCompiledIn(bsp_perf::shared::BspLogger::LogLevel::level)) \
+        {                                                                                            \
+            if ((logger)->shouldLog(bsp_perf::shared::BspLogger::LogLevel::level))                   \
+            {                                                                                        \
+                (logger)->method(bsp_perf::shared::BspLogger::LogLevel::level, __VA_ARGS__);        \
+            }                                                                                        \
+        }                                                                                            \
+    } while (0)
+
+#define BSP_LOG_EVERY_N(logger, method, level, n, ...)                                               \
+    do {                                                                                             \
+        if constexpr (bsp_perf::shared::BspLogger::isCompiledIn(bsp_perf::shared::BspLogger::LogLevel::level)) \
+        {                                                                                            \
+            static bsp_perf::shared::BspLogger::RateLimiter bsp_log_limiter_;                        \
+            if ((logger)->shouldLog(bsp_perf::shared::BspLogger::LogLevel::level) &&                 \
+                bsp_log_limiter_.everyN(n))                                                          \
+            {                                                                                        \
+                (logger)->method(bsp_perf::shared::BspLogger::LogLevel::level, __VA_ARGS__);        \
+            }                                                                                        \
+        }                                                                                            \
+    } while (0)
+
+#define BSP_LOG_EVERY_MS(logger, method, level, period_ms, ...)                                      \
+    do {                                                                                             \
+        if constexpr (bsp_perf::shared::BspLogger::isCompiledIn(bsp_perf::shared::BspLogger::LogLevel::level)) \
+        {                                                                                            \
+            static bsp_perf::shared::BspLogger::RateLimiter bsp_log_limiter_;                        \
+            if ((logger)->shouldLog(bsp_perf::shared::BspLogger::LogLevel::level) &&                 \
+                bsp_log_limiter_.everyMs(period_ms))                                                 \
+            {                                                                                        \
+                (logger)->method(bsp_perf::shared::BspLogger::LogLevel::level, __VA_ARGS__);        \
+            }                                                                                        \
+        }                                                                                            \
+    } while (0)
+
 #endif // __BSP_LOGGER_HPP__
\ No newline at end of file
@@ -0,0 +1,227 @@
+#ifndef __BSP_PACKET_BUFFER_HPP__
+#define __BSP_PACKET_BUFFER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace bsp_perf {
+namespace shared {
+
+/**
+ * @brief Refcounted view of one compressed packet (bitstream of a frame, demuxed packet).
+ *
+ * Copies share the memory, it stays valid as long as one copy holds owner. Whoever produced
+ * the bytes decides where they live: a PacketBufferPool block, an MppBuffer, an AVPacket ...
+ * the owner deleter gives them back. This lets an encoded frame travel encoder -> muxer
+ * without being copied, the FFmpeg side wraps it with av_buffer_create().
+ */
+struct PacketBuffer
+{
+    // same as AV_INPUT_BUFFER_PADDING_SIZE
+    static constexpr size_t PADDING_SIZE{64};
+
+    uint8_t* data{nullptr};
+    size_t size{0};
+    size_t capacity{0};
+    // PADDING_SIZE zeroed bytes follow size (pool buffers), FFmpeg readers may overread into them;
+    // the FFmpeg muxer passes only padded buffers by reference and copies the others
+    bool padded{false};
+    std::shared_ptr<void> owner{nullptr};
+
+    bool empty() const { return (data == nullptr) || (size == 0); }
+
+    /**
+     * @brief Reference to external memory, owner keeps it alive.
+     */
+    static PacketBuffer wrap(uint8_t* data, size_t size, std::shared_ptr<void> owner)
+    {
+        PacketBuffer buffer;
+        buffer.data = data;
+        buffer.size = size;
+        buffer.capacity = size;
+        buffer.owner = std::move(owner);
+        return buffer;
+    }
+
+    /**
+     * @brief Append bytes, fails when capacity is exceeded. Only for buffers nobody else reads yet.
+     */
+    bool append(const uint8_t* src, size_t len)
+    {
+        if ((data == nullptr) || (size + len > capacity))
+        {
+            return false;
+        }
+        std::memcpy(data + size, src, len);
+        size += len;
+        if (padded)
+        {
+            std::memset(data + size, 0, PADDING_SIZE);
+        }
+        return true;
+    }
+
+    void reset()
+    {
+        data = nullptr;
+        size = 0;
+        capacity = 0;
+        padded = false;
+        owner.reset();
+    }
+};
+
+/**
+ * @brief Recycling allocator for PacketBuffers, for producers that have to copy the bitstream
+ * out of memory they reuse (a V4L2 capture buffer, partitioned encoder output).
+ *
+ * Blocks are bucketed by power of two capacities, so the mix of I and P frame sizes settles on
+ * a handful of blocks. A block returns to the pool when the last PacketBuffer copy is dropped,
+ * buffers may outlive the pool.
+ */
+class PacketBufferPool
+{
+public:
+    static constexpr size_t MIN_CAPACITY{4096};
+
+    struct Stats
+    {
+        uint64_t allocations{0};
+        uint64_t reuses{0};
+        size_t freeBlocks{0};
+        size_t freeBytes{0};
+    };
+
+    explicit PacketBufferPool(size_t maxFreePerSize = 8)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->maxFreePerSize = maxFreePerSize;
+    }
+
+    ~PacketBufferPool()
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->alive = false;
+        for (auto& bucket : m_state->freeBlocks)
+        {
+            for (auto* block : bucket.second)
+            {
+                std::free(block);
+            }
+        }
+        m_state->freeBlocks.clear();
+    }
+
+    PacketBufferPool(const PacketBufferPool&) = delete;
+    PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+    /**
+     * @brief Empty buffer (size 0) with at least capacity bytes, fill it with append().
+     * @return an empty PacketBuffer when the allocation failed
+     */
+    PacketBuffer acquire(size_t capacity)
+    {
+        size_t blockCapacity = MIN_CAPACITY;
+        while (blockCapacity < capacity)
+        {
+            blockCapacity <<= 1;
+        }
+
+        uint8_t* block = takeFreeBlock(blockCapacity);
+        if (block == nullptr)
+        {
+            block = static_cast<uint8_t*>(std::malloc(blockCapacity + PacketBuffer::PADDING_SIZE));
+            if (block == nullptr)
+            {
+                return PacketBuffer{};
+            }
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            ++m_state->stats.allocations;
+        }
+        std::memset(block, 0, PacketBuffer::PADDING_SIZE);
+
+        std::weak_ptr<State> weakState = m_state;
+        PacketBuffer buffer;
+        buffer.data = block;
+        buffer.capacity = blockCapacity;
+        buffer.padded = true;
+        buffer.owner = std::shared_ptr<void>(block, [weakState, blockCapacity](void* p) {
+            recycle(weakState, static_cast<uint8_t*>(p), blockCapacity);
+        });
+        return buffer;
+    }
+
+    /**
+     * @brief Pool copy of len bytes.
+     */
+    PacketBuffer copy(const uint8_t* src, size_t len)
+    {
+        PacketBuffer buffer = acquire(len);
+        buffer.append(src, len);
+        return buffer;
+    }
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->stats;
+    }
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        bool alive{true};
+        size_t maxFreePerSize{8};
+        std::unordered_map<size_t, std::vector<uint8_t*>> freeBlocks;
+        Stats stats;
+    };
+
+    static void recycle(const std::weak_ptr<State>& weakState, uint8_t* block, size_t blockCapacity)
+    {
+        auto state = weakState.lock();
+        if (state)
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            auto& bucket = state->freeBlocks[blockCapacity];
+            if (state->alive && (bucket.size() < state->maxFreePerSize))
+            {
+                bucket.push_back(block);
+                ++state->stats.freeBlocks;
+                state->stats.freeBytes += blockCapacity;
+                return;
+            }
+        }
+        std::free(block);
+    }
+
+    uint8_t* takeFreeBlock(size_t blockCapacity)
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        auto it = m_state->freeBlocks.find(blockCapacity);
+        if ((it == m_state->freeBlocks.end()) || it->second.empty())
+        {
+            return nullptr;
+        }
+        uint8_t* block = it->second.back();
+        it->second.pop_back();
+        ++m_state->stats.reuses;
+        --m_state->stats.freeBlocks;
+        m_state->stats.freeBytes -= blockCapacity;
+        return block;
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace shared
+} // namespace bsp_perf
+
+#endif // __BSP_PACKET_BUFFER_HPP__
@@ -0,0 +1,492 @@
+#include "BspParallel.hpp"
+#include "BspThreadConfig.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace bsp_perf {
+namespace shared {
+
+constexpr char BspParallel::LOG_TAG[];
+constexpr char BspParallel::THREAD_ROLE[];
+
+namespace
+{
+// chunks per thread, small enough bands that fast cores can take over the work of slow ones
+constexpr int CHUNKS_PER_THREAD{4};
+constexpr int MIN_TILE_ROWS{8};
+constexpr int TILE_COLUMN_ALIGN{64};
+constexpr size_t DEFAULT_L2_BYTES{256 * 1024};
+
+// set while a thread runs chunks, nested calls then run inline
+thread_local bool t_in_job{false};
+
+long readSysfsLong(const std::string& path, long fallback)
+{
+    std::ifstream file(path);
+    long value = 0;
+    if (!(file >> value))
+    {
+        return fallback;
+    }
+    return value;
+}
+
+std::string cpuPath(int cpu, const std::string& node)
+{
+    return "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/" + node;
+}
+
+// "512K" / "2M" / "1048576"
+size_t parseCacheSize(const std::string& str)
+{
+    size_t pos = 0;
+    unsigned long value = 0;
+    try
+    {
+        value = std::stoul(str, &pos);
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+    if (pos < str.size())
+    {
+        if (str[pos] == 'K')
+        {
+            value *= 1024;
+        }
+        else if (str[pos] == 'M')
+        {
+            value *= 1024 * 1024;
+        }
+    }
+    return value;
+}
+
+size_t detectL2Bytes(int cpu)
+{
+    for (int index = 0; index < 8; ++index)
+    {
+        const std::string dir = cpuPath(cpu, "cache/index" + std::to_string(index) + "/");
+        if (readSysfsLong(dir + "level", 0) != 2)
+        {
+            continue;
+        }
+        std::ifstream file(dir + "size");
+        std::string size;
+        if ((file >> size) && (parseCacheSize(size) > 0))
+        {
+            return parseCacheSize(size);
+        }
+    }
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    const long size = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0)
+    {
+        return static_cast<size_t>(size);
+    }
+#endif
+    return DEFAULT_L2_BYTES;
+}
+
+int envThreads()
+{
+    for (const char* name : {"BSP_PARALLEL_THREADS", "BSP_CPU2D_THREADS"})
+    {
+        const char* env = std::getenv(name);
+        if (env != nullptr)
+        {
+            return std::atoi(env);
+        }
+    }
+    return 0;
+}
+} // namespace
+
+BspParallel::BspParallel()
+{
+    detectTopology();
+
+    size_t cpu_count = 0;
+    for (const auto& cluster : m_clusters)
+    {
+        cpu_count += cluster.cpus.size();
+    }
+    int threads = envThreads();
+    if (threads <= 0)
+    {
+        threads = static_cast<int>(cpu_count);
+    }
+    threads = std::max(threads, 1);
+
+    BspThreadConfig::ThreadRole role{};
+    const bool role_configured = BspThreadConfig::getInstance().getRole(THREAD_ROLE, role);
+    m_bound = !role_configured && (m_clusters.size() > 1);
+
+    // spread the workers over the clusters like the cores are, the caller takes the first slot
+    std::vector<int> slots;
+    for (size_t i = 0; i < m_clusters.size(); ++i)
+    {
+        slots.insert(slots.end(), m_clusters[i].cpus.size(), static_cast<int>(i));
+    }
+    if (slots.empty())
+    {
+        slots.push_back(0);
+    }
+    for (int i = 1; i < threads; ++i)
+    {
+        m_worker_cluster.push_back(slots[static_cast<size_t>(i) % slots.size()]);
+    }
+
+    m_ranges = std::make_unique<ClusterRange[]>(std::max<size_t>(m_clusters.size(), 1));
+    for (int i = 1; i < threads; ++i)
+    {
+        m_workers.emplace_back([this, i]() {workerLoop(i - 1);});
+    }
+}
+
+BspParallel::~BspParallel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_job_cv.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void BspParallel::detectTopology()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    const bool has_mask = (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    const long configured = std::max(::sysconf(_SC_NPROCESSORS_CONF), 1L);
+
+    // cores with the same cluster (or package) id and capacity share a cluster
+    std::map<std::pair<long, long>, size_t> keys;
+    for (int cpu = 0; (cpu < configured) && (cpu < CPU_SETSIZE); ++cpu)
+    {
+        if ((has_mask && !CPU_ISSET(cpu, &allowed)) || (readSysfsLong(cpuPath(cpu, "online"), 1) == 0))
+        {
+            continue;
+        }
+
+        long id = readSysfsLong(cpuPath(cpu, "topology/cluster_id"), -1);
+        if (id < 0)
+        {
+            id = readSysfsLong(cpuPath(cpu, "topology/physical_package_id"), 0);
+        }
+        long capacity = readSysfsLong(cpuPath(cpu, "cpu_capacity"), 0);
+        if (capacity <= 0)
+        {
+            capacity = readSysfsLong(cpuPath(cpu, "cpufreq/cpuinfo_max_freq"), 0) / 1000;
+        }
+        capacity = std::max(capacity, 1L);
+
+        const auto key = std::make_pair(id, capacity);
+        auto it = keys.find(key);
+        if (it == keys.end())
+        {
+            it = keys.emplace(key, m_clusters.size()).first;
+            m_clusters.push_back(CpuCluster{{}, static_cast<uint32_t>(capacity)});
+        }
+        m_clusters[it->second].cpus.push_back(cpu);
+        if (m_cpu_cluster.size() <= static_cast<size_t>(cpu))
+        {
+            m_cpu_cluster.resize(static_cast<size_t>(cpu) + 1, -1);
+        }
+        m_cpu_cluster[static_cast<size_t>(cpu)] = static_cast<int>(it->second);
+    }
+
+    if (m_clusters.empty())
+    {
+        // no sysfs (containers, old kernels): one cluster of the cores the runtime reports
+        CpuCluster cluster{};
+        const int count = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+        for (int cpu = 0; cpu < count; ++cpu)
+        {
+            cluster.cpus.push_back(cpu);
+        }
+        m_clusters.push_back(cluster);
+    }
+
+    const size_t l2_bytes = detectL2Bytes(m_clusters.front().cpus.front());
+    m_tile_bytes = std::clamp(l2_bytes / 2, size_t{32 * 1024}, size_t{1024 * 1024});
+}
+
+int BspParallel::concurrency() const
+{
+    const int limit = m_thread_limit.load(std::memory_order_relaxed);
+    return (limit > 0) ? std::min(limit, maxConcurrency()) : maxConcurrency();
+}
+
+void BspParallel::setThreadLimit(int threads)
+{
+    m_thread_limit.store(std::max(threads, 0), std::memory_order_relaxed);
+}
+
+int BspParallel::homeCluster() const
+{
+    if (!m_bound)
+    {
+        return 0;
+    }
+    const int cpu = ::sched_getcpu();
+    if ((cpu < 0) || (static_cast<size_t>(cpu) >= m_cpu_cluster.size()) || (m_cpu_cluster[static_cast<size_t>(cpu)] < 0))
+    {
+        return 0;
+    }
+    return m_cpu_cluster[static_cast<size_t>(cpu)];
+}
+
+void BspParallel::runChunk(int chunk)
+{
+    if (m_range_fn != nullptr)
+    {
+        const int begin = chunk * m_chunk_size;
+        (*m_range_fn)(begin, std::min(begin + m_chunk_size, m_count));
+        return;
+    }
+
+    Tile tile{};
+    tile.x = (chunk % m_tiles_per_row) * m_tile.width;
+    tile.y = (chunk / m_tiles_per_row) * m_tile.height;
+    tile.width = std::min(m_tile.width, m_image.width - tile.x);
+    tile.height = std::min(m_tile.height, m_image.height - tile.y);
+    (*m_tile_fn)(tile);
+}
+
+void BspParallel::runChunks()
+{
+    t_in_job = true;
+    const int cluster_count = m_bound ? static_cast<int>(m_clusters.size()) : 1;
+    const int home = homeCluster();
+    for (int i = 0; i < cluster_count; ++i)
+    {
+        ClusterRange& range = m_ranges[static_cast<size_t>((home + i) % cluster_count)];
+        while (true)
+        {
+            const int chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= range.end)
+            {
+                break;
+            }
+            runChunk(chunk);
+        }
+    }
+    t_in_job = false;
+}
+
+void BspParallel::workerLoop(int index)
+{
+    auto& thread_config = BspThreadConfig::getInstance();
+    BspThreadConfig::ThreadRole role{};
+    if (thread_config.getRole(THREAD_ROLE, role) || !m_bound)
+    {
+        thread_config.applyToCurrentThread(THREAD_ROLE);
+    }
+    else
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : m_clusters[static_cast<size_t>(m_worker_cluster[static_cast<size_t>(index)])].cpus)
+        {
+            CPU_SET(cpu, &cpus);
+        }
+        if (::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) != 0)
+        {
+            std::cerr << LOG_TAG << "cannot bind worker " << index << " to its cluster" << std::endl;
+        }
+    }
+
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_cv.wait(lock, [&]() {return m_stop || (m_generation != seen_generation);});
+            if (m_stop)
+            {
+                return;
+            }
+            seen_generation = m_generation;
+            if (index >= m_job_workers)
+            {
+                // left out by the thread limit
+                continue;
+            }
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busy_workers;
+        }
+        m_done_cv.notify_one();
+    }
+}
+
+void BspParallel::runJob(int chunk_count)
+{
+    const int job_workers = concurrency() - 1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t cluster_count = m_bound ? m_clusters.size() : 1;
+        std::vector<uint64_t> weights(cluster_count, 0);
+        if (cluster_count > 1)
+        {
+            weights[static_cast<size_t>(homeCluster())] += m_clusters[static_cast<size_t>(homeCluster())].capacity;
+            for (int i = 0; i < job_workers; ++i)
+            {
+                const auto cluster = static_cast<size_t>(m_worker_cluster[static_cast<size_t>(i)]);
+                weights[cluster] += m_clusters[cluster].capacity;
+            }
+        }
+        else
+        {
+            weights[0] = 1;
+        }
+
+        // contiguous share per cluster, proportional to the capacity taking part in the job
+        uint64_t total_weight = 0;
+        for (auto weight : weights)
+        {
+            total_weight += weight;
+        }
+        uint64_t weight_sum = 0;
+        int begin = 0;
+        for (size_t i = 0; i < cluster_count; ++i)
+        {
+            weight_sum += weights[i];
+            const int end = static_cast<int>(static_cast<uint64_t>(chunk_count) * weight_sum / total_weight);
+            m_ranges[i].next.store(begin, std::memory_order_relaxed);
+            m_ranges[i].end = end;
+            begin = end;
+        }
+
+        m_job_workers = job_workers;
+        m_busy_workers = job_workers;
+        ++m_generation;
+    }
+    m_job_cv.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [this]() {return m_busy_workers == 0;});
+    m_range_fn = nullptr;
+    m_tile_fn = nullptr;
+}
+
+void BspParallel::parallelFor(int count, int min_chunk, int align, const std::function<void(int, int)>& fn)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    min_chunk = std::max(min_chunk, 1);
+    align = std::max(align, 1);
+    const int threads = concurrency();
+    const int chunk_count = std::min(threads * CHUNKS_PER_THREAD, count / min_chunk);
+    if ((threads <= 1) || (chunk_count <= 1) || t_in_job)
+    {
+        fn(0, count);
+        return;
+    }
+
+    std::unique_lock<std::mutex> job_lock(m_job_mutex, std::try_to_lock);
+    if (!job_lock.owns_lock())
+    {
+        fn(0, count);
+        return;
+    }
+
+    int chunk_size = (count + chunk_count - 1) / chunk_count;
+    chunk_size = (chunk_size + align - 1) / align * align;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_range_fn = &fn;
+        m_tile_fn = nullptr;
+        m_count = count;
+        m_chunk_size = chunk_size;
+    }
+    runJob((count + chunk_size - 1) / chunk_size);
+}
+
+BspParallel::Tile BspParallel::tileSize(int width, int height, size_t bytes_per_pixel) const
+{
+    Tile tile{0, 0, std::max(width, 1), std::max(height, 1)};
+    const size_t row_bytes = static_cast<size_t>(tile.width) * std::max<size_t>(bytes_per_pixel, 1);
+    if (row_bytes * MIN_TILE_ROWS <= m_tile_bytes)
+    {
+        tile.height = std::clamp(static_cast<int>(m_tile_bytes / row_bytes), 1, tile.height);
+        return tile;
+    }
+
+    tile.height = std::min(MIN_TILE_ROWS, tile.height);
+    const size_t columns = m_tile_bytes / (static_cast<size_t>(tile.height) * std::max<size_t>(bytes_per_pixel, 1));
+    const int aligned = std::max(static_cast<int>(columns) / TILE_COLUMN_ALIGN * TILE_COLUMN_ALIGN, TILE_COLUMN_ALIGN);
+    tile.width = std::min(aligned, tile.width);
+    return tile;
+}
+
+void BspParallel::parallelForTiles(int width, int height, size_t bytes_per_pixel,
+                                   const std::function<void(const Tile&)>& fn)
+{
+    if ((width <= 0) || (height <= 0))
+    {
+        return;
+    }
+
+    const Tile tile = tileSize(width, height, bytes_per_pixel);
+    const int tiles_per_row = (width + tile.width - 1) / tile.width;
+    const int tile_rows = (height + tile.height - 1) / tile.height;
+    const int tile_count = tiles_per_row * tile_rows;
+
+    std::unique_lock<std::mutex> job_lock(m_job_mutex, std::defer_lock);
+    if ((tile_count > 1) && (concurrency() > 1) && !t_in_job)
+    {
+        job_lock.try_lock();
+    }
+    if (!job_lock.owns_lock())
+    {
+        for (int y = 0; y < height; y += tile.height)
+        {
+            for (int x = 0; x < width; x += tile.width)
+            {
+                fn(Tile{x, y, std::min(tile.width, width - x), std::min(tile.height, height - y)});
+            }
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_range_fn = nullptr;
+        m_tile_fn = &fn;
+        m_image = Tile{0, 0, width, height};
+        m_tile = tile;
+        m_tiles_per_row = tiles_per_row;
+    }
+    runJob(tile_count);
+}
+
+} // namespace shared
+} // namespace bsp_perf
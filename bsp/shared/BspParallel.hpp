@@ -0,0 +1,155 @@
+#ifndef __BSP_PARALLEL_HPP__
+#define __BSP_PARALLEL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bsp_perf {
+namespace shared {
+
+/**
+ * @brief Process wide persistent worker pool for data parallel CPU kernels.
+ *
+ * Work is cut into chunks (row bands or cache sized 2D tiles) that the calling thread and the
+ * workers claim dynamically, so a big.LITTLE SoC keeps every core busy instead of waiting for
+ * the slowest one. The CPU topology is read from sysfs: cores are grouped into clusters
+ * (arm64 cluster / x86 package, split by capacity), every worker is bound to one cluster and
+ * each cluster first walks its own contiguous share of the chunks, sized by its capacity,
+ * before it steals from the others. Neighbouring rows therefore stay in one shared L2/L3.
+ *
+ * Threads take the "bsp_parallel" BspThreadConfig role when it is configured (cluster binding
+ * is skipped then). The thread count defaults to the online cores, BSP_PARALLEL_THREADS
+ * overrides it (BSP_CPU2D_THREADS is still honored).
+ *
+ * Calls from inside a chunk and calls while the pool serves another caller run inline.
+ */
+class BspParallel
+{
+public:
+    static constexpr char LOG_TAG[] {"[BspParallel]: "};
+    static constexpr char THREAD_ROLE[] {"bsp_parallel"};
+
+    struct Tile
+    {
+        int x{0};
+        int y{0};
+        int width{0};
+        int height{0};
+    };
+
+    struct CpuCluster
+    {
+        std::vector<int> cpus{};
+        uint32_t capacity{1};   // per core, cpu_capacity or max frequency
+    };
+
+    static BspParallel& getInstance()
+    {
+        static BspParallel instance;
+        return instance;
+    }
+
+    /**
+     * @brief Run fn(begin, end) over [0, count) split into chunks of at least min_chunk items,
+     * chunk starts are multiples of align. The calling thread works on chunks too.
+     */
+    void parallelFor(int count, int min_chunk, int align, const std::function<void(int, int)>& fn);
+
+    /**
+     * @brief Run fn(tile) over a width x height image cut into tiles of about tileBytes(),
+     * bytes_per_pixel counts every plane a pixel reads and writes. Tiles span the full width
+     * unless a few rows already exceed the budget, then columns are split on 64 pixels.
+     */
+    void parallelForTiles(int width, int height, size_t bytes_per_pixel, const std::function<void(const Tile&)>& fn);
+
+    /**
+     * @brief Tile size parallelForTiles() would use.
+     */
+    Tile tileSize(int width, int height, size_t bytes_per_pixel) const;
+
+    /**
+     * @brief Threads a job is split across, the caller included.
+     */
+    int concurrency() const;
+
+    int maxConcurrency() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    /**
+     * @brief Limit the threads used by the following jobs, e.g. for scaling runs, 0 lifts the limit.
+     */
+    void setThreadLimit(int threads);
+
+    /**
+     * @brief Tile budget in bytes, half of the L2 cache.
+     */
+    size_t tileBytes() const { return m_tile_bytes; }
+
+    const std::vector<CpuCluster>& clusters() const { return m_clusters; }
+
+private:
+    BspParallel();
+    ~BspParallel();
+    BspParallel(const BspParallel&) = delete;
+    BspParallel& operator=(const BspParallel&) = delete;
+
+    struct ClusterRange
+    {
+        std::atomic<int> next{0};
+        int end{0};
+    };
+
+    void detectTopology();
+
+    void workerLoop(int index);
+
+    int homeCluster() const;
+
+    /**
+     * @brief Hand the chunks out per cluster, wake the workers and help until all are done.
+     */
+    void runJob(int chunk_count);
+
+    void runChunks();
+
+    void runChunk(int chunk);
+
+private:
+    std::vector<CpuCluster> m_clusters;
+    std::vector<int> m_cpu_cluster;         // cpu -> cluster index, -1 unknown
+    std::vector<int> m_worker_cluster;      // worker -> cluster it is bound to
+    bool m_bound{false};                    // workers are bound to their cluster
+    size_t m_tile_bytes{128 * 1024};
+    std::atomic<int> m_thread_limit{0};
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_job_mutex;
+    std::mutex m_mutex;
+    std::condition_variable m_job_cv;
+    std::condition_variable m_done_cv;
+    bool m_stop{false};
+    uint64_t m_generation{0};
+    int m_job_workers{0};
+    int m_busy_workers{0};
+
+    // current job, written under m_mutex before m_generation is bumped
+    const std::function<void(int, int)>* m_range_fn{nullptr};
+    const std::function<void(const Tile&)>* m_tile_fn{nullptr};
+    int m_count{0};
+    int m_chunk_size{0};
+    Tile m_image{};
+    Tile m_tile{};
+    int m_tiles_per_row{0};
+    std::unique_ptr<ClusterRange[]> m_ranges;
+};
+
+} // namespace shared
+} // namespace bsp_perf
+
+#endif // __BSP_PARALLEL_HPP__
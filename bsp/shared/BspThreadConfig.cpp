@@ -0,0 +1,320 @@
+#include "BspThreadConfig.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+namespace bsp_perf {
+namespace shared {
+
+constexpr char BspThreadConfig::LOG_TAG[];
+constexpr char BspThreadConfig::ARG_SECTION[];
+
+void BspThreadConfig::splitList(const std::string& str, char delim, std::vector<std::string>& out)
+{
+    std::stringstream ss(str);
+    std::string item;
+    out.clear();
+
+    while (std::getline(ss, item, delim))
+    {
+        auto first = item.find_first_not_of(" \t");
+        auto last = item.find_last_not_of(" \t");
+        if (first == std::string::npos)
+        {
+            continue;
+        }
+        out.push_back(item.substr(first, last - first + 1));
+    }
+}
+
+int BspThreadConfig::parseCpuList(const std::string& str, std::vector<int>& cpus)
+{
+    cpus.clear();
+    if (str.empty() || str == "*")
+    {
+        return 0;
+    }
+
+    std::vector<std::string> ranges;
+    splitList(str, ',', ranges);
+
+    try
+    {
+        for (const auto& range : ranges)
+        {
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+
+            if (first < 0 || last < first || last >= CPU_SETSIZE)
+            {
+                return -1;
+            }
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        cpus.clear();
+        return -1;
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return 0;
+}
+
+int BspThreadConfig::parseSchedPolicy(const std::string& str, SchedPolicy& policy)
+{
+    std::string name(str);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (name.empty() || name == "other" || name == "normal")
+    {
+        policy = SchedPolicy::Other;
+    }
+    else if (name == "batch")
+    {
+        policy = SchedPolicy::Batch;
+    }
+    else if (name == "idle")
+    {
+        policy = SchedPolicy::Idle;
+    }
+    else if (name == "fifo")
+    {
+        policy = SchedPolicy::Fifo;
+    }
+    else if (name == "rr")
+    {
+        policy = SchedPolicy::RoundRobin;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int BspThreadConfig::loadRoleSpecs(const std::vector<std::string>& specs)
+{
+    int ret = 0;
+    for (const auto& spec : specs)
+    {
+        std::vector<std::string> fields;
+        splitList(spec, ':', fields);
+
+        ThreadRole role{};
+        if (fields.size() < 2 || parseCpuList(fields[1], role.cpus) < 0)
+        {
+            std::cerr << LOG_TAG << "invalid thread role spec: " << spec << std::endl;
+            ret = -1;
+            continue;
+        }
+
+        if (fields.size() > 2 && parseSchedPolicy(fields[2], role.policy) < 0)
+        {
+            std::cerr << LOG_TAG << "invalid sched policy in spec: " << spec << std::endl;
+            ret = -1;
+            continue;
+        }
+
+        if (fields.size() > 3)
+        {
+            try
+            {
+                int value = std::stoi(fields[3]);
+                if (role.policy == SchedPolicy::Fifo || role.policy == SchedPolicy::RoundRobin)
+                {
+                    role.priority = value;
+                }
+                else
+                {
+                    role.nice = value;
+                }
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << LOG_TAG << "invalid priority in spec: " << spec << std::endl;
+                ret = -1;
+                continue;
+            }
+        }
+        setRole(fields[0], role);
+    }
+    return ret;
+}
+
+void BspThreadConfig::setRole(const std::string& name, const ThreadRole& role)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_roles[name] = role;
+}
+
+bool BspThreadConfig::getRole(const std::string& name, ThreadRole& role)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_roles.find(name);
+    if (it == m_roles.end())
+    {
+        return false;
+    }
+    role = it->second;
+    return true;
+}
+
+void BspThreadConfig::setMemoryPolicy(const MemoryPolicy& policy)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memory_policy = policy;
+}
+
+BspThreadConfig::MemoryPolicy BspThreadConfig::getMemoryPolicy()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memory_policy;
+}
+
+int BspThreadConfig::applyRole(pthread_t thd, const ThreadRole& role, bool is_current_thread)
+{
+    int ret = 0;
+
+    if (!role.cpus.empty())
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int cpu : role.cpus)
+        {
+            CPU_SET(cpu, &cpuset);
+        }
+
+        int err = pthread_setaffinity_np(thd, sizeof(cpu_set_t), &cpuset);
+        if (err != 0)
+        {
+            std::cerr << LOG_TAG << "pthread_setaffinity_np failed: " << strerror(err) << std::endl;
+            ret = -1;
+        }
+    }
+
+    int policy = SCHED_OTHER;
+    switch (role.policy)
+    {
+    case SchedPolicy::Batch:
+        policy = SCHED_BATCH;
+        break;
+    case SchedPolicy::Idle:
+        policy = SCHED_IDLE;
+        break;
+    case SchedPolicy::Fifo:
+        policy = SCHED_FIFO;
+        break;
+    case SchedPolicy::RoundRobin:
+        policy = SCHED_RR;
+        break;
+    default:
+        policy = SCHED_OTHER;
+        break;
+    }
+
+    struct sched_param param{};
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+    {
+        param.sched_priority = std::clamp(role.priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+    }
+
+    if (role.policy != SchedPolicy::Other)
+    {
+        int err = pthread_setschedparam(thd, policy, &param);
+        if (err != 0)
+        {
+            // EPERM without CAP_SYS_NICE / RLIMIT_RTPRIO, keep running on the default scheduler
+            std::cerr << LOG_TAG << "pthread_setschedparam failed: " << strerror(err) << std::endl;
+            ret = -1;
+        }
+    }
+
+    if (role.nice != 0 && is_current_thread)
+    {
+        // On Linux the nice value is a per-thread attribute addressed by tid
+        pid_t tid = static_cast<pid_t>(::syscall(SYS_gettid));
+        if (::setpriority(PRIO_PROCESS, tid, role.nice) != 0)
+        {
+            std::cerr << LOG_TAG << "setpriority failed: " << strerror(errno) << std::endl;
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+int BspThreadConfig::applyToCurrentThread(const std::string& role_name)
+{
+    ThreadRole role{};
+    if (!getRole(role_name, role))
+    {
+        return 0;
+    }
+    pthread_setname_np(pthread_self(), role_name.substr(0, 15).c_str());
+    return applyRole(pthread_self(), role, true);
+}
+
+int BspThreadConfig::applyToThread(std::thread& thd, const std::string& role_name)
+{
+    ThreadRole role{};
+    if (!thd.joinable() || !getRole(role_name, role))
+    {
+        return 0;
+    }
+    pthread_setname_np(thd.native_handle(), role_name.substr(0, 15).c_str());
+    return applyRole(thd.native_handle(), role, false);
+}
+
+int BspThreadConfig::applyMemoryPolicy()
+{
+    MemoryPolicy policy = getMemoryPolicy();
+
+    if (policy.lockAll && (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+    {
+        std::cerr << LOG_TAG << "mlockall failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int BspThreadConfig::adviseHugePages(void* addr, size_t len)
+{
+#ifdef MADV_HUGEPAGE
+    if (addr == nullptr || !getMemoryPolicy().hugePages)
+    {
+        return 0;
+    }
+
+    const uintptr_t page_size = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + page_size - 1) & ~(page_size - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + len) & ~(page_size - 1);
+
+    if (end <= begin)
+    {
+        return 0;
+    }
+    return ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+#else
+    return 0;
+#endif
+}
+
+} // namespace shared
+} // namespace bsp_perf
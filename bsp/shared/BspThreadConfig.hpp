@@ -0,0 +1,225 @@
+#ifndef __BSP_THREAD_CONFIG_HPP__
+#define __BSP_THREAD_CONFIG_HPP__
+
+#include <shared/ArgParser.hpp>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <pthread.h>
+
+namespace bsp_perf {
+namespace shared {
+
+/**
+ * @brief Process wide thread placement table.
+ *
+ * Components name the role of every thread they spawn ("video_decoder", "dnn_inference", ...)
+ * and call applyToCurrentThread() at the top of the thread body. The role table is loaded from
+ * the app config (JSON node "thread_config" or INI section [threadConfig]); roles that are not
+ * configured are left to the default scheduler, so an empty config keeps the old behavior.
+ *
+ * Role spec string (INI and JSON shorthand), entries separated by ';':
+ *     <role>:<cpus>[:<policy>[:<priority>]]
+ *     cpus: "4-7", "0,2,4-5" or "*" for no pinning
+ *     policy: other | batch | idle | fifo | rr
+ *     priority: SCHED_FIFO/RR priority (1..99) for fifo/rr, nice value (-20..19) otherwise
+ */
+class BspThreadConfig
+{
+public:
+    enum class SchedPolicy
+    {
+        Other,
+        Batch,
+        Idle,
+        Fifo,
+        RoundRobin
+    };
+
+    struct ThreadRole
+    {
+        std::vector<int> cpus{};
+        SchedPolicy policy{SchedPolicy::Other};
+        int priority{0};
+        int nice{0};
+    };
+
+    struct MemoryPolicy
+    {
+        bool lockAll{false};
+        bool hugePages{false};
+    };
+
+    static constexpr char LOG_TAG[] {"[BspThreadConfig]: "};
+    static constexpr char ARG_SECTION[] {"threadConfig"};
+
+    static BspThreadConfig& getInstance()
+    {
+        static BspThreadConfig instance;
+        return instance;
+    }
+
+    /**
+     * @brief Register the [threadConfig] options on an ArgParser, must be called before parseArgs().
+     */
+    static void addArgOptions(ArgParser& parser)
+    {
+        parser.addSubOption(ARG_SECTION, "--roles", std::string(""), "thread roles: role:cpus:policy:priority;...");
+        parser.addSubOption(ARG_SECTION, "--mlockall", false, "lock all current and future pages in RAM");
+        parser.addSubOption(ARG_SECTION, "--hugepage", false, "advise transparent hugepages for large buffers");
+    }
+
+    /**
+     * @brief Load roles and memory policy from the parsed [threadConfig] section.
+     * @return 0 on success, -1 if a role spec is malformed.
+     */
+    int loadArgConfig(ArgParser& parser)
+    {
+        std::vector<std::string> specs;
+        parser.getOptionSplitStrList(ARG_SECTION, "--roles", specs);
+
+        MemoryPolicy mem_policy{};
+        parser.getSubOptionVal(ARG_SECTION, "--mlockall", mem_policy.lockAll);
+        parser.getSubOptionVal(ARG_SECTION, "--hugepage", mem_policy.hugePages);
+        setMemoryPolicy(mem_policy);
+
+        return loadRoleSpecs(specs);
+    }
+
+    /**
+     * @brief Load roles and memory policy from a nlohmann::json like object, e.g.
+     * @code
+     * "thread_config": {
+     *     "mlockall": true,
+     *     "hugepage": false,
+     *     "roles": {
+     *         "video_decoder": {"cpus": "4-5", "policy": "other", "nice": -5},
+     *         "dnn_inference": {"cpus": [6, 7], "policy": "fifo", "priority": 50}
+     *     }
+     * }
+     * @endcode
+     * "roles" may also be a spec string in the INI shorthand.
+     * @return 0 on success, -1 if a role is malformed.
+     */
+    template <typename Json>
+    int loadJsonConfig(const Json& cfg)
+    {
+        if (!cfg.is_object())
+        {
+            return 0;
+        }
+
+        MemoryPolicy mem_policy{};
+        mem_policy.lockAll = cfg.value("mlockall", false);
+        mem_policy.hugePages = cfg.value("hugepage", false);
+        setMemoryPolicy(mem_policy);
+
+        if (!cfg.contains("roles"))
+        {
+            return 0;
+        }
+
+        const auto& roles = cfg["roles"];
+        if (roles.is_string())
+        {
+            std::vector<std::string> specs;
+            splitList(roles.template get<std::string>(), ';', specs);
+            return loadRoleSpecs(specs);
+        }
+
+        int ret = 0;
+        for (const auto& item : roles.items())
+        {
+            const auto& node = item.value();
+            ThreadRole role{};
+            if (node.contains("cpus"))
+            {
+                const auto& cpus = node["cpus"];
+                if (cpus.is_string())
+                {
+                    if (parseCpuList(cpus.template get<std::string>(), role.cpus) < 0)
+                    {
+                        ret = -1;
+                        continue;
+                    }
+                }
+                else
+                {
+                    role.cpus = cpus.template get<std::vector<int>>();
+                }
+            }
+            if (parseSchedPolicy(node.value("policy", std::string("other")), role.policy) < 0)
+            {
+                ret = -1;
+                continue;
+            }
+            role.priority = node.value("priority", 0);
+            role.nice = node.value("nice", 0);
+            setRole(item.key(), role);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Load roles from spec strings "<role>:<cpus>[:<policy>[:<priority>]]".
+     */
+    int loadRoleSpecs(const std::vector<std::string>& specs);
+
+    void setRole(const std::string& name, const ThreadRole& role);
+
+    bool getRole(const std::string& name, ThreadRole& role);
+
+    void setMemoryPolicy(const MemoryPolicy& policy);
+
+    MemoryPolicy getMemoryPolicy();
+
+    /**
+     * @brief Pin and prioritize the calling thread according to its role. Unknown roles are a no-op.
+     * @return 0 on success, -1 if any of affinity/scheduler/nice could not be applied.
+     */
+    int applyToCurrentThread(const std::string& role_name);
+
+    /**
+     * @brief Same as applyToCurrentThread() for an already running std::thread. The nice value
+     * can only be set from inside the thread on Linux, so it is skipped here.
+     */
+    int applyToThread(std::thread& thd, const std::string& role_name);
+
+    /**
+     * @brief Apply the memory policy to the whole process (mlockall). Call once from main().
+     */
+    int applyMemoryPolicy();
+
+    /**
+     * @brief Hint the kernel to back [addr, addr + len) with transparent hugepages when the
+     * hugepage policy is enabled. The range is shrunk to page boundaries.
+     */
+    int adviseHugePages(void* addr, size_t len);
+
+    static int parseCpuList(const std::string& str, std::vector<int>& cpus);
+
+    static int parseSchedPolicy(const std::string& str, SchedPolicy& policy);
+
+private:
+    BspThreadConfig() = default;
+    ~BspThreadConfig() = default;
+    BspThreadConfig(const BspThreadConfig&) = delete;
+    BspThreadConfig& operator=(const BspThreadConfig&) = delete;
+
+    static void splitList(const std::string& str, char delim, std::vector<std::string>& out);
+
+    int applyRole(pthread_t thd, const ThreadRole& role, bool is_current_thread);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, ThreadRole> m_roles{};
+    MemoryPolicy m_memory_policy{};
+};
+
+} // namespace shared
+} // namespace bsp_perf
+
+#endif // __BSP_THREAD_CONFIG_HPP__
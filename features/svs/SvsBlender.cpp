@@ -1,5 +1,7 @@
 #include "SvsBlender.hpp"
+#include <shared/BspParallel.hpp>
 #include <algorithm>
+#include <atomic>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
@@ -10,6 +12,11 @@ namespace svs
 
 namespace
 {
+using bsp_perf::shared::BspParallel;
+
+// rows per chunk below which splitting the per pixel loops costs more than it saves
+constexpr int kMinChunkRows{16};
+
 struct BgrStats
 {
     int b{0};
@@ -33,36 +40,54 @@ bool calcBgrStats(const cv::Mat& image, BgrStats& stats)
         return false;
     }
 
-    int64_t b = 0;
-    int64_t g = 0;
-    int64_t r = 0;
-    for (int row = 0; row < image.rows; ++row) {
-        const auto* pixel = image.ptr<uint8_t>(row);
-        for (int col = 0; col < image.cols; ++col) {
-            b += pixel[0];
-            g += pixel[1];
-            r += pixel[2];
-            pixel += 3;
+    std::atomic<int64_t> b{0};
+    std::atomic<int64_t> g{0};
+    std::atomic<int64_t> r{0};
+    BspParallel::getInstance().parallelFor(image.rows, kMinChunkRows, 1, [&](int begin, int end) {
+        int64_t sumB = 0;
+        int64_t sumG = 0;
+        int64_t sumR = 0;
+        for (int row = begin; row < end; ++row) {
+            const auto* pixel = image.ptr<uint8_t>(row);
+            for (int col = 0; col < image.cols; ++col) {
+                sumB += pixel[0];
+                sumG += pixel[1];
+                sumR += pixel[2];
+                pixel += 3;
+            }
         }
-    }
-
-    stats.b = static_cast<int>(b / pixelCount);
-    stats.g = static_cast<int>(g / pixelCount);
-    stats.r = static_cast<int>(r / pixelCount);
+        b.fetch_add(sumB, std::memory_order_relaxed);
+        g.fetch_add(sumG, std::memory_order_relaxed);
+        r.fetch_add(sumR, std::memory_order_relaxed);
+    });
+
+    stats.b = static_cast<int>(b.load() / pixelCount);
+    stats.g = static_cast<int>(g.load() / pixelCount);
+    stats.r = static_cast<int>(r.load() / pixelCount);
     return true;
 }
 
 void applyBgrGain(cv::Mat& image, float rGain, float gGain, float bGain)
 {
-    for (int row = 0; row < image.rows; ++row) {
-        auto* pixel = image.ptr<uint8_t>(row);
-        for (int col = 0; col < image.cols; ++col) {
-            pixel[0] = clipToByte(static_cast<float>(pixel[0]) * bGain);
-            pixel[1] = clipToByte(static_cast<float>(pixel[1]) * gGain);
-            pixel[2] = clipToByte(static_cast<float>(pixel[2]) * rGain);
-            pixel += 3;
-        }
+    // per channel lookup tables, same rounding as scaling every pixel
+    std::array<std::array<uint8_t, 256>, 3> lut;
+    for (int value = 0; value < 256; ++value) {
+        lut[0][value] = clipToByte(static_cast<float>(value) * bGain);
+        lut[1][value] = clipToByte(static_cast<float>(value) * gGain);
+        lut[2][value] = clipToByte(static_cast<float>(value) * rGain);
     }
+
+    BspParallel::getInstance().parallelFor(image.rows, kMinChunkRows, 1, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            auto* pixel = image.ptr<uint8_t>(row);
+            for (int col = 0; col < image.cols; ++col) {
+                pixel[0] = lut[0][pixel[0]];
+                pixel[1] = lut[1][pixel[1]];
+                pixel[2] = lut[2][pixel[2]];
+                pixel += 3;
+            }
+        }
+    });
 }
 
 std::string joinPath(const std::string& root, const std::string& path)
@@ -222,20 +247,24 @@ void SvsBlender::mergeImage(const cv::Mat& src1, const cv::Mat& src2, const cv::
         return;
     }
 
-    for (int row = 0; row < src1.rows; ++row) {
-        const auto* p1 = src1.ptr<uint8_t>(row);
-        const auto* p2 = src2.ptr<uint8_t>(row);
-        const auto* w = weight.ptr<float>(row);
-        auto* dst = out.ptr<uint8_t>(row);
-        for (int col = 0; col < src1.cols; ++col) {
-            dst[0] = clipToByte(static_cast<float>(p1[0]) * w[col] + static_cast<float>(p2[0]) * (1.0f - w[col]));
-            dst[1] = clipToByte(static_cast<float>(p1[1]) * w[col] + static_cast<float>(p2[1]) * (1.0f - w[col]));
-            dst[2] = clipToByte(static_cast<float>(p1[2]) * w[col] + static_cast<float>(p2[2]) * (1.0f - w[col]));
-            p1 += 3;
-            p2 += 3;
-            dst += 3;
+    // two BGR sources, the BGR output and the float weight per pixel
+    constexpr size_t bytesPerPixel = 3 + 3 + 3 + sizeof(float);
+    BspParallel::getInstance().parallelForTiles(src1.cols, src1.rows, bytesPerPixel, [&](const BspParallel::Tile& tile) {
+        for (int row = tile.y; row < tile.y + tile.height; ++row) {
+            const auto* p1 = src1.ptr<uint8_t>(row) + tile.x * 3;
+            const auto* p2 = src2.ptr<uint8_t>(row) + tile.x * 3;
+            const auto* w = weight.ptr<float>(row);
+            auto* dst = out.ptr<uint8_t>(row) + tile.x * 3;
+            for (int col = tile.x; col < tile.x + tile.width; ++col) {
+                dst[0] = clipToByte(static_cast<float>(p1[0]) * w[col] + static_cast<float>(p2[0]) * (1.0f - w[col]));
+                dst[1] = clipToByte(static_cast<float>(p1[1]) * w[col] + static_cast<float>(p2[1]) * (1.0f - w[col]));
+                dst[2] = clipToByte(static_cast<float>(p1[2]) * w[col] + static_cast<float>(p2[2]) * (1.0f - w[col]));
+                p1 += 3;
+                p2 += 3;
+                dst += 3;
+            }
         }
-    }
+    });
 }
 
 } // namespace svs
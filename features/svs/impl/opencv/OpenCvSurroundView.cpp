@@ -60,6 +60,7 @@ int OpenCvSurroundView::process(const FrameSet& input, OutputFrame& output)
         return -1;
     }
 
+    // blended is allocated per frame, the output buffer takes a reference instead of a copy
     return bsp_perf::bsp_image::OpenCvImageAdapter::fromMat(blended, "BGR888", output.image) ? 0 : -1;
 }
 
@@ -0,0 +1,878 @@
+/*
+MIT License
+
+Copyright (c) 2024 Clarence Zhou<287334895@qq.com> and contributors.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#ifndef __CODEC_CONTAINER_PERF_HPP__
+#define __CODEC_CONTAINER_PERF_HPP__
+
+#include <framework/BasePerfCase.hpp>
+#include <shared/ArgParser.hpp>
+#include <shared/BspPacketBuffer.hpp>
+#include <profiler/PerfProfiler.hpp>
+#include <profiler/BspTrace.hpp>
+#include <bsp_codec/IEncoder.hpp>
+#include <bsp_codec/IDecoder.hpp>
+#include <bsp_container/IMuxer.hpp>
+#include <bsp_container/IDemuxer.hpp>
+#include <bsp_image/ImageBuffer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+namespace bsp_perf {
+namespace perf_cases {
+
+using namespace bsp_perf::common;
+
+/**
+ * @brief Throughput of bsp_codec and bsp_container without sample files: for every resolution
+ * and frame rate an NV12 sequence generated in memory is encoded, the packets are decoded
+ * again, muxed to MP4, demuxed and remuxed to a second MP4.
+ *
+ * Every stage reports FPS, per frame latency percentiles, CPU usage (user + sys time of the
+ * process over wall time, codec worker threads included, 100% is one core) and bytes copied
+ * per frame on the paths the API exposes: the upload of a source frame into the encoder input
+ * buffer, packets passed as StreamPacket::pkt_data (--copy_packets) which the muxer copies once
+ * more, and demuxer output outside zero copy mode. Copies inside a codec backend are not counted.
+ */
+class codecContainerPerf : public BasePerfCase
+{
+
+public:
+    static constexpr char LOG_TAG[] {"[codecContainerPerf]: "};
+
+    codecContainerPerf(bsp_perf::shared::ArgParser&& args):
+        BasePerfCase(std::move(args))
+    {
+        auto& params = getArgs();
+        std::string case_name;
+        params.getOptionVal("--case_name", case_name);
+        std::string file_path;
+        params.getOptionVal("--profile_path", file_path);
+        m_profiler = std::make_unique<bsp_perf::common::PerfProfiler>(case_name, file_path);
+    }
+    codecContainerPerf(const codecContainerPerf&) = delete;
+    codecContainerPerf& operator=(const codecContainerPerf&) = delete;
+    codecContainerPerf(codecContainerPerf&&) = delete;
+    codecContainerPerf& operator=(codecContainerPerf&&) = delete;
+    ~codecContainerPerf()
+    {
+        m_profiler.reset();
+    }
+
+private:
+    // distinct frames of a sequence, played in a loop
+    static constexpr size_t SEQUENCE_FRAMES{16};
+    // a decoder silent this long after the last packet is done
+    static constexpr int DECODE_IDLE_MS{2000};
+
+    struct BenchCase
+    {
+        uint32_t width{0};
+        uint32_t height{0};
+        int fps{0};
+        std::string label{};
+    };
+
+    struct StageResult
+    {
+        std::string name{};
+        size_t frames{0};
+        double wall_s{0.0};
+        double cpu_s{0.0};
+        uint64_t bytes_copied{0};
+        std::vector<double> latency_us{};
+    };
+
+    struct CaseResult
+    {
+        BenchCase bench{};
+        bool failed{false};
+        size_t encoded_bytes{0};
+        std::vector<StageResult> stages{};
+    };
+
+    struct EncodedFrame
+    {
+        bsp_perf::shared::PacketBuffer buffer{};
+        bool key_frame{false};
+    };
+
+    class StageClock
+    {
+    public:
+        StageClock():
+            m_begin{std::chrono::steady_clock::now()},
+            m_cpu_begin{processCpuSeconds()}
+        {
+        }
+
+        void stop(StageResult& stage) const
+        {
+            stage.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count();
+            stage.cpu_s = processCpuSeconds() - m_cpu_begin;
+        }
+
+    private:
+        static double processCpuSeconds()
+        {
+            struct rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                   static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        }
+
+        std::chrono::steady_clock::time_point m_begin;
+        double m_cpu_begin;
+    };
+
+    void onInit() override
+    {
+        BSP_TRACE_EVENT_BEGIN("Codec Container Perf Init");
+        auto& params = getArgs();
+        params.getOptionVal("--encoderImpl", m_encoder_impl);
+        params.getOptionVal("--decoderImpl", m_decoder_impl);
+        params.getOptionVal("--encodingType", m_encoding);
+        params.getOptionVal("--frames", m_frames);
+        params.getOptionVal("--output_dir", m_output_dir);
+        m_copy_packets = params.getFlagVal("--copy_packets");
+        m_keep_files = params.getFlagVal("--keep_files");
+
+        std::string resolutions;
+        params.getOptionVal("--resolutions", resolutions);
+        std::string rates;
+        params.getOptionVal("--rates", rates);
+        for (const auto& resolution : splitList(resolutions))
+        {
+            unsigned width = 0;
+            unsigned height = 0;
+            if ((std::sscanf(resolution.c_str(), "%ux%u", &width, &height) != 2) || (width < 64) || (height < 64))
+            {
+                std::cerr << LOG_TAG << "skip resolution " << resolution << std::endl;
+                continue;
+            }
+            for (const auto& rate : splitList(rates))
+            {
+                int fps = std::atoi(rate.c_str());
+                if (fps <= 0)
+                {
+                    std::cerr << LOG_TAG << "skip rate " << rate << std::endl;
+                    continue;
+                }
+                // NV12 and the encoders want even sizes
+                BenchCase bench;
+                bench.width = width & ~1u;
+                bench.height = height & ~1u;
+                bench.fps = fps;
+                bench.label = std::to_string(bench.width) + "x" + std::to_string(bench.height) + "@" + std::to_string(fps);
+                m_cases.push_back(bench);
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_output_dir, ec);
+        BSP_TRACE_EVENT_END();
+    }
+
+    void onProcess() override
+    {
+        m_results.clear();
+        for (const auto& bench : m_cases)
+        {
+            CaseResult result;
+            result.bench = bench;
+            try
+            {
+                result.failed = (runCase(bench, result) < 0);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << LOG_TAG << bench.label << ": " << e.what() << std::endl;
+                result.failed = true;
+            }
+            releaseCase();
+            m_results.push_back(std::move(result));
+        }
+    }
+
+    void onRender() override
+    {
+        std::cout << "encoder " << m_encoder_impl << ", decoder " << m_decoder_impl << ", " << m_encoding
+                  << ", " << m_frames << " frames, packets " << (m_copy_packets ? "copied" : "shared") << std::endl;
+        std::cout << std::left << std::setw(16) << "case" << std::setw(8) << "stage" << std::right
+                  << std::setw(8) << "frames" << std::setw(10) << "fps" << std::setw(10) << "p50 us"
+                  << std::setw(10) << "p90 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+                  << std::setw(8) << "cpu %" << std::setw(14) << "copied B/frm" << std::endl;
+        for (const auto& result : m_results)
+        {
+            if (result.failed)
+            {
+                std::cout << std::left << std::setw(16) << result.bench.label << "FAILED" << std::endl;
+            }
+            for (const auto& stage : result.stages)
+            {
+                const std::string prefix = result.bench.label + " " + stage.name;
+                const double fps = (stage.wall_s > 0.0) ? stage.frames / stage.wall_s : 0.0;
+                const double cpu = (stage.wall_s > 0.0) ? 100.0 * stage.cpu_s / stage.wall_s : 0.0;
+                const double copied = (stage.frames > 0) ? static_cast<double>(stage.bytes_copied) / stage.frames : 0.0;
+                std::cout << std::left << std::setw(16) << result.bench.label << std::setw(8) << stage.name
+                          << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(8) << stage.frames << std::setw(10) << fps
+                          << std::setw(10) << percentile(stage.latency_us, 0.50)
+                          << std::setw(10) << percentile(stage.latency_us, 0.90)
+                          << std::setw(10) << percentile(stage.latency_us, 0.99)
+                          << std::setw(10) << percentile(stage.latency_us, 1.0)
+                          << std::setw(8) << cpu << std::setw(14) << copied << std::endl;
+                m_profiler->printPerfData(prefix + " FPS", fps, "fps");
+                m_profiler->printPerfData(prefix + " P99 Latency", percentile(stage.latency_us, 0.99), "us");
+                m_profiler->printPerfData(prefix + " CPU", cpu, "%");
+                m_profiler->printPerfData(prefix + " Copied", copied, "B/frame");
+            }
+            if (!result.stages.empty() && (result.stages.front().frames > 0))
+            {
+                // bitrate of the synthetic content, a sanity check that the encoder did real work
+                const double kbps = result.encoded_bytes * 8.0 * result.bench.fps / result.stages.front().frames / 1000.0;
+                std::cout << std::left << std::setw(16) << result.bench.label << "bitrate " << std::fixed
+                          << std::setprecision(0) << kbps << " kbit/s" << std::endl;
+            }
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::right << std::setprecision(6);
+    }
+
+    void onRelease() override
+    {
+        releaseCase();
+        m_cases.clear();
+        m_results.clear();
+    }
+
+    int runCase(const BenchCase& bench, CaseResult& result)
+    {
+        makeSequence(bench);
+
+        result.stages.emplace_back();
+        if (encodeSequence(bench, result.stages.back()) < 0)
+        {
+            return -1;
+        }
+        for (const auto& packet : m_packets)
+        {
+            result.encoded_bytes += packet.buffer.size;
+        }
+
+        result.stages.emplace_back();
+        int ret = decodePackets(bench, result.stages.back());
+
+        const std::string muxPath = m_output_dir + "/codec_bench_" + bench.label + ".mp4";
+        const std::string remuxPath = m_output_dir + "/codec_bench_" + bench.label + "_remux.mp4";
+        result.stages.emplace_back();
+        if (muxPackets(bench, muxPath, result.stages.back()) < 0)
+        {
+            return -1;
+        }
+
+        std::vector<bsp_container::StreamPacket> demuxed;
+        std::vector<uint8_t> extraData;
+        result.stages.emplace_back();
+        if (demuxFile(bench, muxPath, demuxed, extraData, result.stages.back()) < 0)
+        {
+            return -1;
+        }
+        if (demuxed.size() != m_packets.size())
+        {
+            std::cerr << LOG_TAG << bench.label << ": muxed " << m_packets.size() << " packets, demuxed "
+                      << demuxed.size() << std::endl;
+            ret = -1;
+        }
+
+        result.stages.emplace_back();
+        if (remuxPackets(bench, remuxPath, demuxed, extraData, result.stages.back()) < 0)
+        {
+            return -1;
+        }
+
+        if (!m_keep_files)
+        {
+            std::remove(muxPath.c_str());
+            std::remove(remuxPath.c_str());
+        }
+        return ret;
+    }
+
+    void releaseCase()
+    {
+        // the packets may point into encoder memory, drop them first
+        m_packets.clear();
+        m_header.clear();
+        if (m_encoder != nullptr)
+        {
+            m_encoder->tearDown();
+            m_encoder.reset();
+        }
+        m_sequence.clear();
+    }
+
+    void makeSequence(const BenchCase& bench)
+    {
+        BSP_TRACE_EVENT_BEGIN("Synthetic Sequence");
+        m_sequence.clear();
+        for (size_t index = 0; index < SEQUENCE_FRAMES; index++)
+        {
+            bsp_perf::bsp_image::ImageDesc desc{};
+            desc.width = bench.width;
+            desc.height = bench.height;
+            desc.widthStride = bench.width;
+            desc.heightStride = bench.height;
+            desc.format = "YUV420SP";
+            auto frame = bsp_perf::bsp_image::makeHostImageBuffer(desc);
+            fillSyntheticFrame(frame->view, index);
+            m_sequence.push_back(std::move(frame));
+        }
+        BSP_TRACE_EVENT_END();
+    }
+
+    /**
+     * @brief A scrolling gradient, a moving box and some noise: motion for the inter prediction
+     * and texture for the residual, so the encoder does about the work of a camera scene.
+     */
+    static void fillSyntheticFrame(const bsp_perf::bsp_image::ImageView& view, size_t index)
+    {
+        const uint32_t width = view.desc.width;
+        const uint32_t height = view.desc.height;
+        const uint32_t box = std::max<uint32_t>(16, std::min(width, height) / 6);
+        const uint32_t boxX = static_cast<uint32_t>(index * 12) % (width - box);
+        const uint32_t boxY = static_cast<uint32_t>(index * 6) % (height - box);
+        uint32_t noise = 0x9e3779b9u * static_cast<uint32_t>(index + 1);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            uint8_t* row = view.data(0) + static_cast<size_t>(y) * view.planes[0].rowStride;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                // xorshift32
+                noise ^= noise << 13;
+                noise ^= noise >> 17;
+                noise ^= noise << 5;
+                const bool inBox = (x >= boxX) && (x < boxX + box) && (y >= boxY) && (y < boxY + box);
+                const int value = inBox ? 220 : static_cast<int>(((x + y + index * 4) / 2) & 0xff);
+                row[x] = static_cast<uint8_t>(std::min(255, std::max(0, value + static_cast<int>(noise & 0x7) - 4)));
+            }
+        }
+        for (uint32_t y = 0; y < height / 2; y++)
+        {
+            uint8_t* row = view.data(1) + static_cast<size_t>(y) * view.planes[1].rowStride;
+            for (uint32_t x = 0; x < width / 2; x++)
+            {
+                row[2 * x] = static_cast<uint8_t>(96 + (x * 64) / (width / 2));
+                row[2 * x + 1] = static_cast<uint8_t>(96 + ((y + index) * 64 / (height / 2)) % 64);
+            }
+        }
+    }
+
+    /**
+     * @brief Copy a source frame into an encoder input buffer plane by plane.
+     * @return bytes copied
+     */
+    static size_t uploadFrame(const bsp_perf::bsp_image::ImageView& src, const bsp_perf::bsp_image::ImageView& dst)
+    {
+        const auto format = bsp_perf::bsp_image::pixelFormatFromString(src.desc.format);
+        size_t copied = 0;
+        for (uint32_t plane = 0; plane < std::min(src.planeCount, dst.planeCount); plane++)
+        {
+            const uint32_t rowBytes = bsp_perf::bsp_image::planeRowBytes(format, plane, src.desc.width);
+            const uint32_t rows = bsp_perf::bsp_image::planeRows(format, plane, src.desc.height);
+            for (uint32_t row = 0; row < rows; row++)
+            {
+                std::memcpy(dst.data(plane) + static_cast<size_t>(row) * dst.planes[plane].rowStride,
+                            src.data(plane) + static_cast<size_t>(row) * src.planes[plane].rowStride, rowBytes);
+            }
+            copied += static_cast<size_t>(rowBytes) * rows;
+        }
+        return copied;
+    }
+
+    int encodeSequence(const BenchCase& bench, StageResult& stage)
+    {
+        stage.name = "encode";
+        m_encoder = bsp_codec::IEncoder::create(m_encoder_impl);
+        bsp_codec::EncodeConfig cfg;
+        cfg.encodingType = m_encoding;
+        cfg.frameFormat = "YUV420SP";
+        cfg.fps = bench.fps;
+        cfg.width = bench.width;
+        cfg.height = bench.height;
+        cfg.hor_stride = bench.width;
+        cfg.ver_stride = bench.height;
+        if (m_encoder->setup(cfg) < 0)
+        {
+            std::cerr << LOG_TAG << bench.label << ": " << m_encoder_impl << " encoder setup failed" << std::endl;
+            return -1;
+        }
+
+        const uint32_t latencyId = m_profiler->registerMetric(bench.label + " encode latency", "us");
+        stage.latency_us.reserve(m_frames);
+        StageClock clock;
+        for (int32_t index = 0; index < m_frames; index++)
+        {
+            BSP_TRACE_BEGIN(Codec, "Bench Encode");
+            auto input = m_encoder->getInputBuffer();
+            if (input == nullptr)
+            {
+                BSP_TRACE_END(Codec);
+                std::cerr << LOG_TAG << bench.label << ": no encoder input buffer" << std::endl;
+                return -1;
+            }
+            auto begin = m_profiler->getCurrentTimePoint();
+            stage.bytes_copied += uploadFrame(m_sequence[index % SEQUENCE_FRAMES]->view, input->view);
+
+            bsp_codec::EncodePacket packet;
+            packet.max_size = m_encoder->getFrameSize();
+            packet.pkt_eos = 0;
+            int ret = m_encoder->encode(*input, packet);
+            auto end = m_profiler->getCurrentTimePoint();
+            BSP_TRACE_END(Codec);
+            if (ret < 0)
+            {
+                std::cerr << LOG_TAG << bench.label << ": encode of frame " << index << " failed" << std::endl;
+                return -1;
+            }
+
+            const double latency = static_cast<double>(m_profiler->getLatencyUs(begin, end));
+            stage.latency_us.push_back(latency);
+            m_profiler->asyncRecordPerfData(latencyId, latency);
+            stage.frames++;
+            if (!packet.buffer.empty())
+            {
+                EncodedFrame frame;
+                frame.key_frame = packet.key_frame;
+                frame.buffer = std::move(packet.buffer);
+                m_packets.push_back(std::move(frame));
+            }
+        }
+
+        // EOS carries no frame, whatever the encoder still holds comes out
+        bsp_perf::bsp_image::ImageBuffer none;
+        bsp_codec::EncodePacket flushed;
+        flushed.max_size = m_encoder->getFrameSize();
+        flushed.pkt_eos = 1;
+        if (m_encoder->encode(none, flushed) < 0)
+        {
+            std::cerr << LOG_TAG << bench.label << ": encoder flush failed" << std::endl;
+            return -1;
+        }
+        if (!flushed.buffer.empty())
+        {
+            EncodedFrame frame;
+            frame.key_frame = flushed.key_frame;
+            frame.buffer = std::move(flushed.buffer);
+            m_packets.push_back(std::move(frame));
+        }
+        clock.stop(stage);
+
+        m_encoder->getEncoderHeader(m_header);
+        if (m_packets.empty())
+        {
+            std::cerr << LOG_TAG << bench.label << ": the encoder returned no packets" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    int decodePackets(const BenchCase& bench, StageResult& stage)
+    {
+        stage.name = "decode";
+        auto decoder = bsp_codec::IDecoder::create(m_decoder_impl);
+        bsp_codec::DecodeConfig cfg;
+        cfg.encoding = m_encoding;
+        // as fast as it goes, no pacing
+        cfg.fps = 0;
+        if (decoder->setup(cfg) < 0)
+        {
+            std::cerr << LOG_TAG << bench.label << ": " << m_decoder_impl << " decoder setup failed" << std::endl;
+            return -1;
+        }
+
+        // no B frames: the frames come out in the order the packets went in
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<time_point_t> submitted;
+        const uint32_t latencyId = m_profiler->registerMetric(bench.label + " decode latency", "us");
+        stage.latency_us.reserve(m_packets.size());
+        decoder->setDecodeReadyCallback([&](std::any, std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>)
+        {
+            auto now = m_profiler->getCurrentTimePoint();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!submitted.empty())
+            {
+                const double latency = static_cast<double>(m_profiler->getLatencyUs(submitted.front(), now));
+                submitted.pop_front();
+                stage.latency_us.push_back(latency);
+                m_profiler->asyncRecordPerfData(latencyId, latency);
+            }
+            stage.frames++;
+            cv.notify_one();
+        }, nullptr);
+
+        StageClock clock;
+        if (!m_header.empty())
+        {
+            // SPS / PPS of a global header, the packets do not repeat them
+            bsp_codec::DecodePacket header;
+            header.data = reinterpret_cast<uint8_t*>(&m_header[0]);
+            header.pkt_size = m_header.size();
+            header.pkt_eos = 0;
+            decoder->decode(header);
+        }
+        int ret = 0;
+        for (size_t index = 0; index < m_packets.size(); index++)
+        {
+            BSP_TRACE_BEGIN(Codec, "Bench Decode");
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                submitted.push_back(m_profiler->getCurrentTimePoint());
+            }
+            bsp_codec::DecodePacket packet;
+            packet.data = m_packets[index].buffer.data;
+            packet.pkt_size = m_packets[index].buffer.size;
+            packet.pkt_eos = (index + 1 == m_packets.size()) ? 1 : 0;
+            ret = decoder->decode(packet);
+            BSP_TRACE_END(Codec);
+            if (ret < 0)
+            {
+                std::cerr << LOG_TAG << bench.label << ": decode of packet " << index << " failed" << std::endl;
+                break;
+            }
+        }
+
+        {
+            // hardware decoders deliver on their own thread
+            std::unique_lock<std::mutex> lock(mutex);
+            size_t seen = stage.frames;
+            while (stage.frames < m_packets.size())
+            {
+                cv.wait_for(lock, std::chrono::milliseconds(DECODE_IDLE_MS));
+                if (stage.frames == seen)
+                {
+                    break;
+                }
+                seen = stage.frames;
+            }
+        }
+        clock.stop(stage);
+        decoder->tearDown();
+        decoder.reset();
+
+        if (stage.frames != m_packets.size())
+        {
+            std::cerr << LOG_TAG << bench.label << ": " << m_packets.size() << " packets decoded to "
+                      << stage.frames << " frames" << std::endl;
+            return -1;
+        }
+        return (ret < 0) ? -1 : 0;
+    }
+
+    bsp_container::StreamInfo videoStreamInfo(const BenchCase& bench, const std::vector<uint8_t>& extraData) const
+    {
+        bsp_container::StreamInfo info{};
+        info.index = 0;
+        info.start_time = 0;
+        info.duration = 0;
+        info.num_of_frames = static_cast<int64_t>(m_packets.size());
+        info.codec_params.codec_type = "video";
+        info.codec_params.codec_name = (m_encoding == "h265") ? "hevc" : m_encoding;
+        info.codec_params.bit_rate = 0;
+        info.codec_params.sample_aspect_ratio = 1.0f;
+        info.codec_params.frame_rate = bench.fps;
+        info.codec_params.width = static_cast<int>(bench.width);
+        info.codec_params.height = static_cast<int>(bench.height);
+        info.codec_params.sample_rate = 0;
+        info.codec_params.extra_data = extraData;
+        return info;
+    }
+
+    /**
+     * @brief Write one packet, by reference or, with --copy_packets, as a pkt_data copy.
+     * @return bytes copied, -1 on error
+     */
+    int64_t writePacket(bsp_container::IMuxer& muxer, bsp_container::StreamPacket& packet)
+    {
+        int64_t copied = 0;
+        if (m_copy_packets && !packet.buffer.empty())
+        {
+            packet.pkt_data.assign(packet.buffer.data, packet.buffer.data + packet.buffer.size);
+            packet.useful_pkt_size = packet.buffer.size;
+            packet.buffer.reset();
+            copied += static_cast<int64_t>(packet.useful_pkt_size);
+        }
+        if (packet.buffer.empty())
+        {
+            // the muxer copies pkt_data into a packet of its own
+            copied += static_cast<int64_t>(packet.useful_pkt_size);
+        }
+        if (muxer.writeStreamPacket(packet) < 0)
+        {
+            return -1;
+        }
+        return copied;
+    }
+
+    int muxPackets(const BenchCase& bench, const std::string& path, StageResult& stage)
+    {
+        stage.name = "mux";
+        auto muxer = bsp_container::IMuxer::create("FFmpegMuxer");
+        bsp_container::IMuxer::MuxConfig cfg;
+        cfg.ts_recreate = true;
+        cfg.video_fps = static_cast<float>(bench.fps);
+
+        StageClock clock;
+        if (muxer->openContainerMux(path, cfg) < 0)
+        {
+            std::cerr << LOG_TAG << "open " << path << " failed" << std::endl;
+            return -1;
+        }
+        auto info = videoStreamInfo(bench, std::vector<uint8_t>(m_header.begin(), m_header.end()));
+        int streamIndex = muxer->addStream(info);
+        if (streamIndex < 0)
+        {
+            muxer->closeContainerMux();
+            return -1;
+        }
+
+        const uint32_t latencyId = m_profiler->registerMetric(bench.label + " mux latency", "us");
+        stage.latency_us.reserve(m_packets.size());
+        int ret = 0;
+        for (size_t index = 0; index < m_packets.size(); index++)
+        {
+            bsp_container::StreamPacket packet;
+            packet.pts = static_cast<int64_t>(index);
+            packet.dts = static_cast<int64_t>(index);
+            packet.duration = 1;
+            packet.stream_index = streamIndex;
+            packet.pos = -1;
+            packet.key_frame = m_packets[index].key_frame;
+            packet.buffer = m_packets[index].buffer;
+
+            BSP_TRACE_BEGIN(Io, "Bench Mux");
+            auto begin = m_profiler->getCurrentTimePoint();
+            int64_t copied = writePacket(*muxer, packet);
+            auto end = m_profiler->getCurrentTimePoint();
+            BSP_TRACE_END(Io);
+            if (copied < 0)
+            {
+                std::cerr << LOG_TAG << bench.label << ": mux of packet " << index << " failed" << std::endl;
+                ret = -1;
+                break;
+            }
+            const double latency = static_cast<double>(m_profiler->getLatencyUs(begin, end));
+            stage.latency_us.push_back(latency);
+            m_profiler->asyncRecordPerfData(latencyId, latency);
+            stage.bytes_copied += static_cast<uint64_t>(copied);
+            stage.frames++;
+        }
+        if (muxer->endStreamMux() < 0)
+        {
+            ret = -1;
+        }
+        muxer->closeContainerMux();
+        clock.stop(stage);
+        return ret;
+    }
+
+    int demuxFile(const BenchCase& bench, const std::string& path, std::vector<bsp_container::StreamPacket>& packets,
+                  std::vector<uint8_t>& extraData, StageResult& stage)
+    {
+        stage.name = "demux";
+        auto demuxer = bsp_container::IDemuxer::create("FFmpegDemuxer");
+
+        StageClock clock;
+        if (demuxer->openContainerDemux(path) < 0)
+        {
+            std::cerr << LOG_TAG << "open " << path << " failed" << std::endl;
+            return -1;
+        }
+        bsp_container::ContainerInfo containerInfo;
+        if ((demuxer->getContainerInfo(containerInfo) < 0) || containerInfo.stream_info_list.empty())
+        {
+            demuxer->closeContainerDemux();
+            return -1;
+        }
+        // avcC / hvcC now, the MP4 form of the global header
+        extraData = containerInfo.stream_info_list.front().codec_params.extra_data;
+        demuxer->setZeroCopy(!m_copy_packets);
+
+        const uint32_t latencyId = m_profiler->registerMetric(bench.label + " demux latency", "us");
+        packets.reserve(m_packets.size());
+        stage.latency_us.reserve(m_packets.size());
+        while (true)
+        {
+            bsp_container::StreamPacket packet;
+            BSP_TRACE_BEGIN(Io, "Bench Demux");
+            auto begin = m_profiler->getCurrentTimePoint();
+            int ret = demuxer->readStreamPacket(packet);
+            auto end = m_profiler->getCurrentTimePoint();
+            BSP_TRACE_END(Io);
+            if (ret < 0)
+            {
+                break;
+            }
+            const double latency = static_cast<double>(m_profiler->getLatencyUs(begin, end));
+            stage.latency_us.push_back(latency);
+            m_profiler->asyncRecordPerfData(latencyId, latency);
+            if (packet.buffer.empty())
+            {
+                stage.bytes_copied += packet.useful_pkt_size;
+            }
+            stage.frames++;
+            packets.push_back(std::move(packet));
+        }
+        demuxer->closeContainerDemux();
+        clock.stop(stage);
+        return 0;
+    }
+
+    int remuxPackets(const BenchCase& bench, const std::string& path, std::vector<bsp_container::StreamPacket>& packets,
+                     const std::vector<uint8_t>& extraData, StageResult& stage)
+    {
+        stage.name = "remux";
+        auto muxer = bsp_container::IMuxer::create("FFmpegMuxer");
+        bsp_container::IMuxer::MuxConfig cfg;
+        cfg.ts_recreate = true;
+        cfg.video_fps = static_cast<float>(bench.fps);
+
+        StageClock clock;
+        if (muxer->openContainerMux(path, cfg) < 0)
+        {
+            std::cerr << LOG_TAG << "open " << path << " failed" << std::endl;
+            return -1;
+        }
+        auto info = videoStreamInfo(bench, extraData);
+        int streamIndex = muxer->addStream(info);
+        if (streamIndex < 0)
+        {
+            muxer->closeContainerMux();
+            return -1;
+        }
+
+        const uint32_t latencyId = m_profiler->registerMetric(bench.label + " remux latency", "us");
+        stage.latency_us.reserve(packets.size());
+        int ret = 0;
+        for (auto& packet : packets)
+        {
+            packet.stream_index = streamIndex;
+            BSP_TRACE_BEGIN(Io, "Bench Remux");
+            auto begin = m_profiler->getCurrentTimePoint();
+            int64_t copied = writePacket(*muxer, packet);
+            auto end = m_profiler->getCurrentTimePoint();
+            BSP_TRACE_END(Io);
+            if (copied < 0)
+            {
+                std::cerr << LOG_TAG << bench.label << ": remux failed" << std::endl;
+                ret = -1;
+                break;
+            }
+            const double latency = static_cast<double>(m_profiler->getLatencyUs(begin, end));
+            stage.latency_us.push_back(latency);
+            m_profiler->asyncRecordPerfData(latencyId, latency);
+            stage.bytes_copied += static_cast<uint64_t>(copied);
+            stage.frames++;
+        }
+        if (muxer->endStreamMux() < 0)
+        {
+            ret = -1;
+        }
+        muxer->closeContainerMux();
+        clock.stop(stage);
+        return ret;
+    }
+
+    /**
+     * @brief Nearest rank percentile, q in (0, 1].
+     */
+    static double percentile(std::vector<double> samples, double q)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(samples.size())));
+        rank = std::min(std::max<size_t>(rank, 1), samples.size());
+        std::nth_element(samples.begin(), samples.begin() + (rank - 1), samples.end());
+        return samples[rank - 1];
+    }
+
+    static std::vector<std::string> splitList(const std::string& list)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+private:
+    std::unique_ptr<bsp_perf::common::PerfProfiler> m_profiler{nullptr};
+    std::string m_encoder_impl{"ffmpeg"};
+    std::string m_decoder_impl{"ffmpeg"};
+    std::string m_encoding{"h264"};
+    int32_t m_frames{300};
+    std::string m_output_dir{"logs"};
+    bool m_copy_packets{false};
+    bool m_keep_files{false};
+
+    std::vector<BenchCase> m_cases{};
+    std::vector<CaseResult> m_results{};
+
+    std::vector<std::shared_ptr<bsp_perf::bsp_image::ImageBuffer>> m_sequence{};
+    std::unique_ptr<bsp_codec::IEncoder> m_encoder{nullptr};
+    std::vector<EncodedFrame> m_packets{};
+    std::string m_header{};
+};
+
+} // namespace perf_cases
+} // namespace bsp_perf
+
+#endif // __CODEC_CONTAINER_PERF_HPP__
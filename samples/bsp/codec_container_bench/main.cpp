@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+#include "codecContainerPerf.hpp"
+
+using namespace bsp_perf::perf_cases;
+using namespace bsp_perf::shared;
+using namespace std::string_literals;
+
+int main(int argc, char* argv[])
+{
+    ArgParser parser("codecContainerPerf");
+    parser.addOption("--case_name", "Codec Container Bench"s, "name of perf test case");
+    parser.addOption("--profile_path", "logs/codec_container.metrics"s, "path the of the profile file");
+    parser.addOption("--encoderImpl", "ffmpeg"s, "encoder backend: ffmpeg, rkmpp or nvenc");
+    parser.addOption("--decoderImpl", "ffmpeg"s, "decoder backend: ffmpeg, rkmpp or nvdec");
+    parser.addOption("--encodingType", "h264"s, "h264 or h265");
+    parser.addOption("--resolutions", "640x360,1280x720,1920x1080"s, "comma separated WxH list");
+    parser.addOption("--rates", "30"s, "comma separated frame rate list");
+    parser.addOption("--frames", int32_t(300), "frames per resolution and rate");
+    parser.addOption("--output_dir", "logs"s, "directory of the muxed / remuxed files");
+    parser.addFlag("--copy_packets", false, "pass packets as pkt_data copies instead of shared buffers");
+    parser.addFlag("--keep_files", false, "keep the muxed / remuxed files");
+    parser.addOption("--cycles", int32_t(1), "Running cycles for the perf case");
+    parser.parseArgs(argc, argv);
+
+    int32_t cycles;
+    parser.getOptionVal("--cycles", cycles);
+
+    BspTrace codecTrace("./codec_container_perf.perfetto");
+
+    codecContainerPerf perf_case(std::move(parser));
+    perf_case.run(cycles);
+
+    return 0;
+}
@@ -10,7 +10,7 @@ int main(int argc, char* argv[])
 {
     ArgParser parser("ddrPerf");
     parser.addOption("--case_name", "DDR RW Bandwidth"s, "name of perf test case");
-    parser.addOption("--profile_path", "logs/ddr_rw.profile"s, "path the of the profile file");
+    parser.addOption("--profile_path", "logs/ddr_rw.metrics"s, "path the of the profile file");
     parser.addOption("--size_mb", size_t(256), "Memory size for the perf case");
     parser.addOption("--cycles", int32_t(5), "Running cycles for the perf case");
     parser.parseArgs(argc, argv);
@@ -94,26 +94,33 @@ private:
 
     void onProcess() override
     {
-        StreamPacket streamPacket;
-        while(m_demuxer->readStreamPacket(streamPacket) >= 0)
+        // packets reference the demuxer buffers and go to the writers without a copy
+        m_demuxer->setZeroCopy(true);
+        std::vector<StreamPacket> packets;
+        int count = 0;
+        while ((count = m_demuxer->readStreamPackets(packets, PACKET_BATCH_SIZE)) > 0)
         {
-            m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
-                "DemuxApp::onProcess() streamPacket: stream_index: {}, pts: {}, dts: {}, size: {}",
-                streamPacket.stream_index, streamPacket.pts, streamPacket.dts, streamPacket.useful_pkt_size);
-
-            std::string codec_type = m_streamInfoMap[streamPacket.stream_index].codec_params.codec_type;
-            if (codec_type == "video")
+            for (int i = 0; i < count; i++)
             {
-                m_frame_count++;
-                if(1 == m_frame_count)
+                const StreamPacket& streamPacket = packets[i];
+                m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
+                    "DemuxApp::onProcess() streamPacket: stream_index: {}, pts: {}, dts: {}, size: {}",
+                    streamPacket.stream_index, streamPacket.pts, streamPacket.dts, streamPacket.useful_pkt_size);
+
+                std::string codec_type = m_streamInfoMap[streamPacket.stream_index].codec_params.codec_type;
+                if (codec_type == "video")
                 {
-                    m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info, "DemuxApp::onProcess() write h264 header");
-                    m_streamWriterMap[streamPacket.stream_index]->writeHeader();
+                    m_frame_count++;
+                    if(1 == m_frame_count)
+                    {
+                        m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info, "DemuxApp::onProcess() write h264 header");
+                        m_streamWriterMap[streamPacket.stream_index]->writeHeader();
+                    }
+                    m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
+                        "DemuxApp::onProcess() video streamPacket: stream_index: {}, pts: {}, dts: {}, duration: {}, size: {}",
+                        streamPacket.stream_index, streamPacket.pts, streamPacket.dts, streamPacket.duration, streamPacket.useful_pkt_size);
+                    m_streamWriterMap[streamPacket.stream_index]->writePacket(streamPacket);
                 }
-                m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
-                    "DemuxApp::onProcess() video streamPacket: stream_index: {}, pts: {}, dts: {}, duration: {}, size: {}",
-                    streamPacket.stream_index, streamPacket.pts, streamPacket.dts, streamPacket.duration, streamPacket.useful_pkt_size);
-                m_streamWriterMap[streamPacket.stream_index]->writePacket(streamPacket);
             }
         }
         for (auto& writer_pair : m_streamWriterMap)
@@ -138,6 +145,7 @@ private:
     }
 
 private:
+    static constexpr size_t PACKET_BATCH_SIZE{16};
     std::string m_name {"[DemuxApp]:"};
     std::unique_ptr<bsp_perf::shared::BspLogger> m_logger{nullptr};
     std::unique_ptr<IDemuxer> m_demuxer{nullptr};
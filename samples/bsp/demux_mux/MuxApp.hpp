@@ -62,6 +62,8 @@ private:
     void onProcess() override
     {
         StreamPacket streamPacket;
+        // remux by reference, the reader's packet buffer goes straight into the muxer
+        m_streamReaderMap[0]->setZeroCopy(true);
         while (m_streamReaderMap[0]->readPacket(streamPacket) >= 0)
         {
             m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
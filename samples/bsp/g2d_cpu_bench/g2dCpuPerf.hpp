@@ -0,0 +1,199 @@
+/*
+MIT License
+
+Copyright (c) 2024 Clarence Zhou<287334895@qq.com> and contributors.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#ifndef __G2D_CPU_PERF_HPP__
+#define __G2D_CPU_PERF_HPP__
+
+#include <framework/BasePerfCase.hpp>
+#include <shared/ArgParser.hpp>
+#include <profiler/PerfProfiler.hpp>
+#include <profiler/BspTrace.hpp>
+#include <bsp_g2d/IGraphics2D.hpp>
+#include <bsp_image/ImageBuffer.hpp>
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <iostream>
+
+namespace bsp_perf {
+namespace perf_cases {
+
+using namespace bsp_perf::common;
+
+/**
+ * @brief Compares the "cpu" IGraphics2D backend against OpenCV on the same host:
+ * NV12 -> RGB888 conversion and a bilinear RGB888 downscale, the two ops of a detector preprocess.
+ */
+class g2dCpuPerf : public BasePerfCase
+{
+
+public:
+
+    g2dCpuPerf(bsp_perf::shared::ArgParser&& args):
+        BasePerfCase(std::move(args))
+    {
+        auto& params = getArgs();
+        std::string case_name;
+        params.getOptionVal("--case_name", case_name);
+        std::string file_path;
+        params.getOptionVal("--profile_path", file_path);
+        m_profiler = std::make_unique<bsp_perf::common::PerfProfiler>(case_name, file_path);
+    }
+    g2dCpuPerf(const g2dCpuPerf&) = delete;
+    g2dCpuPerf& operator=(const g2dCpuPerf&) = delete;
+    g2dCpuPerf(g2dCpuPerf&&) = delete;
+    g2dCpuPerf& operator=(g2dCpuPerf&&) = delete;
+    ~g2dCpuPerf()
+    {
+        m_profiler.reset();
+    }
+
+private:
+
+    void onInit() override
+    {
+        BSP_TRACE_EVENT_BEGIN("G2D CPU Perf Init");
+        auto& params = getArgs();
+        params.getOptionVal("--src_width", m_src_width);
+        params.getOptionVal("--src_height", m_src_height);
+        params.getOptionVal("--dst_width", m_dst_width);
+        params.getOptionVal("--dst_height", m_dst_height);
+        params.getOptionVal("--isa", m_isa);
+
+        m_g2d = bsp_g2d::IGraphics2D::create("cpu");
+
+        m_nv12 = makeImage(m_src_width, m_src_height, "YUV420SP");
+        m_rgb = makeImage(m_src_width, m_src_height, "RGB888");
+        m_resized = makeImage(m_dst_width, m_dst_height, "RGB888");
+        m_cv_nv12 = cv::Mat(m_src_height * 3 / 2, m_src_width, CV_8UC1, m_nv12.host->view.data());
+        cv::randu(m_cv_nv12, 0, 255);
+        BSP_TRACE_EVENT_END();
+    }
+
+    void onProcess() override
+    {
+        {
+            BSP_TRACE_EVENT_BEGIN("Cpu2d NV12 to RGB");
+            auto begin = m_profiler->getCurrentTimePoint();
+            m_g2d->imageCvtColor(m_nv12.g2d, m_rgb.g2d, "YUV420SP", "RGB888");
+            auto end = m_profiler->getCurrentTimePoint();
+            m_cpu2d_cvt_us = m_profiler->getLatencyUs(begin, end);
+            m_profiler->asyncRecordPerfData("Cpu2d NV12 to RGB", m_cpu2d_cvt_us, "us");
+            BSP_TRACE_EVENT_END();
+        }
+
+        {
+            BSP_TRACE_EVENT_BEGIN("OpenCV NV12 to RGB");
+            auto begin = m_profiler->getCurrentTimePoint();
+            cv::cvtColor(m_cv_nv12, m_cv_rgb, cv::COLOR_YUV2RGB_NV12);
+            auto end = m_profiler->getCurrentTimePoint();
+            m_opencv_cvt_us = m_profiler->getLatencyUs(begin, end);
+            m_profiler->asyncRecordPerfData("OpenCV NV12 to RGB", m_opencv_cvt_us, "us");
+            BSP_TRACE_EVENT_END();
+        }
+
+        {
+            BSP_TRACE_EVENT_BEGIN("Cpu2d Resize");
+            auto begin = m_profiler->getCurrentTimePoint();
+            m_g2d->imageResize(m_rgb.g2d, m_resized.g2d);
+            auto end = m_profiler->getCurrentTimePoint();
+            m_cpu2d_resize_us = m_profiler->getLatencyUs(begin, end);
+            m_profiler->asyncRecordPerfData("Cpu2d Resize", m_cpu2d_resize_us, "us");
+            BSP_TRACE_EVENT_END();
+        }
+
+        {
+            BSP_TRACE_EVENT_BEGIN("OpenCV Resize");
+            auto begin = m_profiler->getCurrentTimePoint();
+            cv::resize(m_cv_rgb, m_cv_resized, cv::Size(m_dst_width, m_dst_height), 0, 0, cv::INTER_LINEAR);
+            auto end = m_profiler->getCurrentTimePoint();
+            m_opencv_resize_us = m_profiler->getLatencyUs(begin, end);
+            m_profiler->asyncRecordPerfData("OpenCV Resize", m_opencv_resize_us, "us");
+            BSP_TRACE_EVENT_END();
+        }
+    }
+
+    void onRender() override
+    {
+        std::cout << "Cpu2d kernels: " << m_isa << std::endl;
+        m_profiler->printPerfData("Cpu2d NV12 to RGB", m_cpu2d_cvt_us, "us");
+        m_profiler->printPerfData("OpenCV NV12 to RGB", m_opencv_cvt_us, "us");
+        m_profiler->printPerfData("Cpu2d Resize", m_cpu2d_resize_us, "us");
+        m_profiler->printPerfData("OpenCV Resize", m_opencv_resize_us, "us");
+    }
+
+    void onRelease() override
+    {
+        m_nv12 = {};
+        m_rgb = {};
+        m_resized = {};
+        m_g2d.reset();
+    }
+
+    struct BenchImage
+    {
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> host{nullptr};
+        std::shared_ptr<bsp_perf::bsp_image::ImageBuffer> g2d{nullptr};
+    };
+
+    BenchImage makeImage(int width, int height, const std::string& format)
+    {
+        bsp_perf::bsp_image::ImageDesc desc{};
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        BenchImage image;
+        image.host = bsp_perf::bsp_image::makeHostImageBuffer(desc);
+        image.g2d = m_g2d->createBuffer(bsp_g2d::IGraphics2D::BufferType::Mapped, image.host->view);
+        return image;
+    }
+
+private:
+    std::unique_ptr<bsp_perf::common::PerfProfiler> m_profiler{nullptr};
+    std::unique_ptr<bsp_g2d::IGraphics2D> m_g2d{nullptr};
+    int32_t m_src_width{1920};
+    int32_t m_src_height{1080};
+    int32_t m_dst_width{640};
+    int32_t m_dst_height{640};
+    std::string m_isa{"auto"};
+
+    BenchImage m_nv12{};
+    BenchImage m_rgb{};
+    BenchImage m_resized{};
+    cv::Mat m_cv_nv12{};
+    cv::Mat m_cv_rgb{};
+    cv::Mat m_cv_resized{};
+
+    size_t m_cpu2d_cvt_us{0};
+    size_t m_opencv_cvt_us{0};
+    size_t m_cpu2d_resize_us{0};
+    size_t m_opencv_resize_us{0};
+};
+
+} // namespace perf_cases
+} // namespace bsp_perf
+
+#endif // __G2D_CPU_PERF_HPP__
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "g2dCpuPerf.hpp"
+
+using namespace bsp_perf::perf_cases;
+using namespace bsp_perf::shared;
+using namespace std::string_literals;
+
+int main(int argc, char* argv[])
+{
+    ArgParser parser("g2dCpuPerf");
+    parser.addOption("--case_name", "G2D CPU Backend"s, "name of perf test case");
+    parser.addOption("--profile_path", "logs/g2d_cpu.metrics"s, "path the of the profile file");
+    parser.addOption("--src_width", int32_t(1920), "source image width");
+    parser.addOption("--src_height", int32_t(1080), "source image height");
+    parser.addOption("--dst_width", int32_t(640), "resize target width");
+    parser.addOption("--dst_height", int32_t(640), "resize target height");
+    parser.addOption("--isa", "auto"s, "cpu kernels: auto, avx2, sse, neon or scalar");
+    parser.addOption("--threads", int32_t(0), "worker threads for both cpu2d and OpenCV, 0: all cores");
+    parser.addOption("--cycles", int32_t(100), "Running cycles for the perf case");
+    parser.parseArgs(argc, argv);
+
+    int32_t cycles;
+    parser.getOptionVal("--cycles", cycles);
+
+    // the cpu backend reads both at its first use
+    std::string isa;
+    parser.getOptionVal("--isa", isa);
+    if (isa != "auto")
+    {
+        setenv("BSP_CPU2D_ISA", isa.c_str(), 1);
+    }
+    int32_t threads;
+    parser.getOptionVal("--threads", threads);
+    if (threads > 0)
+    {
+        setenv("BSP_PARALLEL_THREADS", std::to_string(threads).c_str(), 1);
+        cv::setNumThreads(threads);
+    }
+
+    BspTrace g2dCpuTrace("./g2d_cpu_perf.perfetto");
+
+    g2dCpuPerf perf_case(std::move(parser));
+    perf_case.run(cycles);
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <string>
+#include "parallelScalingPerf.hpp"
+
+using namespace bsp_perf::perf_cases;
+using namespace bsp_perf::shared;
+using namespace std::string_literals;
+
+int main(int argc, char* argv[])
+{
+    ArgParser parser("parallelScalingPerf");
+    parser.addOption("--case_name", "BspParallel Scaling"s, "name of perf test case");
+    parser.addOption("--profile_path", "logs/parallel_scaling.metrics"s, "path the of the profile file");
+    parser.addOption("--width", int32_t(1600), "image width");
+    parser.addOption("--height", int32_t(1600), "image height");
+    parser.addOption("--max_threads", int32_t(0), "largest thread count of the sweep, 0: all pool threads");
+    parser.addOption("--cycles", int32_t(20), "Running cycles for the perf case");
+    parser.parseArgs(argc, argv);
+
+    int32_t cycles;
+    parser.getOptionVal("--cycles", cycles);
+
+    BspTrace parallelTrace("./parallel_scaling.perfetto");
+
+    parallelScalingPerf perf_case(std::move(parser));
+    perf_case.run(cycles);
+
+    return 0;
+}
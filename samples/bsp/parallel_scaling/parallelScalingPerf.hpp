@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2024 Clarence Zhou<287334895@qq.com> and contributors.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __PARALLEL_SCALING_PERF_HPP__
+#define __PARALLEL_SCALING_PERF_HPP__
+
+#include <framework/BasePerfCase.hpp>
+#include <shared/ArgParser.hpp>
+#include <shared/BspParallel.hpp>
+#include <profiler/PerfProfiler.hpp>
+#include <profiler/BspTrace.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bsp_perf {
+namespace perf_cases {
+
+using namespace bsp_perf::common;
+using bsp_perf::shared::BspParallel;
+
+/**
+ * @brief Thread scaling of BspParallel from 1 to N threads on the surround view kernels:
+ * the weighted two image BGR blend (tiled) and the per channel BGR sum (row bands).
+ */
+class parallelScalingPerf : public BasePerfCase
+{
+
+public:
+
+    parallelScalingPerf(bsp_perf::shared::ArgParser&& args):
+        BasePerfCase(std::move(args))
+    {
+        auto& params = getArgs();
+        std::string case_name;
+        params.getOptionVal("--case_name", case_name);
+        std::string file_path;
+        params.getOptionVal("--profile_path", file_path);
+        m_profiler = std::make_unique<bsp_perf::common::PerfProfiler>(case_name, file_path);
+    }
+    parallelScalingPerf(const parallelScalingPerf&) = delete;
+    parallelScalingPerf& operator=(const parallelScalingPerf&) = delete;
+    parallelScalingPerf(parallelScalingPerf&&) = delete;
+    parallelScalingPerf& operator=(parallelScalingPerf&&) = delete;
+    ~parallelScalingPerf()
+    {
+        BspParallel::getInstance().setThreadLimit(0);
+        m_profiler.reset();
+    }
+
+private:
+
+    void onInit() override
+    {
+        BSP_TRACE_EVENT_BEGIN("Parallel Scaling Init");
+        auto& params = getArgs();
+        params.getOptionVal("--width", m_width);
+        params.getOptionVal("--height", m_height);
+        int32_t max_threads = 0;
+        params.getOptionVal("--max_threads", max_threads);
+
+        auto& parallel = BspParallel::getInstance();
+        m_max_threads = (max_threads > 0) ? std::min(max_threads, parallel.maxConcurrency()) : parallel.maxConcurrency();
+
+        const size_t pixels = static_cast<size_t>(m_width) * m_height;
+        m_src1.resize(pixels * 3);
+        m_src2.resize(pixels * 3);
+        m_dst.resize(pixels * 3);
+        m_weight.resize(pixels);
+        for (size_t i = 0; i < pixels * 3; ++i)
+        {
+            m_src1[i] = static_cast<uint8_t>(std::rand());
+            m_src2[i] = static_cast<uint8_t>(std::rand());
+        }
+        for (size_t i = 0; i < pixels; ++i)
+        {
+            m_weight[i] = static_cast<float>(std::rand() % 256) / 255.0f;
+        }
+
+        m_blend_us.assign(m_max_threads + 1, 0);
+        m_sum_us.assign(m_max_threads + 1, 0);
+
+        std::cout << "BspParallel: " << parallel.maxConcurrency() << " threads, " << parallel.clusters().size()
+                  << " cpu clusters, tile budget " << parallel.tileBytes() / 1024 << " KiB" << std::endl;
+        BSP_TRACE_EVENT_END();
+    }
+
+    void onProcess() override
+    {
+        auto& parallel = BspParallel::getInstance();
+        for (int threads = 1; threads <= m_max_threads; ++threads)
+        {
+            parallel.setThreadLimit(threads);
+            const std::string suffix = " x" + std::to_string(threads);
+
+            {
+                BSP_TRACE_EVENT_BEGIN("Blend");
+                auto begin = m_profiler->getCurrentTimePoint();
+                blend();
+                auto end = m_profiler->getCurrentTimePoint();
+                m_blend_us[threads] = m_profiler->getLatencyUs(begin, end);
+                m_profiler->asyncRecordPerfData("Blend" + suffix, m_blend_us[threads], "us");
+                BSP_TRACE_EVENT_END();
+            }
+
+            {
+                BSP_TRACE_EVENT_BEGIN("BGR Sum");
+                auto begin = m_profiler->getCurrentTimePoint();
+                bgrSum();
+                auto end = m_profiler->getCurrentTimePoint();
+                m_sum_us[threads] = m_profiler->getLatencyUs(begin, end);
+                m_profiler->asyncRecordPerfData("BGR Sum" + suffix, m_sum_us[threads], "us");
+                BSP_TRACE_EVENT_END();
+            }
+        }
+        parallel.setThreadLimit(0);
+    }
+
+    void onRender() override
+    {
+        std::cout << "Image " << m_width << "x" << m_height << std::endl;
+        for (int threads = 1; threads <= m_max_threads; ++threads)
+        {
+            const std::string suffix = " x" + std::to_string(threads);
+            m_profiler->printPerfData("Blend" + suffix, m_blend_us[threads], "us");
+            m_profiler->printPerfData("BGR Sum" + suffix, m_sum_us[threads], "us");
+            if ((threads > 1) && (m_blend_us[threads] > 0) && (m_sum_us[threads] > 0))
+            {
+                std::cout << "  speedup x" << threads << ": blend "
+                          << static_cast<double>(m_blend_us[1]) / static_cast<double>(m_blend_us[threads])
+                          << ", sum " << static_cast<double>(m_sum_us[1]) / static_cast<double>(m_sum_us[threads])
+                          << std::endl;
+            }
+        }
+    }
+
+    void onRelease() override
+    {
+        m_src1.clear();
+        m_src2.clear();
+        m_dst.clear();
+        m_weight.clear();
+    }
+
+    static uint8_t clipToByte(float value)
+    {
+        return static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, value)));
+    }
+
+    // same math as SvsBlender::mergeImage
+    void blend()
+    {
+        constexpr size_t bytes_per_pixel = 3 + 3 + 3 + sizeof(float);
+        BspParallel::getInstance().parallelForTiles(m_width, m_height, bytes_per_pixel, [&](const BspParallel::Tile& tile) {
+            for (int row = tile.y; row < tile.y + tile.height; ++row)
+            {
+                const size_t offset = static_cast<size_t>(row) * m_width + tile.x;
+                const uint8_t* p1 = m_src1.data() + offset * 3;
+                const uint8_t* p2 = m_src2.data() + offset * 3;
+                const float* w = m_weight.data() + offset;
+                uint8_t* dst = m_dst.data() + offset * 3;
+                for (int col = 0; col < tile.width; ++col)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        dst[c] = clipToByte(static_cast<float>(p1[c]) * w[col] + static_cast<float>(p2[c]) * (1.0f - w[col]));
+                    }
+                    p1 += 3;
+                    p2 += 3;
+                    dst += 3;
+                }
+            }
+        });
+    }
+
+    // the reduction of SvsBlender's white balance statistics
+    void bgrSum()
+    {
+        std::atomic<int64_t> sum{0};
+        BspParallel::getInstance().parallelFor(m_height, 16, 1, [&](int begin, int end) {
+            int64_t local = 0;
+            const uint8_t* pixel = m_dst.data() + static_cast<size_t>(begin) * m_width * 3;
+            const uint8_t* last = m_dst.data() + static_cast<size_t>(end) * m_width * 3;
+            for (; pixel < last; ++pixel)
+            {
+                local += *pixel;
+            }
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+        m_checksum = sum.load();
+    }
+
+private:
+    std::unique_ptr<bsp_perf::common::PerfProfiler> m_profiler{nullptr};
+    int32_t m_width{1600};
+    int32_t m_height{1600};
+    int m_max_threads{1};
+
+    std::vector<uint8_t> m_src1{};
+    std::vector<uint8_t> m_src2{};
+    std::vector<uint8_t> m_dst{};
+    std::vector<float> m_weight{};
+    int64_t m_checksum{0};
+
+    std::vector<size_t> m_blend_us{};
+    std::vector<size_t> m_sum_us{};
+};
+
+} // namespace perf_cases
+} // namespace bsp_perf
+
+#endif // __PARALLEL_SCALING_PERF_HPP__
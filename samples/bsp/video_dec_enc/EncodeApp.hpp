@@ -154,18 +154,17 @@ private:
             // 拷贝输入数据到编码器缓冲区
             memcpy(inputBuf->view.data(), data_ptr + offset, m_frame_size);
 
-            // 准备输出包
+            // 准备输出包，码流通过 outPkt.buffer 引用编码器输出，不再拷贝
             EncodePacket outPkt;
             outPkt.max_size = m_frame_size * 2; // 预留足够空间
             outPkt.pkt_eos = 0;
-            outPkt.encode_pkt.resize(outPkt.max_size);
 
             // 编码
             m_encoder->encode(*inputBuf, outPkt);
             m_logger->printStdoutLog(bsp_perf::shared::BspLogger::LogLevel::Info,
                 "EncodeApp::onProcess() Encoded {} frames, offset: {} / {}",
                 m_frame_count, offset, total_size);
-            fwrite(outPkt.encode_pkt.data(), 1, outPkt.pkt_len, m_outputFile.get());
+            fwrite(outPkt.buffer.data, 1, outPkt.buffer.size, m_outputFile.get());
 
             m_frame_count++;
             offset += m_frame_size;
@@ -193,9 +192,8 @@ private:
             eosPkt.max_size = m_encoder->getFrameSize() * 2;
             eosPkt.pkt_eos = 1;
             eosPkt.pkt_len = 0;
-            eosPkt.encode_pkt.resize(eosPkt.max_size);
             m_encoder->encode(*inputBuf, eosPkt);
-            fwrite(eosPkt.encode_pkt.data(), 1, eosPkt.pkt_len, m_outputFile.get());
+            fwrite(eosPkt.buffer.data, 1, eosPkt.buffer.size, m_outputFile.get());
         }
 
         // Wait for encoding to complete
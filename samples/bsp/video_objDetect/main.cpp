@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include "VideoDetectApp.hpp"
+#include <shared/BspThreadConfig.hpp>
 
 using namespace bsp_perf::perf_cases;
 using namespace bsp_perf::shared;
@@ -25,9 +26,14 @@ int main(int argc, char* argv[])
     parser.addSubOption("objDetectParams", "--pads_top", int(0), "objDetectParams pads_top");
     parser.addSubOption("objDetectParams", "--pads_bottom", int(0), "objDetectParams pads_bottom");
 
+    BspThreadConfig::addArgOptions(parser);
+
     parser.setConfig("--cfg", "config.ini", "set an configuration ini file for all options");
     parser.parseArgs(argc, argv);
 
+    BspThreadConfig::getInstance().loadArgConfig(parser);
+    BspThreadConfig::getInstance().applyMemoryPolicy();
+
 
     VideoDetectApp app(std::move(parser));
     app.run();